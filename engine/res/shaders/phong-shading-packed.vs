@@ -0,0 +1,46 @@
+#version 460 core
+
+//Packed vertex layout of the asset-manager/cook/vertex-quantize.h
+layout(location = 0) in vec4 position; //Unorm inside of the mesh bounds, w is the sign of the bitangent
+layout(location = 1) in vec2 normal;   //Octahedral snorm
+layout(location = 2) in vec2 uv;       //Half floats
+layout(location = 3) in vec2 tangent;  //Octahedral snorm
+
+out VS_OUT
+{
+	vec3 FragPos;
+	vec3 Normal;
+	vec2 UV;
+	vec3 Tangent;
+} vs_out;
+
+uniform mat4 ToClip = mat4(1.0f);
+uniform mat4 ToCamera = mat4(1.0f);
+uniform mat4 ToWorld = mat4(1.0f);
+
+uniform vec3 PositionOffset = vec3(0.0f);
+uniform vec3 PositionScale = vec3(1.0f);
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 v = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+	//Lower hemisphere is folded onto the corners of the square
+	float t = max(-v.z, 0.0f);
+	v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0.0f)));
+
+	return normalize(v);
+}
+
+void main()
+{
+	vec3 objectPosition = PositionOffset + PositionScale * position.xyz;
+	vec3 objectTangent = DecodeOctahedral(tangent);
+
+	vs_out.FragPos = (ToWorld * vec4(objectPosition, 1.0f)).xyz;
+	vs_out.Normal = DecodeOctahedral(normal);
+	vs_out.UV = uv;
+	vs_out.Tangent = (ToWorld * vec4(objectTangent, 1.0f)).xyz;
+
+	gl_Position = ToClip * ToCamera * ToWorld * vec4(objectPosition, 1.0f);
+}
@@ -419,7 +419,9 @@ void main()
 {
     vec3 lightSum;
 
-    vec3 normalTexture = 2.0f * (texture(NormalTexture, vs_in.UV).xyz - 0.5f);
+    //Z is reconstructed, because the BC5 normal maps store only X and Y
+    vec2 normalXY = 2.0f * (texture(NormalTexture, vs_in.UV).xy - 0.5f);
+    vec3 normalTexture = vec3(normalXY, sqrt(max(1.0f - dot(normalXY, normalXY), 0.0f)));
 
     mat3 tbn = mat3(normalize(vs_in.Tangent),
                     normalize(cross(vs_in.Tangent, vs_in.Normal)),
@@ -2,251 +2,1346 @@
 
 #include <filesystem>
 #include <string_view>
+#include <charconv>
+#include <cmath>
+#include <thread>
 
 #include "stb/stb_image.h"
 
+#include "cook/mip-chain.h"
+#include "cook/atlas.h"
+#include "cook/mesh-simplify.h"
+#include "cook/meshlets.h"
+#include "cook/mesh-optimize.h"
+#include "gltf/glb.h"
+#include "obj/obj-reader.h"
 #include "jobs/job-system.h"
+#include "jobs/pipeline.h"
+#include "utils/io-file.h"
 #include "utils/timer.h"
 
 namespace assets
 {
    namespace loaders
    {
-      TrigVertices LoadTrigVertices(const std::string_view filepath)
+      //Tangents are computed per triangle from its UVs and are summed in its vertices, so the shared vertices get the mean of their triangles
+      static void ComputeTangents(TrigVertices& mesh)
+      {
+         const size_t verticesCount = mesh.Positions.size();
+         const size_t indicesCount = mesh.Indices.empty() ? verticesCount : mesh.Indices.size();
+
+         mesh.Tangents.assign(verticesCount, mm::vec3(0.0f));
+         mesh.Bitangents.assign(verticesCount, mm::vec3(0.0f));
+
+         for (size_t i = 0; i + 2 < indicesCount; i += 3)
+         {
+            const size_t i0 = mesh.Indices.empty() ? i : mesh.Indices[i];
+            const size_t i1 = mesh.Indices.empty() ? i + 1 : mesh.Indices[i + 1];
+            const size_t i2 = mesh.Indices.empty() ? i + 2 : mesh.Indices[i + 2];
+
+            mm::vec3 p0 = mesh.Positions[i0];
+            mm::vec3 p1 = mesh.Positions[i1];
+            mm::vec3 p2 = mesh.Positions[i2];
+
+            mm::vec2 uv0 = mesh.UVs[i0];
+            mm::vec2 uv1 = mesh.UVs[i1];
+            mm::vec2 uv2 = mesh.UVs[i2];
+
+            mm::vec3 edge1 = p1 - p0;
+            mm::vec3 edge2 = p2 - p0;
+
+            mm::vec2 uvEdge1 = uv1 - uv0;
+            mm::vec2 uvEdge2 = uv2 - uv0;
+
+
+            //Find matrix inverse
+
+            float inverseD = 1 / (uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x);
+
+            //Triangle without the UV area has no tangent space, it would spread NaNs to its neighbours
+            if (!std::isfinite(inverseD))
+               continue;
+
+            float m00 = uvEdge2.y * inverseD;
+            float m01 = -uvEdge1.y * inverseD;
+            float m10 = -uvEdge2.x * inverseD;
+            float m11 = uvEdge1.x * inverseD;
+
+
+            mm::vec3 tangent;
+            tangent.x = m00 * edge1.x + m01 * edge2.x;
+            tangent.y = m00 * edge1.y + m01 * edge2.y;
+            tangent.z = m00 * edge1.z + m01 * edge2.z;
+
+            mm::vec3 bitangent;
+            bitangent.x = m10 * edge1.x + m11 * edge2.x;
+            bitangent.y = m10 * edge1.y + m11 * edge2.y;
+            bitangent.z = m10 * edge1.z + m11 * edge2.z;
+
+            if (mm::length(tangent) == 0.0f || mm::length(bitangent) == 0.0f)
+               continue;
+
+            tangent = mm::normalize(tangent);
+            bitangent = mm::normalize(bitangent);
+
+            for (const size_t vertex : { i0, i1, i2 })
+            {
+               mesh.Tangents[vertex] = mesh.Tangents[vertex] + tangent;
+               mesh.Bitangents[vertex] = mesh.Bitangents[vertex] + bitangent;
+            }
+         }
+
+         for (size_t i = 0; i < verticesCount; ++i)
+         {
+            if (mm::length(mesh.Tangents[i]) > 0.0f)
+               mesh.Tangents[i] = mm::normalize(mesh.Tangents[i]);
+
+            if (mm::length(mesh.Bitangents[i]) > 0.0f)
+               mesh.Bitangents[i] = mm::normalize(mesh.Bitangents[i]);
+         }
+      }
+
+      static TrigVertices MakeTrigVertices(const std::string_view filepath, obj::ObjMesh& mesh, const utils::Timer& loadTimer)
       {
          TrigVertices resData;
 
+         resData.FacesCount = mesh.Indices.size();
+         resData.Positions = std::move(mesh.Positions);
+         resData.Normals = std::move(mesh.Normals);
+         resData.UVs = std::move(mesh.UVs);
+         resData.Indices = std::move(mesh.Indices);
+
+         ComputeTangents(resData);
+
+         resData.Name = filepath;
+         resData.HashedName = utils::HashedString(filepath);
+         resData.LoadTime = loadTimer.GetElapsedTime();
+         resData.IsValid = true;
+
+         return resData;
+      }
+
+      TrigVertices LoadTrigVertices(const std::string_view filepath, const RawData& data)
+      {
          utils::Timer loadTimer(true);
 
-         FILE* file = fopen(&filepath[0], "rb");
-         if (!file)
+         //Data in memory is the single window
+         obj::ObjReader reader;
+         obj::ObjMesh mesh;
+
+         if (!reader.Feed(reinterpret_cast<const char*>(data.Data), data.Size) || !reader.Finish(mesh))
          {
-            //TODO when loading fail laod the default model
-            LOG_ERROR("Failed to load trig model: %s", filepath);
-            return resData;
+            LOG_ERROR("%s: %s", reader.GetError(), filepath.data());
+            return TrigVertices();
+         }
+
+         return MakeTrigVertices(filepath, mesh, loadTimer);
+      }
+
+      TrigVertices StreamTrigVertices(const std::string_view filepath, const obj::ObjReadParams& params, size_t* peakBytes)
+      {
+         utils::Timer loadTimer(true);
+
+         obj::ObjMesh mesh;
+         size_t readerPeakBytes;
+         const char* error;
+
+         const bool isRead = obj::ReadObjFile(filepath, params, mesh, readerPeakBytes, error);
+
+         if (peakBytes)
+            *peakBytes = readerPeakBytes;
+
+         if (!isRead)
+         {
+            LOG_ERROR("%s: %s", error, filepath.data());
+            return TrigVertices();
          }
 
-         std::vector<mm::vec3> positionArray;
-         std::vector<mm::vec3> normalArray;
-         std::vector<mm::vec2> uvArray;
+         return MakeTrigVertices(filepath, mesh, loadTimer);
+      }
+
+      TrigVertices LoadGlbVertices(const std::string_view filepath, const RawData& data)
+      {
+         TrigVertices resData;
 
-         std::vector<uint32_t> positionIndicesArray;
-         std::vector<uint32_t> normalIndicesArray;
-         std::vector<uint32_t> uvIndicesArray;
+         utils::Timer loadTimer(true);
 
-         while (1)
+         gltf::GlbMesh mesh;
+         if (!gltf::ImportGlb(data.Data, data.Size, mesh))
          {
-            char header[128];
-            if (fscanf(file, "%s", header) == EOF)
-               break;
+            LOG_ERROR("Invalid glb file or it has no triangles: %s", filepath.data());
+            return resData;
+         }
 
-            if (!strcmp(header, "v"))
-            {
-               mm::vec3 v;
-               fscanf(file, "%f %f %f", &v.x, &v.y, &v.z);
+         if (mesh.SkippedPrimitives > 0)
+            LOG_WARNING("%zu non triangle or invalid primitives are skipped: %s", mesh.SkippedPrimitives, filepath.data());
 
-               positionArray.emplace_back(v);
-            }
-            else if (!strcmp(header, "vn"))
-            {
-               mm::vec3 v;
-               fscanf(file, "%f %f %f", &v.x, &v.y, &v.z);
+         resData.FacesCount = mesh.Indices.size();
+         resData.Positions = std::move(mesh.Positions);
+         resData.Normals = std::move(mesh.Normals);
+         resData.UVs = std::move(mesh.UVs);
+         resData.Indices = std::move(mesh.Indices);
 
-               normalArray.emplace_back(v);
-            }
-            else if (!strcmp(header, "vt"))
-            {
-               mm::vec2 v;
-               fscanf(file, "%f %f", &v.x, &v.y);
+         ComputeTangents(resData);
 
-               uvArray.emplace_back(v);
-            }
-            else if (!strcmp(header, "f"))
-            {
-               int p1, p2, p3;
-               int n1, n2, n3;
-               int t1, t2, t3;
+         resData.Name = filepath;
+         resData.HashedName = utils::HashedString(filepath);
+         resData.LoadTime = loadTimer.GetElapsedTime();
+         resData.IsValid = true;
 
-               fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d", &p1, &t1, &n1, &p2, &t2, &n2, &p3, &t3, &n3);
+         return resData;
+      }
+
+      TrigVertices LoadMesh(const std::string_view filepath, const RawData& data)
+      {
+         if (std::filesystem::path(filepath).extension() == ".glb")
+            return LoadGlbVertices(filepath, data);
 
-               positionIndicesArray.emplace_back(p1);
-               positionIndicesArray.emplace_back(p2);
-               positionIndicesArray.emplace_back(p3);
+         return LoadTrigVertices(filepath, data);
+      }
 
-               normalIndicesArray.emplace_back(n1);
-               normalIndicesArray.emplace_back(n2);
-               normalIndicesArray.emplace_back(n3);
+      //Every level has half of the triangles of the previous one, so the last level has 1/16 of the source ones
+      constexpr size_t MeshLodLevels = 4;
+      constexpr float MeshLodRatio = 0.5f;
 
-               uvIndicesArray.emplace_back(t1);
-               uvIndicesArray.emplace_back(t2);
-               uvIndicesArray.emplace_back(t3);
-            }
+      //Triangles are ordered by the meshlets, every meshlet is the continuous range of the indices
+      //Inside of the meshlet the triangles are in the vertex cache order, the meshlets are in the overdraw order,
+      //and the vertices are in the order of their first use
+      //Indices are of the welded vertices, unique has the source soup vertex for every welded one
+      static void CookLevel(const TrigVertices& source, const std::vector<mm::vec3>& positions, const std::vector<uint32_t>& unique,
+                            const std::vector<uint32_t>& indices, TrigVertices& res)
+      {
+         std::vector<cook::Meshlet> meshlets;
+         std::vector<uint32_t> triangles;
+         cook::BuildMeshlets(positions.data(), positions.size(), indices, meshlets, triangles);
+
+         std::vector<uint32_t> resIndices;
+         resIndices.reserve(indices.size());
+
+         for (uint32_t triangle : triangles)
+            resIndices.insert(resIndices.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3);
+
+         for (auto& meshlet : meshlets)
+            cook::OptimizeVertexCache(&resIndices[meshlet.FirstIndex], meshlet.IndicesCount, &resIndices[meshlet.FirstIndex]);
+
+         cook::OptimizeOverdraw(positions.data(), resIndices, meshlets);
+
+         std::vector<uint32_t> vertices;
+         cook::OptimizeVertexFetch(resIndices, positions.size(), vertices);
+
+         std::vector<mm::vec3> resPositions;
+         std::vector<mm::vec3> resNormals;
+         std::vector<mm::vec2> resUVs;
+
+         resPositions.reserve(vertices.size());
+         resNormals.reserve(vertices.size());
+         resUVs.reserve(vertices.size());
+
+         for (uint32_t vertex : vertices)
+         {
+            resPositions.push_back(source.Positions[unique[vertex]]);
+            resNormals.push_back(source.Normals[unique[vertex]]);
+            resUVs.push_back(source.UVs[unique[vertex]]);
          }
 
-         std::vector<mm::vec3> resultPositionArray;
-         std::vector<mm::vec3> resultNormalArray;
-         std::vector<mm::vec2> resultUvArray;
+         //Result can be the source itself, so it is written only at the end
+         res.Positions = std::move(resPositions);
+         res.Normals = std::move(resNormals);
+         res.UVs = std::move(resUVs);
+         res.Indices = std::move(resIndices);
+         res.Meshlets = std::move(meshlets);
+         res.Bounds = cook::ComputeMeshBounds(res.Positions.data(), res.Positions.size());
 
-         for (size_t i = 0; i < positionIndicesArray.size(); ++i)
+         ComputeTangents(res);
+      }
+
+      //Soup is welded by the positions, normals and UVs, so every level is the indexed mesh of the shared vertices
+      //Every level, the source one too, is split into the meshlets and ordered for the GPU
+      void CookMesh(TrigVertices& mesh)
+      {
+         std::vector<uint32_t> remap;
+         std::vector<uint32_t> unique;
+
+         cook::WeldVertices({ mesh.Positions.data(), mesh.Normals.data(), mesh.UVs.data() },
+                            { sizeof(mm::vec3), sizeof(mm::vec3), sizeof(mm::vec2) }, mesh.Positions.size(), remap, unique);
+
+         //Indexed source is welded too, its duplicated vertices are merged and the triangles are remapped to the unique ones
+         if (!mesh.Indices.empty())
          {
-            resultPositionArray.emplace_back(positionArray[positionIndicesArray[i] - 1]);
-            resultNormalArray.emplace_back(normalArray[normalIndicesArray[i] - 1]);
-            resultUvArray.emplace_back(uvArray[uvIndicesArray[i] - 1]);
+            for (auto& index : mesh.Indices)
+               index = remap[index];
+
+            remap = std::move(mesh.Indices);
          }
 
+         std::vector<mm::vec3> positions(unique.size());
+         for (size_t i = 0; i < unique.size(); ++i)
+            positions[i] = mesh.Positions[unique[i]];
 
-         std::vector<mm::vec3> tangentArray;
-         std::vector<mm::vec3> bitangentArray;
+         std::vector<cook::LodLevel> levels = cook::BuildLodChain(positions.data(), positions.size(), remap,
+                                                                  MeshLodLevels, MeshLodRatio);
 
-         for (size_t i = 0; i < resultPositionArray.size(); i += 3)
+         mesh.Lods.clear();
+
+         for (auto& level : levels)
          {
-            mm::vec3 p0 = resultPositionArray[i];
-            mm::vec3 p1 = resultPositionArray[i + 1];
-            mm::vec3 p2 = resultPositionArray[i + 2];
+            auto lod = std::make_shared<TrigVertices>();
 
-            mm::vec2 uv0 = resultUvArray[i];
-            mm::vec2 uv1 = resultUvArray[i + 1];
-            mm::vec2 uv2 = resultUvArray[i + 2];
+            CookLevel(mesh, positions, unique, level.Indices, *lod);
 
-            mm::vec3 edge1 = p1 - p0;
-            mm::vec3 edge2 = p2 - p0;
+            lod->FacesCount = level.Indices.size();
+            lod->LodError = level.Error;
+            lod->Name = mesh.Name;
+            lod->HashedName = mesh.HashedName;
+            lod->IsValid = true;
 
-            mm::vec2 uvEdge1 = uv1 - uv0;
-            mm::vec2 uvEdge2 = uv2 - uv0;
+            mesh.Lods.push_back(std::move(lod));
+         }
 
+         //Levels take their vertices from the source soup, so it is cooked the last
+         CookLevel(mesh, positions, unique, remap, mesh);
+      }
 
-            //Find matrix inverse
+      static void PackLevel(TrigVertices& level)
+      {
+         const size_t verticesCount = level.Positions.size();
 
-            float inverseD = 1 / (uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x);
+         level.PackedBounds = cook::ComputeVertexBounds(level.Positions.data(), verticesCount);
+         level.PackedVertices.resize(verticesCount);
 
-            float m00 = uvEdge2.y * inverseD;
-            float m01 = -uvEdge1.y * inverseD;
-            float m10 = -uvEdge2.x * inverseD;
-            float m11 = uvEdge1.x * inverseD;
+         cook::PackVertices(level.Positions.data(), level.Normals.data(), level.UVs.data(), level.Tangents.data(), level.Bitangents.data(),
+                            verticesCount, level.PackedBounds, level.PackedVertices.data());
 
+         level.Positions = {};
+         level.Normals = {};
+         level.UVs = {};
+         level.Tangents = {};
+         level.Bitangents = {};
+      }
 
-            mm::vec3 tangent;
-            tangent.x = m00 * edge1.x + m01 * edge2.x;
-            tangent.y = m00 * edge1.y + m01 * edge2.y;
-            tangent.z = m00 * edge1.z + m01 * edge2.z;
-            tangent = mm::normalize(tangent);
+      void PackMesh(TrigVertices& mesh)
+      {
+         PackLevel(mesh);
 
-            mm::vec3 bitangent;
-            bitangent.x = m10 * edge1.x + m11 * edge2.x;
-            bitangent.y = m10 * edge1.y + m11 * edge2.y;
-            bitangent.z = m10 * edge1.z + m11 * edge2.z;
-            bitangent = mm::normalize(bitangent);
+         for (auto& lod : mesh.Lods)
+            PackLevel(*lod);
+      }
+
+      //Layout of the cooked mesh, the result of the CookMesh and of the PackMesh when it was done:
+      //   CookedMeshHeader
+      //   Source level and then every LOD, each is its scalars and its arrays, every array is the uint64_t count and the elements
+      constexpr uint32_t CookedMeshMagic = 0x48534D52; //"RMSH"
+      constexpr uint32_t CookedMeshVersion = 2;
+
+      struct CookedMeshHeader
+      {
+         uint32_t Magic;
+         uint32_t Version;
+
+         uint32_t LodsCount;
+         uint32_t Reserved;
+      };
+
+      template<typename T>
+      static void AppendValue(std::vector<uint8_t>& res, const T& value)
+      {
+         static_assert(std::is_trivially_copyable_v<T>, "Only the plain data is stored as is");
+
+         const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+         res.insert(res.end(), bytes, bytes + sizeof(T));
+      }
+
+      template<typename T>
+      static void AppendArray(std::vector<uint8_t>& res, const std::vector<T>& values)
+      {
+         static_assert(std::is_trivially_copyable_v<T>, "Only the plain data is stored as is");
+
+         AppendValue(res, static_cast<uint64_t>(values.size()));
+
+         const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+         res.insert(res.end(), bytes, bytes + values.size() * sizeof(T));
+      }
+
+      //Every read checks the size, so the damaged data fails the load instead of reading past the end
+      struct CookedReader
+      {
+         const uint8_t* Data;
+         size_t Size;
+         size_t Offset = 0;
 
+         template<typename T>
+         bool Read(T& value)
+         {
+            if (Size - Offset < sizeof(T))
+               return false;
 
-            tangentArray.push_back(tangent);
-            tangentArray.push_back(tangent);
-            tangentArray.push_back(tangent);
+            memcpy(&value, Data + Offset, sizeof(T));
+            Offset += sizeof(T);
 
-            bitangentArray.push_back(bitangent);
-            bitangentArray.push_back(bitangent);
-            bitangentArray.push_back(bitangent);
+            return true;
          }
 
+         template<typename T>
+         bool ReadArray(std::vector<T>& values)
+         {
+            uint64_t count;
+            if (!Read(count) || count > (Size - Offset) / sizeof(T))
+               return false;
 
-         resData.FacesCount = positionIndicesArray.size();
-         resData.Positions = resultPositionArray;
-         resData.Normals = resultNormalArray;
-         resData.UVs = resultUvArray;
-         resData.Tangents = tangentArray;
-         resData.Bitangents = bitangentArray;
+            values.resize(static_cast<size_t>(count));
+            memcpy(values.data(), Data + Offset, values.size() * sizeof(T));
+            Offset += values.size() * sizeof(T);
 
-         resData.Name = filepath;
-         resData.HashedName = std::hash<std::string_view>{}(filepath);
-         resData.LoadTime = loadTimer.GetElapsedTime();
-         resData.IsValid = true;
+            return true;
+         }
+      };
+
+      static void WriteCookedLevel(std::vector<uint8_t>& res, const TrigVertices& level)
+      {
+         AppendValue(res, level.FacesCount);
+         AppendValue(res, level.LodError);
+         AppendValue(res, level.PackedBounds);
+         AppendValue(res, level.Bounds);
 
-         return  resData;
+         AppendArray(res, level.Positions);
+         AppendArray(res, level.Normals);
+         AppendArray(res, level.UVs);
+         AppendArray(res, level.Tangents);
+         AppendArray(res, level.Bitangents);
+         AppendArray(res, level.Indices);
+         AppendArray(res, level.Meshlets);
+         AppendArray(res, level.PackedVertices);
       }
 
-      PixelsData LoadPixels(const std::string_view filepath)
+      static bool ReadCookedLevel(CookedReader& reader, TrigVertices& level)
       {
-         stbi_set_flip_vertically_on_load(1);
+         return reader.Read(level.FacesCount) && reader.Read(level.LodError) && reader.Read(level.PackedBounds) && reader.Read(level.Bounds)
+                && reader.ReadArray(level.Positions) && reader.ReadArray(level.Normals) && reader.ReadArray(level.UVs)
+                && reader.ReadArray(level.Tangents) && reader.ReadArray(level.Bitangents) && reader.ReadArray(level.Indices)
+                && reader.ReadArray(level.Meshlets) && reader.ReadArray(level.PackedVertices);
+      }
+
+      std::vector<uint8_t> WriteCookedMesh(const TrigVertices& mesh)
+      {
+         std::vector<uint8_t> res;
+
+         AppendValue(res, CookedMeshHeader({ CookedMeshMagic, CookedMeshVersion, static_cast<uint32_t>(mesh.Lods.size()), 0 }));
+
+         WriteCookedLevel(res, mesh);
+
+         for (auto& lod : mesh.Lods)
+            WriteCookedLevel(res, *lod);
+
+         return res;
+      }
+
+      TrigVertices ReadCookedMesh(const std::string_view filepath, const RawData& data)
+      {
+         utils::Timer loadTimer(true);
+
+         TrigVertices mesh;
+         mesh.IsValid = false;
+
+         CookedReader reader = { data.Data, data.Size };
+         CookedMeshHeader header;
+
+         bool isRead = reader.Read(header) && header.Magic == CookedMeshMagic && header.Version == CookedMeshVersion
+                       && header.LodsCount <= MeshLodLevels && ReadCookedLevel(reader, mesh);
+
+         for (uint32_t i = 0; isRead && i < header.LodsCount; ++i)
+         {
+            auto lod = std::make_shared<TrigVertices>();
+            isRead = ReadCookedLevel(reader, *lod);
+
+            lod->Name = filepath;
+            lod->HashedName = utils::HashedString(filepath);
+            lod->IsValid = true;
+
+            mesh.Lods.push_back(std::move(lod));
+         }
+
+         if (!isRead || reader.Offset != reader.Size)
+         {
+            LOG_ERROR("Invalid cooked mesh: %s", filepath.data());
+
+            mesh.Lods.clear();
+            return mesh;
+         }
+
+         mesh.Name = filepath;
+         mesh.HashedName = utils::HashedString(filepath);
+         mesh.LoadTime = loadTimer.GetElapsedTime();
+         mesh.IsValid = true;
+
+         return mesh;
+      }
+
+      //Decoded image has only the level 0, it is valid already, so the failed mips can be told apart by the empty Mips
+      static PixelsData DecodePixels(const std::string_view filepath, const RawData& data, const bool flipVertically)
+      {
+         utils::Timer loadTimer(true);
 
          PixelsData resData;
          resData.LoadTime = 0.0f;
          resData.IsValid  = false;
 
-         resData.Pixels = stbi_load(&filepath[0], &resData.Width, &resData.Height, &resData.Channels, 0);
+         //Flip is done by the loader, so the stb flip state of this thread must stay off
+         //The global stbi_set_flip_vertically_on_load isn't thread safe and is never used
+         stbi_set_flip_vertically_on_load_thread(0);
+
+         resData.Pixels = PixelBuffer(stbi_load_from_memory(data.Data, static_cast<int>(data.Size),
+                                                            &resData.Width, &resData.Height, &resData.Channels, 0));
 
          if (!resData.Pixels)
          {
             //TODO load default image
-            LOG_ERROR("Faild to load image: %s", filepath);
+            LOG_ERROR("Faild to load image: %s (%s)", filepath.data(), stbi_failure_reason());
             return resData;
          }
 
+         if (flipVertically)
+            cook::FlipRows(resData.Pixels.get(), static_cast<size_t>(resData.Width) * resData.Channels, resData.Height);
+
          resData.Name = filepath;
-         resData.HashedName = std::hash<std::string_view>{}(filepath);
-         resData.LoadTime = 0.0f;
+         resData.HashedName = utils::HashedString(filepath);
+         resData.LoadTime = loadTimer.GetElapsedTime();
          resData.IsValid = true;
 
+         return resData;
+      }
+
+      static bool BuildPixelsMips(PixelsData& image)
+      {
+         utils::Timer mipsTimer(true);
+
+         //Decoded image is released back to the pool, when the chain is built
+         if (!cook::BuildMipChain(image.Pixels.get(), image.Width, image.Height, image.Channels,
+                                  cook::GetMipFilter(image.Name), image.Pixels, image.Mips))
+         {
+            LOG_ERROR("Failed to build mips of image: %s", image.Name.c_str());
+
+            image.IsValid = false;
+            return false;
+         }
+
+         image.LoadTime += mipsTimer.GetElapsedTime();
+
+         return true;
+      }
+
+      PixelsData LoadPixels(const std::string_view filepath, const RawData& data, const bool flipVertically)
+      {
+         PixelsData resData = DecodePixels(filepath, data, flipVertically);
+
+         if (resData.IsValid)
+            BuildPixelsMips(resData);
+
          return resData;
       } 
-   }
-   std::unordered_map<std::string_view, AssetType> g_AssetTypeLookup =
-   {
-      {".obj", AssetType::Mesh},
-      {".png", AssetType::Image},
-      {".jpg", AssetType::Image}
-   };
 
-   struct JobLoadParams
-   {
-      std::string Path;
-      Hash HashedPath;
-      AssetManager* AM;
-   };
+      //Cooked image already has the mips, so it is only copied out of the archive
+      //Levels outside of [firstLevel, firstLevel + levelsCount) aren't touched, so for the mapped archive they aren't even read from the disk
+      PixelsData LoadCookedPixels(const std::string_view filepath, const RawData& data, const size_t firstLevel = 0, const size_t levelsCount = SIZE_MAX)
+      {
+         utils::Timer loadTimer(true);
 
-   void AssetManager::Load()
-   {
-      for (auto assetInfo : LoadQueue)
+         PixelsData resData;
+         resData.LoadTime = 0.0f;
+         resData.IsValid  = false;
+
+         cook::TextureHeader header;
+         std::vector<MipLevel> mips;
+
+         if (!cook::ReadTextureLayout(data.Data, data.Size, header, mips))
+         {
+            LOG_ERROR("Invalid cooked image: %s", filepath.data());
+            return resData;
+         }
+
+         const size_t first = std::min(firstLevel, mips.size() - 1);
+         const size_t count = std::min(levelsCount, mips.size() - first);
+
+         mips.erase(mips.begin() + first + count, mips.end());
+         mips.erase(mips.begin(), mips.begin() + first);
+
+         uint64_t size = 0;
+         for (auto& mip : mips)
+            size += mip.Size;
+
+         resData.Pixels = PixelBuffer(static_cast<uint8_t*>(PixelPool::Allocate(static_cast<size_t>(size))));
+
+         uint64_t offset = 0;
+         for (auto& mip : mips)
+         {
+            memcpy(resData.Pixels.get() + offset, data.Data + mip.Offset, static_cast<size_t>(mip.Size));
+
+            mip.Offset = offset;
+            offset += mip.Size;
+         }
+
+         resData.Width = header.Width;
+         resData.Height = header.Height;
+         resData.Channels = header.Channels;
+         resData.Mips = std::move(mips);
+         resData.FirstLevel = static_cast<int32_t>(first);
+         resData.Compression = header.Format;
+
+         resData.Name = filepath;
+         resData.HashedName = utils::HashedString(filepath);
+         resData.LoadTime = loadTimer.GetElapsedTime();
+         resData.IsValid = true;
+
+         return resData;
+      }
+
+      //Keeps only the levels [firstLevel, firstLevel + levelsCount) of the fully loaded image
+      void TrimLevels(PixelsData& image, const size_t firstLevel, const size_t levelsCount)
       {
-         auto[hashedFilepath, filepath] = assetInfo;
+         const size_t first = std::min(firstLevel, image.Mips.size() - 1);
+         const size_t count = std::min(levelsCount, image.Mips.size() - first);
 
-         JobLoadParams* params = new JobLoadParams({ filepath, hashedFilepath , this });
+         if (!first && count == image.Mips.size())
+            return;
 
-         core::JobSystem::Execute([](uintptr_t args)
-            {
-               std::unique_ptr<JobLoadParams> params = std::unique_ptr<JobLoadParams>(reinterpret_cast<JobLoadParams*>(args));
-               AssetManager* am = params->AM;
-
-               std::filesystem::path path(params->Path);
-
-               auto find = g_AssetTypeLookup.find(path.extension().string());
-               AssetType type = find != g_AssetTypeLookup.end() ? find->second : AssetType::None;
-
-               std::shared_ptr<AssetData> assetData;
-               switch (type)
-               {
-               case assets::AssetType::Mesh:
-                  {
-                     TrigVertices mesh = loaders::LoadTrigVertices(path.string());
-                     assetData = std::make_shared<TrigVertices>(mesh);
-                  }break;
-               case assets::AssetType::Image:
-                  {
-                     PixelsData image = loaders::LoadPixels(path.string());
-                     assetData = std::make_shared<PixelsData>(image);
-                  }break;
-               default:
-                  {
-                     PRINT_AND_TERMINATE("This asset cannot be processed by the engine: %s", path.string().c_str());
-                  }break;
-               }
-
-               std::lock_guard<utils::sync::SpinLock> l(am->LoadSL);
-               am->AssetDataLookup[params->HashedPath] = assetData;
-
-            }, reinterpret_cast<uintptr_t>(params));
+         std::vector<MipLevel> mips(image.Mips.begin() + first, image.Mips.begin() + first + count);
+
+         uint64_t size = 0;
+         for (auto& mip : mips)
+            size += mip.Size;
+
+         PixelBuffer pixels(static_cast<uint8_t*>(PixelPool::Allocate(static_cast<size_t>(size))));
+
+         uint64_t offset = 0;
+         for (auto& mip : mips)
+         {
+            memcpy(pixels.get() + offset, image.Pixels.get() + mip.Offset, static_cast<size_t>(mip.Size));
+
+            mip.Offset = offset;
+            offset += mip.Size;
+         }
+
+         image.Pixels = std::move(pixels);
+         image.Mips = std::move(mips);
+         image.FirstLevel = static_cast<int32_t>(first);
+      }
+
+      //Loose file is mapped, the loaders read it straight from the page cache without the copy
+      bool ReadLooseFile(const std::string& filepath, RawData& data)
+      {
+         if (!data.File.Open(filepath, utils::FileAccess::Sequential))
+         {
+            LOG_ERROR("Couldn't open asset file: %s (%s)", filepath.c_str(), data.File.GetError().c_str());
+            return false;
+         }
+
+         data.Data = data.File.GetData();
+         data.Size = data.File.GetSize();
+
+         return true;
+      }
+
+      bool CookSourceFile(const cook::CookJob& job, std::vector<uint8_t>& result, std::string& error)
+      {
+         const bool isObj = std::filesystem::path(job.Path).extension() == ".obj";
+
+         RawData data;
+         if (!isObj && !ReadLooseFile(job.Path, data))
+         {
+            error = "Couldn't read source file";
+            return false;
+         }
+
+         if (job.Type == cook::CookJobType::Mesh)
+         {
+            TrigVertices mesh = isObj ? StreamTrigVertices(job.Path, obj::ObjReadParams()) : LoadMesh(job.Path, data);
+            if (!mesh.IsValid)
+            {
+               error = "Couldn't load mesh";
+               return false;
+            }
+
+            CookMesh(mesh);
+
+            if (job.Flags & cook::CJF_PACKED_VERTICES)
+               PackMesh(mesh);
+
+            result = WriteCookedMesh(mesh);
+            return true;
+         }
+
+         PixelsData image = DecodePixels(job.Path, data, true);
+         if (!image.IsValid || !BuildPixelsMips(image))
+         {
+            error = "Couldn't decode image";
+            return false;
+         }
+
+         result = cook::WriteTexture(image.Width, image.Height, image.Channels, image.Compression, image.Pixels.get(), image.Mips);
+         return true;
+      }
+   }
+   utils::FlatHashMap<std::string, AssetType> g_AssetTypeLookup =
+   {
+      {".obj", AssetType::Mesh},
+      {".glb", AssetType::Mesh},
+      {".png", AssetType::Image},
+      {".jpg", AssetType::Image}
+   };
+
+   //Settings of the Load call, they are copied, so the jobs don't touch the manager
+   struct PipelineContext
+   {
+      obj::ObjReadParams ObjParams;
+      cook::VertexFormat MeshVertexFormat;
+
+      UploadFunc Upload;
+      uintptr_t UploadArgs;
+
+      AssetManager* AM;
+
+      core::Pipeline* Pipeline;
+      core::IoService* Io;
+
+      cook::DerivedCache* Cache; //Null when it isn't open
+      cook::CookWorkerPool* CookWorkers; //Null when the assets are cooked in the engine
+   };
+
+   //Asset on its way through the load pipeline, every stage fills the next part of it
+   struct PipelineLoad
+   {
+      LoadRequest Request;
+      AssetType Type;
+
+      //Loose OBJ files are parsed by the windows straight from the disk, so the whole text is never in memory
+      bool IsStreamed;
+
+      const PipelineContext* Context;
+
+      //Loose asset is cooked by the worker process, it reads the source by itself
+      bool IsPooled = false;
+
+      RawData Data;
+      std::shared_ptr<AssetData> Asset;
+
+      //Cooked result is stored in the cache under the key, the cached one skips the cook stage
+      bool IsKeyed = false;
+      bool IsCached = false;
+      cook::DerivedKey CacheKey;
+   };
+
+   //Bump them when the loaders or the cookers change their results, the cached assets of the older versions aren't used then
+   constexpr uint32_t MeshCookVersion = 2;
+   constexpr uint32_t ImageCookVersion = 2;
+
+   //Streamed file is hashed by the chunks, so it still isn't in memory at once
+   static bool AddFileToKey(const std::string& filepath, cook::DerivedKeyBuilder& builder)
+   {
+      constexpr size_t ChunkSize = 1024 * 1024;
+
+      uint64_t size;
+      std::string error;
+
+      const utils::IoFile file = utils::OpenIoFile(filepath, size, error);
+      if (file == utils::InvalidIoFile)
+         return false;
+
+      std::vector<uint8_t> chunk(ChunkSize);
+
+      uint64_t offset = 0;
+      while (offset < size)
+      {
+         const int64_t read = utils::ReadIoFile(file, offset, chunk.data(), chunk.size());
+         if (read <= 0)
+            break;
+
+         builder.Add(chunk.data(), static_cast<size_t>(read));
+         offset += read;
+      }
+
+      utils::CloseIoFile(file);
+
+      return offset == size;
+   }
+
+   static void AddImageParamsToKey(const std::string& path, cook::DerivedKeyBuilder& builder)
+   {
+      builder.Add(ImageCookVersion);
+      builder.Add(cook::TextureVersion);
+      builder.Add(static_cast<uint32_t>(cook::GetMipFilter(path)));
+   }
+
+   //Key is of the source bytes and everything else the cooked result depends on, the path matters only by the loader it picks
+   static bool BuildCacheKey(const PipelineLoad& load, const PipelineContext& context, cook::DerivedKey& key)
+   {
+      const std::string& path = load.Request.Path;
+
+      cook::DerivedKeyBuilder builder;
+
+      if (load.Type == AssetType::Mesh)
+      {
+         builder.Add(MeshCookVersion);
+         builder.Add(static_cast<uint32_t>(context.MeshVertexFormat));
+         builder.Add(std::filesystem::path(path).extension().string());
+      }
+      else
+         AddImageParamsToKey(path, builder);
+
+      if (load.IsStreamed)
+      {
+         if (!AddFileToKey(path, builder))
+            return false;
+      }
+      else
+         builder.Add(load.Data.Data, load.Data.Size);
+
+      key = builder.Finish();
+
+      return true;
+   }
+
+   static bool LoadCached(PipelineLoad& load, cook::DerivedCache& cache)
+   {
+      RawData cached;
+      if (!cache.Get(load.CacheKey, cached.Storage))
+         return false;
+
+      cached.Data = cached.Storage.data();
+      cached.Size = cached.Storage.size();
+
+      if (load.Type == AssetType::Mesh)
+         load.Asset = std::make_shared<TrigVertices>(loaders::ReadCookedMesh(load.Request.Path, cached));
+      else
+         load.Asset = std::make_shared<PixelsData>(loaders::LoadCookedPixels(load.Request.Path, cached));
+
+      return load.Asset->IsValid;
+   }
+
+   static void StoreCached(const PipelineLoad& load, cook::DerivedCache& cache)
+   {
+      std::vector<uint8_t> payload;
+
+      if (load.Type == AssetType::Mesh)
+         payload = loaders::WriteCookedMesh(static_cast<const TrigVertices&>(*load.Asset));
+      else
+      {
+         const PixelsData& image = static_cast<const PixelsData&>(*load.Asset);
+
+         payload = cook::WriteTexture(image.Width, image.Height, image.Channels, image.Compression, image.Pixels.get(), image.Mips);
+      }
+
+      cache.Put(load.CacheKey, payload.data(), payload.size());
+   }
+
+   constexpr uint32_t ReadStageIndex = 0;
+
+   //Async stage, the loose files are read by the IO service, so the cold reads don't block the job threads
+   static bool ReadStage(uintptr_t item, uintptr_t args)
+   {
+      PipelineLoad* load = reinterpret_cast<PipelineLoad*>(item);
+      const PipelineContext* context = reinterpret_cast<const PipelineContext*>(args);
+      const LoadRequest& request = load->Request;
+
+      //Streamed OBJ is read by its parser, the archive entry is already mapped and the pooled asset is read by its worker
+      //Pooled source is still read for the cache key
+      if (load->IsStreamed || request.Archive || (load->IsPooled && !context->Cache))
+      {
+         if (request.Archive && !request.Archive->Read(*request.Entry, load->Data))
+         {
+            //TODO when loading fail load the default asset
+            LOG_ERROR("Failed to read asset file: %s", request.Path.c_str());
+            return false;
+         }
+
+         context->Pipeline->Complete(ReadStageIndex, item, true);
+         return true;
+      }
+
+      context->Io->Read(request.Path, [](core::ReadResult& result, uintptr_t args)
+         {
+            PipelineLoad* load = reinterpret_cast<PipelineLoad*>(args);
+
+            if (result.IsSucceeded)
+            {
+               load->Data.Storage = std::move(result.Data);
+               load->Data.Data = load->Data.Storage.data();
+               load->Data.Size = load->Data.Storage.size();
+            }
+            else
+               LOG_ERROR("Failed to read asset file: %s (%s)", result.Path.c_str(), result.Error.c_str());
+
+            load->Context->Pipeline->Complete(ReadStageIndex, args, result.IsSucceeded);
+         }, item);
+
+      return true;
+   }
+
+   static void FlushReads(uintptr_t args)
+   {
+      reinterpret_cast<const PipelineContext*>(args)->Io->Submit();
+   }
+
+   static bool ParseStage(uintptr_t item, uintptr_t args)
+   {
+      PipelineLoad* load = reinterpret_cast<PipelineLoad*>(item);
+      const PipelineContext* context = reinterpret_cast<const PipelineContext*>(args);
+      const LoadRequest& request = load->Request;
+
+      const bool isCooked = request.Entry && (request.Entry->Flags & pak::EF_COOKED);
+
+      if (context->Cache && !isCooked && BuildCacheKey(*load, *context, load->CacheKey))
+      {
+         load->IsKeyed = true;
+         load->IsCached = LoadCached(*load, *context->Cache);
+
+         if (load->IsCached)
+         {
+            load->Data = RawData();
+            return true;
+         }
+      }
+
+      if (load->IsPooled)
+      {
+         load->Data = RawData();
+         return true;
+      }
+
+      switch (load->Type)
+      {
+      case assets::AssetType::Mesh:
+         {
+            TrigVertices mesh = load->IsStreamed ? loaders::StreamTrigVertices(request.Path, context->ObjParams)
+                                                 : loaders::LoadMesh(request.Path, load->Data);
+
+            load->Asset = std::make_shared<TrigVertices>(std::move(mesh));
+         }break;
+      case assets::AssetType::Image:
+         {
+            PixelsData image = isCooked ? loaders::LoadCookedPixels(request.Path, load->Data)
+                                        : loaders::DecodePixels(request.Path, load->Data, true);
+
+            load->Asset = std::make_shared<PixelsData>(std::move(image));
+         }break;
+      default:
+         break;
+      }
+
+      //Source bytes aren't needed anymore, the queue holds only the parsed assets
+      load->Data = RawData();
+
+      return load->Asset && load->Asset->IsValid;
+   }
+
+   constexpr uint32_t CookStageIndex = 2;
+
+   static bool CookLoad(PipelineLoad& load)
+   {
+      if (load.Type == AssetType::Mesh)
+      {
+         TrigVertices& mesh = static_cast<TrigVertices&>(*load.Asset);
+
+         loaders::CookMesh(mesh);
+
+         if (load.Context->MeshVertexFormat == cook::VertexFormat::Packed)
+            loaders::PackMesh(mesh);
+      }
+      else
+      {
+         PixelsData& image = static_cast<PixelsData&>(*load.Asset);
+
+         //Cooked images come with their mips
+         if (image.Mips.empty() && !loaders::BuildPixelsMips(image))
+            return false;
+      }
+
+      if (load.IsKeyed)
+         StoreCached(load, *load.Context->Cache);
+
+      return true;
+   }
+
+   //Worker result is the cached blob, so it is stored as it is
+   static void FinishPooledCook(cook::CookResult& result, uintptr_t args)
+   {
+      PipelineLoad* load = reinterpret_cast<PipelineLoad*>(args);
+
+      if (result.IsSucceeded)
+      {
+         RawData cooked;
+         cooked.Data = result.Data.data();
+         cooked.Size = result.Data.size();
+
+         if (load->Type == AssetType::Mesh)
+            load->Asset = std::make_shared<TrigVertices>(loaders::ReadCookedMesh(load->Request.Path, cooked));
+         else
+            load->Asset = std::make_shared<PixelsData>(loaders::LoadCookedPixels(load->Request.Path, cooked));
+
+         if (load->Asset->IsValid && load->IsKeyed)
+            load->Context->Cache->Put(load->CacheKey, result.Data.data(), result.Data.size());
+      }
+      else
+         LOG_ERROR("Failed to cook asset: %s (%s)", result.Path.c_str(), result.Error.c_str());
+
+      load->Context->Pipeline->Complete(CookStageIndex, args, load->Asset && load->Asset->IsValid);
+   }
+
+   //Async stage, the cook runs either on the job threads or in the worker processes
+   static bool CookStage(uintptr_t item, uintptr_t args)
+   {
+      PipelineLoad* load = reinterpret_cast<PipelineLoad*>(item);
+      const PipelineContext* context = reinterpret_cast<const PipelineContext*>(args);
+
+      if (load->IsCached)
+      {
+         context->Pipeline->Complete(CookStageIndex, item, true);
+         return true;
+      }
+
+      if (load->IsPooled)
+      {
+         const bool isPacked = context->MeshVertexFormat == cook::VertexFormat::Packed;
+         const cook::CookJob job = { load->Type == AssetType::Mesh ? cook::CookJobType::Mesh : cook::CookJobType::Image, load->Request.Path,
+                                     isPacked ? cook::CJF_PACKED_VERTICES : cook::CJF_NONE };
+
+         context->CookWorkers->Submit(job, FinishPooledCook, item);
+         return true;
+      }
+
+      core::JobSystem::Execute([](uintptr_t args)
+         {
+            PipelineLoad* load = reinterpret_cast<PipelineLoad*>(args);
+            load->Context->Pipeline->Complete(CookStageIndex, args, CookLoad(*load));
+         }, item);
+
+      return true;
+   }
+
+   bool AssetManager::Mount(const std::string_view& archivePath)
+   {
+      auto archive = std::make_unique<pak::Archive>();
+
+      if (!archive->Mount(archivePath))
+         return false;
+
+      MountedArchives.push_back(std::move(archive));
+
+      return true;
+   }
+
+   LoadRequest AssetManager::Resolve(const std::string_view& filepath) const
+   {
+      LoadRequest request;
+      request.HashedPath = utils::HashedString(filepath).GetValue(); //Interns the path for the debug messages
+      request.Path = filepath;
+
+      for (auto archive = MountedArchives.rbegin(); archive != MountedArchives.rend(); ++archive)
+      {
+         if (auto entry = (*archive)->Find(request.HashedPath))
+         {
+            request.Archive = archive->get();
+            request.Entry = entry;
+            break;
+         }
+      }
+
+      return request;
+   }
+
+   void AssetManager::ToLoad(const std::string_view& filepath)
+   {
+      LoadQueue.push_back(Resolve(filepath));
+   }
+
+   PixelsData AssetManager::LoadImageLevels(const std::string_view& filepath, const size_t firstLevel, const size_t levelsCount) const
+   {
+      const LoadRequest request = Resolve(filepath);
+
+      RawData rawData;
+
+      const bool isRead = request.Archive ? request.Archive->Read(*request.Entry, rawData)
+                                          : loaders::ReadLooseFile(request.Path, rawData);
+      if (!isRead)
+      {
+         LOG_ERROR("Failed to read asset file: %s", request.Path.c_str());
+         return PixelsData();
+      }
+
+      if (request.Entry && (request.Entry->Flags & pak::EF_COOKED))
+         return loaders::LoadCookedPixels(request.Path, rawData, firstLevel, levelsCount);
+
+      //Key is the same as the one of the load pipeline, so the chain cooked by either of them is reused
+      cook::DerivedKey key;
+
+      if (DerivedData.IsOpen())
+      {
+         cook::DerivedKeyBuilder builder;
+         AddImageParamsToKey(request.Path, builder);
+         builder.Add(rawData.Data, rawData.Size);
+
+         key = builder.Finish();
+
+         RawData cached;
+         if (DerivedData.Get(key, cached.Storage))
+         {
+            cached.Data = cached.Storage.data();
+            cached.Size = cached.Storage.size();
+
+            return loaders::LoadCookedPixels(request.Path, cached, firstLevel, levelsCount);
+         }
+      }
+
+      PixelsData image = loaders::LoadPixels(request.Path, rawData, true);
+
+      if (!image.IsValid)
+         return image;
+
+      if (DerivedData.IsOpen())
+      {
+         const std::vector<uint8_t> payload = cook::WriteTexture(image.Width, image.Height, image.Channels, image.Compression, image.Pixels.get(), image.Mips);
+         DerivedData.Put(key, payload.data(), payload.size());
+      }
+
+      loaders::TrimLevels(image, firstLevel, levelsCount);
+
+      return image;
+   }
+
+   //Func gets the UV by the reference, the packed half UVs are decoded for it and encoded back
+   template<typename Func>
+   static void ForEachUV(TrigVertices& level, Func&& func)
+   {
+      for (auto& uv : level.UVs)
+         func(uv.x, uv.y);
+
+      for (auto& vertex : level.PackedVertices)
+      {
+         float u = cook::HalfToFloat(vertex.UV[0]);
+         float v = cook::HalfToFloat(vertex.UV[1]);
+
+         func(u, v);
+
+         vertex.UV[0] = cook::FloatToHalf(u);
+         vertex.UV[1] = cook::FloatToHalf(v);
+      }
+   }
+
+   bool AssetManager::BuildAtlas(const std::vector<std::string>& pageNames, const std::vector<AtlasItem>& items,
+                                 const int32_t maxSize, const int32_t gutter)
+   {
+      //Items with the same first page texture share the region
+      utils::FlatHashMap<Hash, size_t> regionLookup;
+      std::vector<std::vector<std::shared_ptr<PixelsData>>> regionImages;
+
+      std::vector<std::shared_ptr<TrigVertices>> meshes;
+      std::vector<size_t> meshRegions;
+      utils::FlatHashMap<const TrigVertices*, size_t> meshLookup;
+
+      for (auto& item : items)
+      {
+         auto mesh = FindData<TrigVertices>(item.MeshPath);
+         if (!mesh)
+         {
+            LOG_ERROR("Atlas mesh isn't loaded: %s", item.MeshPath.c_str());
+            return false;
+         }
+
+         if (item.TexturePaths.size() != pageNames.size())
+         {
+            LOG_ERROR("Atlas item doesn't have the texture for every page: %s", item.MeshPath.c_str());
+            return false;
+         }
+
+         bool isTiled = false;
+         ForEachUV(*mesh, [&isTiled](float& u, float& v)
+            {
+               isTiled |= u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f;
+            });
+
+         if (isTiled)
+         {
+            LOG_ERROR("Atlas mesh has the tiled UVs: %s", item.MeshPath.c_str());
+            return false;
+         }
+
+         if (!meshLookup.try_emplace(mesh.get(), meshes.size()).second)
+         {
+            LOG_ERROR("Atlas mesh is used by the several items: %s", item.MeshPath.c_str());
+            return false;
+         }
+
+         auto region = regionLookup.try_emplace(GetHash(item.TexturePaths[0]), regionImages.size());
+
+         meshes.push_back(mesh);
+         meshRegions.push_back(region.first->second);
+
+         if (!region.second)
+            continue;
+
+         std::vector<std::shared_ptr<PixelsData>> images;
+
+         for (auto& path : item.TexturePaths)
+         {
+            auto image = FindData<PixelsData>(path);
+
+            if (!image || image->Compression != cook::BlockFormat::None || image->FirstLevel != 0)
+            {
+               LOG_ERROR("Atlas texture isn't loaded or isn't raw: %s", path.c_str());
+               return false;
+            }
+
+            if (!images.empty() && (image->Width != images[0]->Width || image->Height != images[0]->Height))
+            {
+               LOG_ERROR("Atlas textures of the single item have different sizes: %s", path.c_str());
+               return false;
+            }
+
+            images.push_back(image);
+         }
+
+         regionImages.push_back(std::move(images));
+      }
+
+      std::vector<std::pair<int32_t, int32_t>> sizes;
+      for (auto& images : regionImages)
+         sizes.push_back({ images[0]->Width, images[0]->Height });
+
+      cook::AtlasLayout layout;
+      if (!cook::PackAtlas(sizes, maxSize, gutter, layout))
+      {
+         LOG_ERROR("Atlas textures don't fit into %d x %d", maxSize, maxSize);
+         return false;
+      }
+
+      std::vector<std::shared_ptr<PixelsData>> pages;
+
+      for (size_t page = 0; page < pageNames.size(); ++page)
+      {
+         std::vector<const uint8_t*> pixels;
+         std::vector<int32_t> channels;
+
+         int32_t pageChannels = 3;
+
+         for (auto& images : regionImages)
+         {
+            pixels.push_back(images[page]->GetMipData(0));
+            channels.push_back(images[page]->Channels);
+
+            pageChannels = std::max(pageChannels, images[page]->Channels);
+         }
+
+         PixelsData atlas;
+         atlas.Width = layout.Width;
+         atlas.Height = layout.Height;
+         atlas.Channels = pageChannels;
+
+         const cook::MipFilter filter = cook::GetMipFilter(regionImages[0][page]->Name);
+
+         if (!cook::ComposeAtlas(layout, pixels, channels, pageChannels, filter, atlas.Pixels, atlas.Mips))
+         {
+            LOG_ERROR("Failed to compose atlas: %s", pageNames[page].c_str());
+            return false;
+         }
+
+         atlas.Name = pageNames[page];
+         atlas.HashedName = utils::HashedString(pageNames[page]);
+         atlas.IsValid = true;
+
+         pages.push_back(std::make_shared<PixelsData>(std::move(atlas)));
+      }
+
+      for (size_t page = 0; page < pageNames.size(); ++page)
+         AssetDataLookup[GetHash(pageNames[page])] = pages[page];
+
+      for (size_t i = 0; i < meshes.size(); ++i)
+      {
+         const cook::AtlasRegion& region = layout.Regions[meshRegions[i]];
+
+         auto remap = [&layout, &region](float& u, float& v)
+         {
+            cook::RemapUV(layout, region, u, v);
+         };
+
+         ForEachUV(*meshes[i], remap);
+
+         //Lods take their UVs from the source mesh, so they are in [0, 1] too
+         for (auto& lod : meshes[i]->Lods)
+            ForEachUV(*lod, remap);
+      }
+
+      return true;
+   }
+
+   void AssetManager::Load(UploadFunc upload, uintptr_t uploadArgs)
+   {
+      if (!Io)
+         Io = std::make_unique<core::IoService>(PipelineParams.Io);
+
+      if (!CookWorkers && PipelineParams.CookWorkers)
+      {
+         cook::CookWorkerParams params;
+         params.Command = PipelineParams.CookWorkerCommand;
+         params.WorkersCount = PipelineParams.CookWorkers;
+
+         CookWorkers = std::make_unique<cook::CookWorkerPool>(params);
+      }
+
+      PipelineContext context = { ObjParams, MeshVertexFormat, upload, uploadArgs, this, nullptr, Io.get(),
+                                 DerivedData.IsOpen() ? &DerivedData : nullptr, CookWorkers.get() };
+
+      auto jobsCount = [](const uint16_t count)
+      {
+         return count ? count : static_cast<uint16_t>(std::max(std::thread::hardware_concurrency(), 1u));
+      };
+
+      //Upload registers the asset, so the lookup is touched only by this thread
+      const core::StageFunc uploadStage = [](uintptr_t item, uintptr_t args)
+      {
+         PipelineLoad* load = reinterpret_cast<PipelineLoad*>(item);
+         const PipelineContext* context = reinterpret_cast<const PipelineContext*>(args);
+
+         if (context->Upload)
+            context->Upload(*load->Asset, context->UploadArgs);
+
+         context->AM->AssetDataLookup[load->Request.HashedPath] = load->Asset;
+
+         return true;
+      };
+
+      core::Pipeline pipeline({ { ReadStage, reinterpret_cast<uintptr_t>(&context), std::max<uint16_t>(PipelineParams.ReadsInFlight, 1), false, true, FlushReads },
+                                { ParseStage, reinterpret_cast<uintptr_t>(&context), jobsCount(PipelineParams.ParseJobs) },
+                                { CookStage, reinterpret_cast<uintptr_t>(&context), std::max(jobsCount(PipelineParams.CookJobs), PipelineParams.CookWorkers), false, true },
+                                { uploadStage, reinterpret_cast<uintptr_t>(&context), std::max<uint16_t>(PipelineParams.UploadsPerPump, 1), true } },
+                              PipelineParams.QueueCapacity);
+
+      context.Pipeline = &pipeline;
+
+      std::vector<std::unique_ptr<PipelineLoad>> loads;
+      loads.reserve(LoadQueue.size());
+
+      for (auto& request : LoadQueue)
+      {
+         std::filesystem::path path(request.Path);
+
+         //Asset stays unloaded, the GetData reports it when it is used
+         auto find = g_AssetTypeLookup.find(path.extension().string());
+         if (find == g_AssetTypeLookup.end())
+         {
+            LOG_ERROR("This asset cannot be processed by the engine: %s", request.Path.c_str());
+            continue;
+         }
+
+         const AssetType type = find->second;
+         const bool isStreamed = type == AssetType::Mesh && !request.Archive && path.extension() == ".obj";
+
+         //Archive entries are in memory already and the cooked ones have nothing to cook
+         const bool isPooled = CookWorkers && !request.Archive;
+
+         loads.push_back(std::make_unique<PipelineLoad>(PipelineLoad({ request, type, isStreamed, &context, isPooled })));
+         pipeline.Add(reinterpret_cast<uintptr_t>(loads.back().get()));
       }
 
       LoadQueue.clear();
 
-      core::JobSystem::Wait();
+      pipeline.Drain();
    }
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
-#include <unordered_map>
+#include <vector>
+#include <string>
 #include <typeindex>
 #include <memory>
 #include <optional>
@@ -9,15 +10,28 @@
 #include "math/math.h"
 
 #include "debug/globals.h"
-#include "utils/sync/spin-lock.h"
+#include "utils/hashed-string.h"
+#include "utils/flat-hash-map.h"
+
+#include "pak/pak-archive.h"
+#include "pixel-pool.h"
+#include "cook/texture-format.h"
+#include "cook/meshlets.h"
+#include "cook/vertex-quantize.h"
+#include "cook/derived-cache.h"
+#include "cook/cook-worker.h"
+#include "obj/obj-reader.h"
+
+#include "jobs/io-service.h"
 
 namespace assets
 {
-   typedef size_t Hash;
+   typedef uint64_t Hash;
 
-   static Hash GetHash(const std::string_view& str)
+   //Hash is stable across compilers and runs, so it is used as the asset id in the cooked data
+   constexpr Hash GetHash(const std::string_view& str)
    {
-      return std::hash<std::string_view>{}(str);
+      return utils::HashFnv1a(str);
    }
 
 
@@ -34,9 +48,9 @@ namespace assets
    class AssetData
    {
    public:
-      std::string Name = "";//Later this with HasedName  should be replaced with one type that implement hash string
+      std::string Name = "";
 
-      Hash HashedName = -1;
+      utils::HashedString HashedName;
 
       float LoadTime = 0.0f;
 
@@ -58,56 +72,228 @@ namespace assets
 
       std::vector<mm::vec3> Bitangents;
 
+      //Triangles of the vertices above, when it is empty the vertices are the triangle soup, e.g. of the debug meshes
+      std::vector<uint32_t> Indices;
+
       Hash FacesCount;
 
+      //Clusters of the connected triangles, every one is the continuous range of the indices above
+      std::vector<cook::Meshlet> Meshlets;
+
+      //Simplified levels from the finest to the coarsest, they are generated at the import
+      std::vector<std::shared_ptr<TrigVertices>> Lods;
+
+      //Computed by the cooking from the float positions, so the packed levels keep it too
+      cook::MeshBounds Bounds = {};
+
+      //Distance from this level to the surface of the source mesh, in the object space
+      float LodError = 0.0f;
+
+      //Compact layout of the vertices above, packed meshes keep only it and the float attributes are empty
+      std::vector<cook::PackedVertex> PackedVertices;
+
+      cook::VertexBounds PackedBounds;
+
+      inline size_t GetVerticesCount() const
+      {
+         return PackedVertices.empty() ? Positions.size() : PackedVertices.size();
+      }
+
       ASSET_TYPE(AssetType::Mesh);
    };
 
    class PixelsData : public AssetData
    {
    public:
+      //Size of the full image, even when only the part of the chain is loaded
       int32_t Width;
 
       int32_t Height;
 
       int32_t Channels;
 
-      void* Pixels;
+      //Rows are stored from the bottom to the top, as the OpenGL expects
+      //All the mip levels are in this buffer, level 0 is at the start
+      PixelBuffer Pixels;
+
+      std::vector<MipLevel> Mips;
+
+      //Level of the full chain that is stored in the Mips[0], partially loaded images skip the biggest levels
+      int32_t FirstLevel = 0;
+
+      //Cooked images can be block compressed, then the mips hold the blocks instead of the pixels
+      cook::BlockFormat Compression = cook::BlockFormat::None;
+
+      inline const uint8_t* GetMipData(const size_t level) const
+      {
+         return Pixels.get() + Mips[level].Offset;
+      }
 
       ASSET_TYPE(AssetType::Image)
    }; 
 
 
+   namespace loaders
+   {
+      //Only the triangulated OBJ faces with the positions, UVs and normals are loaded
+      //Corners with the same position, UV and normal indices are the single vertex of the indexed result
+      TrigVertices LoadTrigVertices(const std::string_view filepath, const RawData& data);
+
+      //Same as above, but the file is read by the windows and the reader memory is bounded by the params
+      //peakBytes gets the peak of the reader, it is set on the failure too
+      TrigVertices StreamTrigVertices(const std::string_view filepath, const obj::ObjReadParams& params, size_t* peakBytes = nullptr);
+
+      //Triangle primitives of the binary glTF scene merged into the single indexed mesh with the node transforms applied
+      TrigVertices LoadGlbVertices(const std::string_view filepath, const RawData& data);
+
+      //Loader is picked by the extension
+      TrigVertices LoadMesh(const std::string_view filepath, const RawData& data);
+
+      //Makes the loaded soup or the indexed mesh the welded one with the meshlets and the LODs, the AssetManager does it for every loaded mesh
+      void CookMesh(TrigVertices& mesh);
+
+      //Quantizes the cooked mesh and its LODs into the PackedVertices, every level has its own bounds
+      void PackMesh(TrigVertices& mesh);
+
+      //Cooked mesh with its LODs as the single blob, it is stored in the derived data cache
+      std::vector<uint8_t> WriteCookedMesh(const TrigVertices& mesh);
+
+      TrigVertices ReadCookedMesh(const std::string_view filepath, const RawData& data);
+
+      //Cooker of the cook worker process, the loose source file is cooked into the blob of the ReadCookedMesh or the LoadCookedPixels
+      bool CookSourceFile(const cook::CookJob& job, std::vector<uint8_t>& result, std::string& error);
+   }
+
+
+   struct LoadRequest
+   {
+      Hash HashedPath;
+      std::string Path;
+
+      //Null when the asset isn't found in the mounted archives and is loaded from the loose file
+      const pak::Archive* Archive = nullptr;
+      const pak::TocEntry* Entry = nullptr;
+   };
+
+   //Loading is the pipeline of the read, parse, cook and upload stages, the items between them are bounded by the QueueCapacity
+   //Zero job count is the number of the hardware threads
+   struct LoadPipelineParams
+   {
+      //Loose files that are read at once by the IO service, the reads don't take the job threads
+      uint16_t ReadsInFlight = 8;
+      uint16_t ParseJobs = 0;
+      uint16_t CookJobs = 0;
+
+      //Upload stage runs on the thread that calls the Load, this many assets per pump
+      uint16_t UploadsPerPump = 4;
+
+      size_t QueueCapacity = 8;
+
+      core::IoServiceParams Io;
+
+      //Loose assets are cooked by this many worker processes instead of the job threads, zero cooks them in the engine
+      //Worker executable is run from the working directory of the engine
+      uint16_t CookWorkers = 0;
+      std::string CookWorkerCommand = "cook-worker";
+   };
+
+   //Called on the loading thread for every loaded asset before it is registered, e.g. to create its GPU resources
+   using UploadFunc = void(*)(AssetData& asset, uintptr_t args);
+
+   struct AtlasItem
+   {
+      std::string MeshPath;
+      std::vector<std::string> TexturePaths; //One per atlas page, textures of the single item must be of the same size
+   };
+
    class AssetManager
    {
    private:
-      std::vector<std::pair<Hash, std::string>> LoadQueue;
-      std::unordered_map<Hash, std::shared_ptr<AssetData>> AssetDataLookup;
+      std::vector<LoadRequest> LoadQueue;
+      utils::FlatHashMap<Hash, std::shared_ptr<AssetData>> AssetDataLookup;
+
+      std::vector<std::unique_ptr<pak::Archive>> MountedArchives;
+
+      cook::VertexFormat MeshVertexFormat = cook::VertexFormat::Float;
+
+      obj::ObjReadParams ObjParams;
+
+      LoadPipelineParams PipelineParams;
+
+      //Created by the first Load, it keeps its threads between the loads
+      std::unique_ptr<core::IoService> Io;
 
-      utils::sync::SpinLock LoadSL;
+      //Created by the first Load when the CookWorkers are set, the workers stay running between the loads
+      std::unique_ptr<cook::CookWorkerPool> CookWorkers;
+
+      //Image level loads are const, but they fill the cache too
+      mutable cook::DerivedCache DerivedData;
+
+      LoadRequest Resolve(const std::string_view& filepath) const;
 
       template<typename T>
-      inline std::shared_ptr<T> GetData(const Hash hash) const
+      inline std::shared_ptr<T> FindData(const std::string_view& path) const
       {
-         auto asset = AssetDataLookup.find(hash);
+         auto asset = AssetDataLookup.find(GetHash(path));
 
-         if (asset == AssetDataLookup.end()
-            || T::GetStaticType() != asset->second->GetType()
-            || !asset->second->IsValid)
-         {
-            PRINT_AND_TERMINATE("Invalid asset was trying to being used: %s", asset->second->Name.c_str());
-         }
+         if (asset == AssetDataLookup.end() || T::GetStaticType() != asset->second->GetType() || !asset->second->IsValid)
+            return nullptr;
 
-         return std::static_pointer_cast<T>(AssetDataLookup.at(hash));
+         return std::static_pointer_cast<T>(asset->second);
       }
    public:
-      void Load();
+      //Blocks until every queued asset has passed the pipeline, the failed ones aren't registered
+      void Load(UploadFunc upload = nullptr, uintptr_t uploadArgs = 0);
+
+      //Layout of the meshes loaded after this call, the renderer must be set up for the same one
+      inline void SetMeshVertexFormat(const cook::VertexFormat format)
+      {
+         MeshVertexFormat = format;
+      }
 
-      inline void ToLoad(const std::string_view& filepath)
+      //Loose OBJ files are streamed from the disk with these params, the ones from the archives are already in memory
+      inline void SetObjReadParams(const obj::ObjReadParams& params)
       {
-         LoadQueue.emplace_back(GetHash(filepath), filepath);
+         ObjParams = params;
       }
 
+      inline void SetLoadPipelineParams(const LoadPipelineParams& params)
+      {
+         PipelineParams = params;
+         Io.reset(); //Next Load creates it with the new params
+         CookWorkers.reset();
+      }
+
+      //Cooked meshes and images are stored in the directory and reused by the later loads of the same source bytes
+      //Cooked images from the archives aren't cached, they are already cooked
+      inline bool OpenDerivedCache(const std::string_view& directory, const uint64_t maxSize)
+      {
+         return DerivedData.Open(directory, maxSize);
+      }
+
+      inline cook::DerivedCacheStats GetDerivedCacheStats()
+      {
+         return DerivedData.GetStats();
+      }
+
+      //Archives mounted later override the assets with the same path from the earlier ones
+      bool Mount(const std::string_view& archivePath);
+
+      //Path is resolved against the mounted archives first and only then against the loose files
+      void ToLoad(const std::string_view& filepath);
+
+      //Loads the image levels [firstLevel, firstLevel + levelsCount) on the calling thread, the result isn't stored in the manager
+      //Cooked images read only these levels from the archive, the other images are decoded in full and trimmed
+      //With the open derived data cache the loose image is decoded only once, the next loads read its cooked chain
+      //firstLevel is clamped to the last level of the chain, the loads can run on the job threads
+      PixelsData LoadImageLevels(const std::string_view& filepath, const size_t firstLevel, const size_t levelsCount = SIZE_MAX) const;
+
+      //Packs the textures of the loaded items into the atlas pages registered as the pageNames, the UVs of the meshes are remapped into them
+      //Pages share the layout, so the single remap serves e.g. both the diffuse and the normal atlas
+      //Nothing is changed when any item can't be atlased: compressed or partially loaded textures, UVs outside of [0, 1]
+      bool BuildAtlas(const std::vector<std::string>& pageNames, const std::vector<AtlasItem>& items,
+                      const int32_t maxSize = 4096, const int32_t gutter = 8);
+
       template<typename T>
       inline void Register(const std::string_view& assetName, const T& assetData)
       {
@@ -116,11 +302,22 @@ namespace assets
          AssetDataLookup[GetHash(assetName)] = std::shared_ptr<T>(&const_cast<T&>(assetData)); 
       }
 
+      //Literal paths are hashed at compile time, so keep the HashedString around for the repeated lookups
+      //Literal ids aren't interned, so the error names them only by the hash, the ids made from the runtime strings have the path
       template<typename T>
-      inline std::shared_ptr<T> GetData(const std::string_view& filepath) const
+      inline std::shared_ptr<T> GetData(const utils::HashedString& id) const
       {
-         const Hash hash = GetHash(filepath);
-         return GetData<T>(hash);
+         auto asset = AssetDataLookup.find(id.GetValue());
+
+         if (asset == AssetDataLookup.end()
+            || T::GetStaticType() != asset->second->GetType()
+            || !asset->second->IsValid)
+         {
+            PRINT_AND_TERMINATE("Invalid asset was trying to being used: %s (%016llx)", id.GetDebugName(),
+                                static_cast<unsigned long long>(id.GetValue()));
+         }
+
+         return std::static_pointer_cast<T>(asset->second);
       }
    };
 }
@@ -0,0 +1,269 @@
+#include "atlas.h"
+
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include "jobs/job-system.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      static inline int32_t AlignUp(const int32_t value, const int32_t alignment)
+      {
+         return (value + alignment - 1) / alignment * alignment;
+      }
+
+      SkylinePacker::SkylinePacker(const int32_t width, const int32_t height)
+         : Width(width), Height(height)
+      {
+         Skyline.push_back({ 0, 0, width });
+      }
+
+      int32_t SkylinePacker::Fit(const size_t index, const int32_t width, const int32_t height) const
+      {
+         const int32_t x = Skyline[index].X;
+         if (x + width > Width)
+            return -1;
+
+         int32_t y = 0;
+         int32_t widthLeft = width;
+
+         //Rectangle lies on the highest of the segments that it covers
+         for (size_t i = index; widthLeft > 0; ++i)
+         {
+            y = std::max(y, Skyline[i].Y);
+            if (y + height > Height)
+               return -1;
+
+            widthLeft -= Skyline[i].Width;
+         }
+
+         return y;
+      }
+
+      void SkylinePacker::Place(const size_t index, const int32_t x, const int32_t y, const int32_t width, const int32_t height)
+      {
+         Skyline.insert(Skyline.begin() + index, { x, y + height, width });
+
+         //Segments under the new one are cut or removed
+         for (size_t i = index + 1; i < Skyline.size();)
+         {
+            const int32_t right = x + width;
+            Segment& segment = Skyline[i];
+
+            if (segment.X >= right)
+               break;
+
+            const int32_t shrink = right - segment.X;
+
+            if (segment.Width <= shrink)
+            {
+               Skyline.erase(Skyline.begin() + i);
+               continue;
+            }
+
+            segment.X += shrink;
+            segment.Width -= shrink;
+            break;
+         }
+
+         //Neighbours of the same height are merged, so the skyline stays short
+         for (size_t i = 0; i + 1 < Skyline.size();)
+         {
+            if (Skyline[i].Y == Skyline[i + 1].Y)
+            {
+               Skyline[i].Width += Skyline[i + 1].Width;
+               Skyline.erase(Skyline.begin() + i + 1);
+            }
+            else
+            {
+               ++i;
+            }
+         }
+      }
+
+      bool SkylinePacker::Insert(const int32_t width, const int32_t height, int32_t& x, int32_t& y)
+      {
+         size_t bestIndex = Skyline.size();
+         int32_t bestTop = INT32_MAX;
+         int32_t bestX = 0;
+         int32_t bestY = 0;
+
+         for (size_t i = 0; i < Skyline.size(); ++i)
+         {
+            const int32_t fitY = Fit(i, width, height);
+            if (fitY < 0)
+               continue;
+
+            if (fitY + height < bestTop)
+            {
+               bestIndex = i;
+               bestTop = fitY + height;
+               bestX = Skyline[i].X;
+               bestY = fitY;
+            }
+         }
+
+         if (bestIndex == Skyline.size())
+            return false;
+
+         Place(bestIndex, bestX, bestY, width, height);
+
+         x = bestX;
+         y = bestY;
+
+         return true;
+      }
+
+      bool PackAtlas(const std::vector<std::pair<int32_t, int32_t>>& sizes, const int32_t maxSize, const int32_t gutter,
+                     AtlasLayout& layout)
+      {
+         if (gutter <= 0 || (gutter & (gutter - 1)))
+            return false;
+
+         //Padded sizes are gutter aligned, so every position of the skyline is aligned too
+         std::vector<std::pair<int32_t, int32_t>> padded(sizes.size());
+         uint64_t area = 0;
+
+         for (size_t i = 0; i < sizes.size(); ++i)
+         {
+            padded[i] = { AlignUp(sizes[i].first + 2 * gutter, gutter), AlignUp(sizes[i].second + 2 * gutter, gutter) };
+            area += static_cast<uint64_t>(padded[i].first) * padded[i].second;
+         }
+
+         //Tall images first, the skyline stays flat
+         std::vector<size_t> order(sizes.size());
+         std::iota(order.begin(), order.end(), 0);
+         std::sort(order.begin(), order.end(), [&padded](const size_t a, const size_t b)
+            {
+               if (padded[a].second != padded[b].second)
+                  return padded[a].second > padded[b].second;
+
+               return padded[a].first > padded[b].first;
+            });
+
+         int32_t width = gutter;
+         int32_t height = gutter;
+
+         while (static_cast<uint64_t>(width) * height < area)
+         {
+            if (width <= height)
+               width *= 2;
+            else
+               height *= 2;
+         }
+
+         std::vector<AtlasRegion> regions(sizes.size());
+
+         while (width <= maxSize && height <= maxSize)
+         {
+            SkylinePacker packer(width, height);
+
+            bool isPacked = true;
+            for (size_t i : order)
+            {
+               int32_t x, y;
+               if (!packer.Insert(padded[i].first, padded[i].second, x, y))
+               {
+                  isPacked = false;
+                  break;
+               }
+
+               regions[i] = { x + gutter, y + gutter, sizes[i].first, sizes[i].second };
+            }
+
+            if (isPacked)
+            {
+               layout.Width = width;
+               layout.Height = height;
+               layout.Gutter = gutter;
+               layout.Regions = std::move(regions);
+
+               return true;
+            }
+
+            if (width <= height)
+               width *= 2;
+            else
+               height *= 2;
+         }
+
+         return false;
+      }
+
+      size_t GetAtlasMipsCount(const AtlasLayout& layout)
+      {
+         size_t count = 1;
+         for (int32_t gutter = layout.Gutter; gutter > 1; gutter >>= 1)
+            ++count;
+
+         return std::min(count, GetMipsCount(layout.Width, layout.Height));
+      }
+
+      //Gray images are expanded to RGB, the second channel of the two channel image is its alpha, missing alpha is opaque
+      static uint8_t GetAtlasChannel(const uint8_t* src, const int32_t imageChannels, const int32_t channel)
+      {
+         if (channel == 3)
+            return imageChannels == 4 ? src[3] : imageChannels == 2 ? src[1] : 255;
+
+         if (imageChannels <= 2)
+            return src[0];
+
+         return channel < imageChannels ? src[channel] : 0;
+      }
+
+      //Writes the image and its gutter, the gutter texels repeat the nearest edge texel
+      static void CopyRegion(const AtlasLayout& layout, const AtlasRegion& region, const uint8_t* image, const int32_t imageChannels,
+                             const int32_t channels, uint8_t* atlas)
+      {
+         const int32_t gutter = layout.Gutter;
+
+         for (int32_t y = -gutter; y < region.Height + gutter; ++y)
+         {
+            const int32_t sy = std::clamp(y, 0, region.Height - 1);
+            uint8_t* dst = atlas + (static_cast<size_t>(region.Y + y) * layout.Width + region.X - gutter) * channels;
+
+            for (int32_t x = -gutter; x < region.Width + gutter; ++x, dst += channels)
+            {
+               const int32_t sx = std::clamp(x, 0, region.Width - 1);
+               const uint8_t* src = image + (static_cast<size_t>(sy) * region.Width + sx) * imageChannels;
+
+               for (int32_t c = 0; c < channels; ++c)
+                  dst[c] = GetAtlasChannel(src, imageChannels, c);
+            }
+         }
+      }
+
+      bool ComposeAtlas(const AtlasLayout& layout, const std::vector<const uint8_t*>& images, const std::vector<int32_t>& imageChannels,
+                        const int32_t channels, const MipFilter filter, PixelBuffer& resPixels, std::vector<MipLevel>& resMips)
+      {
+         if (images.size() != layout.Regions.size() || imageChannels.size() != layout.Regions.size())
+            return false;
+
+         const size_t size = static_cast<size_t>(layout.Width) * layout.Height * channels;
+
+         PixelBuffer atlas(static_cast<uint8_t*>(PixelPool::Allocate(size)));
+         if (!atlas)
+            return false;
+
+         //Space between the regions is never sampled, it is cleared only to keep the output deterministic
+         memset(atlas.get(), 0, size);
+
+         core::JobSystem::ParallelFor(images.size(), 1, [&](const size_t begin, const size_t end)
+            {
+               for (size_t i = begin; i < end; ++i)
+                  CopyRegion(layout, layout.Regions[i], images[i], imageChannels[i], channels, atlas.get());
+            });
+
+         if (!BuildMipChain(atlas.get(), layout.Width, layout.Height, channels, filter, resPixels, resMips))
+            return false;
+
+         //Data of the dropped levels stays at the end of the buffer, it is small compared to the level 0
+         resMips.resize(GetAtlasMipsCount(layout));
+
+         return true;
+      }
+   }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "asset-manager/pixel-pool.h"
+#include "texture-format.h"
+#include "mip-chain.h"
+
+//Packing of the small images into the single atlas image
+//
+//Every image is surrounded by the gutter of its replicated edge texels and starts at the gutter aligned position,
+//so the 2x2 box filter of the mip chain never mixes the texels of the different images down to the level log2(gutter)
+//Deeper levels would bleed the neighbours, so the atlas chain is cut at that level
+
+namespace assets
+{
+   namespace cook
+   {
+      struct AtlasRegion
+      {
+         //Image texels without the gutter, in the rows from the bottom to the top as all the images
+         int32_t X;
+         int32_t Y;
+         int32_t Width;
+         int32_t Height;
+      };
+
+      struct AtlasLayout
+      {
+         int32_t Width;
+         int32_t Height;
+         int32_t Gutter;
+
+         std::vector<AtlasRegion> Regions; //In the order of the packed sizes
+      };
+
+      //Skyline bottom left packer, keeps the top edge of the placed rectangles as the list of the horizontal segments
+      //Rectangle goes to the position with the lowest top, ties are broken by the smaller x
+      class SkylinePacker
+      {
+      private:
+         struct Segment
+         {
+            int32_t X;
+            int32_t Y;
+            int32_t Width;
+         };
+
+         int32_t Width;
+         int32_t Height;
+
+         std::vector<Segment> Skyline;
+
+         //Returns the y of the rectangle placed at the start of the segment or -1 if it doesn't fit there
+         int32_t Fit(const size_t index, const int32_t width, const int32_t height) const;
+
+         void Place(const size_t index, const int32_t x, const int32_t y, const int32_t width, const int32_t height);
+      public:
+         SkylinePacker(const int32_t width, const int32_t height);
+
+         bool Insert(const int32_t width, const int32_t height, int32_t& x, int32_t& y);
+      };
+
+      //Gutter must be the power of two, sizes are the image sizes without it
+      //Atlas grows from the smallest power of two square that can hold the images up to the maxSize
+      bool PackAtlas(const std::vector<std::pair<int32_t, int32_t>>& sizes, const int32_t maxSize, const int32_t gutter,
+                     AtlasLayout& layout);
+
+      //Levels that don't mix the texels of the different images
+      size_t GetAtlasMipsCount(const AtlasLayout& layout);
+
+      //Copies the images with their gutters into the atlas and builds its chain, images are expanded or cut to the channels count
+      bool ComposeAtlas(const AtlasLayout& layout, const std::vector<const uint8_t*>& images, const std::vector<int32_t>& imageChannels,
+                        const int32_t channels, const MipFilter filter, PixelBuffer& resPixels, std::vector<MipLevel>& resMips);
+
+      //Moves the image UV into the region of the atlas, only the [0, 1] UVs can be remapped, the tiling isn't possible in the atlas
+      inline void RemapUV(const AtlasLayout& layout, const AtlasRegion& region, float& u, float& v)
+      {
+         u = (region.X + u * region.Width) / layout.Width;
+         v = (region.Y + v * region.Height) / layout.Height;
+      }
+   }
+}
@@ -0,0 +1,919 @@
+#include "block-compression.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+
+#include <emmintrin.h>
+
+#include "jobs/job-system.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      //Smaller work isn't worth the jobs overhead
+      constexpr size_t MinBlocksPerJob = 64;
+
+      constexpr size_t LeastSquaresIterations = 2;
+
+      //Texels of the block in the SoA layout, so 4 texels are processed by the single SSE instruction
+      struct BlockTexels
+      {
+         alignas(16) float Channels[4][16];
+      };
+
+      struct Endpoints
+      {
+         float E0[4];
+         float E1[4];
+      };
+
+      class BitWriter
+      {
+      private:
+         uint8_t* Data;
+         size_t Position = 0;
+      public:
+         inline BitWriter(uint8_t* data, const size_t size)
+            : Data(data)
+         {
+            memset(data, 0, size);
+         }
+
+         inline void Write(const uint32_t value, const size_t bitsCount)
+         {
+            for (size_t i = 0; i < bitsCount; ++i, ++Position)
+            {
+               if ((value >> i) & 1)
+                  Data[Position >> 3] |= static_cast<uint8_t>(1 << (Position & 7));
+            }
+         }
+      };
+
+      class BitReader
+      {
+      private:
+         const uint8_t* Data;
+         size_t Position = 0;
+      public:
+         inline BitReader(const uint8_t* data)
+            : Data(data) {}
+
+         inline uint32_t Read(const size_t bitsCount)
+         {
+            uint32_t value = 0;
+            for (size_t i = 0; i < bitsCount; ++i, ++Position)
+               value |= ((Data[Position >> 3] >> (Position & 7)) & 1u) << i;
+
+            return value;
+         }
+      };
+
+      static void LoadTexels(const uint8_t* rgba, BlockTexels& texels)
+      {
+         for (size_t i = 0; i < 16; ++i)
+         {
+            for (size_t c = 0; c < 4; ++c)
+               texels.Channels[c][i] = rgba[i * 4 + c];
+         }
+      }
+
+      static inline float Clamp255(const float v)
+      {
+         return std::clamp(v, 0.0f, 255.0f);
+      }
+
+      template<size_t ChannelsCount>
+      static void BoundingBoxEndpoints(const BlockTexels& texels, const float inset, Endpoints& res)
+      {
+         for (size_t c = 0; c < ChannelsCount; ++c)
+         {
+            const float* values = texels.Channels[c];
+
+            const float minValue = *std::min_element(values, values + 16);
+            const float maxValue = *std::max_element(values, values + 16);
+
+            const float offset = (maxValue - minValue) * inset;
+
+            res.E0[c] = maxValue - offset;
+            res.E1[c] = minValue + offset;
+         }
+      }
+
+      //Endpoints are the extreme projections of the texels to the principal axis of the colors
+      template<size_t ChannelsCount>
+      static void PrincipalAxisEndpoints(const BlockTexels& texels, Endpoints& res)
+      {
+         float mean[4] = { 0.0f };
+         for (size_t c = 0; c < ChannelsCount; ++c)
+         {
+            for (size_t i = 0; i < 16; ++i)
+               mean[c] += texels.Channels[c][i];
+
+            mean[c] /= 16.0f;
+         }
+
+         float covariance[4][4] = { { 0.0f } };
+         for (size_t i = 0; i < 16; ++i)
+         {
+            for (size_t a = 0; a < ChannelsCount; ++a)
+            {
+               for (size_t b = a; b < ChannelsCount; ++b)
+                  covariance[a][b] += (texels.Channels[a][i] - mean[a]) * (texels.Channels[b][i] - mean[b]);
+            }
+         }
+
+         for (size_t a = 0; a < ChannelsCount; ++a)
+         {
+            for (size_t b = 0; b < a; ++b)
+               covariance[a][b] = covariance[b][a];
+         }
+
+         //Power iteration, starts from the channel with the biggest variance
+         size_t start = 0;
+         for (size_t c = 1; c < ChannelsCount; ++c)
+         {
+            if (covariance[c][c] > covariance[start][start])
+               start = c;
+         }
+
+         float axis[4] = { 0.0f };
+         for (size_t c = 0; c < ChannelsCount; ++c)
+            axis[c] = covariance[start][c];
+
+         for (size_t iteration = 0; iteration < 8; ++iteration)
+         {
+            float next[4] = { 0.0f };
+            float length = 0.0f;
+
+            for (size_t a = 0; a < ChannelsCount; ++a)
+            {
+               for (size_t b = 0; b < ChannelsCount; ++b)
+                  next[a] += covariance[a][b] * axis[b];
+
+               length += next[a] * next[a];
+            }
+
+            if (length < 1e-12f)
+               break;
+
+            length = 1.0f / sqrtf(length);
+            for (size_t c = 0; c < ChannelsCount; ++c)
+               axis[c] = next[c] * length;
+         }
+
+         float minProjection = FLT_MAX;
+         float maxProjection = -FLT_MAX;
+
+         for (size_t i = 0; i < 16; ++i)
+         {
+            float projection = 0.0f;
+            for (size_t c = 0; c < ChannelsCount; ++c)
+               projection += (texels.Channels[c][i] - mean[c]) * axis[c];
+
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+         }
+
+         for (size_t c = 0; c < ChannelsCount; ++c)
+         {
+            res.E0[c] = Clamp255(mean[c] + axis[c] * maxProjection);
+            res.E1[c] = Clamp255(mean[c] + axis[c] * minProjection);
+         }
+      }
+
+      //Picks the nearest palette entry for every texel, returns the squared error of the block
+      template<size_t ChannelsCount>
+      static float FitIndices(const BlockTexels& texels, const float (*palette)[4], const size_t paletteSize, uint8_t* indices)
+      {
+         float error = 0.0f;
+
+         for (size_t i = 0; i < 16; i += 4)
+         {
+            __m128 channels[ChannelsCount];
+            for (size_t c = 0; c < ChannelsCount; ++c)
+               channels[c] = _mm_load_ps(&texels.Channels[c][i]);
+
+            __m128 bestDistance = _mm_set1_ps(FLT_MAX);
+            __m128i bestIndex = _mm_setzero_si128();
+
+            for (size_t p = 0; p < paletteSize; ++p)
+            {
+               __m128 distance = _mm_setzero_ps();
+               for (size_t c = 0; c < ChannelsCount; ++c)
+               {
+                  const __m128 d = _mm_sub_ps(channels[c], _mm_set1_ps(palette[p][c]));
+                  distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+               }
+
+               const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, bestDistance));
+
+               bestDistance = _mm_min_ps(distance, bestDistance);
+               bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(p))),
+                                        _mm_andnot_si128(closer, bestIndex));
+            }
+
+            alignas(16) int32_t resIndices[4];
+            alignas(16) float resDistances[4];
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(resIndices), bestIndex);
+            _mm_store_ps(resDistances, bestDistance);
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+               indices[i + j] = static_cast<uint8_t>(resIndices[j]);
+               error += resDistances[j];
+            }
+         }
+
+         return error;
+      }
+
+      //Solves for the endpoints that minimize the error with the fixed indices
+      //weights[i] is the part of the E0 in the palette entry i
+      template<size_t ChannelsCount>
+      static bool LeastSquaresEndpoints(const BlockTexels& texels, const uint8_t* indices, const float* weights, Endpoints& res)
+      {
+         float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+         float ap[4] = { 0.0f }, bp[4] = { 0.0f };
+
+         for (size_t i = 0; i < 16; ++i)
+         {
+            const float a = weights[indices[i]];
+            const float b = 1.0f - a;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+
+            for (size_t c = 0; c < ChannelsCount; ++c)
+            {
+               ap[c] += a * texels.Channels[c][i];
+               bp[c] += b * texels.Channels[c][i];
+            }
+         }
+
+         const float determinant = aa * bb - ab * ab;
+         if (fabsf(determinant) < 1e-6f)
+            return false;
+
+         const float inverse = 1.0f / determinant;
+
+         for (size_t c = 0; c < ChannelsCount; ++c)
+         {
+            res.E0[c] = Clamp255((ap[c] * bb - bp[c] * ab) * inverse);
+            res.E1[c] = Clamp255((bp[c] * aa - ap[c] * ab) * inverse);
+         }
+
+         return true;
+      }
+
+
+      //BC1
+
+      struct ColorBlock
+      {
+         uint16_t C0;
+         uint16_t C1;
+         uint8_t Indices[16];
+         float Error;
+      };
+
+      //Palette order of the 4 colors mode, part of the C0 for every index
+      constexpr float BC1Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+      static inline uint16_t To565(const float* color)
+      {
+         const uint32_t r = static_cast<uint32_t>(Clamp255(color[0]) * 31.0f / 255.0f + 0.5f);
+         const uint32_t g = static_cast<uint32_t>(Clamp255(color[1]) * 63.0f / 255.0f + 0.5f);
+         const uint32_t b = static_cast<uint32_t>(Clamp255(color[2]) * 31.0f / 255.0f + 0.5f);
+
+         return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+      }
+
+      static inline void From565(const uint16_t value, uint32_t* color)
+      {
+         const uint32_t r = value >> 11;
+         const uint32_t g = (value >> 5) & 63;
+         const uint32_t b = value & 31;
+
+         color[0] = (r << 3) | (r >> 2);
+         color[1] = (g << 2) | (g >> 4);
+         color[2] = (b << 3) | (b >> 2);
+      }
+
+      //Decoder palette, the same integer math is used by the encoder to measure the error
+      static void BC1Palette(const uint16_t c0, const uint16_t c1, uint32_t (*palette)[4])
+      {
+         From565(c0, palette[0]);
+         From565(c1, palette[1]);
+
+         palette[0][3] = palette[1][3] = 255;
+         palette[2][3] = palette[3][3] = 255;
+
+         for (size_t c = 0; c < 3; ++c)
+         {
+            if (c0 > c1)
+            {
+               palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+               palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+               palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+               palette[3][c] = 0;
+            }
+         }
+
+         if (c0 <= c1)
+            palette[3][3] = 0;
+      }
+
+      //Always the 4 colors mode, the 3 colors one isn't supported by the BC3
+      static void EvaluateColorBlock(const BlockTexels& texels, uint16_t c0, uint16_t c1, ColorBlock& res)
+      {
+         if (c0 < c1)
+            std::swap(c0, c1);
+
+         res.C0 = c0;
+         res.C1 = c1;
+
+         uint32_t palette[4][4];
+         BC1Palette(c0, c1, palette);
+
+         float floatPalette[4][4];
+         for (size_t p = 0; p < 4; ++p)
+         {
+            for (size_t c = 0; c < 4; ++c)
+               floatPalette[p][c] = static_cast<float>(palette[p][c]);
+         }
+
+         //Equal endpoints mean the single color, the palette has only one valid entry
+         res.Error = FitIndices<3>(texels, floatPalette, c0 == c1 ? 1 : 4, res.Indices);
+      }
+
+      static void EncodeColorBlock(const BlockTexels& texels, const CompressionQuality quality, uint8_t* block)
+      {
+         Endpoints endpoints;
+
+         if (quality == CompressionQuality::Fast)
+            BoundingBoxEndpoints<3>(texels, 1.0f / 16.0f, endpoints);
+         else
+            PrincipalAxisEndpoints<3>(texels, endpoints);
+
+         ColorBlock best;
+         EvaluateColorBlock(texels, To565(endpoints.E0), To565(endpoints.E1), best);
+
+         if (quality == CompressionQuality::High)
+         {
+            ColorBlock current = best;
+
+            for (size_t i = 0; i < LeastSquaresIterations && current.C0 != current.C1; ++i)
+            {
+               if (!LeastSquaresEndpoints<3>(texels, current.Indices, BC1Weights, endpoints))
+                  break;
+
+               EvaluateColorBlock(texels, To565(endpoints.E0), To565(endpoints.E1), current);
+
+               if (current.Error < best.Error)
+                  best = current;
+            }
+         }
+
+         uint32_t indices = 0;
+         for (size_t i = 0; i < 16; ++i)
+            indices |= static_cast<uint32_t>(best.Indices[i]) << (i * 2);
+
+         memcpy(block, &best.C0, 2);
+         memcpy(block + 2, &best.C1, 2);
+         memcpy(block + 4, &indices, 4);
+      }
+
+
+      //BC4, single channel block, used for the alpha of the BC3 and for both channels of the BC5
+
+      //Decoder palette, values are rounded as the integer decoders do
+      static void BC4Palette(const uint8_t a0, const uint8_t a1, float* palette)
+      {
+         palette[0] = a0;
+         palette[1] = a1;
+
+         if (a0 > a1)
+         {
+            for (uint32_t i = 1; i < 7; ++i)
+               palette[i + 1] = static_cast<float>(((7 - i) * a0 + i * a1 + 3) / 7);
+         }
+         else
+         {
+            for (uint32_t i = 1; i < 5; ++i)
+               palette[i + 1] = static_cast<float>(((5 - i) * a0 + i * a1 + 2) / 5);
+
+            palette[6] = 0.0f;
+            palette[7] = 255.0f;
+         }
+      }
+
+      static float FitSingleChannel(const float* values, const uint8_t a0, const uint8_t a1, uint8_t* indices)
+      {
+         float palette[8];
+         BC4Palette(a0, a1, palette);
+
+         float error = 0.0f;
+
+         for (size_t i = 0; i < 16; ++i)
+         {
+            float bestDistance = FLT_MAX;
+
+            for (uint8_t p = 0; p < 8; ++p)
+            {
+               const float distance = (values[i] - palette[p]) * (values[i] - palette[p]);
+               if (distance < bestDistance)
+               {
+                  bestDistance = distance;
+                  indices[i] = p;
+               }
+            }
+
+            error += bestDistance;
+         }
+
+         return error;
+      }
+
+      static void EncodeSingleChannel(const float* values, const CompressionQuality quality, uint8_t* block)
+      {
+         const float minValue = *std::min_element(values, values + 16);
+         const float maxValue = *std::max_element(values, values + 16);
+
+         uint8_t a0 = static_cast<uint8_t>(maxValue);
+         uint8_t a1 = static_cast<uint8_t>(minValue);
+
+         uint8_t indices[16] = { 0 };
+         float error = a0 == a1 ? 0.0f : FitSingleChannel(values, a0, a1, indices);
+
+         //6 values mode has the exact 0 and 255, so it is better for the blocks with the few extreme values
+         if (quality == CompressionQuality::High && error > 0.0f)
+         {
+            float innerMin = 255.0f;
+            float innerMax = 0.0f;
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+               if (values[i] > 0.0f && values[i] < 255.0f)
+               {
+                  innerMin = std::min(innerMin, values[i]);
+                  innerMax = std::max(innerMax, values[i]);
+               }
+            }
+
+            if (innerMin <= innerMax)
+            {
+               const uint8_t b0 = static_cast<uint8_t>(innerMin);
+               const uint8_t b1 = static_cast<uint8_t>(innerMax);
+
+               uint8_t otherIndices[16];
+               const float otherError = FitSingleChannel(values, b0, b1, otherIndices);
+
+               if (otherError < error)
+               {
+                  a0 = b0;
+                  a1 = b1;
+                  error = otherError;
+                  memcpy(indices, otherIndices, sizeof(indices));
+               }
+            }
+         }
+
+         uint64_t bits = 0;
+         for (size_t i = 0; i < 16; ++i)
+            bits |= static_cast<uint64_t>(indices[i]) << (i * 3);
+
+         block[0] = a0;
+         block[1] = a1;
+
+         for (size_t i = 0; i < 6; ++i)
+            block[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+      }
+
+      static void DecodeSingleChannel(const uint8_t* block, uint8_t* rgba, const size_t channel)
+      {
+         float palette[8];
+         BC4Palette(block[0], block[1], palette);
+
+         uint64_t bits = 0;
+         for (size_t i = 0; i < 6; ++i)
+            bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+
+         for (size_t i = 0; i < 16; ++i)
+            rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+      }
+
+
+      //BC7 mode 6, RGBA endpoints with 7 bits per channel and the unique P bit per endpoint, 4 bits indices
+
+      constexpr uint32_t BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+      struct BC7Block
+      {
+         uint8_t Q0[4];
+         uint8_t Q1[4];
+         uint8_t P0;
+         uint8_t P1;
+         uint8_t Indices[16];
+         float Error;
+      };
+
+      static inline uint32_t BC7Interpolate(const uint32_t e0, const uint32_t e1, const uint32_t index)
+      {
+         return ((64 - BC7Weights[index]) * e0 + BC7Weights[index] * e1 + 32) >> 6;
+      }
+
+      //Picks the 7 bits values for the given P bit
+      static void QuantizeBC7Endpoint(const float* endpoint, const uint8_t pBit, uint8_t* q)
+      {
+         for (size_t c = 0; c < 4; ++c)
+            q[c] = static_cast<uint8_t>(std::clamp((endpoint[c] - pBit) / 2.0f + 0.5f, 0.0f, 127.0f));
+      }
+
+      static void EvaluateBC7Block(const BlockTexels& texels, BC7Block& block)
+      {
+         uint32_t e0[4], e1[4];
+         for (size_t c = 0; c < 4; ++c)
+         {
+            e0[c] = (block.Q0[c] << 1) | block.P0;
+            e1[c] = (block.Q1[c] << 1) | block.P1;
+         }
+
+         float palette[16][4];
+         for (uint32_t i = 0; i < 16; ++i)
+         {
+            for (size_t c = 0; c < 4; ++c)
+               palette[i][c] = static_cast<float>(BC7Interpolate(e0[c], e1[c], i));
+         }
+
+         block.Error = FitIndices<4>(texels, palette, 16, block.Indices);
+      }
+
+      //Tries every P bits combination for the endpoints and keeps the best one
+      static void FitBC7Endpoints(const BlockTexels& texels, const Endpoints& endpoints, const bool allPBits, BC7Block& best)
+      {
+         best.Error = FLT_MAX;
+
+         for (uint8_t p = 0; p < 4; ++p)
+         {
+            BC7Block block;
+            block.P0 = p & 1;
+            block.P1 = p >> 1;
+
+            //Without the full search the P bits are the same, it is the most common best choice for the smooth blocks
+            if (!allPBits && block.P0 != block.P1)
+               continue;
+
+            QuantizeBC7Endpoint(endpoints.E0, block.P0, block.Q0);
+            QuantizeBC7Endpoint(endpoints.E1, block.P1, block.Q1);
+
+            EvaluateBC7Block(texels, block);
+
+            if (block.Error < best.Error)
+               best = block;
+         }
+      }
+
+      static void EncodeBC7Block(const BlockTexels& texels, const CompressionQuality quality, uint8_t* dst)
+      {
+         Endpoints endpoints;
+
+         if (quality == CompressionQuality::Fast)
+            BoundingBoxEndpoints<4>(texels, 0.0f, endpoints);
+         else
+            PrincipalAxisEndpoints<4>(texels, endpoints);
+
+         const bool allPBits = quality != CompressionQuality::Fast;
+
+         BC7Block best;
+         FitBC7Endpoints(texels, endpoints, allPBits, best);
+
+         if (quality == CompressionQuality::High)
+         {
+            float weights[16];
+            for (size_t i = 0; i < 16; ++i)
+               weights[i] = 1.0f - BC7Weights[i] / 64.0f;
+
+            BC7Block current = best;
+
+            for (size_t i = 0; i < LeastSquaresIterations; ++i)
+            {
+               if (!LeastSquaresEndpoints<4>(texels, current.Indices, weights, endpoints))
+                  break;
+
+               FitBC7Endpoints(texels, endpoints, allPBits, current);
+
+               if (current.Error < best.Error)
+                  best = current;
+            }
+         }
+
+         //Highest bit of the first texel index is implicit zero, so the endpoints are swapped when it is set
+         if (best.Indices[0] >= 8)
+         {
+            std::swap(best.Q0, best.Q1);
+            std::swap(best.P0, best.P1);
+
+            for (auto& index : best.Indices)
+               index = 15 - index;
+         }
+
+         BitWriter writer(dst, 16);
+         writer.Write(1 << 6, 7);
+
+         for (size_t c = 0; c < 4; ++c)
+         {
+            writer.Write(best.Q0[c], 7);
+            writer.Write(best.Q1[c], 7);
+         }
+
+         writer.Write(best.P0, 1);
+         writer.Write(best.P1, 1);
+
+         writer.Write(best.Indices[0], 3);
+         for (size_t i = 1; i < 16; ++i)
+            writer.Write(best.Indices[i], 4);
+      }
+
+
+      BlockFormat SelectBlockFormat(const MipFilter filter, const int32_t channels, const CompressionQuality quality)
+      {
+         if (filter == MipFilter::Normal)
+            return BlockFormat::BC5;
+
+         if (quality == CompressionQuality::High)
+            return BlockFormat::BC7;
+
+         return channels == 4 ? BlockFormat::BC3 : BlockFormat::BC1;
+      }
+
+      void EncodeBC1(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block)
+      {
+         BlockTexels texels;
+         LoadTexels(rgba, texels);
+
+         EncodeColorBlock(texels, quality, block);
+      }
+
+      void EncodeBC3(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block)
+      {
+         BlockTexels texels;
+         LoadTexels(rgba, texels);
+
+         EncodeSingleChannel(texels.Channels[3], quality, block);
+         EncodeColorBlock(texels, quality, block + 8);
+      }
+
+      void EncodeBC5(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block)
+      {
+         BlockTexels texels;
+         LoadTexels(rgba, texels);
+
+         EncodeSingleChannel(texels.Channels[0], quality, block);
+         EncodeSingleChannel(texels.Channels[1], quality, block + 8);
+      }
+
+      void EncodeBC7(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block)
+      {
+         BlockTexels texels;
+         LoadTexels(rgba, texels);
+
+         EncodeBC7Block(texels, quality, block);
+      }
+
+      void DecodeBC1(const uint8_t* block, uint8_t* rgba)
+      {
+         uint16_t c0, c1;
+         uint32_t indices;
+
+         memcpy(&c0, block, 2);
+         memcpy(&c1, block + 2, 2);
+         memcpy(&indices, block + 4, 4);
+
+         uint32_t palette[4][4];
+         BC1Palette(c0, c1, palette);
+
+         for (size_t i = 0; i < 16; ++i)
+         {
+            const uint32_t* color = palette[(indices >> (i * 2)) & 3];
+
+            for (size_t c = 0; c < 4; ++c)
+               rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+         }
+      }
+
+      void DecodeBC3(const uint8_t* block, uint8_t* rgba)
+      {
+         DecodeBC1(block + 8, rgba);
+         DecodeSingleChannel(block, rgba, 3);
+      }
+
+      void DecodeBC5(const uint8_t* block, uint8_t* rgba)
+      {
+         for (size_t i = 0; i < 16; ++i)
+         {
+            rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+         }
+
+         DecodeSingleChannel(block, rgba, 0);
+         DecodeSingleChannel(block + 8, rgba, 1);
+      }
+
+      bool DecodeBC7(const uint8_t* block, uint8_t* rgba)
+      {
+         BitReader reader(block);
+
+         if (reader.Read(7) != (1 << 6))
+            return false;
+
+         uint32_t e0[4], e1[4];
+         for (size_t c = 0; c < 4; ++c)
+         {
+            e0[c] = reader.Read(7) << 1;
+            e1[c] = reader.Read(7) << 1;
+         }
+
+         const uint32_t p0 = reader.Read(1);
+         const uint32_t p1 = reader.Read(1);
+
+         for (size_t c = 0; c < 4; ++c)
+         {
+            e0[c] |= p0;
+            e1[c] |= p1;
+         }
+
+         for (size_t i = 0; i < 16; ++i)
+         {
+            const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+
+            for (size_t c = 0; c < 4; ++c)
+               rgba[i * 4 + c] = static_cast<uint8_t>(BC7Interpolate(e0[c], e1[c], index));
+         }
+
+         return true;
+      }
+
+      //Gathers the block texels as RGBA, texels outside of the image are replaced by the nearest edge ones
+      static void GatherBlock(const uint8_t* pixels, const int32_t width, const int32_t height, const int32_t channels,
+                              const int32_t blockX, const int32_t blockY, uint8_t* rgba)
+      {
+         for (int32_t y = 0; y < 4; ++y)
+         {
+            const int32_t sy = std::min(blockY * 4 + y, height - 1);
+
+            for (int32_t x = 0; x < 4; ++x)
+            {
+               const int32_t sx = std::min(blockX * 4 + x, width - 1);
+
+               const uint8_t* src = pixels + (static_cast<size_t>(sy) * width + sx) * channels;
+               uint8_t* dst = rgba + (y * 4 + x) * 4;
+
+               switch (channels)
+               {
+               case 1:
+                  dst[0] = dst[1] = dst[2] = src[0];
+                  dst[3] = 255;
+                  break;
+               case 2:
+                  dst[0] = src[0];
+                  dst[1] = src[1];
+                  dst[2] = 0;
+                  dst[3] = 255;
+                  break;
+               case 3:
+                  dst[0] = src[0];
+                  dst[1] = src[1];
+                  dst[2] = src[2];
+                  dst[3] = 255;
+                  break;
+               default:
+                  memcpy(dst, src, 4);
+                  break;
+               }
+            }
+         }
+      }
+
+      bool CompressImage(const uint8_t* pixels, const int32_t width, const int32_t height, const int32_t channels,
+                         const BlockFormat format, const CompressionQuality quality, uint8_t* dst)
+      {
+         if (format == BlockFormat::None || width <= 0 || height <= 0 || channels <= 0 || channels > 4)
+            return false;
+
+         const int32_t blocksX = (width + 3) / 4;
+         const int32_t blocksY = (height + 3) / 4;
+         const size_t blockSize = GetBlockSize(format);
+
+         const size_t minRowsPerJob = std::max<size_t>(1, MinBlocksPerJob / blocksX);
+
+         core::JobSystem::ParallelFor(blocksY, minRowsPerJob, [&](const size_t begin, const size_t end)
+            {
+               uint8_t rgba[64];
+
+               for (size_t by = begin; by < end; ++by)
+               {
+                  for (int32_t bx = 0; bx < blocksX; ++bx)
+                  {
+                     GatherBlock(pixels, width, height, channels, bx, static_cast<int32_t>(by), rgba);
+
+                     uint8_t* block = dst + (by * blocksX + bx) * blockSize;
+
+                     switch (format)
+                     {
+                     case BlockFormat::BC1: EncodeBC1(rgba, quality, block); break;
+                     case BlockFormat::BC3: EncodeBC3(rgba, quality, block); break;
+                     case BlockFormat::BC5: EncodeBC5(rgba, quality, block); break;
+                     case BlockFormat::BC7: EncodeBC7(rgba, quality, block); break;
+                     default: break;
+                     }
+                  }
+               }
+            });
+
+         return true;
+      }
+
+      bool DecompressImage(const uint8_t* blocks, const int32_t width, const int32_t height, const BlockFormat format, uint8_t* rgba)
+      {
+         if (format == BlockFormat::None || width <= 0 || height <= 0)
+            return false;
+
+         const int32_t blocksX = (width + 3) / 4;
+         const int32_t blocksY = (height + 3) / 4;
+         const size_t blockSize = GetBlockSize(format);
+
+         bool res = true;
+         uint8_t decoded[64];
+
+         for (int32_t by = 0; by < blocksY; ++by)
+         {
+            for (int32_t bx = 0; bx < blocksX; ++bx)
+            {
+               const uint8_t* block = blocks + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+
+               switch (format)
+               {
+               case BlockFormat::BC1: DecodeBC1(block, decoded); break;
+               case BlockFormat::BC3: DecodeBC3(block, decoded); break;
+               case BlockFormat::BC5: DecodeBC5(block, decoded); break;
+               case BlockFormat::BC7: res &= DecodeBC7(block, decoded); break;
+               default: break;
+               }
+
+               for (int32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+               {
+                  for (int32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                  {
+                     const size_t dst = (static_cast<size_t>(by * 4 + y) * width + bx * 4 + x) * 4;
+                     memcpy(rgba + dst, decoded + (y * 4 + x) * 4, 4);
+                  }
+               }
+            }
+         }
+
+         return res;
+      }
+
+      bool CompressMipChain(const uint8_t* pixels, const std::vector<MipLevel>& mips, const int32_t channels,
+                            const BlockFormat format, const CompressionQuality quality,
+                            PixelBuffer& resPixels, std::vector<MipLevel>& resMips)
+      {
+         std::vector<MipLevel> compressedMips(mips);
+
+         uint64_t offset = 0;
+         for (auto& mip : compressedMips)
+         {
+            mip.Offset = offset;
+            mip.Size = GetLevelSize(format, mip.Width, mip.Height, channels);
+
+            offset += mip.Size;
+         }
+
+         PixelBuffer buffer(static_cast<uint8_t*>(PixelPool::Allocate(static_cast<size_t>(offset))));
+         if (!buffer)
+            return false;
+
+         for (size_t i = 0; i < mips.size(); ++i)
+         {
+            if (!CompressImage(pixels + mips[i].Offset, mips[i].Width, mips[i].Height, channels,
+                               format, quality, buffer.get() + compressedMips[i].Offset))
+            {
+               return false;
+            }
+         }
+
+         resPixels = std::move(buffer);
+         resMips = std::move(compressedMips);
+
+         return true;
+      }
+   }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "asset-manager/pixel-pool.h"
+#include "texture-format.h"
+#include "mip-chain.h"
+
+//CPU encoders and decoders of the BC formats
+//
+//Block encoders take 16 RGBA texels of the 4x4 block in the row order
+//Image encoders replicate the edge texels into the blocks that are partially outside of the image,
+//missing channels are expanded as the OpenGL does: gray to RGB, 0 for G and B, 255 for alpha
+
+namespace assets
+{
+   namespace cook
+   {
+      enum class CompressionQuality : uint8_t
+      {
+         Fast,   //Bounding box endpoints
+         Normal, //Principal axis endpoints
+         High    //Principal axis with the least squares endpoints refinement
+      };
+
+      //Normal maps go to BC5, everything else to BC1/BC3, or to BC7 with the High quality
+      BlockFormat SelectBlockFormat(const MipFilter filter, const int32_t channels, const CompressionQuality quality);
+
+      void EncodeBC1(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block);
+      void EncodeBC3(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block);
+      void EncodeBC5(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block);
+      void EncodeBC7(const uint8_t* rgba, const CompressionQuality quality, uint8_t* block);
+
+      //Decoded blocks are RGBA, BC5 decodes to RG with B = 0 and A = 255
+      void DecodeBC1(const uint8_t* block, uint8_t* rgba);
+      void DecodeBC3(const uint8_t* block, uint8_t* rgba);
+      void DecodeBC5(const uint8_t* block, uint8_t* rgba);
+      bool DecodeBC7(const uint8_t* block, uint8_t* rgba); //Returns false for the modes other than 6
+
+      //Block rows are encoded in parallel, dst must have GetLevelSize bytes
+      bool CompressImage(const uint8_t* pixels, const int32_t width, const int32_t height, const int32_t channels,
+                         const BlockFormat format, const CompressionQuality quality, uint8_t* dst);
+
+      //Decodes to the RGBA image, used to measure the compression error
+      bool DecompressImage(const uint8_t* blocks, const int32_t width, const int32_t height, const BlockFormat format, uint8_t* rgba);
+
+      //Compresses every level of the chain into the single buffer
+      bool CompressMipChain(const uint8_t* pixels, const std::vector<MipLevel>& mips, const int32_t channels,
+                            const BlockFormat format, const CompressionQuality quality,
+                            PixelBuffer& resPixels, std::vector<MipLevel>& resMips);
+   }
+}
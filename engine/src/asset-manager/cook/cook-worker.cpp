@@ -0,0 +1,390 @@
+#include "cook-worker.h"
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include "jobs/job-system.h"
+#include "debug/globals.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      static bool SendReply(const utils::ParentPipe& pipe, const CookStatus status, const uint64_t size, const std::string& text = std::string())
+      {
+         const CookReply reply = { status, static_cast<uint32_t>(std::min<size_t>(text.size(), MaxCookTextSize)), size };
+
+         return utils::WriteToParent(pipe, &reply, sizeof(reply)) && utils::WriteToParent(pipe, text.data(), reply.TextSize);
+      }
+
+      int RunCookWorker(CookFunc cook)
+      {
+         const utils::ParentPipe pipe = utils::OpenParentPipe();
+
+         utils::SharedMemory memory;
+
+         std::vector<uint8_t> result;
+         bool isPending = false; //Result waits for the bigger shared memory
+
+         std::string text;
+         std::string error;
+
+         while (true)
+         {
+            CookRequest request;
+
+            //Closed pipe is the engine that has exited
+            if (!utils::ReadFromParent(pipe, &request, sizeof(request)) || request.TextSize > MaxCookTextSize)
+               return 0;
+
+            text.resize(request.TextSize);
+            if (!utils::ReadFromParent(pipe, text.data(), text.size()))
+               return 0;
+
+            bool isSent = true;
+
+            switch (request.Type)
+            {
+            case CookMessageType::Map:
+               {
+                  if (!memory.Open(text, static_cast<size_t>(request.Size)))
+                  {
+                     isPending = false;
+                     isSent = SendReply(pipe, CookStatus::Failed, 0, memory.GetError());
+                     break;
+                  }
+
+                  if (!isPending)
+                  {
+                     isSent = SendReply(pipe, CookStatus::Mapped, 0);
+                     break;
+                  }
+
+                  isPending = false;
+
+                  if (result.size() > memory.GetSize())
+                  {
+                     isSent = SendReply(pipe, CookStatus::Failed, 0, "Shared memory is too small");
+                     break;
+                  }
+
+                  memcpy(memory.GetData(), result.data(), result.size());
+                  isSent = SendReply(pipe, CookStatus::Done, result.size());
+               }break;
+            case CookMessageType::Cook:
+               {
+                  result.clear();
+                  error.clear();
+
+                  if (!cook({ request.JobType, text, request.Flags }, result, error))
+                  {
+                     isSent = SendReply(pipe, CookStatus::Failed, 0, error);
+                     break;
+                  }
+
+                  if (result.size() > memory.GetSize())
+                  {
+                     isPending = true;
+                     isSent = SendReply(pipe, CookStatus::NeedsSpace, result.size());
+                     break;
+                  }
+
+                  memcpy(memory.GetData(), result.data(), result.size());
+                  isSent = SendReply(pipe, CookStatus::Done, result.size());
+               }break;
+            default:
+               return 0;
+            }
+
+            if (!isSent)
+               return 0;
+         }
+      }
+
+      CookWorkerPool::CookWorkerPool(const CookWorkerParams& params)
+         : Params(params)
+      {
+         Params.WorkersCount = std::max<uint32_t>(Params.WorkersCount, 1);
+         Params.SharedSize = std::max<size_t>(Params.SharedSize, 4096);
+         Params.MaxAttempts = std::max<uint32_t>(Params.MaxAttempts, 1);
+
+         //Names are unique across the engines that run at once
+         NamePrefix = "cook-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+         for (uint32_t i = 0; i < Params.WorkersCount; ++i)
+         {
+            auto worker = std::make_unique<Worker>();
+            worker->Index = i;
+
+            std::string error;
+            if (!StartWorker(*worker, error))
+               LOG_ERROR("Couldn't start cook worker: %s (%s)", Params.Command.c_str(), error.c_str());
+
+            Workers.push_back(std::move(worker));
+         }
+
+         for (auto& worker : Workers)
+         {
+            Worker* w = worker.get();
+            w->Thread = std::thread([this, w]() { RunWorkerThread(*w); });
+         }
+      }
+
+      CookWorkerPool::~CookWorkerPool()
+      {
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+            IsStopping = true;
+         }
+
+         TaskCV.notify_all();
+
+         for (auto& worker : Workers)
+         {
+            worker->Thread.join();
+            StopWorker(*worker);
+         }
+      }
+
+      bool CookWorkerPool::MapMemory(Worker& worker, const size_t size, std::string& error)
+      {
+         const std::string name = NamePrefix + "-" + std::to_string(worker.Index) + "-" + std::to_string(++worker.Generation);
+
+         if (!worker.Memory.Create(name, size))
+         {
+            error = worker.Memory.GetError();
+            return false;
+         }
+
+         const CookRequest request = { CookMessageType::Map, CookJobType::Mesh, 0, static_cast<uint32_t>(name.size()), size };
+
+         if (!utils::WriteToProcess(worker.Process, &request, sizeof(request))
+             || !utils::WriteToProcess(worker.Process, name.data(), name.size()))
+         {
+            error = "Cook worker has exited";
+            return false;
+         }
+
+         return true;
+      }
+
+      bool CookWorkerPool::StartWorker(Worker& worker, std::string& error)
+      {
+         worker.Process = utils::CreateChildProcess(Params.Command, Params.WorkingDir, true);
+
+         if (!utils::IsProcessRunning(worker.Process))
+         {
+            error = "Process isn't created";
+            return false;
+         }
+
+         worker.IsRunning = true;
+
+         CookReply reply;
+         if (!MapMemory(worker, Params.SharedSize, error) || !utils::ReadFromProcess(worker.Process, &reply, sizeof(reply)))
+         {
+            if (error.empty())
+               error = "Cook worker has exited";
+
+            StopWorker(worker);
+            return false;
+         }
+
+         if (reply.Status != CookStatus::Mapped)
+         {
+            error = "Cook worker couldn't map shared memory";
+
+            StopWorker(worker);
+            return false;
+         }
+
+         return true;
+      }
+
+      void CookWorkerPool::StopWorker(Worker& worker)
+      {
+         if (!worker.IsRunning)
+            return;
+
+         //Running worker exits by itself, the crashed one is only reaped
+         const CookRequest request = { CookMessageType::Quit, CookJobType::Mesh, 0, 0, 0 };
+         utils::WriteToProcess(worker.Process, &request, sizeof(request));
+
+         utils::DestroyProcess(worker.Process);
+         worker.Process = utils::ProcessInfo();
+         worker.Memory.Close();
+
+         worker.IsRunning = false;
+      }
+
+      bool CookWorkerPool::RunTask(Worker& worker, const Task& task, CookResult& result)
+      {
+         const CookJob& job = task.Job;
+
+         const CookRequest request = { CookMessageType::Cook, job.Type, job.Flags, static_cast<uint32_t>(job.Path.size()), 0 };
+
+         CookReply reply;
+
+         if (job.Path.size() > MaxCookTextSize
+             || !utils::WriteToProcess(worker.Process, &request, sizeof(request))
+             || !utils::WriteToProcess(worker.Process, job.Path.data(), job.Path.size())
+             || !utils::ReadFromProcess(worker.Process, &reply, sizeof(reply)))
+         {
+            return false;
+         }
+
+         if (reply.Status == CookStatus::NeedsSpace)
+         {
+            //Memory grows by the doubling, so the next results of the similar size fit
+            const size_t size = std::max(static_cast<size_t>(reply.Size), worker.Memory.GetSize() * 2);
+
+            worker.Memory.Close();
+
+            std::string error;
+            if (!MapMemory(worker, size, error) || !utils::ReadFromProcess(worker.Process, &reply, sizeof(reply)))
+               return false;
+         }
+
+         switch (reply.Status)
+         {
+         case CookStatus::Done:
+            {
+               if (reply.Size > worker.Memory.GetSize())
+                  return false;
+
+               result.Data.assign(worker.Memory.GetData(), worker.Memory.GetData() + reply.Size);
+               result.IsSucceeded = true;
+            }break;
+         case CookStatus::Failed:
+            {
+               if (reply.TextSize > MaxCookTextSize)
+                  return false;
+
+               result.Error.resize(reply.TextSize);
+               if (!utils::ReadFromProcess(worker.Process, result.Error.data(), result.Error.size()))
+                  return false;
+
+               result.IsSucceeded = false;
+            }break;
+         default:
+            return false;
+         }
+
+         return true;
+      }
+
+      void CookWorkerPool::Finish(const Task& task, CookResult&& result)
+      {
+         struct Completion
+         {
+            CookResult Result;
+            CookCallback Callback;
+            uintptr_t Args;
+         };
+
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+
+            if (result.IsSucceeded)
+               ++Stats.Done;
+            else
+               ++Stats.Failed;
+         }
+
+         Completion* completion = new Completion({ std::move(result), task.Callback, task.Args });
+
+         core::JobSystem::Execute([](uintptr_t params)
+            {
+               std::unique_ptr<Completion> completion(reinterpret_cast<Completion*>(params));
+               completion->Callback(completion->Result, completion->Args);
+            }, reinterpret_cast<uintptr_t>(completion));
+      }
+
+      void CookWorkerPool::RunWorkerThread(Worker& worker)
+      {
+         while (true)
+         {
+            Task task;
+
+            {
+               std::unique_lock<std::mutex> l(Mutex);
+               TaskCV.wait(l, [this]() { return IsStopping || !Tasks.empty(); });
+
+               if (Tasks.empty())
+                  return;
+
+               task = std::move(Tasks.front());
+               Tasks.pop_front();
+            }
+
+            CookResult result;
+            result.Path = task.Job.Path;
+
+            std::string error;
+            if (!worker.IsRunning && !StartWorker(worker, error))
+            {
+               result.Error = "Couldn't start cook worker: " + error;
+
+               Finish(task, std::move(result));
+               continue;
+            }
+
+            if (RunTask(worker, task, result))
+            {
+               Finish(task, std::move(result));
+               continue;
+            }
+
+            LOG_WARNING("Cook worker has crashed on: %s, it is restarted", task.Job.Path.c_str());
+
+            StopWorker(worker);
+
+            {
+               std::lock_guard<std::mutex> l(Mutex);
+               ++Stats.Crashes;
+            }
+
+            if (StartWorker(worker, error))
+            {
+               std::lock_guard<std::mutex> l(Mutex);
+               ++Stats.Restarts;
+            }
+
+            //Retried by any worker, the restarted one could have failed to start
+            if (++task.Attempts < Params.MaxAttempts)
+            {
+               {
+                  std::lock_guard<std::mutex> l(Mutex);
+                  Tasks.push_front(std::move(task));
+               }
+
+               TaskCV.notify_one();
+               continue;
+            }
+
+            result.IsSucceeded = false;
+            result.Data.clear();
+            result.Error = "Cook worker has crashed";
+
+            Finish(task, std::move(result));
+         }
+      }
+
+      void CookWorkerPool::Submit(const CookJob& job, CookCallback callback, uintptr_t args)
+      {
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+            Tasks.push_back({ job, callback, args });
+         }
+
+         TaskCV.notify_one();
+      }
+
+      CookWorkerStats CookWorkerPool::GetStats()
+      {
+         std::lock_guard<std::mutex> l(Mutex);
+         return Stats;
+      }
+   }
+}
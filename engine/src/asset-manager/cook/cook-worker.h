@@ -0,0 +1,192 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "utils/process/process.h"
+#include "utils/shared-memory.h"
+
+//Messages between the engine and the cook worker, every one is the header and then the bytes of its text:
+//   Engine -> worker: CookRequest, the text is the path of the source for the cook and the name of the shared memory for the map
+//   Worker -> engine: CookReply, the text is the error of the failed request
+//Results are written into the shared memory of the worker, the reply has only their size
+
+namespace assets
+{
+   namespace cook
+   {
+      enum class CookJobType : uint32_t
+      {
+         Mesh, //Result is the blob of the loaders::WriteCookedMesh
+         Image //Result is the cooked texture
+      };
+
+      enum CookJobFlags : uint32_t
+      {
+         CJF_NONE = 0,
+         CJF_PACKED_VERTICES = 1 << 0
+      };
+
+      struct CookJob
+      {
+         CookJobType Type;
+         std::string Path;
+         uint32_t Flags = CJF_NONE;
+      };
+
+      struct CookResult
+      {
+         std::string Path;
+         std::vector<uint8_t> Data;
+
+         bool IsSucceeded = false;
+         std::string Error;
+      };
+
+      //Cooker of the worker process, it is run for every job
+      using CookFunc = bool(*)(const CookJob& job, std::vector<uint8_t>& result, std::string& error);
+
+      //Runs as the job in the engine process, the result can be moved out
+      using CookCallback = void(*)(CookResult& result, uintptr_t args);
+
+      enum class CookMessageType : uint32_t
+      {
+         Map,  //Worker maps the shared memory, the pending result is written into it
+         Cook,
+         Quit
+      };
+
+      enum class CookStatus : uint32_t
+      {
+         Mapped,
+         Done,
+         Failed,
+         NeedsSpace //Result doesn't fit into the shared memory, the worker keeps it until the bigger one is mapped
+      };
+
+      struct CookRequest
+      {
+         CookMessageType Type;
+         CookJobType JobType;
+         uint32_t Flags;
+         uint32_t TextSize;
+
+         uint64_t Size; //Of the shared memory to map
+      };
+
+      struct CookReply
+      {
+         CookStatus Status;
+         uint32_t TextSize;
+
+         uint64_t Size; //Of the result
+      };
+
+      inline constexpr uint32_t MaxCookTextSize = 64 * 1024;
+
+      //Worker side, serves the requests of the engine until it quits or closes the pipe, returns the exit code
+      int RunCookWorker(CookFunc cook);
+
+      struct CookWorkerParams
+      {
+         //Command line of the worker executable, e.g. "cook-worker"
+         std::string Command;
+         std::string WorkingDir;
+
+         uint32_t WorkersCount = 2;
+
+         //Initial shared memory of every worker, it grows to the biggest result
+         size_t SharedSize = 16 * 1024 * 1024;
+
+         //Job that crashes the worker this many times fails, so the broken asset doesn't restart the workers forever
+         uint32_t MaxAttempts = 2;
+      };
+
+      struct CookWorkerStats
+      {
+         size_t Done;
+         size_t Failed;
+         size_t Crashes;
+         size_t Restarts;
+      };
+
+      //Pool of the cook processes, so the heavy cooks don't take the engine threads and their crash doesn't take the engine down
+      //
+      //Every worker is served by its own thread that sends it the jobs one by one and waits for the replies. Crashed worker
+      //is started again and its job is retried. The callback of the job is executed by the JobSystem
+      class CookWorkerPool
+      {
+      private:
+         struct Task
+         {
+            CookJob Job;
+            CookCallback Callback;
+            uintptr_t Args;
+
+            uint32_t Attempts = 0;
+         };
+
+         struct Worker
+         {
+            uint32_t Index;
+
+            utils::ProcessInfo Process;
+            utils::SharedMemory Memory;
+            uint32_t Generation = 0; //Every shared memory of the worker has the new name
+
+            bool IsRunning = false;
+
+            std::thread Thread;
+         };
+
+         CookWorkerParams Params;
+         std::string NamePrefix;
+
+         std::vector<std::unique_ptr<Worker>> Workers;
+
+         std::mutex Mutex;
+         std::condition_variable TaskCV;
+
+         std::deque<Task> Tasks;
+         bool IsStopping = false;
+
+         CookWorkerStats Stats = {};
+
+         bool MapMemory(Worker& worker, const size_t size, std::string& error);
+
+         bool StartWorker(Worker& worker, std::string& error);
+
+         void StopWorker(Worker& worker);
+
+         //Returns false when the worker has crashed or broke the protocol
+         bool RunTask(Worker& worker, const Task& task, CookResult& result);
+
+         void Finish(const Task& task, CookResult&& result);
+
+         void RunWorkerThread(Worker& worker);
+      public:
+         //Workers are started right away
+         CookWorkerPool(const CookWorkerParams& params);
+
+         //Queued jobs are finished before the workers quit
+         ~CookWorkerPool();
+
+         CookWorkerPool(const CookWorkerPool&) = delete;
+         CookWorkerPool& operator = (const CookWorkerPool&) = delete;
+
+         void Submit(const CookJob& job, CookCallback callback, uintptr_t args);
+
+         CookWorkerStats GetStats();
+
+         inline size_t GetWorkersCount() const
+         {
+            return Workers.size();
+         }
+      };
+   }
+}
@@ -0,0 +1,448 @@
+#include "derived-cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#include "utils/io-file.h"
+#include "debug/globals.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      constexpr uint64_t KeyPrime1 = 0x9E3779B185EBCA87ull;
+      constexpr uint64_t KeyPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+      //Temporary files older than this are left by the crashed writers
+      constexpr auto StaleTempAge = std::chrono::hours(1);
+
+      constexpr const char* EntryExtension = ".ddc";
+      constexpr const char* TempExtension = ".tmp";
+
+      static inline uint64_t Rotl(const uint64_t value, const uint32_t shift)
+      {
+         return (value << shift) | (value >> (64 - shift));
+      }
+
+      //Finalizer of the MurmurHash3, every input bit affects every output bit
+      static inline uint64_t MixBits(uint64_t value)
+      {
+         value ^= value >> 33;
+         value *= 0xFF51AFD7ED558CCDull;
+         value ^= value >> 33;
+         value *= 0xC4CEB9FE1A85EC53ull;
+         value ^= value >> 33;
+
+         return value;
+      }
+
+      //Lanes mix the words differently, so together they give the 128 bits of the key
+      static inline void MixWord(uint64_t& high, uint64_t& low, const uint64_t word)
+      {
+         high = Rotl(high ^ (word * KeyPrime2), 31) * KeyPrime1;
+         low = Rotl(low ^ MixBits(word), 27) * 5 + 0x52DCE729;
+      }
+
+      static bool ParseKey(const std::string& str, DerivedKey& key)
+      {
+         if (str.size() != 32)
+            return false;
+
+         uint64_t parts[2] = { 0, 0 };
+
+         for (size_t i = 0; i < str.size(); ++i)
+         {
+            const char c = str[i];
+            uint64_t digit;
+
+            if (c >= '0' && c <= '9')
+               digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+               digit = c - 'a' + 10;
+            else
+               return false;
+
+            parts[i / 16] = (parts[i / 16] << 4) | digit;
+         }
+
+         key = { parts[0], parts[1] };
+
+         return true;
+      }
+
+      std::string DerivedKey::ToString() const
+      {
+         char str[33];
+         snprintf(str, sizeof(str), "%016llx%016llx", static_cast<unsigned long long>(High), static_cast<unsigned long long>(Low));
+
+         return str;
+      }
+
+      DerivedKeyBuilder::DerivedKeyBuilder()
+         : High(KeyPrime1), Low(KeyPrime2) {}
+
+      void DerivedKeyBuilder::Add(const void* data, size_t size)
+      {
+         const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+         Length += size;
+
+         //Bytes of the previous part go first, so the words don't depend on how the input is split
+         for (; TailSize && size; ++bytes, --size)
+         {
+            Tail |= static_cast<uint64_t>(*bytes) << (TailSize * 8);
+
+            if (++TailSize == 8)
+            {
+               MixWord(High, Low, Tail);
+
+               Tail = 0;
+               TailSize = 0;
+            }
+         }
+
+         for (; size >= 8; bytes += 8, size -= 8)
+         {
+            uint64_t word;
+            memcpy(&word, bytes, sizeof(word));
+
+            MixWord(High, Low, word);
+         }
+
+         for (; size; ++bytes, --size)
+            Tail |= static_cast<uint64_t>(*bytes) << (TailSize++ * 8);
+      }
+
+      void DerivedKeyBuilder::Add(const std::string_view& str)
+      {
+         const uint64_t size = str.size();
+
+         Add(&size, sizeof(size));
+         Add(str.data(), str.size());
+      }
+
+      DerivedKey DerivedKeyBuilder::Finish() const
+      {
+         uint64_t high = High;
+         uint64_t low = Low;
+
+         //Length tells apart the inputs that differ only by the trailing zeros
+         MixWord(high, low, Tail);
+         MixWord(high, low, Length);
+
+         high = MixBits(high + low);
+         low = MixBits(low + high);
+
+         return { high, low };
+      }
+
+      static uint64_t HashPayload(const uint8_t* payload, const size_t size)
+      {
+         DerivedKeyBuilder builder;
+         builder.Add(payload, size);
+
+         return builder.Finish().Low;
+      }
+
+      std::filesystem::path DerivedCache::GetEntryPath(const DerivedKey& key) const
+      {
+         const std::string name = key.ToString();
+
+         //Entries are spread by the first byte, so the single directory doesn't get too big
+         return Directory / name.substr(0, 2) / (name + EntryExtension);
+      }
+
+      bool DerivedCache::Open(const std::string_view& directory, const uint64_t maxSize)
+      {
+         const std::filesystem::path path(directory);
+
+         std::error_code error;
+         std::filesystem::create_directories(path, error);
+
+         if (error)
+         {
+            LOG_ERROR("Couldn't create derived cache directory: %s (%s)", path.string().c_str(), error.message().c_str());
+            return false;
+         }
+
+         const auto now = std::filesystem::file_time_type::clock::now();
+
+         std::lock_guard<std::mutex> l(Mutex);
+
+         Entries.clear();
+         Stats.TotalSize = 0;
+
+         for (auto it = std::filesystem::recursive_directory_iterator(path, error);
+              !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+         {
+            if (!it->is_regular_file(error))
+               continue;
+
+            const std::filesystem::path& file = it->path();
+            const auto lastWrite = it->last_write_time(error);
+
+            if (error)
+               continue;
+
+            if (file.extension() == TempExtension)
+            {
+               if (now - lastWrite > StaleTempAge)
+                  std::filesystem::remove(file, error);
+
+               continue;
+            }
+
+            DerivedKey key;
+            if (file.extension() != EntryExtension || !ParseKey(file.stem().string(), key))
+               continue;
+
+            const uint64_t size = it->file_size(error);
+            if (error)
+               continue;
+
+            Entries[key] = { size, lastWrite };
+            Stats.TotalSize += size;
+         }
+
+         if (error)
+         {
+            LOG_ERROR("Couldn't index derived cache: %s (%s)", path.string().c_str(), error.message().c_str());
+
+            Entries.clear();
+            Stats.TotalSize = 0;
+
+            return false;
+         }
+
+         Directory = path;
+         MaxSize = maxSize;
+
+         //Budget could be lowered since the last run
+         for (auto& key : CollectEvicted())
+            std::filesystem::remove(GetEntryPath(key), error);
+
+         return true;
+      }
+
+      void DerivedCache::Touch(const DerivedKey& key, const std::filesystem::path& path)
+      {
+         const auto now = std::filesystem::file_time_type::clock::now();
+
+         std::error_code error;
+         std::filesystem::last_write_time(path, now, error);
+
+         std::lock_guard<std::mutex> l(Mutex);
+
+         auto entry = Entries.find(key);
+         if (entry != Entries.end())
+            entry->second.LastUse = now;
+      }
+
+      void DerivedCache::Remove(const DerivedKey& key, const std::filesystem::path& path)
+      {
+         std::error_code error;
+         std::filesystem::remove(path, error);
+
+         std::lock_guard<std::mutex> l(Mutex);
+
+         auto entry = Entries.find(key);
+         if (entry != Entries.end())
+         {
+            Stats.TotalSize -= entry->second.Size;
+            Entries.erase(key);
+         }
+      }
+
+      std::vector<DerivedKey> DerivedCache::CollectEvicted()
+      {
+         std::vector<DerivedKey> evicted;
+
+         if (Stats.TotalSize <= MaxSize)
+            return evicted;
+
+         std::vector<std::pair<std::filesystem::file_time_type, DerivedKey>> order;
+         order.reserve(Entries.size());
+
+         for (auto& entry : Entries)
+            order.push_back({ entry.second.LastUse, entry.first });
+
+         std::sort(order.begin(), order.end(), [](const auto& l, const auto& r) { return l.first < r.first; });
+
+         //Pruned below the limit, so the next few writes don't prune again
+         const uint64_t target = static_cast<uint64_t>(MaxSize * PruneRatio);
+
+         for (auto& item : order)
+         {
+            if (Stats.TotalSize <= target)
+               break;
+
+            Stats.TotalSize -= Entries.at(item.second).Size;
+            Entries.erase(item.second);
+
+            ++Stats.Evictions;
+            evicted.push_back(item.second);
+         }
+
+         return evicted;
+      }
+
+      //Entry is looked up by its file, so the entries written by the other processes after the Open are found too
+      bool DerivedCache::Get(const DerivedKey& key, std::vector<uint8_t>& payload)
+      {
+         if (!IsOpen())
+            return false;
+
+         const std::filesystem::path path = GetEntryPath(key);
+
+         uint64_t fileSize;
+         std::string openError;
+
+         const utils::IoFile file = utils::OpenIoFile(path.string(), fileSize, openError);
+         if (file == utils::InvalidIoFile)
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+            ++Stats.Misses;
+
+            return false;
+         }
+
+         DerivedEntryHeader header = {};
+         bool isValid = fileSize >= sizeof(header)
+                        && utils::ReadIoFile(file, 0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header)
+                        && header.Magic == DerivedMagic && header.Version == DerivedVersion && header.Key == key
+                        && header.PayloadSize == fileSize - sizeof(header);
+
+         if (isValid)
+         {
+            payload.resize(static_cast<size_t>(header.PayloadSize));
+
+            uint64_t offset = 0;
+            while (isValid && offset < header.PayloadSize)
+            {
+               const int64_t read = utils::ReadIoFile(file, sizeof(header) + offset, payload.data() + offset,
+                                                      static_cast<size_t>(header.PayloadSize - offset));
+               isValid = read > 0;
+               offset += isValid ? read : 0;
+            }
+
+            isValid = isValid && HashPayload(payload.data(), payload.size()) == header.PayloadHash;
+         }
+
+         utils::CloseIoFile(file);
+
+         if (!isValid)
+         {
+            LOG_WARNING("Damaged derived cache entry is removed: %s", path.string().c_str());
+
+            Remove(key, path);
+            payload.clear();
+
+            std::lock_guard<std::mutex> l(Mutex);
+            ++Stats.Corrupted;
+            ++Stats.Misses;
+
+            return false;
+         }
+
+         Touch(key, path);
+
+         std::lock_guard<std::mutex> l(Mutex);
+
+         if (!Entries.contains(key))
+         {
+            Entries[key] = { fileSize, std::filesystem::file_time_type::clock::now() };
+            Stats.TotalSize += fileSize;
+         }
+
+         ++Stats.Hits;
+         Stats.BytesRead += fileSize;
+
+         return true;
+      }
+
+      bool DerivedCache::Put(const DerivedKey& key, const uint8_t* payload, const size_t size)
+      {
+         if (!IsOpen())
+            return false;
+
+         const std::filesystem::path path = GetEntryPath(key);
+
+         std::error_code error;
+         std::filesystem::create_directories(path.parent_path(), error);
+
+         uint64_t tempId;
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+            tempId = ++TempCounter;
+         }
+
+         //Name is unique across the processes too, the time tells apart the processes with the same counter
+         std::filesystem::path tempPath = path;
+         tempPath += "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-"
+                     + std::to_string(tempId) + TempExtension;
+
+         const DerivedEntryHeader header = { DerivedMagic, DerivedVersion, key, size, HashPayload(payload, size) };
+
+         FILE* file = fopen(tempPath.string().c_str(), "wb");
+         if (!file)
+         {
+            LOG_WARNING("Couldn't write derived cache entry: %s", tempPath.string().c_str());
+            return false;
+         }
+
+         bool isWritten = fwrite(&header, sizeof(header), 1, file) == 1
+                          && (!size || fwrite(payload, 1, size, file) == size);
+
+         isWritten = fclose(file) == 0 && isWritten;
+
+         //Rename replaces the entry of the concurrent writer, it has the same payload
+         if (isWritten)
+            std::filesystem::rename(tempPath, path, error);
+
+         if (!isWritten || error)
+         {
+            LOG_WARNING("Couldn't write derived cache entry: %s", path.string().c_str());
+
+            std::filesystem::remove(tempPath, error);
+            return false;
+         }
+
+         const uint64_t fileSize = sizeof(header) + size;
+
+         std::vector<DerivedKey> evicted;
+
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+
+            auto entry = Entries.find(key);
+            if (entry != Entries.end())
+               Stats.TotalSize -= entry->second.Size;
+
+            Entries[key] = { fileSize, std::filesystem::file_time_type::clock::now() };
+            Stats.TotalSize += fileSize;
+
+            ++Stats.Writes;
+            Stats.BytesWritten += fileSize;
+
+            evicted = CollectEvicted();
+         }
+
+         for (auto& evictedKey : evicted)
+            std::filesystem::remove(GetEntryPath(evictedKey), error);
+
+         return true;
+      }
+
+      DerivedCacheStats DerivedCache::GetStats()
+      {
+         std::lock_guard<std::mutex> l(Mutex);
+
+         DerivedCacheStats stats = Stats;
+         stats.EntriesCount = Entries.size();
+
+         return stats;
+      }
+   }
+}
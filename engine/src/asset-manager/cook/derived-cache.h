@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <filesystem>
+
+#include "utils/flat-hash-map.h"
+
+//Layout of the cache entry file, <directory>/<first 2 key digits>/<32 key digits>.ddc:
+//   DerivedEntryHeader
+//   Payload, the cooked asset in the format of its cooker
+
+namespace assets
+{
+   namespace cook
+   {
+      struct DerivedKey
+      {
+         uint64_t High;
+         uint64_t Low;
+
+         inline bool operator==(const DerivedKey& other) const
+         {
+            return High == other.High && Low == other.Low;
+         }
+
+         inline bool operator!=(const DerivedKey& other) const
+         {
+            return !(*this == other);
+         }
+
+         //32 hex digits, it is the name of the entry file
+         std::string ToString() const;
+      };
+
+      //128 bit hash of everything the cooked result depends on: the source bytes, the cook params and the cooker version
+      //Result is the same for every compiler and platform, so the cache can be shared between the machines
+      //Input can be added by the parts of any size, the key doesn't depend on how it is split
+      class DerivedKeyBuilder
+      {
+      private:
+         uint64_t High;
+         uint64_t Low;
+
+         uint64_t Tail = 0; //Bytes that don't fill the whole word yet
+         uint32_t TailSize = 0;
+         uint64_t Length = 0;
+      public:
+         DerivedKeyBuilder();
+
+         void Add(const void* data, const size_t size);
+
+         //Strings are prefixed by the size, so the neighbouring ones can't be confused
+         void Add(const std::string_view& str);
+
+         inline void Add(const uint32_t value)
+         {
+            Add(&value, sizeof(value));
+         }
+
+         DerivedKey Finish() const;
+      };
+
+      inline constexpr uint32_t DerivedMagic = 0x43444452; //"RDDC"
+      inline constexpr uint32_t DerivedVersion = 1;
+
+      struct DerivedEntryHeader
+      {
+         uint32_t Magic;
+         uint32_t Version;
+
+         DerivedKey Key;
+
+         uint64_t PayloadSize;
+         uint64_t PayloadHash; //Damaged or truncated entries are dropped by it
+      };
+
+      static_assert(sizeof(DerivedEntryHeader) == 40, "Derived cache entry layout is changed");
+
+      struct DerivedCacheStats
+      {
+         size_t Hits;
+         size_t Misses;
+         size_t Writes;
+         size_t Evictions;
+         size_t Corrupted;    //Entries that failed the validation, they are removed and count as the misses
+
+         uint64_t BytesRead;
+         uint64_t BytesWritten;
+
+         uint64_t TotalSize;  //Current size of the entries on the disk
+         size_t EntriesCount;
+      };
+
+      //Local content addressed cache of the cooked assets, so every unique input is cooked once across the runs
+      //
+      //Entry is written into the temporary file and renamed into place, so the readers, other processes too, see either
+      //the whole entry or none. Same key always means the same payload, so the concurrent writers of it don't conflict
+      //
+      //Size is bounded by the maxSize: when it is exceeded the least recently used entries are removed down to the
+      //PruneRatio of it. Use time is the modification time of the entry file, so the order survives the restarts
+      //
+      //Methods are thread safe, the file IO is done outside of the lock
+      class DerivedCache
+      {
+      private:
+         struct EntryInfo
+         {
+            uint64_t Size;
+            std::filesystem::file_time_type LastUse;
+         };
+
+         struct KeyHasher
+         {
+            inline size_t operator()(const DerivedKey& key) const
+            {
+               return static_cast<size_t>(key.Low);
+            }
+         };
+
+         std::filesystem::path Directory;
+         uint64_t MaxSize = 0;
+
+         std::mutex Mutex;
+
+         utils::FlatHashMap<DerivedKey, EntryInfo, KeyHasher> Entries;
+         DerivedCacheStats Stats = {};
+
+         uint64_t TempCounter = 0;
+
+         std::filesystem::path GetEntryPath(const DerivedKey& key) const;
+
+         void Touch(const DerivedKey& key, const std::filesystem::path& path);
+
+         void Remove(const DerivedKey& key, const std::filesystem::path& path);
+
+         //Called under the lock, returns the entries to remove from the disk
+         std::vector<DerivedKey> CollectEvicted();
+      public:
+         static constexpr float PruneRatio = 0.9f;
+
+         //Creates the directory when it is missing and indexes the entries that are already there
+         //Temporary files left by the crashed writers are removed
+         bool Open(const std::string_view& directory, const uint64_t maxSize);
+
+         inline bool IsOpen() const
+         {
+            return !Directory.empty();
+         }
+
+         //Payload of the valid entry, the damaged one is removed
+         bool Get(const DerivedKey& key, std::vector<uint8_t>& payload);
+
+         //Returns false when the entry couldn't be written, the cache stays consistent then
+         bool Put(const DerivedKey& key, const uint8_t* payload, const size_t size);
+
+         DerivedCacheStats GetStats();
+      };
+   }
+}
@@ -0,0 +1,267 @@
+#include "mesh-optimize.h"
+
+#include <cmath>
+#include <cfloat>
+#include <numeric>
+#include <algorithm>
+
+namespace assets
+{
+   namespace cook
+   {
+      //Scores of Forsyth's "Linear-Speed Vertex Cache Optimisation"
+      constexpr size_t ForsythCacheSize = 32;
+      constexpr float CacheDecayPower = 1.5f;
+      constexpr float LastTriangleScore = 0.75f;
+      constexpr float ValenceBoostScale = 2.0f;
+      constexpr float ValenceBoostPower = 0.5f;
+
+      static float GetVertexScore(const int32_t cachePosition, const uint32_t liveTriangles)
+      {
+         //Vertex without the triangles left never adds to the score
+         if (liveTriangles == 0)
+            return -1.0f;
+
+         float score = 0.0f;
+
+         //Vertices of the last triangle get the fixed score, so the next triangle doesn't strongly prefer any of its edges
+         if (cachePosition >= 0)
+         {
+            if (cachePosition < 3)
+               score = LastTriangleScore;
+            else
+               score = powf(1.0f - static_cast<float>(cachePosition - 3) / (ForsythCacheSize - 3), CacheDecayPower);
+         }
+
+         //Vertices with the few triangles left go first, so they leave the cache without the lone triangles behind
+         return score + ValenceBoostScale * powf(static_cast<float>(liveTriangles), -ValenceBoostPower);
+      }
+
+      VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indicesCount, const size_t verticesCount,
+                                          const size_t cacheSize)
+      {
+         //Vertex is in the FIFO cache while less than cacheSize other vertices were added after it
+         std::vector<size_t> timestamps(verticesCount, 0);
+         size_t time = cacheSize + 1;
+         size_t misses = 0;
+
+         for (size_t i = 0; i < indicesCount; ++i)
+         {
+            const uint32_t vertex = indices[i];
+
+            if (time - timestamps[vertex] > cacheSize)
+            {
+               timestamps[vertex] = time++;
+               ++misses;
+            }
+         }
+
+         VertexCacheStats stats;
+         stats.Acmr = indicesCount > 0 ? static_cast<float>(misses) / (indicesCount / 3) : 0.0f;
+         stats.Atvr = verticesCount > 0 ? static_cast<float>(misses) / verticesCount : 0.0f;
+
+         return stats;
+      }
+
+      void OptimizeVertexCache(const uint32_t* indices, const size_t indicesCount, uint32_t* resIndices)
+      {
+         const size_t trianglesCount = indicesCount / 3;
+
+         if (trianglesCount == 0)
+            return;
+
+         //Vertices are numbered locally, so the meshlet of the big mesh doesn't pay for all of the mesh vertices
+         std::vector<uint32_t> vertices(indices, indices + trianglesCount * 3);
+         std::sort(vertices.begin(), vertices.end());
+         vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+         const size_t verticesCount = vertices.size();
+
+         std::vector<uint32_t> localIndices(trianglesCount * 3);
+         for (size_t i = 0; i < localIndices.size(); ++i)
+            localIndices[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+
+         //Triangles of every vertex, the first liveCounts of them aren't emitted yet
+         std::vector<uint32_t> adjacencyOffsets(verticesCount + 1, 0);
+         std::vector<uint32_t> adjacency(localIndices.size());
+
+         for (uint32_t vertex : localIndices)
+            ++adjacencyOffsets[vertex + 1];
+
+         for (size_t i = 1; i <= verticesCount; ++i)
+            adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+         std::vector<uint32_t> liveCounts(verticesCount, 0);
+
+         for (size_t i = 0; i < localIndices.size(); ++i)
+         {
+            const uint32_t vertex = localIndices[i];
+            adjacency[adjacencyOffsets[vertex] + liveCounts[vertex]++] = static_cast<uint32_t>(i / 3);
+         }
+
+         std::vector<int32_t> cachePositions(verticesCount, -1);
+         std::vector<float> vertexScores(verticesCount);
+
+         for (size_t i = 0; i < verticesCount; ++i)
+            vertexScores[i] = GetVertexScore(-1, liveCounts[i]);
+
+         std::vector<uint8_t> isEmitted(trianglesCount, 0);
+
+         //Cache is kept 3 entries longer, so the vertices pushed out by the triangle get their scores updated
+         std::vector<uint32_t> cache;
+         std::vector<uint32_t> newCache;
+         cache.reserve(ForsythCacheSize + 3);
+         newCache.reserve(ForsythCacheSize + 3);
+
+         std::vector<uint32_t> result;
+         result.reserve(localIndices.size());
+
+         uint32_t best = UINT32_MAX;
+         size_t cursor = 0;
+
+         for (size_t emitted = 0; emitted < trianglesCount; ++emitted)
+         {
+            //Nothing in the cache has the triangles left, the next one in the source order starts again
+            if (best == UINT32_MAX)
+            {
+               while (isEmitted[cursor])
+                  ++cursor;
+
+               best = static_cast<uint32_t>(cursor);
+            }
+
+            isEmitted[best] = 1;
+
+            newCache.clear();
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+               const uint32_t vertex = localIndices[best * 3 + c];
+               result.push_back(vertex);
+
+               //Triangle is moved out of the live part of the vertex triangles
+               uint32_t* live = adjacency.data() + adjacencyOffsets[vertex];
+               std::swap(*std::find(live, live + liveCounts[vertex], best), live[liveCounts[vertex] - 1]);
+               --liveCounts[vertex];
+
+               if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+                  newCache.push_back(vertex);
+            }
+
+            //Rest of the cache moves back behind the triangle vertices
+            const size_t triangleVertices = newCache.size();
+
+            for (uint32_t vertex : cache)
+            {
+               if (std::find(newCache.begin(), newCache.begin() + triangleVertices, vertex) == newCache.begin() + triangleVertices)
+                  newCache.push_back(vertex);
+            }
+
+            for (size_t i = 0; i < newCache.size(); ++i)
+            {
+               const uint32_t vertex = newCache[i];
+
+               cachePositions[vertex] = i < ForsythCacheSize ? static_cast<int32_t>(i) : -1;
+               vertexScores[vertex] = GetVertexScore(cachePositions[vertex], liveCounts[vertex]);
+            }
+
+            //Only the triangles around the cache changed their scores, so the best one is searched only among them
+            best = UINT32_MAX;
+            float bestScore = -FLT_MAX;
+
+            for (uint32_t vertex : newCache)
+            {
+               const uint32_t* live = adjacency.data() + adjacencyOffsets[vertex];
+
+               for (uint32_t i = 0; i < liveCounts[vertex]; ++i)
+               {
+                  const uint32_t triangle = live[i];
+
+                  const float score = vertexScores[localIndices[triangle * 3]] + vertexScores[localIndices[triangle * 3 + 1]]
+                                    + vertexScores[localIndices[triangle * 3 + 2]];
+
+                  if (cachePositions[vertex] >= 0 && score > bestScore)
+                  {
+                     best = triangle;
+                     bestScore = score;
+                  }
+               }
+            }
+
+            newCache.resize(std::min(newCache.size(), ForsythCacheSize));
+            std::swap(cache, newCache);
+         }
+
+         for (size_t i = 0; i < result.size(); ++i)
+            resIndices[i] = vertices[result[i]];
+      }
+
+      void OptimizeOverdraw(const mm::vec3* positions, std::vector<uint32_t>& indices, std::vector<Meshlet>& meshlets)
+      {
+         //Center of the surface, the triangles are weighted by their areas so the dense parts don't pull it
+         mm::vec3 center(0.0f);
+         float area = 0.0f;
+
+         for (size_t i = 0; i + 2 < indices.size(); i += 3)
+         {
+            const mm::vec3& p0 = positions[indices[i]];
+            const mm::vec3& p1 = positions[indices[i + 1]];
+            const mm::vec3& p2 = positions[indices[i + 2]];
+
+            const float triangleArea = mm::length(mm::cross(p1 - p0, p2 - p0));
+
+            center = center + (p0 + p1 + p2) * (triangleArea / 3.0f);
+            area += triangleArea;
+         }
+
+         if (area > 0.0f)
+            center = center / area;
+
+         //Meshlets that face away from the center are on the outside of the mesh, they occlude the others the most
+         std::vector<float> keys(meshlets.size());
+         for (size_t i = 0; i < meshlets.size(); ++i)
+            keys[i] = mm::dot(meshlets[i].Center - center, meshlets[i].ConeAxis);
+
+         std::vector<uint32_t> order(meshlets.size());
+         std::iota(order.begin(), order.end(), 0);
+         std::stable_sort(order.begin(), order.end(), [&keys](const uint32_t left, const uint32_t right) { return keys[left] > keys[right]; });
+
+         std::vector<uint32_t> resIndices;
+         std::vector<Meshlet> resMeshlets;
+
+         resIndices.reserve(indices.size());
+         resMeshlets.reserve(meshlets.size());
+
+         for (uint32_t i : order)
+         {
+            Meshlet meshlet = meshlets[i];
+
+            resIndices.insert(resIndices.end(), indices.begin() + meshlet.FirstIndex, indices.begin() + meshlet.FirstIndex + meshlet.IndicesCount);
+
+            meshlet.FirstIndex = static_cast<uint32_t>(resIndices.size() - meshlet.IndicesCount);
+            resMeshlets.push_back(meshlet);
+         }
+
+         indices = std::move(resIndices);
+         meshlets = std::move(resMeshlets);
+      }
+
+      void OptimizeVertexFetch(std::vector<uint32_t>& indices, const size_t verticesCount, std::vector<uint32_t>& resVertices)
+      {
+         std::vector<uint32_t> remap(verticesCount, UINT32_MAX);
+
+         resVertices.clear();
+
+         for (auto& index : indices)
+         {
+            if (remap[index] == UINT32_MAX)
+            {
+               remap[index] = static_cast<uint32_t>(resVertices.size());
+               resVertices.push_back(index);
+            }
+
+            index = remap[index];
+         }
+      }
+   }
+}
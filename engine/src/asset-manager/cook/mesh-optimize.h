@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "math/math.h"
+#include "meshlets.h"
+
+//Ordering of the indexed triangle meshes for the GPU
+//
+//Vertex cache order reuses the transformed vertices of the recent triangles, so less vertices are shaded per triangle
+//Overdraw order draws the outer parts of the mesh first, so the inner ones fail the depth test before the shading
+//Vertex fetch order puts the vertices into memory in the order they are used, so the vertex fetch reads the memory linearly
+
+namespace assets
+{
+   namespace cook
+   {
+      //Size of the simulated cache by the optimizer and the analysis, the common post-transform caches are 16-32 entries
+      constexpr size_t VertexCacheSize = 16;
+
+      struct VertexCacheStats
+      {
+         //Average cache miss ratio, transformed vertices per triangle, 0.5 at best for the big regular grids and 3 at worst
+         float Acmr;
+
+         //Average transform to vertex ratio, transformed vertices per vertex of the mesh, 1 at best
+         float Atvr;
+      };
+
+      //Simulates the FIFO cache of the cacheSize entries over the indices
+      VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indicesCount, const size_t verticesCount,
+                                          const size_t cacheSize = VertexCacheSize);
+
+      //Forsyth's greedy ordering, the triangle of the best vertices score is emitted next
+      //Vertex score grows with its position in the simulated LRU cache and with the less triangles left to emit
+      //Result can be the same memory as the indices
+      void OptimizeVertexCache(const uint32_t* indices, const size_t indicesCount, uint32_t* resIndices);
+
+      //Meshlets are the clusters of the overdraw order, the ones that face away from the mesh center go first
+      //Triangles inside of the meshlet keep their order, so the vertex cache order of the meshlet stays
+      //Indices and the meshlet ranges are rewritten in the new order
+      void OptimizeOverdraw(const mm::vec3* positions, std::vector<uint32_t>& indices, std::vector<Meshlet>& meshlets);
+
+      //Renumbers the vertices in the order of their first use in the indices
+      //resVertices has the source vertex for every new one, the vertices that aren't used are dropped
+      void OptimizeVertexFetch(std::vector<uint32_t>& indices, const size_t verticesCount, std::vector<uint32_t>& resVertices);
+   }
+}
@@ -0,0 +1,578 @@
+#include "mesh-simplify.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include "utils/flat-hash-map.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      //Border moves change the silhouette, so they cost more than the same moves inside of the surface
+      constexpr double BorderWeight = 10.0;
+      constexpr double SeamWeight = 1.0;
+
+      //Collapse is rejected when it turns any triangle more than by ~75 degrees
+      constexpr double MinFlipCos = 0.25;
+
+      //Costs are the squared distances, so the pass goes up to 1.5 times the distance of its goal collapse
+      constexpr double PassCostFactor = 1.5 * 1.5;
+
+      //Symmetric 4x4 matrix of the sum of the squared plane distances, only the upper half is stored
+      struct Quadric
+      {
+         double A00, A01, A02, A11, A12, A22;
+         double B0, B1, B2;
+         double C;
+
+         double Weight;
+      };
+
+      struct Collapse
+      {
+         uint32_t From;
+         uint32_t To;
+         double Cost;
+      };
+
+      struct Vec3d
+      {
+         double X, Y, Z;
+      };
+
+      static inline Vec3d ToDouble(const mm::vec3& v)
+      {
+         return { v.x, v.y, v.z };
+      }
+
+      static inline Vec3d Sub(const Vec3d& a, const Vec3d& b)
+      {
+         return { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+      }
+
+      static inline Vec3d Cross(const Vec3d& a, const Vec3d& b)
+      {
+         return { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+      }
+
+      static inline double Dot(const Vec3d& a, const Vec3d& b)
+      {
+         return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+      }
+
+      static inline double Length(const Vec3d& v)
+      {
+         return sqrt(Dot(v, v));
+      }
+
+      //Plane goes through the point, the normal must be of the unit length
+      static void AddPlane(Quadric& q, const Vec3d& normal, const Vec3d& point, const double weight)
+      {
+         const double d = -Dot(normal, point);
+
+         q.A00 += weight * normal.X * normal.X;
+         q.A01 += weight * normal.X * normal.Y;
+         q.A02 += weight * normal.X * normal.Z;
+         q.A11 += weight * normal.Y * normal.Y;
+         q.A12 += weight * normal.Y * normal.Z;
+         q.A22 += weight * normal.Z * normal.Z;
+
+         q.B0 += weight * normal.X * d;
+         q.B1 += weight * normal.Y * d;
+         q.B2 += weight * normal.Z * d;
+
+         q.C += weight * d * d;
+
+         q.Weight += weight;
+      }
+
+      static void AddQuadric(Quadric& q, const Quadric& other)
+      {
+         q.A00 += other.A00;
+         q.A01 += other.A01;
+         q.A02 += other.A02;
+         q.A11 += other.A11;
+         q.A12 += other.A12;
+         q.A22 += other.A22;
+
+         q.B0 += other.B0;
+         q.B1 += other.B1;
+         q.B2 += other.B2;
+
+         q.C += other.C;
+
+         q.Weight += other.Weight;
+      }
+
+      //Weighted mean of the squared distances from the point to the planes of the quadric
+      static double Evaluate(const Quadric& q, const Vec3d& p)
+      {
+         const double r = q.A00 * p.X * p.X + q.A11 * p.Y * p.Y + q.A22 * p.Z * p.Z
+                        + 2.0 * (q.A01 * p.X * p.Y + q.A02 * p.X * p.Z + q.A12 * p.Y * p.Z)
+                        + 2.0 * (q.B0 * p.X + q.B1 * p.Y + q.B2 * p.Z)
+                        + q.C;
+
+         return q.Weight > 0.0 ? std::max(r, 0.0) / q.Weight : 0.0;
+      }
+
+      static inline uint64_t EdgeKey(const uint32_t a, const uint32_t b)
+      {
+         return (static_cast<uint64_t>(a) << 32) | b;
+      }
+
+      void WeldVertices(const std::vector<const void*>& streams, const std::vector<size_t>& elementSizes, const size_t verticesCount,
+                        std::vector<uint32_t>& resIndices, std::vector<uint32_t>& resUnique)
+      {
+         auto compare = [&](const uint32_t a, const uint32_t b)
+            {
+               for (size_t s = 0; s < streams.size(); ++s)
+               {
+                  const uint8_t* data = static_cast<const uint8_t*>(streams[s]);
+
+                  const int res = memcmp(data + a * elementSizes[s], data + b * elementSizes[s], elementSizes[s]);
+                  if (res != 0)
+                     return res;
+               }
+
+               return 0;
+            };
+
+         std::vector<uint32_t> order(verticesCount);
+         std::iota(order.begin(), order.end(), 0);
+
+         //Stable sort keeps the first soup vertex at the start of every group of the equal ones
+         std::stable_sort(order.begin(), order.end(), [&compare](const uint32_t a, const uint32_t b)
+            {
+               return compare(a, b) < 0;
+            });
+
+         std::vector<uint32_t> first(verticesCount);
+         for (size_t i = 0; i < verticesCount; ++i)
+            first[order[i]] = i > 0 && compare(order[i - 1], order[i]) == 0 ? first[order[i - 1]] : order[i];
+
+         //Unique vertices go in the order of their first use, so the result stays close to the soup order
+         resIndices.resize(verticesCount);
+         resUnique.clear();
+
+         for (uint32_t v = 0; v < verticesCount; ++v)
+         {
+            if (first[v] == v)
+            {
+               resIndices[v] = static_cast<uint32_t>(resUnique.size());
+               resUnique.push_back(v);
+            }
+            else
+            {
+               resIndices[v] = resIndices[first[v]];
+            }
+         }
+      }
+
+      class Simplifier
+      {
+      private:
+         const mm::vec3* Positions;
+         std::vector<uint32_t>& Indices;
+
+         //Vertices with the equal positions share the position id, the collapses are done between the positions
+         std::vector<uint32_t> PositionIds;
+         std::vector<Quadric> Quadrics;
+
+         //Triangles of every position, rebuilt on every pass
+         std::vector<uint32_t> AdjacencyOffsets;
+         std::vector<uint32_t> Adjacency;
+
+         std::vector<uint32_t> Remap;
+         std::vector<std::pair<uint32_t, uint32_t>> CollapseRemap;
+
+         inline uint32_t GetPosition(const size_t corner) const
+         {
+            return PositionIds[Indices[corner]];
+         }
+
+         void BuildQuadrics();
+         void BuildAdjacency();
+
+         //Finds where the vertices of the from position go, fails on the seams that the edge doesn't follow and on the flips
+         bool CanCollapse(const uint32_t from, const uint32_t to);
+      public:
+         Simplifier(const mm::vec3* positions, const size_t verticesCount, std::vector<uint32_t>& indices);
+
+         float Simplify(const size_t targetIndicesCount, const float maxError);
+      };
+
+      Simplifier::Simplifier(const mm::vec3* positions, const size_t verticesCount, std::vector<uint32_t>& indices)
+         : Positions(positions), Indices(indices)
+      {
+         std::vector<uint32_t> unique;
+         WeldVertices({ positions }, { sizeof(mm::vec3) }, verticesCount, PositionIds, unique);
+
+         Quadrics.resize(unique.size(), Quadric{});
+
+         Remap.resize(verticesCount);
+         std::iota(Remap.begin(), Remap.end(), 0);
+
+         BuildQuadrics();
+      }
+
+      void Simplifier::BuildQuadrics()
+      {
+         //Opposite half edges tell the borders and the seams
+         utils::FlatHashMap<uint64_t, uint32_t> halfEdges;
+         halfEdges.reserve(Indices.size());
+
+         for (size_t i = 0; i < Indices.size(); ++i)
+         {
+            const size_t next = i - i % 3 + (i + 1) % 3;
+            halfEdges.try_emplace(EdgeKey(GetPosition(i), GetPosition(next)), static_cast<uint32_t>(i));
+         }
+
+         for (size_t t = 0; t < Indices.size(); t += 3)
+         {
+            const Vec3d p[3] = { ToDouble(Positions[Indices[t]]), ToDouble(Positions[Indices[t + 1]]), ToDouble(Positions[Indices[t + 2]]) };
+
+            const Vec3d normal = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+            const double length = Length(normal);
+
+            if (length == 0.0)
+               continue;
+
+            const Vec3d unitNormal = { normal.X / length, normal.Y / length, normal.Z / length };
+
+            for (size_t c = 0; c < 3; ++c)
+               AddPlane(Quadrics[GetPosition(t + c)], unitNormal, p[0], length * 0.5);
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+               const size_t next = t + (c + 1) % 3;
+
+               double weight = 0.0;
+
+               auto opposite = halfEdges.find(EdgeKey(GetPosition(next), GetPosition(t + c)));
+
+               if (opposite == halfEdges.end())
+               {
+                  weight = BorderWeight;
+               }
+               else
+               {
+                  const size_t oppositeNext = opposite->second - opposite->second % 3 + (opposite->second + 1) % 3;
+
+                  if (Indices[opposite->second] != Indices[next] || Indices[oppositeNext] != Indices[t + c])
+                     weight = SeamWeight;
+               }
+
+               if (weight == 0.0)
+                  continue;
+
+               //Plane through the edge that is perpendicular to the triangle keeps the edge from moving sideways
+               const Vec3d edge = Sub(p[(c + 1) % 3], p[c]);
+               const Vec3d edgeNormal = Cross(edge, unitNormal);
+               const double edgeLength = Length(edgeNormal);
+
+               if (edgeLength == 0.0)
+                  continue;
+
+               const Vec3d unitEdgeNormal = { edgeNormal.X / edgeLength, edgeNormal.Y / edgeLength, edgeNormal.Z / edgeLength };
+
+               AddPlane(Quadrics[GetPosition(t + c)], unitEdgeNormal, p[c], weight * edgeLength * edgeLength);
+               AddPlane(Quadrics[GetPosition(next)], unitEdgeNormal, p[c], weight * edgeLength * edgeLength);
+            }
+         }
+      }
+
+      void Simplifier::BuildAdjacency()
+      {
+         AdjacencyOffsets.assign(Quadrics.size() + 1, 0);
+
+         for (size_t i = 0; i < Indices.size(); ++i)
+            ++AdjacencyOffsets[GetPosition(i) + 1];
+
+         for (size_t i = 1; i < AdjacencyOffsets.size(); ++i)
+            AdjacencyOffsets[i] += AdjacencyOffsets[i - 1];
+
+         Adjacency.resize(Indices.size());
+
+         std::vector<uint32_t> fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+
+         for (size_t i = 0; i < Indices.size(); ++i)
+            Adjacency[fill[GetPosition(i)]++] = static_cast<uint32_t>(i / 3);
+      }
+
+      bool Simplifier::CanCollapse(const uint32_t from, const uint32_t to)
+      {
+         CollapseRemap.clear();
+
+         Vec3d toPosition = {};
+         bool isEdge = false;
+
+         //Triangles of the edge tell the vertex of the to position for every vertex of the from one
+         for (uint32_t i = AdjacencyOffsets[from]; i < AdjacencyOffsets[from + 1]; ++i)
+         {
+            const size_t t = Adjacency[i] * 3;
+
+            uint32_t fromVertex = UINT32_MAX;
+            uint32_t toVertex = UINT32_MAX;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+               if (GetPosition(t + c) == from)
+                  fromVertex = Indices[t + c];
+               else if (GetPosition(t + c) == to)
+                  toVertex = Indices[t + c];
+            }
+
+            if (toVertex == UINT32_MAX)
+               continue;
+
+            isEdge = true;
+            toPosition = ToDouble(Positions[toVertex]);
+
+            auto mapped = std::find_if(CollapseRemap.begin(), CollapseRemap.end(), [fromVertex](auto& pair)
+               {
+                  return pair.first == fromVertex;
+               });
+
+            if (mapped == CollapseRemap.end())
+               CollapseRemap.push_back({ fromVertex, toVertex });
+            else if (mapped->second != toVertex)
+               return false;
+         }
+
+         if (!isEdge)
+            return false;
+
+         for (uint32_t i = AdjacencyOffsets[from]; i < AdjacencyOffsets[from + 1]; ++i)
+         {
+            const size_t t = Adjacency[i] * 3;
+
+            size_t fromCorner = 0;
+            bool hasTo = false;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+               if (GetPosition(t + c) == from)
+                  fromCorner = c;
+               else if (GetPosition(t + c) == to)
+                  hasTo = true;
+            }
+
+            //These triangles are removed by the collapse
+            if (hasTo)
+               continue;
+
+            const uint32_t fromVertex = Indices[t + fromCorner];
+
+            //Vertex on the seam that the edge doesn't follow has nowhere to go
+            auto mapped = std::find_if(CollapseRemap.begin(), CollapseRemap.end(), [fromVertex](auto& pair)
+               {
+                  return pair.first == fromVertex;
+               });
+
+            if (mapped == CollapseRemap.end())
+               return false;
+
+            const Vec3d a = ToDouble(Positions[Indices[t + (fromCorner + 1) % 3]]);
+            const Vec3d b = ToDouble(Positions[Indices[t + (fromCorner + 2) % 3]]);
+            const Vec3d p = ToDouble(Positions[fromVertex]);
+
+            const Vec3d before = Cross(Sub(a, p), Sub(b, p));
+            const Vec3d after = Cross(Sub(a, toPosition), Sub(b, toPosition));
+
+            if (Dot(before, after) <= MinFlipCos * Length(before) * Length(after))
+               return false;
+         }
+
+         return true;
+      }
+
+      float Simplifier::Simplify(const size_t targetIndicesCount, const float maxError)
+      {
+         const double maxCost = static_cast<double>(maxError) * maxError;
+
+         double error = 0.0;
+
+         std::vector<uint64_t> edges;
+         std::vector<Collapse> collapses;
+         std::vector<uint8_t> locked;
+
+         while (Indices.size() > targetIndicesCount)
+         {
+            BuildAdjacency();
+
+            edges.clear();
+            for (size_t i = 0; i < Indices.size(); ++i)
+            {
+               const uint32_t a = GetPosition(i);
+               const uint32_t b = GetPosition(i - i % 3 + (i + 1) % 3);
+
+               if (a != b)
+                  edges.push_back(EdgeKey(std::min(a, b), std::max(a, b)));
+            }
+
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            //Vertex of the first triangle of the position, every vertex of the position has the same coordinates
+            auto getPoint = [this](const uint32_t position)
+               {
+                  const uint32_t triangle = Adjacency[AdjacencyOffsets[position]];
+
+                  for (size_t c = 0; c < 3; ++c)
+                  {
+                     if (GetPosition(triangle * 3 + c) == position)
+                        return ToDouble(Positions[Indices[triangle * 3 + c]]);
+                  }
+
+                  return Vec3d{};
+               };
+
+            collapses.clear();
+            for (uint64_t edge : edges)
+            {
+               const uint32_t a = static_cast<uint32_t>(edge >> 32);
+               const uint32_t b = static_cast<uint32_t>(edge);
+
+               Quadric q = Quadrics[a];
+               AddQuadric(q, Quadrics[b]);
+
+               collapses.push_back({ a, b, Evaluate(q, getPoint(b)) });
+               collapses.push_back({ b, a, Evaluate(q, getPoint(a)) });
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right)
+               {
+                  return left.Cost < right.Cost;
+               });
+
+            //Every collapse removes about 2 triangles, many of the cheapest ones are locked by their neighbours, so the pass
+            //goes a bit past the cost of the collapse that would reach the target alone
+            //Without this limit the pass reaches the expensive collapses while the cheap ones wait for the next pass
+            const size_t collapsesGoal = ((Indices.size() - targetIndicesCount) / 3 + 1) / 2;
+            const double passCost = collapsesGoal < collapses.size() ? PassCostFactor * collapses[collapsesGoal].Cost : DBL_MAX;
+
+            //Every position takes part in the single collapse per pass, so the checks see the up to date triangles
+            locked.assign(Quadrics.size(), 0);
+
+            size_t indicesLeft = Indices.size();
+            size_t collapsesCount = 0;
+
+            for (auto& collapse : collapses)
+            {
+               if (indicesLeft <= targetIndicesCount)
+                  break;
+
+               //The rest of the edges is above the error, the locked ones can still be cheap in the next pass
+               if (collapse.Cost > maxCost || collapse.Cost > passCost)
+                  break;
+
+               if (locked[collapse.From] || locked[collapse.To] || !CanCollapse(collapse.From, collapse.To))
+                  continue;
+
+               for (auto& pair : CollapseRemap)
+                  Remap[pair.first] = pair.second;
+
+               AddQuadric(Quadrics[collapse.To], Quadrics[collapse.From]);
+
+               for (uint32_t i = AdjacencyOffsets[collapse.From]; i < AdjacencyOffsets[collapse.From + 1]; ++i)
+               {
+                  const size_t t = Adjacency[i] * 3;
+
+                  bool hasTo = false;
+                  for (size_t c = 0; c < 3; ++c)
+                  {
+                     locked[GetPosition(t + c)] = 1;
+                     hasTo |= GetPosition(t + c) == collapse.To;
+                  }
+
+                  if (hasTo)
+                     indicesLeft -= 3;
+               }
+
+               locked[collapse.To] = 1;
+
+               error = std::max(error, collapse.Cost);
+               ++collapsesCount;
+            }
+
+            if (collapsesCount == 0)
+               break;
+
+            //Triangles of the collapsed edges become degenerate and are removed
+            size_t write = 0;
+            for (size_t t = 0; t < Indices.size(); t += 3)
+            {
+               const uint32_t v0 = Remap[Indices[t]];
+               const uint32_t v1 = Remap[Indices[t + 1]];
+               const uint32_t v2 = Remap[Indices[t + 2]];
+
+               const uint32_t p0 = PositionIds[v0];
+               const uint32_t p1 = PositionIds[v1];
+               const uint32_t p2 = PositionIds[v2];
+
+               if (p0 == p1 || p1 == p2 || p0 == p2)
+                  continue;
+
+               Indices[write++] = v0;
+               Indices[write++] = v1;
+               Indices[write++] = v2;
+            }
+
+            Indices.resize(write);
+
+            std::iota(Remap.begin(), Remap.end(), 0);
+         }
+
+         return static_cast<float>(sqrt(error));
+      }
+
+      float SimplifyMesh(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                         const size_t targetIndicesCount, const float maxError, std::vector<uint32_t>& resIndices)
+      {
+         resIndices = indices;
+
+         if (indices.size() <= targetIndicesCount)
+            return 0.0f;
+
+         Simplifier simplifier(positions, verticesCount, resIndices);
+
+         return simplifier.Simplify(targetIndicesCount, maxError);
+      }
+
+      std::vector<LodLevel> BuildLodChain(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                                          const size_t levelsCount, const float ratio)
+      {
+         //Levels are simplified from the previous ones, so the references must stay valid
+         std::vector<LodLevel> levels;
+         levels.reserve(levelsCount);
+
+         const std::vector<uint32_t>* source = &indices;
+         float error = 0.0f;
+
+         for (size_t i = 0; i < levelsCount; ++i)
+         {
+            const size_t target = static_cast<size_t>(source->size() / 3 * ratio) * 3;
+
+            LodLevel level;
+            const float levelError = SimplifyMesh(positions, verticesCount, *source, target, FLT_MAX, level.Indices);
+
+            //Quadrics start from the previous level, so its error is the distance to the source only together with the previous errors
+            error += levelError;
+            level.Error = error;
+
+            //Less than the 10% of the triangles are gone, the mesh is as simple as it can be
+            if (level.Indices.empty() || level.Indices.size() * 10 > source->size() * 9)
+               break;
+
+            levels.push_back(std::move(level));
+            source = &levels.back().Indices;
+         }
+
+         return levels;
+      }
+   }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "math/math.h"
+
+//Quadric error metric simplification of the indexed triangle meshes
+//
+//Vertices are collapsed into their neighbours along the edges, the cheapest collapses by the quadric error go first
+//Collapse only moves the indices, so no new vertices are made and the attributes of the kept vertices stay valid
+//Vertices that share the position but not the attributes (UV seams) are collapsed together, only along the seam
+//Border and seam edges add the planes that are perpendicular to the surface, so the silhouette and the seams keep their shape
+
+namespace assets
+{
+   namespace cook
+   {
+      struct LodLevel
+      {
+         std::vector<uint32_t> Indices;
+
+         //Distance from the simplified surface to the source one, in the units of the positions
+         float Error;
+      };
+
+      //Maps the equal vertices of the triangle soup onto the single vertex, vertex is compared bitwise by all of its attributes
+      //Streams are the tightly packed attribute arrays with the elements of the elementSizes bytes
+      //Result has the index of the unique vertex for every soup vertex, resUnique is the first soup vertex of every unique one
+      void WeldVertices(const std::vector<const void*>& streams, const std::vector<size_t>& elementSizes, const size_t verticesCount,
+                        std::vector<uint32_t>& resIndices, std::vector<uint32_t>& resUnique);
+
+      //Collapses the edges until the indices are down to the targetIndicesCount or the next collapse is above the maxError
+      //Returns the error of the result, the resIndices reference the same vertices as the source ones
+      float SimplifyMesh(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                         const size_t targetIndicesCount, const float maxError, std::vector<uint32_t>& resIndices);
+
+      //Every level has about the ratio of the triangles of the previous one and is simplified from it, so the errors only grow
+      //The chain stops early when the mesh can't be simplified any further
+      std::vector<LodLevel> BuildLodChain(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                                          const size_t levelsCount, const float ratio = 0.5f);
+   }
+}
@@ -0,0 +1,256 @@
+#include "meshlets.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "mesh-simplify.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      //Sphere around the bounding box and the cone around the mean of the triangle normals
+      static void ComputeBounds(const mm::vec3* positions, const std::vector<uint32_t>& indices, const uint32_t* triangles,
+                                const size_t trianglesCount, Meshlet& meshlet)
+      {
+         mm::vec3 min = positions[indices[triangles[0] * 3]];
+         mm::vec3 max = min;
+
+         for (size_t i = 0; i < trianglesCount; ++i)
+         {
+            for (size_t c = 0; c < 3; ++c)
+            {
+               const mm::vec3& p = positions[indices[triangles[i] * 3 + c]];
+
+               min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z) };
+               max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z) };
+            }
+         }
+
+         meshlet.Center = (min + max) * 0.5f;
+         meshlet.Radius = 0.0f;
+
+         std::vector<mm::vec3> normals;
+         normals.reserve(trianglesCount);
+
+         mm::vec3 axis(0.0f);
+
+         for (size_t i = 0; i < trianglesCount; ++i)
+         {
+            const mm::vec3& p0 = positions[indices[triangles[i] * 3]];
+            const mm::vec3& p1 = positions[indices[triangles[i] * 3 + 1]];
+            const mm::vec3& p2 = positions[indices[triangles[i] * 3 + 2]];
+
+            for (const mm::vec3* p : { &p0, &p1, &p2 })
+               meshlet.Radius = std::max(meshlet.Radius, mm::length(*p - meshlet.Center));
+
+            //Degenerate triangles are never drawn, so they don't limit the cone
+            const mm::vec3 normal = mm::cross(p1 - p0, p2 - p0);
+            const float length = mm::length(normal);
+
+            if (length == 0.0f)
+               continue;
+
+            normals.push_back(normal / length);
+            axis = axis + normals.back();
+         }
+
+         const float axisLength = mm::length(axis);
+
+         meshlet.ConeAxis = axisLength > 0.0f ? axis / axisLength : mm::vec3(0.0f, 0.0f, 1.0f);
+         meshlet.ConeCos = axisLength > 0.0f ? 1.0f : 0.0f;
+
+         for (auto& normal : normals)
+            meshlet.ConeCos = std::min(meshlet.ConeCos, mm::dot(normal, meshlet.ConeAxis));
+
+         //Cone wider than the half space can't be culled
+         meshlet.ConeCos = std::max(meshlet.ConeCos, 0.0f);
+         meshlet.ConeSin = sqrtf(std::max(1.0f - meshlet.ConeCos * meshlet.ConeCos, 0.0f));
+      }
+
+      MeshBounds ComputeMeshBounds(const mm::vec3* positions, const size_t verticesCount)
+      {
+         MeshBounds bounds;
+         bounds.Min = mm::vec3(0.0f);
+         bounds.Max = mm::vec3(0.0f);
+         bounds.Center = mm::vec3(0.0f);
+         bounds.Radius = 0.0f;
+
+         if (verticesCount == 0)
+            return bounds;
+
+         bounds.Min = positions[0];
+         bounds.Max = positions[0];
+
+         for (size_t i = 1; i < verticesCount; ++i)
+         {
+            const mm::vec3& p = positions[i];
+
+            bounds.Min = { std::min(bounds.Min.x, p.x), std::min(bounds.Min.y, p.y), std::min(bounds.Min.z, p.z) };
+            bounds.Max = { std::max(bounds.Max.x, p.x), std::max(bounds.Max.y, p.y), std::max(bounds.Max.z, p.z) };
+         }
+
+         bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+
+         for (size_t i = 0; i < verticesCount; ++i)
+            bounds.Radius = std::max(bounds.Radius, mm::length(positions[i] - bounds.Center));
+
+         return bounds;
+      }
+
+      void BuildMeshlets(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                         std::vector<Meshlet>& resMeshlets, std::vector<uint32_t>& resTriangles,
+                         const size_t maxVertices, const size_t maxTriangles)
+      {
+         const size_t trianglesCount = indices.size() / 3;
+
+         resMeshlets.clear();
+         resTriangles.clear();
+         resTriangles.reserve(trianglesCount);
+
+         //Triangles are connected through the positions, so the UV and normal seams don't split the meshlets
+         std::vector<uint32_t> positionIds;
+         std::vector<uint32_t> unique;
+         WeldVertices({ positions }, { sizeof(mm::vec3) }, verticesCount, positionIds, unique);
+
+         const size_t positionsCount = unique.size();
+
+         //Triangles of every position
+         std::vector<uint32_t> adjacencyOffsets(positionsCount + 1, 0);
+         std::vector<uint32_t> adjacency(trianglesCount * 3);
+
+         for (size_t i = 0; i < trianglesCount * 3; ++i)
+            ++adjacencyOffsets[positionIds[indices[i]] + 1];
+
+         for (size_t i = 1; i <= positionsCount; ++i)
+            adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+         {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for (size_t i = 0; i < trianglesCount * 3; ++i)
+               adjacency[fill[positionIds[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+         }
+
+         //Triangles of the position that aren't in any meshlet yet
+         std::vector<uint32_t> liveCounts(positionsCount);
+         for (size_t i = 0; i < positionsCount; ++i)
+            liveCounts[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+
+         std::vector<uint8_t> isEmitted(trianglesCount, 0);
+         std::vector<uint32_t> vertexMeshlets(verticesCount, UINT32_MAX);
+
+         //Vertices count against the limit, the positions connect the triangles
+         std::vector<uint32_t> meshletVertices;
+         meshletVertices.reserve(maxVertices);
+
+         std::vector<uint32_t> positionMeshlets(positionsCount, UINT32_MAX);
+         std::vector<uint32_t> meshletPositions;
+         meshletPositions.reserve(maxVertices);
+
+         size_t seed = 0;
+
+         while (true)
+         {
+            while (seed < trianglesCount && isEmitted[seed])
+               ++seed;
+
+            if (seed == trianglesCount)
+               break;
+
+            const uint32_t meshletId = static_cast<uint32_t>(resMeshlets.size());
+            const size_t firstTriangle = resTriangles.size();
+
+            meshletVertices.clear();
+            meshletPositions.clear();
+
+            auto getNewVertices = [&](const uint32_t triangle)
+               {
+                  size_t count = 0;
+                  for (size_t c = 0; c < 3; ++c)
+                     count += vertexMeshlets[indices[triangle * 3 + c]] != meshletId;
+
+                  return count;
+               };
+
+            auto emit = [&](const uint32_t triangle)
+               {
+                  isEmitted[triangle] = 1;
+                  resTriangles.push_back(triangle);
+
+                  for (size_t c = 0; c < 3; ++c)
+                  {
+                     const uint32_t vertex = indices[triangle * 3 + c];
+                     const uint32_t position = positionIds[vertex];
+
+                     --liveCounts[position];
+
+                     if (vertexMeshlets[vertex] != meshletId)
+                     {
+                        vertexMeshlets[vertex] = meshletId;
+                        meshletVertices.push_back(vertex);
+                     }
+
+                     if (positionMeshlets[position] != meshletId)
+                     {
+                        positionMeshlets[position] = meshletId;
+                        meshletPositions.push_back(position);
+                     }
+                  }
+               };
+
+            emit(static_cast<uint32_t>(seed));
+
+            while (resTriangles.size() - firstTriangle < maxTriangles)
+            {
+               uint32_t best = UINT32_MAX;
+               size_t bestNewVertices = 4;
+               uint32_t bestLiveCount = UINT32_MAX;
+
+               //Triangles that reuse the vertices go first, then the ones around the positions that are almost done,
+               //so the meshlets don't leave the single triangles behind
+               for (uint32_t position : meshletPositions)
+               {
+                  if (liveCounts[position] == 0)
+                     continue;
+
+                  for (uint32_t i = adjacencyOffsets[position]; i < adjacencyOffsets[position + 1]; ++i)
+                  {
+                     const uint32_t triangle = adjacency[i];
+                     if (isEmitted[triangle])
+                        continue;
+
+                     const size_t newVertices = getNewVertices(triangle);
+                     if (meshletVertices.size() + newVertices > maxVertices)
+                        continue;
+
+                     uint32_t liveCount = UINT32_MAX;
+                     for (size_t c = 0; c < 3; ++c)
+                        liveCount = std::min(liveCount, liveCounts[positionIds[indices[triangle * 3 + c]]]);
+
+                     if (newVertices < bestNewVertices || (newVertices == bestNewVertices && liveCount < bestLiveCount))
+                     {
+                        best = triangle;
+                        bestNewVertices = newVertices;
+                        bestLiveCount = liveCount;
+                     }
+                  }
+               }
+
+               if (best == UINT32_MAX)
+                  break;
+
+               emit(best);
+            }
+
+            Meshlet meshlet;
+            meshlet.FirstIndex = static_cast<uint32_t>(firstTriangle * 3);
+            meshlet.IndicesCount = static_cast<uint32_t>((resTriangles.size() - firstTriangle) * 3);
+
+            ComputeBounds(positions, indices, resTriangles.data() + firstTriangle, resTriangles.size() - firstTriangle, meshlet);
+
+            resMeshlets.push_back(meshlet);
+         }
+      }
+   }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "math/math.h"
+
+//Splitting of the meshes into the small clusters of the connected triangles, that are culled on their own
+//
+//Triangles of the meshlet are the continuous range of the mesh indices, so the visible meshlets are drawn as the ranges of the single buffer
+
+namespace assets
+{
+   namespace cook
+   {
+      constexpr size_t MaxMeshletVertices = 64;
+      constexpr size_t MaxMeshletTriangles = 124;
+
+      struct Meshlet
+      {
+         //Range of the mesh indices, 3 per triangle
+         uint32_t FirstIndex;
+         uint32_t IndicesCount;
+
+         //Bounds of the triangles in the object space
+         mm::vec3 Center;
+         float Radius;
+
+         //Normals of all the triangles are within the angle from the axis, the cone is valid only when the angle is below 90 degrees
+         mm::vec3 ConeAxis;
+         float ConeCos;
+         float ConeSin;
+      };
+
+      //Bounds of the whole level in the object space, the views cull the draws by the sphere
+      struct MeshBounds
+      {
+         mm::vec3 Min;
+         mm::vec3 Max;
+
+         //Sphere around the center of the box, its radius is to the farthest vertex, so it is tighter than the one around the box
+         mm::vec3 Center;
+         float Radius;
+      };
+
+      MeshBounds ComputeMeshBounds(const mm::vec3* positions, const size_t verticesCount);
+
+      //Grows every meshlet from the seed triangle through the shared vertices, the triangles that add less vertices go first
+      //Meshlet ends when the limits are reached or there is no connected triangle left
+      //resTriangles is the source triangle for every triangle of the result, meshlets reference the triangles in this order
+      void BuildMeshlets(const mm::vec3* positions, const size_t verticesCount, const std::vector<uint32_t>& indices,
+                         std::vector<Meshlet>& resMeshlets, std::vector<uint32_t>& resTriangles,
+                         const size_t maxVertices = MaxMeshletVertices, const size_t maxTriangles = MaxMeshletTriangles);
+   }
+}
@@ -0,0 +1,316 @@
+#include "mip-chain.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <emmintrin.h>
+
+#include "jobs/job-system.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      //Smaller work isn't worth the jobs overhead
+      constexpr size_t MinBytesPerJob = 64 * 1024;
+
+      //Linear values are quantized to this count of steps before the conversion back to sRGB
+      constexpr size_t LinearToSrgbSteps = 4096;
+
+      //Source rows are converted to floats with the padding, so the 3 channels pixels can be loaded as 4 floats
+      constexpr size_t RowPadding = 4;
+
+      struct ColorTables
+      {
+         float SrgbToLinear[256];
+         float UnormToFloat[256];
+         uint8_t LinearToSrgb[LinearToSrgbSteps];
+
+         inline ColorTables()
+         {
+            for (size_t i = 0; i < 256; ++i)
+            {
+               const float c = i / 255.0f;
+
+               SrgbToLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+               UnormToFloat[i] = c;
+            }
+
+            for (size_t i = 0; i < LinearToSrgbSteps; ++i)
+            {
+               const float l = i / static_cast<float>(LinearToSrgbSteps - 1);
+               const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+
+               LinearToSrgb[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+            }
+         }
+      };
+
+      static const ColorTables& GetColorTables()
+      {
+         static ColorTables tables;
+         return tables;
+      }
+
+      static inline uint8_t ToUnorm(const float v)
+      {
+         return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+      }
+
+      //Alpha is never in the sRGB space
+      static inline bool IsSrgbChannel(const MipFilter filter, const int32_t channel)
+      {
+         return filter == MipFilter::Srgb && channel < 3;
+      }
+
+      static void DecodeRow(const uint8_t* src, const size_t width, const int32_t channels, const MipFilter filter, float* dst)
+      {
+         const ColorTables& tables = GetColorTables();
+
+         for (int32_t c = 0; c < channels; ++c)
+         {
+            const float* table = IsSrgbChannel(filter, c) ? tables.SrgbToLinear : tables.UnormToFloat;
+
+            for (size_t x = 0; x < width; ++x)
+               dst[x * channels + c] = table[src[x * channels + c]];
+         }
+      }
+
+      static void EncodeRow(float* src, const size_t width, const int32_t channels, const MipFilter filter, uint8_t* dst)
+      {
+         const ColorTables& tables = GetColorTables();
+
+         if (filter == MipFilter::Normal && channels >= 3)
+         {
+            for (size_t x = 0; x < width; ++x)
+            {
+               float* n = src + x * channels;
+
+               const float nx = n[0] * 2.0f - 1.0f;
+               const float ny = n[1] * 2.0f - 1.0f;
+               const float nz = n[2] * 2.0f - 1.0f;
+
+               const float length = sqrtf(nx * nx + ny * ny + nz * nz);
+               const float scale = length > 1e-6f ? 0.5f / length : 0.0f;
+
+               n[0] = nx * scale + 0.5f;
+               n[1] = ny * scale + 0.5f;
+               n[2] = nz * scale + 0.5f;
+            }
+         }
+
+         for (int32_t c = 0; c < channels; ++c)
+         {
+            if (IsSrgbChannel(filter, c))
+            {
+               for (size_t x = 0; x < width; ++x)
+               {
+                  const float l = std::clamp(src[x * channels + c], 0.0f, 1.0f);
+                  dst[x * channels + c] = tables.LinearToSrgb[static_cast<size_t>(l * (LinearToSrgbSteps - 1) + 0.5f)];
+               }
+            }
+            else
+            {
+               for (size_t x = 0; x < width; ++x)
+                  dst[x * channels + c] = ToUnorm(src[x * channels + c]);
+            }
+         }
+      }
+
+      //Source texels of the destination one along the single axis
+      //Odd sizes are reduced by the 3 taps, so the last texel is folded into the neighbours instead of being dropped:
+      //every destination texel covers the (2 * dstSize + 1) / dstSize source texels, the side taps are weighted by the covered parts
+      struct FilterTaps
+      {
+         size_t First;
+         size_t Count;
+         float Weights[3];
+      };
+
+      static FilterTaps GetFilterTaps(const size_t dst, const size_t srcSize, const size_t dstSize)
+      {
+         if (srcSize == 1)
+            return { 0, 1, { 1.0f, 0.0f, 0.0f } };
+
+         if (srcSize % 2 == 0)
+            return { 2 * dst, 2, { 0.5f, 0.5f, 0.0f } };
+
+         const float size = static_cast<float>(srcSize);
+
+         return { 2 * dst, 3, { (dstSize - dst) / size, dstSize / size, (dst + 1) / size } };
+      }
+
+      //Weighted sum of the decoded rows and then of the texels of the sum
+      static void FilterRow(const float* const* rows, const FilterTaps& rowTaps, float* sum,
+                            const size_t srcWidth, const size_t dstWidth, const int32_t channels, float* dst)
+      {
+         const size_t count = srcWidth * channels;
+
+         for (size_t t = 0; t < rowTaps.Count; ++t)
+         {
+            const float* row = rows[t];
+            const float weight = rowTaps.Weights[t];
+            const __m128 weight4 = _mm_set1_ps(weight);
+
+            size_t i = 0;
+
+            if (t == 0)
+            {
+               for (; i + 4 <= count; i += 4)
+                  _mm_storeu_ps(sum + i, _mm_mul_ps(_mm_loadu_ps(row + i), weight4));
+
+               for (; i < count; ++i)
+                  sum[i] = row[i] * weight;
+            }
+            else
+            {
+               for (; i + 4 <= count; i += 4)
+                  _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_mul_ps(_mm_loadu_ps(row + i), weight4)));
+
+               for (; i < count; ++i)
+                  sum[i] += row[i] * weight;
+            }
+         }
+
+         for (size_t x = 0; x < dstWidth; ++x)
+         {
+            const FilterTaps taps = GetFilterTaps(x, srcWidth, dstWidth);
+
+            //Writes up to the 4 floats, the extra ones are overwritten by the next pixel or land into the padding
+            if (channels >= 3)
+            {
+               __m128 s = _mm_setzero_ps();
+
+               for (size_t t = 0; t < taps.Count; ++t)
+                  s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(sum + (taps.First + t) * channels), _mm_set1_ps(taps.Weights[t])));
+
+               _mm_storeu_ps(dst + x * channels, s);
+            }
+            else
+            {
+               for (int32_t c = 0; c < channels; ++c)
+               {
+                  float s = 0.0f;
+
+                  for (size_t t = 0; t < taps.Count; ++t)
+                     s += sum[(taps.First + t) * channels + c] * taps.Weights[t];
+
+                  dst[x * channels + c] = s;
+               }
+            }
+         }
+      }
+
+      static void BuildLevel(const uint8_t* src, const MipLevel& srcLevel, uint8_t* dst, const MipLevel& dstLevel,
+                             const int32_t channels, const MipFilter filter)
+      {
+         const size_t srcWidth = srcLevel.Width;
+         const size_t srcHeight = srcLevel.Height;
+         const size_t dstWidth = dstLevel.Width;
+         const size_t dstHeight = dstLevel.Height;
+
+         const size_t srcRowSize = srcWidth * channels;
+         const size_t dstRowSize = dstWidth * channels;
+
+         const size_t minRowsPerJob = std::max<size_t>(1, MinBytesPerJob / (srcRowSize * 2));
+
+         core::JobSystem::ParallelFor(dstHeight, minRowsPerJob, [&](const size_t begin, const size_t end)
+            {
+               std::vector<float> rows[3];
+               for (auto& row : rows)
+                  row.assign(srcRowSize + RowPadding, 0.0f);
+
+               const float* rowsData[3] = { rows[0].data(), rows[1].data(), rows[2].data() };
+
+               std::vector<float> sum(srcRowSize + RowPadding, 0.0f);
+               std::vector<float> filtered(dstRowSize + RowPadding, 0.0f);
+
+               for (size_t y = begin; y < end; ++y)
+               {
+                  const FilterTaps rowTaps = GetFilterTaps(y, srcHeight, dstHeight);
+
+                  for (size_t t = 0; t < rowTaps.Count; ++t)
+                     DecodeRow(src + (rowTaps.First + t) * srcRowSize, srcWidth, channels, filter, rows[t].data());
+
+                  FilterRow(rowsData, rowTaps, sum.data(), srcWidth, dstWidth, channels, filtered.data());
+
+                  EncodeRow(filtered.data(), dstWidth, channels, filter, dst + y * dstRowSize);
+               }
+            });
+      }
+
+      MipFilter GetMipFilter(const std::string_view& filepath)
+      {
+         const size_t extension = filepath.rfind('.');
+         const std::string_view stem = filepath.substr(0, extension);
+
+         auto endsWith = [&stem](const std::string_view& suffix)
+         {
+            return stem.size() >= suffix.size() && stem.substr(stem.size() - suffix.size()) == suffix;
+         };
+
+         return endsWith("_N") || endsWith("_normal") ? MipFilter::Normal : MipFilter::Srgb;
+      }
+
+      size_t GetMipsCount(const int32_t width, const int32_t height)
+      {
+         size_t count = 1;
+         for (int32_t size = std::max(width, height); size > 1; size >>= 1)
+            ++count;
+
+         return count;
+      }
+
+      void FlipRows(uint8_t* pixels, const size_t rowSize, const size_t rowsCount)
+      {
+         const size_t minRowsPerJob = std::max<size_t>(1, MinBytesPerJob * 4 / rowSize);
+
+         core::JobSystem::ParallelFor(rowsCount / 2, minRowsPerJob, [=](const size_t begin, const size_t end)
+            {
+               for (size_t y = begin; y < end; ++y)
+               {
+                  uint8_t* top = pixels + y * rowSize;
+                  uint8_t* bottom = pixels + (rowsCount - 1 - y) * rowSize;
+
+                  std::swap_ranges(top, top + rowSize, bottom);
+               }
+            });
+      }
+
+      bool BuildMipChain(const uint8_t* pixels, const int32_t width, const int32_t height, const int32_t channels,
+                         const MipFilter filter, PixelBuffer& resPixels, std::vector<MipLevel>& resMips)
+      {
+         if (width <= 0 || height <= 0 || channels <= 0 || channels > 4)
+            return false;
+
+         std::vector<MipLevel> mips(GetMipsCount(width, height));
+
+         uint64_t offset = 0;
+         for (size_t i = 0; i < mips.size(); ++i)
+         {
+            mips[i].Width = std::max(1, width >> i);
+            mips[i].Height = std::max(1, height >> i);
+            mips[i].Offset = offset;
+            mips[i].Size = static_cast<uint64_t>(mips[i].Width) * mips[i].Height * channels;
+
+            offset += mips[i].Size;
+         }
+
+         PixelBuffer buffer(static_cast<uint8_t*>(PixelPool::Allocate(static_cast<size_t>(offset))));
+         if (!buffer)
+            return false;
+
+         memcpy(buffer.get(), pixels, static_cast<size_t>(mips[0].Size));
+
+         //Every level depends on the previous one, so only the rows of the single level are processed in parallel
+         for (size_t i = 1; i < mips.size(); ++i)
+            BuildLevel(buffer.get() + mips[i - 1].Offset, mips[i - 1], buffer.get() + mips[i].Offset, mips[i], channels, filter);
+
+         resPixels = std::move(buffer);
+         resMips = std::move(mips);
+
+         return true;
+      }
+   }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string_view>
+
+#include "asset-manager/pixel-pool.h"
+#include "texture-format.h"
+
+namespace assets
+{
+   namespace cook
+   {
+      enum class MipFilter : uint8_t
+      {
+         Srgb,   //Color channels are averaged in the linear space, alpha is linear
+         Linear,
+         Normal  //Tangent space normals, averaged vectors are renormalized
+      };
+
+      //Normal maps are recognized by the _N and _normal name suffixes
+      MipFilter GetMipFilter(const std::string_view& filepath);
+
+      size_t GetMipsCount(const int32_t width, const int32_t height);
+
+      //Rows are swapped in parallel strips, so the big images aren't flipped by the single thread
+      void FlipRows(uint8_t* pixels, const size_t rowSize, const size_t rowsCount);
+
+      //Builds the full chain down to 1x1 with the 2x2 box filter, level 0 is the copy of the pixels
+      //Odd sizes are reduced by the 3 taps of the same area, so their last row and column are kept in the smaller level
+      //Levels are written one after another into the single buffer, rows of every level are filtered in parallel
+      bool BuildMipChain(const uint8_t* pixels, const int32_t width, const int32_t height, const int32_t channels,
+                         const MipFilter filter, PixelBuffer& resPixels, std::vector<MipLevel>& resMips);
+   }
+}
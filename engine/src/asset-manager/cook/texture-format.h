@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//Layout of the cooked texture, the image with the full mip chain, raw or block compressed:
+//   TextureHeader
+//   TextureMip for every level, level 0 is the full size image
+//   Levels data, every level starts at the LevelAlignment boundary
+//
+//Rows are stored from the bottom to the top, as the OpenGL expects
+
+namespace assets
+{
+   struct MipLevel
+   {
+      int32_t Width;
+      int32_t Height;
+
+      uint64_t Offset; //From the start of the pixels buffer
+      uint64_t Size;
+   };
+
+   namespace cook
+   {
+      inline constexpr uint32_t TextureMagic = 0x58455452; //"RTEX"
+      inline constexpr uint32_t TextureVersion = 2; //Version 2 added the block compression
+
+      enum class BlockFormat : uint32_t
+      {
+         None, //Raw 8 bit channels
+         BC1,  //RGB, 8 bytes per 4x4 block
+         BC3,  //RGBA, 16 bytes per block
+         BC5,  //RG, 16 bytes per block, for the normal maps
+         BC7   //RGBA, 16 bytes per block, only the mode 6 is produced
+      };
+
+      constexpr size_t GetBlockSize(const BlockFormat format)
+      {
+         return format == BlockFormat::BC1 ? 8 : 16;
+      }
+
+      //Compressed levels are padded to the whole 4x4 blocks
+      constexpr uint64_t GetLevelSize(const BlockFormat format, const int32_t width, const int32_t height, const int32_t channels)
+      {
+         if (format == BlockFormat::None)
+            return static_cast<uint64_t>(width) * height * channels;
+
+         return static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+      }
+
+      inline constexpr uint64_t LevelAlignment = 16;
+
+      struct TextureHeader
+      {
+         uint32_t Magic;
+         uint32_t Version;
+
+         int32_t Width;
+         int32_t Height;
+         int32_t Channels;
+
+         uint32_t MipsCount;
+
+         BlockFormat Format;
+         uint32_t Reserved;
+      };
+
+      //Offsets are from the start of the cooked texture
+      using TextureMip = MipLevel;
+
+      static_assert(sizeof(TextureHeader) == 32, "Cooked texture header layout is changed");
+      static_assert(sizeof(TextureMip) == 24, "Cooked texture mip layout is changed");
+
+      constexpr uint64_t AlignLevel(const uint64_t offset)
+      {
+         return (offset + LevelAlignment - 1) & ~(LevelAlignment - 1);
+      }
+
+      //Mips offsets are relative to the pixels
+      inline std::vector<uint8_t> WriteTexture(const int32_t width, const int32_t height, const int32_t channels,
+                                               const BlockFormat format, const uint8_t* pixels, const std::vector<MipLevel>& mips)
+      {
+         const uint64_t tableSize = sizeof(TextureHeader) + sizeof(TextureMip) * mips.size();
+
+         std::vector<TextureMip> table(mips);
+
+         uint64_t offset = AlignLevel(tableSize);
+         for (auto& mip : table)
+         {
+            mip.Offset = offset;
+            offset = AlignLevel(offset + mip.Size);
+         }
+
+         std::vector<uint8_t> res(offset, 0);
+
+         TextureHeader header = { TextureMagic, TextureVersion, width, height, channels, static_cast<uint32_t>(mips.size()), format, 0 };
+         memcpy(res.data(), &header, sizeof(header));
+         memcpy(res.data() + sizeof(header), table.data(), sizeof(TextureMip) * table.size());
+
+         for (size_t i = 0; i < mips.size(); ++i)
+            memcpy(res.data() + table[i].Offset, pixels + mips[i].Offset, mips[i].Size);
+
+         return res;
+      }
+
+      //Validates the header and that every level is inside the data, mips offsets stay relative to the data
+      inline bool ReadTextureLayout(const uint8_t* data, const size_t size, TextureHeader& header, std::vector<MipLevel>& mips)
+      {
+         if (size < sizeof(TextureHeader))
+            return false;
+
+         memcpy(&header, data, sizeof(header));
+
+         if (header.Magic != TextureMagic || header.Version != TextureVersion
+             || !header.MipsCount || header.MipsCount > 32
+             || header.Format > BlockFormat::BC7
+             || size < sizeof(TextureHeader) + sizeof(TextureMip) * header.MipsCount)
+         {
+            return false;
+         }
+
+         mips.resize(header.MipsCount);
+         memcpy(mips.data(), data + sizeof(TextureHeader), sizeof(TextureMip) * header.MipsCount);
+
+         for (auto& mip : mips)
+         {
+            if (mip.Width <= 0 || mip.Height <= 0
+                || mip.Offset > size || mip.Size > size - mip.Offset
+                || mip.Size != GetLevelSize(header.Format, mip.Width, mip.Height, header.Channels))
+            {
+               return false;
+            }
+         }
+
+         return true;
+      }
+   }
+}
@@ -0,0 +1,454 @@
+#include "vertex-quantize.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+
+#include <emmintrin.h>
+
+namespace assets
+{
+   namespace cook
+   {
+      constexpr float UnormMax = 65535.0f;
+      constexpr float SnormMax = 32767.0f;
+
+      //Adding it to the float below the smallest normal half puts the half mantissa into the low bits
+      constexpr uint32_t SubnormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+      constexpr uint32_t HalfExponentMagic = (254 - 15) << 23;
+
+      static float AsFloat(const uint32_t bits)
+      {
+         float value;
+         memcpy(&value, &bits, sizeof(value));
+         return value;
+      }
+
+      static uint32_t AsBits(const float value)
+      {
+         uint32_t bits;
+         memcpy(&bits, &value, sizeof(bits));
+         return bits;
+      }
+
+      uint16_t FloatToHalf(const float value)
+      {
+         uint32_t bits = AsBits(value);
+
+         const uint32_t sign = bits & 0x80000000u;
+         bits ^= sign;
+
+         uint32_t res;
+
+         //Everything from 65520 rounds to the infinity, NaNs stay quiet NaNs
+         if (bits >= (127 + 16) << 23)
+         {
+            res = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+         }
+         else if (bits < (127 - 14) << 23)
+         {
+            res = AsBits(AsFloat(bits) + AsFloat(SubnormalMagic)) - SubnormalMagic;
+         }
+         else
+         {
+            //Exponent is rebiased and the half of the dropped bits is added, the odd mantissa rounds the ties up to the even
+            const uint32_t mantissaOdd = (bits >> 13) & 1;
+
+            bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff;
+            bits += mantissaOdd;
+
+            res = bits >> 13;
+         }
+
+         return static_cast<uint16_t>(res | (sign >> 16));
+      }
+
+      float HalfToFloat(const uint16_t value)
+      {
+         float res = AsFloat(static_cast<uint32_t>(value & 0x7fff) << 13) * AsFloat(HalfExponentMagic);
+
+         uint32_t bits = AsBits(res);
+
+         if ((value & 0x7fff) > 0x7bff)
+            bits |= 255 << 23;
+
+         bits |= static_cast<uint32_t>(value & 0x8000) << 16;
+
+         return AsFloat(bits);
+      }
+
+      //Same operations as the SSE kernels below, so the tail gives the same bits as the 4 vertices before it
+      static void EncodeOctahedral(const mm::vec3& v, int16_t* res)
+      {
+         const float l1 = fabsf(v.x) + fabsf(v.y) + fabsf(v.z);
+
+         float x = 0.0f;
+         float y = 0.0f;
+
+         if (l1 > 0.0f)
+         {
+            x = v.x / l1;
+            y = v.y / l1;
+
+            //Lower hemisphere is folded over the diagonals onto the corners of the square
+            if (v.z < 0.0f)
+            {
+               const float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+               const float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+
+               x = foldedX;
+               y = foldedY;
+            }
+         }
+
+         res[0] = static_cast<int16_t>(lrintf(x * SnormMax));
+         res[1] = static_cast<int16_t>(lrintf(y * SnormMax));
+      }
+
+      static mm::vec3 DecodeOctahedral(const int16_t* v)
+      {
+         float x = std::max(v[0] / SnormMax, -1.0f);
+         float y = std::max(v[1] / SnormMax, -1.0f);
+         const float z = 1.0f - fabsf(x) - fabsf(y);
+
+         const float t = std::max(-z, 0.0f);
+         x += x >= 0.0f ? -t : t;
+         y += y >= 0.0f ? -t : t;
+
+         return mm::normalize(mm::vec3(x, y, z));
+      }
+
+      static mm::vec3 GetUnormScale(const VertexBounds& bounds)
+      {
+         //Flat mesh has the zero size along its normal, all of its positions are at the offset
+         return mm::vec3(bounds.Scale.x > 0.0f ? UnormMax / bounds.Scale.x : 0.0f,
+                         bounds.Scale.y > 0.0f ? UnormMax / bounds.Scale.y : 0.0f,
+                         bounds.Scale.z > 0.0f ? UnormMax / bounds.Scale.z : 0.0f);
+      }
+
+      static void PackVertex(const mm::vec3& position, const mm::vec3& normal, const mm::vec2& uv, const mm::vec3& tangent,
+                             const mm::vec3& bitangent, const VertexBounds& bounds, const mm::vec3& unormScale, PackedVertex& res)
+      {
+         const float scaled[3] = { (position.x - bounds.Offset.x) * unormScale.x,
+                                   (position.y - bounds.Offset.y) * unormScale.y,
+                                   (position.z - bounds.Offset.z) * unormScale.z };
+
+         for (size_t c = 0; c < 3; ++c)
+            res.Position[c] = static_cast<uint16_t>(lrintf(std::min(std::max(scaled[c], 0.0f), UnormMax)));
+
+         const float sign = (normal.y * tangent.z - normal.z * tangent.y) * bitangent.x
+                          + (normal.z * tangent.x - normal.x * tangent.z) * bitangent.y
+                          + (normal.x * tangent.y - normal.y * tangent.x) * bitangent.z;
+
+         res.Position[3] = sign < 0.0f ? 0 : 0xffff;
+
+         EncodeOctahedral(normal, res.Normal);
+         EncodeOctahedral(tangent, res.Tangent);
+
+         res.UV[0] = FloatToHalf(uv.x);
+         res.UV[1] = FloatToHalf(uv.y);
+      }
+
+      static void UnpackVertex(const PackedVertex& vertex, const VertexBounds& bounds, mm::vec3& resPosition, mm::vec3& resNormal,
+                               mm::vec2& resUV, mm::vec3& resTangent, mm::vec3& resBitangent)
+      {
+         resPosition = mm::vec3(bounds.Offset.x + bounds.Scale.x * (vertex.Position[0] / UnormMax),
+                                bounds.Offset.y + bounds.Scale.y * (vertex.Position[1] / UnormMax),
+                                bounds.Offset.z + bounds.Scale.z * (vertex.Position[2] / UnormMax));
+
+         resNormal = DecodeOctahedral(vertex.Normal);
+         resTangent = DecodeOctahedral(vertex.Tangent);
+
+         resUV = mm::vec2(HalfToFloat(vertex.UV[0]), HalfToFloat(vertex.UV[1]));
+
+         const mm::vec3 bitangent = mm::cross(resNormal, resTangent);
+         const float length = mm::length(bitangent);
+
+         resBitangent = length > 0.0f ? bitangent * ((vertex.Position[3] ? 1.0f : -1.0f) / length) : mm::vec3(0.0f);
+      }
+
+
+      //SSE kernels, every __m128 is the single component of the 4 vertices
+
+      static __m128 Select(const __m128 mask, const __m128 a, const __m128 b)
+      {
+         return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+      }
+
+      static __m128i Select(const __m128i mask, const __m128i a, const __m128i b)
+      {
+         return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+      }
+
+      static __m128 Abs(const __m128 v)
+      {
+         return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+      }
+
+      //+1 for the positive values and the zeros, -1 for the negative ones
+      static __m128 SignNotZero(const __m128 v)
+      {
+         return Select(_mm_cmpge_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f), _mm_set1_ps(-1.0f));
+      }
+
+      static void EncodeOctahedral4(const __m128 x, const __m128 y, const __m128 z, __m128i& resX, __m128i& resY)
+      {
+         const __m128 l1 = _mm_add_ps(_mm_add_ps(Abs(x), Abs(y)), Abs(z));
+         const __m128 isValid = _mm_cmpgt_ps(l1, _mm_setzero_ps());
+
+         //Invalid lanes divide by 1, the result is masked out anyway
+         const __m128 divisor = Select(isValid, l1, _mm_set1_ps(1.0f));
+
+         __m128 ox = _mm_and_ps(isValid, _mm_div_ps(x, divisor));
+         __m128 oy = _mm_and_ps(isValid, _mm_div_ps(y, divisor));
+
+         const __m128 foldedX = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(oy)), SignNotZero(ox));
+         const __m128 foldedY = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(ox)), SignNotZero(oy));
+
+         const __m128 isLower = _mm_and_ps(isValid, _mm_cmplt_ps(z, _mm_setzero_ps()));
+
+         ox = Select(isLower, foldedX, ox);
+         oy = Select(isLower, foldedY, oy);
+
+         resX = _mm_cvtps_epi32(_mm_mul_ps(ox, _mm_set1_ps(SnormMax)));
+         resY = _mm_cvtps_epi32(_mm_mul_ps(oy, _mm_set1_ps(SnormMax)));
+      }
+
+      static void DecodeOctahedral4(const __m128 encodedX, const __m128 encodedY, __m128& resX, __m128& resY, __m128& resZ)
+      {
+         const __m128 one = _mm_set1_ps(1.0f);
+
+         __m128 x = _mm_max_ps(_mm_div_ps(encodedX, _mm_set1_ps(SnormMax)), _mm_set1_ps(-1.0f));
+         __m128 y = _mm_max_ps(_mm_div_ps(encodedY, _mm_set1_ps(SnormMax)), _mm_set1_ps(-1.0f));
+         const __m128 z = _mm_sub_ps(_mm_sub_ps(one, Abs(x)), Abs(y));
+
+         const __m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+
+         x = _mm_add_ps(x, _mm_mul_ps(t, _mm_sub_ps(_mm_setzero_ps(), SignNotZero(x))));
+         y = _mm_add_ps(y, _mm_mul_ps(t, _mm_sub_ps(_mm_setzero_ps(), SignNotZero(y))));
+
+         const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+         resX = _mm_div_ps(x, length);
+         resY = _mm_div_ps(y, length);
+         resZ = _mm_div_ps(z, length);
+      }
+
+      //Same steps as the FloatToHalf, the lanes hold the half in their low 16 bits
+      static __m128i FloatToHalf4(const __m128 value)
+      {
+         const __m128 sign = _mm_and_ps(value, _mm_set1_ps(-0.0f));
+         const __m128 absValue = _mm_xor_ps(value, sign);
+         const __m128i bits = _mm_castps_si128(absValue);
+
+         const __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absValue, absValue));
+         const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+         const __m128i infOrNaN = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+         const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+         const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absValue, _mm_castsi128_ps(_mm_set1_epi32(SubnormalMagic)))),
+                                                 _mm_set1_epi32(SubnormalMagic));
+
+         const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+         const __m128i rounded = _mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(15 - 127) << 23) + 0xfff))),
+                                               mantissaOdd);
+         const __m128i normal = _mm_srli_epi32(rounded, 13);
+
+         const __m128i finite = Select(isSubnormal, subnormal, normal);
+         const __m128i res = Select(isRegular, finite, infOrNaN);
+
+         return _mm_or_si128(res, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+      }
+
+      static __m128 HalfToFloat4(const __m128i value)
+      {
+         const __m128i exponentMantissa = _mm_and_si128(value, _mm_set1_epi32(0x7fff));
+         const __m128i sign = _mm_slli_epi32(_mm_xor_si128(value, exponentMantissa), 16);
+
+         const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponentMantissa, 13)),
+                                          _mm_castsi128_ps(_mm_set1_epi32(HalfExponentMagic)));
+
+         const __m128i isInfOrNaN = _mm_cmpgt_epi32(exponentMantissa, _mm_set1_epi32(0x7bff));
+         const __m128i infExponent = _mm_and_si128(isInfOrNaN, _mm_set1_epi32(255 << 23));
+
+         return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infExponent)));
+      }
+
+      struct Lanes4
+      {
+         alignas(16) int32_t Values[4];
+
+         inline void Store(const __m128i v)
+         {
+            _mm_store_si128(reinterpret_cast<__m128i*>(Values), v);
+         }
+      };
+
+      //Component of the 4 vectors, the vectors are the AoS arrays
+      template<typename T>
+      static __m128 Load4(const T* v, const size_t component)
+      {
+         return _mm_set_ps(v[3].Data[component], v[2].Data[component], v[1].Data[component], v[0].Data[component]);
+      }
+
+      VertexBounds ComputeVertexBounds(const mm::vec3* positions, const size_t verticesCount)
+      {
+         VertexBounds bounds;
+         bounds.Offset = mm::vec3(0.0f);
+         bounds.Scale = mm::vec3(0.0f);
+
+         if (verticesCount == 0)
+            return bounds;
+
+         mm::vec3 min = positions[0];
+         mm::vec3 max = positions[0];
+
+         for (size_t i = 1; i < verticesCount; ++i)
+         {
+            min = { std::min(min.x, positions[i].x), std::min(min.y, positions[i].y), std::min(min.z, positions[i].z) };
+            max = { std::max(max.x, positions[i].x), std::max(max.y, positions[i].y), std::max(max.z, positions[i].z) };
+         }
+
+         bounds.Offset = min;
+         bounds.Scale = max - min;
+
+         return bounds;
+      }
+
+      void PackVertices(const mm::vec3* positions, const mm::vec3* normals, const mm::vec2* uvs, const mm::vec3* tangents,
+                        const mm::vec3* bitangents, const size_t verticesCount, const VertexBounds& bounds, PackedVertex* resVertices)
+      {
+         const mm::vec3 unormScale = GetUnormScale(bounds);
+
+         const __m128 offset[3] = { _mm_set1_ps(bounds.Offset.x), _mm_set1_ps(bounds.Offset.y), _mm_set1_ps(bounds.Offset.z) };
+         const __m128 scale[3] = { _mm_set1_ps(unormScale.x), _mm_set1_ps(unormScale.y), _mm_set1_ps(unormScale.z) };
+
+         Lanes4 lanes[10];
+
+         size_t i = 0;
+
+         for (; i + 4 <= verticesCount; i += 4)
+         {
+            for (size_t c = 0; c < 3; ++c)
+            {
+               const __m128 scaled = _mm_mul_ps(_mm_sub_ps(Load4(positions + i, c), offset[c]), scale[c]);
+               lanes[c].Store(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(UnormMax))));
+            }
+
+            const __m128 nx = Load4(normals + i, 0);
+            const __m128 ny = Load4(normals + i, 1);
+            const __m128 nz = Load4(normals + i, 2);
+
+            const __m128 tx = Load4(tangents + i, 0);
+            const __m128 ty = Load4(tangents + i, 1);
+            const __m128 tz = Load4(tangents + i, 2);
+
+            const __m128 sign = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty)), Load4(bitangents + i, 0)),
+                                                      _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz)), Load4(bitangents + i, 1))),
+                                           _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx)), Load4(bitangents + i, 2)));
+
+            lanes[3].Store(_mm_andnot_si128(_mm_castps_si128(_mm_cmplt_ps(sign, _mm_setzero_ps())), _mm_set1_epi32(0xffff)));
+
+            __m128i encodedX, encodedY;
+
+            EncodeOctahedral4(nx, ny, nz, encodedX, encodedY);
+            lanes[4].Store(encodedX);
+            lanes[5].Store(encodedY);
+
+            EncodeOctahedral4(tx, ty, tz, encodedX, encodedY);
+            lanes[6].Store(encodedX);
+            lanes[7].Store(encodedY);
+
+            lanes[8].Store(FloatToHalf4(Load4(uvs + i, 0)));
+            lanes[9].Store(FloatToHalf4(Load4(uvs + i, 1)));
+
+            for (size_t v = 0; v < 4; ++v)
+            {
+               PackedVertex& res = resVertices[i + v];
+
+               for (size_t c = 0; c < 4; ++c)
+                  res.Position[c] = static_cast<uint16_t>(lanes[c].Values[v]);
+
+               res.Normal[0] = static_cast<int16_t>(lanes[4].Values[v]);
+               res.Normal[1] = static_cast<int16_t>(lanes[5].Values[v]);
+               res.Tangent[0] = static_cast<int16_t>(lanes[6].Values[v]);
+               res.Tangent[1] = static_cast<int16_t>(lanes[7].Values[v]);
+               res.UV[0] = static_cast<uint16_t>(lanes[8].Values[v]);
+               res.UV[1] = static_cast<uint16_t>(lanes[9].Values[v]);
+            }
+         }
+
+         for (; i < verticesCount; ++i)
+            PackVertex(positions[i], normals[i], uvs[i], tangents[i], bitangents[i], bounds, unormScale, resVertices[i]);
+      }
+
+      void UnpackVertices(const PackedVertex* vertices, const size_t verticesCount, const VertexBounds& bounds,
+                          mm::vec3* resPositions, mm::vec3* resNormals, mm::vec2* resUVs, mm::vec3* resTangents, mm::vec3* resBitangents)
+      {
+         const __m128 offset[3] = { _mm_set1_ps(bounds.Offset.x), _mm_set1_ps(bounds.Offset.y), _mm_set1_ps(bounds.Offset.z) };
+         const __m128 scale[3] = { _mm_set1_ps(bounds.Scale.x), _mm_set1_ps(bounds.Scale.y), _mm_set1_ps(bounds.Scale.z) };
+
+         alignas(16) float lanes[14][4];
+
+         size_t i = 0;
+
+         for (; i + 4 <= verticesCount; i += 4)
+         {
+            const PackedVertex* v = vertices + i;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+               const __m128 unorm = _mm_cvtepi32_ps(_mm_set_epi32(v[3].Position[c], v[2].Position[c], v[1].Position[c], v[0].Position[c]));
+               _mm_store_ps(lanes[c], _mm_add_ps(offset[c], _mm_mul_ps(scale[c], _mm_div_ps(unorm, _mm_set1_ps(UnormMax)))));
+            }
+
+            __m128 nx, ny, nz;
+            DecodeOctahedral4(_mm_cvtepi32_ps(_mm_set_epi32(v[3].Normal[0], v[2].Normal[0], v[1].Normal[0], v[0].Normal[0])),
+                              _mm_cvtepi32_ps(_mm_set_epi32(v[3].Normal[1], v[2].Normal[1], v[1].Normal[1], v[0].Normal[1])), nx, ny, nz);
+
+            __m128 tx, ty, tz;
+            DecodeOctahedral4(_mm_cvtepi32_ps(_mm_set_epi32(v[3].Tangent[0], v[2].Tangent[0], v[1].Tangent[0], v[0].Tangent[0])),
+                              _mm_cvtepi32_ps(_mm_set_epi32(v[3].Tangent[1], v[2].Tangent[1], v[1].Tangent[1], v[0].Tangent[1])), tx, ty, tz);
+
+            _mm_store_ps(lanes[3], nx);
+            _mm_store_ps(lanes[4], ny);
+            _mm_store_ps(lanes[5], nz);
+            _mm_store_ps(lanes[6], tx);
+            _mm_store_ps(lanes[7], ty);
+            _mm_store_ps(lanes[8], tz);
+
+            //Bitangent is the cross product with the stored sign, the normal and the tangent aren't exactly orthogonal after the cook
+            __m128 bx = _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty));
+            __m128 by = _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz));
+            __m128 bz = _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx));
+
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(by, by)), _mm_mul_ps(bz, bz)));
+            const __m128 isPositive = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set_epi32(v[3].Position[3], v[2].Position[3], v[1].Position[3], v[0].Position[3]),
+                                                                      _mm_setzero_si128()));
+            const __m128 isValid = _mm_cmpgt_ps(length, _mm_setzero_ps());
+            const __m128 factor = _mm_and_ps(isValid, _mm_div_ps(Select(isPositive, _mm_set1_ps(1.0f), _mm_set1_ps(-1.0f)),
+                                                                 Select(isValid, length, _mm_set1_ps(1.0f))));
+
+            _mm_store_ps(lanes[9], _mm_mul_ps(bx, factor));
+            _mm_store_ps(lanes[10], _mm_mul_ps(by, factor));
+            _mm_store_ps(lanes[11], _mm_mul_ps(bz, factor));
+
+            _mm_store_ps(lanes[12], HalfToFloat4(_mm_set_epi32(v[3].UV[0], v[2].UV[0], v[1].UV[0], v[0].UV[0])));
+            _mm_store_ps(lanes[13], HalfToFloat4(_mm_set_epi32(v[3].UV[1], v[2].UV[1], v[1].UV[1], v[0].UV[1])));
+
+            for (size_t l = 0; l < 4; ++l)
+            {
+               resPositions[i + l] = mm::vec3(lanes[0][l], lanes[1][l], lanes[2][l]);
+               resNormals[i + l] = mm::vec3(lanes[3][l], lanes[4][l], lanes[5][l]);
+               resTangents[i + l] = mm::vec3(lanes[6][l], lanes[7][l], lanes[8][l]);
+               resBitangents[i + l] = mm::vec3(lanes[9][l], lanes[10][l], lanes[11][l]);
+               resUVs[i + l] = mm::vec2(lanes[12][l], lanes[13][l]);
+            }
+         }
+
+         for (; i < verticesCount; ++i)
+            UnpackVertex(vertices[i], bounds, resPositions[i], resNormals[i], resUVs[i], resTangents[i], resBitangents[i]);
+      }
+   }
+}
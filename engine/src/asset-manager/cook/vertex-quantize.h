@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "math/math.h"
+
+//Compact vertex layout of the cooked meshes, 20 bytes per vertex instead of the 56 of the float attributes
+//
+//Positions are 16 bit unorm inside of the mesh bounds, so the precision is the 1/65535 of the mesh size
+//Normals and tangents are octahedral encoded into the 2 snorm16, the bitangent is the cross product of them with the stored sign
+//UVs are half floats, that keeps the 1/2048 precision in [0, 1] and allows the tiled UVs
+
+namespace assets
+{
+   namespace cook
+   {
+      enum class VertexFormat : uint8_t
+      {
+         Float,
+         Packed
+      };
+
+      struct PackedVertex
+      {
+         //w is the sign of the bitangent, 0 when it is opposite to the cross(normal, tangent) and 65535 otherwise
+         uint16_t Position[4];
+         int16_t Normal[2];
+         int16_t Tangent[2];
+         uint16_t UV[2];
+      };
+
+      static_assert(sizeof(PackedVertex) == 20, "Packed vertex layout is shared with the shaders");
+
+      //Position is Offset + Scale * unorm
+      struct VertexBounds
+      {
+         mm::vec3 Offset;
+         mm::vec3 Scale;
+      };
+
+      VertexBounds ComputeVertexBounds(const mm::vec3* positions, const size_t verticesCount);
+
+      //Kernels process 4 vertices by the single SSE instruction, the tail is done by the scalar code of the same rounding
+      //Normals and tangents are expected to be normalized, zero ones are packed as +Z
+      void PackVertices(const mm::vec3* positions, const mm::vec3* normals, const mm::vec2* uvs, const mm::vec3* tangents,
+                        const mm::vec3* bitangents, const size_t verticesCount, const VertexBounds& bounds, PackedVertex* resVertices);
+
+      //Bitangents are rebuilt from the normal, the tangent and the sign, so they are orthogonal to both of them
+      void UnpackVertices(const PackedVertex* vertices, const size_t verticesCount, const VertexBounds& bounds,
+                          mm::vec3* resPositions, mm::vec3* resNormals, mm::vec2* resUVs, mm::vec3* resTangents, mm::vec3* resBitangents);
+
+      //IEEE half with the round to nearest even, out of range values become infinities
+      uint16_t FloatToHalf(const float value);
+
+      float HalfToFloat(const uint16_t value);
+   }
+}
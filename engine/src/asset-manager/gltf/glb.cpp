@@ -0,0 +1,649 @@
+#include "glb.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace assets
+{
+   namespace gltf
+   {
+      constexpr uint32_t GlbMagic = 0x46546C67; //"glTF"
+      constexpr uint32_t GlbVersion = 2;
+      constexpr uint32_t ChunkJson = 0x4E4F534A; //"JSON"
+      constexpr uint32_t ChunkBin = 0x004E4942; //"BIN\0"
+
+      constexpr size_t GlbHeaderSize = 12;
+      constexpr size_t ChunkHeaderSize = 8;
+
+      //Primitive topology of the triangle lists, the only one that is imported
+      constexpr int64_t ModeTriangles = 4;
+
+      //Spec limits the byteStride of the vertex attributes
+      constexpr int64_t MaxStride = 252;
+
+      static_assert(sizeof(mm::vec3) == sizeof(float) * 3 && sizeof(mm::vec2) == sizeof(float) * 2,
+                    "Attributes are read into the vectors as the float arrays");
+
+      static inline uint32_t ReadUint32(const uint8_t* data)
+      {
+         uint32_t value;
+         memcpy(&value, data, sizeof(value));
+
+         return value;
+      }
+
+      static size_t GetComponentSize(const ComponentType component)
+      {
+         switch (component)
+         {
+         case ComponentType::Byte:
+         case ComponentType::Ubyte:
+            return 1;
+         case ComponentType::Short:
+         case ComponentType::Ushort:
+            return 2;
+         case ComponentType::Uint:
+         case ComponentType::Float:
+            return 4;
+         }
+
+         return 0;
+      }
+
+      static uint8_t GetComponentsCount(const std::string_view& type)
+      {
+         if (type == "SCALAR")
+            return 1;
+         if (type == "VEC2")
+            return 2;
+         if (type == "VEC3")
+            return 3;
+         if (type == "VEC4")
+            return 4;
+
+         //Matrices have the column padding, no mesh attribute uses them
+         return 0;
+      }
+
+      //Missing optional property is the defaultValue, the present one must be the valid index
+      static int64_t GetOptionalIndex(const JsonValue& value, const std::string_view& key, const int64_t defaultValue)
+      {
+         return value.Find(key) ? value.GetIndex(key) : defaultValue;
+      }
+
+      static const JsonValue* GetElement(const JsonValue& root, const std::string_view& key, const int64_t index)
+      {
+         const JsonValue* array = root.Find(key);
+
+         if (!array || !array->IsArray() || index < 0 || static_cast<size_t>(index) >= array->Elements.size()
+             || !array->Elements[index].IsObject())
+         {
+            return nullptr;
+         }
+
+         return &array->Elements[index];
+      }
+
+      bool GlbDocument::Open(const uint8_t* data, const size_t size)
+      {
+         Bin = nullptr;
+         BinSize = 0;
+
+         if (size < GlbHeaderSize + ChunkHeaderSize || ReadUint32(data) != GlbMagic || ReadUint32(data + 4) != GlbVersion)
+            return false;
+
+         //Trailing bytes after the declared length aren't the part of the file, e.g. the padding of the archive
+         const size_t length = std::min<size_t>(ReadUint32(data + 8), size);
+
+         const size_t jsonSize = ReadUint32(data + GlbHeaderSize);
+         const size_t jsonOffset = GlbHeaderSize + ChunkHeaderSize;
+
+         if (ReadUint32(data + GlbHeaderSize + 4) != ChunkJson || jsonSize > length - jsonOffset)
+            return false;
+
+         if (!ParseJson(reinterpret_cast<const char*>(data + jsonOffset), jsonSize, Json) || !Json.IsObject())
+            return false;
+
+         //Chunks are 4 byte aligned, BIN is optional and always follows the JSON
+         const size_t binHeader = (jsonOffset + jsonSize + 3) & ~size_t(3);
+
+         if (binHeader + ChunkHeaderSize <= length && ReadUint32(data + binHeader + 4) == ChunkBin)
+         {
+            const size_t binSize = ReadUint32(data + binHeader);
+
+            if (binSize > length - binHeader - ChunkHeaderSize)
+               return false;
+
+            Bin = data + binHeader + ChunkHeaderSize;
+            BinSize = binSize;
+         }
+
+         return true;
+      }
+
+      bool GlbDocument::GetAccessor(const size_t index, AccessorView& res) const
+      {
+         const JsonValue* accessor = GetElement(Json, "accessors", static_cast<int64_t>(index));
+         if (!accessor || accessor->Find("sparse"))
+            return false;
+
+         const JsonValue* bufferView = GetElement(Json, "bufferViews", accessor->GetIndex("bufferView"));
+         if (!bufferView)
+            return false;
+
+         //Buffer 0 without the uri is the BIN chunk, the others are the external files
+         const int64_t bufferIndex = bufferView->GetIndex("buffer");
+         const JsonValue* buffer = GetElement(Json, "buffers", bufferIndex);
+
+         if (!buffer || bufferIndex != 0 || buffer->Find("uri") || !Bin)
+            return false;
+
+         const JsonValue* type = accessor->Find("type");
+         if (!type || type->Type != JsonType::String)
+            return false;
+
+         res.Component = static_cast<ComponentType>(accessor->GetIndex("componentType"));
+         res.Components = GetComponentsCount(type->String);
+
+         const JsonValue* normalized = accessor->Find("normalized");
+         res.IsNormalized = normalized && normalized->Type == JsonType::Bool && normalized->Bool;
+
+         const size_t elementSize = GetComponentSize(res.Component) * res.Components;
+
+         const int64_t count = accessor->GetIndex("count");
+         const int64_t offset = GetOptionalIndex(*accessor, "byteOffset", 0);
+
+         const int64_t viewOffset = GetOptionalIndex(*bufferView, "byteOffset", 0);
+         const int64_t viewSize = bufferView->GetIndex("byteLength");
+         const int64_t stride = GetOptionalIndex(*bufferView, "byteStride", static_cast<int64_t>(elementSize));
+
+         if (elementSize == 0 || count < 0 || offset < 0 || viewOffset < 0 || viewSize < 0
+             || stride < static_cast<int64_t>(elementSize) || stride > MaxStride)
+         {
+            return false;
+         }
+
+         if (static_cast<uint64_t>(viewOffset) > BinSize || static_cast<uint64_t>(viewSize) > BinSize - viewOffset)
+            return false;
+
+         //Count is checked by the division, so the hostile one can't overflow the size of the elements
+         if (count > 0)
+         {
+            if (offset > viewSize || static_cast<uint64_t>(viewSize - offset) < elementSize)
+               return false;
+
+            const uint64_t available = static_cast<uint64_t>(viewSize - offset) - elementSize;
+
+            if (static_cast<uint64_t>(count - 1) > available / static_cast<uint64_t>(stride))
+               return false;
+         }
+
+         res.Data = Bin + viewOffset + offset;
+         res.Count = static_cast<size_t>(count);
+         res.Stride = static_cast<size_t>(stride);
+
+         return true;
+      }
+
+      static float ReadComponent(const uint8_t* data, const ComponentType component, const bool isNormalized)
+      {
+         switch (component)
+         {
+         case ComponentType::Byte:
+            {
+               int8_t value;
+               memcpy(&value, data, sizeof(value));
+               return isNormalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+         case ComponentType::Ubyte:
+            {
+               return isNormalized ? data[0] / 255.0f : data[0];
+            }
+         case ComponentType::Short:
+            {
+               int16_t value;
+               memcpy(&value, data, sizeof(value));
+               return isNormalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+         case ComponentType::Ushort:
+            {
+               uint16_t value;
+               memcpy(&value, data, sizeof(value));
+               return isNormalized ? value / 65535.0f : value;
+            }
+         case ComponentType::Uint:
+            {
+               uint32_t value;
+               memcpy(&value, data, sizeof(value));
+               return static_cast<float>(value);
+            }
+         case ComponentType::Float:
+            {
+               float value;
+               memcpy(&value, data, sizeof(value));
+               return value;
+            }
+         }
+
+         return 0.0f;
+      }
+
+      void ReadFloats(const AccessorView& view, const uint8_t components, float* res)
+      {
+         const size_t componentSize = GetComponentSize(view.Component);
+         const uint8_t readComponents = std::min(components, view.Components);
+
+         for (size_t i = 0; i < view.Count; ++i)
+         {
+            const uint8_t* element = view.Data + i * view.Stride;
+
+            for (uint8_t c = 0; c < components; ++c)
+               res[i * components + c] = c < readComponents ? ReadComponent(element + c * componentSize, view.Component, view.IsNormalized) : 0.0f;
+         }
+      }
+
+      bool ReadIndices(const AccessorView& view, uint32_t* res)
+      {
+         if (view.Components != 1 || view.IsNormalized)
+            return false;
+
+         switch (view.Component)
+         {
+         case ComponentType::Ubyte:
+            {
+               for (size_t i = 0; i < view.Count; ++i)
+                  res[i] = view.Data[i * view.Stride];
+            }break;
+         case ComponentType::Ushort:
+            {
+               for (size_t i = 0; i < view.Count; ++i)
+               {
+                  uint16_t index;
+                  memcpy(&index, view.Data + i * view.Stride, sizeof(index));
+                  res[i] = index;
+               }
+            }break;
+         case ComponentType::Uint:
+            {
+               for (size_t i = 0; i < view.Count; ++i)
+                  memcpy(res + i, view.Data + i * view.Stride, sizeof(uint32_t));
+            }break;
+         default:
+            return false;
+         }
+
+         return true;
+      }
+
+      //Column major as the glTF stores it
+      struct Transform
+      {
+         float M[16] = { 1.0f, 0.0f, 0.0f, 0.0f,
+                         0.0f, 1.0f, 0.0f, 0.0f,
+                         0.0f, 0.0f, 1.0f, 0.0f,
+                         0.0f, 0.0f, 0.0f, 1.0f };
+
+         inline mm::vec3 GetColumn(const size_t column) const
+         {
+            return mm::vec3(M[column * 4], M[column * 4 + 1], M[column * 4 + 2]);
+         }
+
+         inline mm::vec3 TransformPoint(const mm::vec3& p) const
+         {
+            return GetColumn(0) * p.x + GetColumn(1) * p.y + GetColumn(2) * p.z + GetColumn(3);
+         }
+      };
+
+      static Transform Multiply(const Transform& left, const Transform& right)
+      {
+         Transform res;
+
+         for (size_t column = 0; column < 4; ++column)
+         {
+            for (size_t row = 0; row < 4; ++row)
+            {
+               float sum = 0.0f;
+               for (size_t i = 0; i < 4; ++i)
+                  sum += left.M[i * 4 + row] * right.M[column * 4 + i];
+
+               res.M[column * 4 + row] = sum;
+            }
+         }
+
+         return res;
+      }
+
+      //Either the matrix or the translation, rotation and scale, the missing ones are the identity
+      static Transform GetLocalTransform(const JsonValue& node)
+      {
+         Transform res;
+
+         const JsonValue* matrix = node.Find("matrix");
+         if (matrix && matrix->IsArray() && matrix->Elements.size() == 16)
+         {
+            for (size_t i = 0; i < 16; ++i)
+               res.M[i] = static_cast<float>(matrix->Elements[i].Number);
+
+            return res;
+         }
+
+         float t[3] = { 0.0f, 0.0f, 0.0f };
+         float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+         float s[3] = { 1.0f, 1.0f, 1.0f };
+
+         auto readArray = [&node](const std::string_view& key, float* values, const size_t count)
+         {
+            const JsonValue* array = node.Find(key);
+            if (!array || !array->IsArray() || array->Elements.size() != count)
+               return;
+
+            for (size_t i = 0; i < count; ++i)
+               values[i] = static_cast<float>(array->Elements[i].Number);
+         };
+
+         readArray("translation", t, 3);
+         readArray("rotation", r, 4);
+         readArray("scale", s, 3);
+
+         const float x = r[0], y = r[1], z = r[2], w = r[3];
+
+         const float rotation[9] = { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w),
+                                     2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w),
+                                     2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) };
+
+         for (size_t column = 0; column < 3; ++column)
+         {
+            for (size_t row = 0; row < 3; ++row)
+               res.M[column * 4 + row] = rotation[column * 3 + row] * s[column];
+         }
+
+         res.M[12] = t[0];
+         res.M[13] = t[1];
+         res.M[14] = t[2];
+
+         return res;
+      }
+
+      struct PrimitiveAccessors
+      {
+         AccessorView Positions;
+         AccessorView Normals;
+         AccessorView UVs;
+         AccessorView Indices;
+
+         bool HasNormals = false;
+         bool HasUVs = false;
+         bool HasIndices = false;
+      };
+
+      //Every accessor of the primitive is checked before anything is written, so the invalid primitive is skipped whole
+      static bool GetPrimitiveAccessors(const GlbDocument& document, const JsonValue& primitive, PrimitiveAccessors& res)
+      {
+         if (GetOptionalIndex(primitive, "mode", ModeTriangles) != ModeTriangles)
+            return false;
+
+         const JsonValue* attributes = primitive.Find("attributes");
+         if (!attributes || !attributes->IsObject())
+            return false;
+
+         const int64_t positions = attributes->GetIndex("POSITION");
+         if (positions < 0 || !document.GetAccessor(positions, res.Positions)
+             || res.Positions.Component != ComponentType::Float || res.Positions.Components != 3)
+         {
+            return false;
+         }
+
+         const size_t verticesCount = res.Positions.Count;
+
+         const int64_t normals = GetOptionalIndex(*attributes, "NORMAL", -2);
+         const int64_t uvs = GetOptionalIndex(*attributes, "TEXCOORD_0", -2);
+         const int64_t indices = GetOptionalIndex(primitive, "indices", -2);
+
+         res.HasNormals = normals != -2;
+         res.HasUVs = uvs != -2;
+         res.HasIndices = indices != -2;
+
+         if (res.HasNormals && (normals < 0 || !document.GetAccessor(normals, res.Normals) || res.Normals.Count != verticesCount))
+            return false;
+
+         if (res.HasUVs && (uvs < 0 || !document.GetAccessor(uvs, res.UVs) || res.UVs.Count != verticesCount))
+            return false;
+
+         if (res.HasIndices && (indices < 0 || !document.GetAccessor(indices, res.Indices) || res.Indices.Components != 1
+                                || res.Indices.IsNormalized || res.Indices.Component == ComponentType::Byte
+                                || res.Indices.Component == ComponentType::Short || res.Indices.Component == ComponentType::Float))
+         {
+            return false;
+         }
+
+         return true;
+      }
+
+      static void ImportPrimitive(const PrimitiveAccessors& accessors, const Transform& transform, GlbMesh& res)
+      {
+         const size_t baseVertex = res.Positions.size();
+         const size_t verticesCount = accessors.Positions.Count;
+
+         res.Positions.resize(baseVertex + verticesCount);
+         res.Normals.resize(baseVertex + verticesCount);
+         res.UVs.resize(baseVertex + verticesCount);
+
+         mm::vec3* positions = res.Positions.data() + baseVertex;
+         mm::vec3* normals = res.Normals.data() + baseVertex;
+         mm::vec2* uvs = res.UVs.data() + baseVertex;
+
+         Span<mm::vec3> positionsSpan;
+         if (GetSpan(accessors.Positions, ComponentType::Float, 3, positionsSpan))
+         {
+            for (size_t i = 0; i < verticesCount; ++i)
+               positions[i] = transform.TransformPoint(positionsSpan.Data[i]);
+         }
+         else
+         {
+            ReadFloats(accessors.Positions, 3, &positions[0].x);
+
+            for (size_t i = 0; i < verticesCount; ++i)
+               positions[i] = transform.TransformPoint(positions[i]);
+         }
+
+         if (accessors.HasUVs)
+         {
+            Span<mm::vec2> uvsSpan;
+            if (GetSpan(accessors.UVs, ComponentType::Float, 2, uvsSpan))
+               std::copy(uvsSpan.Data, uvsSpan.Data + verticesCount, uvs);
+            else
+               ReadFloats(accessors.UVs, 2, &uvs[0].x);
+
+            for (size_t i = 0; i < verticesCount; ++i)
+               uvs[i].y = 1.0f - uvs[i].y;
+         }
+
+         //Mirroring transforms flip the winding, the triangles are reversed to keep them front facing
+         const mm::vec3 a = transform.GetColumn(0);
+         const mm::vec3 b = transform.GetColumn(1);
+         const mm::vec3 c = transform.GetColumn(2);
+
+         const float determinant = mm::dot(a, mm::cross(b, c));
+
+         const size_t baseIndex = res.Indices.size();
+         size_t indicesCount = accessors.HasIndices ? accessors.Indices.Count : verticesCount;
+         indicesCount -= indicesCount % 3;
+
+         res.Indices.resize(baseIndex + indicesCount);
+         uint32_t* indices = res.Indices.data() + baseIndex;
+
+         if (accessors.HasIndices)
+         {
+            Span<uint32_t> indicesSpan;
+            if (GetSpan(accessors.Indices, ComponentType::Uint, 1, indicesSpan))
+               std::copy(indicesSpan.Data, indicesSpan.Data + indicesCount, indices);
+            else
+            {
+               AccessorView view = accessors.Indices;
+               view.Count = indicesCount;
+
+               ReadIndices(view, indices);
+            }
+         }
+         else
+         {
+            for (size_t i = 0; i < indicesCount; ++i)
+               indices[i] = static_cast<uint32_t>(i);
+         }
+
+         //Out of range indices make the whole triangle degenerate instead of failing the file
+         for (size_t i = 0; i < indicesCount; i += 3)
+         {
+            if (indices[i] >= verticesCount || indices[i + 1] >= verticesCount || indices[i + 2] >= verticesCount)
+               indices[i] = indices[i + 1] = indices[i + 2] = 0;
+
+            if (determinant < 0.0f)
+               std::swap(indices[i + 1], indices[i + 2]);
+         }
+
+         if (accessors.HasNormals)
+         {
+            ReadFloats(accessors.Normals, 3, &normals[0].x);
+
+            //Inverse transpose of the 3x3 part is the cofactor matrix divided by the determinant
+            const mm::vec3 cofactors[3] = { mm::cross(b, c), mm::cross(c, a), mm::cross(a, b) };
+            const float sign = determinant < 0.0f ? -1.0f : 1.0f;
+
+            for (size_t i = 0; i < verticesCount; ++i)
+            {
+               const mm::vec3 normal = (cofactors[0] * normals[i].x + cofactors[1] * normals[i].y + cofactors[2] * normals[i].z) * sign;
+               const float length = mm::length(normal);
+
+               normals[i] = length > 0.0f ? normal / length : mm::vec3(0.0f, 0.0f, 1.0f);
+            }
+         }
+         else
+         {
+            //Flat shaded primitives have no normals, the area weighted ones of the shared vertices are close enough
+            for (size_t i = 0; i < indicesCount; i += 3)
+            {
+               const mm::vec3 normal = mm::cross(positions[indices[i + 1]] - positions[indices[i]], positions[indices[i + 2]] - positions[indices[i]]);
+
+               for (size_t j = 0; j < 3; ++j)
+                  normals[indices[i + j]] = normals[indices[i + j]] + normal;
+            }
+
+            for (size_t i = 0; i < verticesCount; ++i)
+            {
+               const float length = mm::length(normals[i]);
+               normals[i] = length > 0.0f ? normals[i] / length : mm::vec3(0.0f, 0.0f, 1.0f);
+            }
+         }
+
+         for (size_t i = 0; i < indicesCount; ++i)
+            indices[i] += static_cast<uint32_t>(baseVertex);
+      }
+
+      static void ImportNodeMesh(const GlbDocument& document, const JsonValue& mesh, const Transform& transform, GlbMesh& res)
+      {
+         const JsonValue* primitives = mesh.Find("primitives");
+         if (!primitives || !primitives->IsArray())
+            return;
+
+         for (auto& primitive : primitives->Elements)
+         {
+            PrimitiveAccessors accessors;
+
+            if (!primitive.IsObject() || !GetPrimitiveAccessors(document, primitive, accessors))
+            {
+               ++res.SkippedPrimitives;
+               continue;
+            }
+
+            ImportPrimitive(accessors, transform, res);
+         }
+      }
+
+      bool ImportGlb(const uint8_t* data, const size_t size, GlbMesh& res)
+      {
+         res = GlbMesh();
+
+         GlbDocument document;
+         if (!document.Open(data, size))
+            return false;
+
+         const JsonValue& json = document.GetJson();
+
+         const JsonValue* nodes = json.Find("nodes");
+         if (!nodes || !nodes->IsArray())
+            return false;
+
+         const size_t nodesCount = nodes->Elements.size();
+
+         std::vector<int64_t> roots;
+
+         const JsonValue* scene = GetElement(json, "scenes", GetOptionalIndex(json, "scene", 0));
+         const JsonValue* sceneNodes = scene ? scene->Find("nodes") : nullptr;
+
+         if (sceneNodes && sceneNodes->IsArray())
+         {
+            for (auto& node : sceneNodes->Elements)
+               roots.push_back(node.GetIndex());
+         }
+         else
+         {
+            std::vector<bool> isChild(nodesCount, false);
+
+            for (auto& node : nodes->Elements)
+            {
+               const JsonValue* children = node.Find("children");
+               if (!children || !children->IsArray())
+                  continue;
+
+               for (auto& child : children->Elements)
+               {
+                  const int64_t index = child.GetIndex();
+
+                  if (index >= 0 && static_cast<size_t>(index) < nodesCount)
+                     isChild[index] = true;
+               }
+            }
+
+            for (size_t i = 0; i < nodesCount; ++i)
+            {
+               if (!isChild[i])
+                  roots.push_back(static_cast<int64_t>(i));
+            }
+         }
+
+         //Nodes are the forest, every one is visited once even if the file says otherwise
+         std::vector<bool> isVisited(nodesCount, false);
+         std::vector<std::pair<int64_t, Transform>> stack;
+
+         for (auto root : roots)
+            stack.emplace_back(root, Transform());
+
+         while (!stack.empty())
+         {
+            const auto [index, parent] = stack.back();
+            stack.pop_back();
+
+            const JsonValue* node = GetElement(json, "nodes", index);
+            if (!node || isVisited[index])
+               continue;
+
+            isVisited[index] = true;
+
+            const Transform transform = Multiply(parent, GetLocalTransform(*node));
+
+            if (const JsonValue* mesh = GetElement(json, "meshes", node->GetIndex("mesh")))
+               ImportNodeMesh(document, *mesh, transform, res);
+
+            const JsonValue* children = node->Find("children");
+            if (!children || !children->IsArray())
+               continue;
+
+            for (auto& child : children->Elements)
+               stack.emplace_back(child.GetIndex(), transform);
+         }
+
+         return !res.Indices.empty();
+      }
+   }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "math/math.h"
+#include "json-reader.h"
+
+//Binary glTF 2.0 importer
+//
+//The file is used in place: the JSON chunk is parsed into the views of its text and the accessors point into the BIN chunk,
+//so the buffers are read straight from the mapping. Only the accessors whose layout differs from the engine one are converted
+//
+//Triangle primitives of every node of the scene are merged into the single indexed mesh, the node transforms are applied to the vertices
+//Materials, images, skins and animations are ignored
+
+namespace assets
+{
+   namespace gltf
+   {
+      enum class ComponentType : uint16_t
+      {
+         Byte = 5120,
+         Ubyte = 5121,
+         Short = 5122,
+         Ushort = 5123,
+         Uint = 5125,
+         Float = 5126
+      };
+
+      //Elements of the accessor in the BIN chunk, Stride is never 0
+      struct AccessorView
+      {
+         const uint8_t* Data = nullptr;
+         size_t Count = 0;
+         size_t Stride = 0;
+
+         ComponentType Component = ComponentType::Float;
+         uint8_t Components = 0;
+         bool IsNormalized = false;
+      };
+
+      //Typed elements that are read without the conversion
+      template<typename T>
+      struct Span
+      {
+         const T* Data = nullptr;
+         size_t Count = 0;
+      };
+
+      class GlbDocument
+      {
+      private:
+         JsonValue Json;
+
+         const uint8_t* Bin = nullptr;
+         size_t BinSize = 0;
+      public:
+         //Data must outlive the document, nothing is copied out of it
+         bool Open(const uint8_t* data, const size_t size);
+
+         inline const JsonValue& GetJson() const
+         {
+            return Json;
+         }
+
+         //Accessors of the external or the sparse buffers aren't supported, neither are the accessors out of the BIN chunk bounds
+         bool GetAccessor(const size_t index, AccessorView& res) const;
+      };
+
+      //Succeeds only when the elements are tightly packed T, e.g. the float vec3 for mm::vec3
+      template<typename T>
+      inline bool GetSpan(const AccessorView& view, const ComponentType component, const uint8_t components, Span<T>& res)
+      {
+         if (view.Component != component || view.Components != components || view.IsNormalized || view.Stride != sizeof(T)
+             || reinterpret_cast<uintptr_t>(view.Data) % alignof(T) != 0)
+         {
+            return false;
+         }
+
+         res.Data = reinterpret_cast<const T*>(view.Data);
+         res.Count = view.Count;
+
+         return true;
+      }
+
+      //First min(components, view.Components) components of every element as floats, normalized integers are mapped to [0, 1] or [-1, 1]
+      void ReadFloats(const AccessorView& view, const uint8_t components, float* res);
+
+      //Scalar unsigned integer accessors only
+      bool ReadIndices(const AccessorView& view, uint32_t* res);
+
+      struct GlbMesh
+      {
+         std::vector<mm::vec3> Positions;
+
+         std::vector<mm::vec3> Normals;
+
+         //Flipped to the bottom left origin of the engine textures
+         std::vector<mm::vec2> UVs;
+
+         std::vector<uint32_t> Indices;
+
+         //Non triangle or invalid primitives
+         size_t SkippedPrimitives = 0;
+      };
+
+      //Nodes of the default scene are traversed, the files without the scenes use all the root nodes
+      bool ImportGlb(const uint8_t* data, const size_t size, GlbMesh& res);
+   }
+}
@@ -0,0 +1,199 @@
+#include "json-reader.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace assets
+{
+   namespace gltf
+   {
+      constexpr size_t MaxJsonDepth = 64;
+
+      class JsonParser
+      {
+      private:
+         const char* Ptr;
+         const char* End;
+
+         inline void SkipSpaces()
+         {
+            while (Ptr < End && (*Ptr == ' ' || *Ptr == '\t' || *Ptr == '\r' || *Ptr == '\n'))
+               ++Ptr;
+         }
+
+         inline bool Skip(const char c)
+         {
+            SkipSpaces();
+
+            if (Ptr >= End || *Ptr != c)
+               return false;
+
+            ++Ptr;
+            return true;
+         }
+
+         inline bool SkipLiteral(const std::string_view& literal)
+         {
+            if (static_cast<size_t>(End - Ptr) < literal.size() || std::string_view(Ptr, literal.size()) != literal)
+               return false;
+
+            Ptr += literal.size();
+            return true;
+         }
+
+         bool ParseString(std::string_view& res)
+         {
+            if (!Skip('"'))
+               return false;
+
+            const char* begin = Ptr;
+
+            for (; Ptr < End && *Ptr != '"'; ++Ptr)
+            {
+               if (*Ptr == '\\' && ++Ptr == End)
+                  return false;
+            }
+
+            if (Ptr == End)
+               return false;
+
+            res = std::string_view(begin, Ptr - begin);
+            ++Ptr;
+
+            return true;
+         }
+      public:
+         inline JsonParser(const char* text, const size_t size)
+            : Ptr(text), End(text + size) {}
+
+         inline bool IsEnd()
+         {
+            SkipSpaces();
+            return Ptr == End;
+         }
+
+         bool ParseValue(JsonValue& res, const size_t depth)
+         {
+            if (depth > MaxJsonDepth)
+               return false;
+
+            SkipSpaces();
+
+            if (Ptr == End)
+               return false;
+
+            switch (*Ptr)
+            {
+            case '{':
+               {
+                  ++Ptr;
+                  res.Type = JsonType::Object;
+
+                  if (Skip('}'))
+                     return true;
+
+                  do
+                  {
+                     auto& member = res.Members.emplace_back();
+
+                     if (!ParseString(member.first) || !Skip(':') || !ParseValue(member.second, depth + 1))
+                        return false;
+                  } while (Skip(','));
+
+                  return Skip('}');
+               }
+            case '[':
+               {
+                  ++Ptr;
+                  res.Type = JsonType::Array;
+
+                  if (Skip(']'))
+                     return true;
+
+                  do
+                  {
+                     if (!ParseValue(res.Elements.emplace_back(), depth + 1))
+                        return false;
+                  } while (Skip(','));
+
+                  return Skip(']');
+               }
+            case '"':
+               {
+                  res.Type = JsonType::String;
+                  return ParseString(res.String);
+               }
+            case 't':
+               {
+                  res.Type = JsonType::Bool;
+                  res.Bool = true;
+                  return SkipLiteral("true");
+               }
+            case 'f':
+               {
+                  res.Type = JsonType::Bool;
+                  return SkipLiteral("false");
+               }
+            case 'n':
+               {
+                  return SkipLiteral("null");
+               }
+            default:
+               {
+                  res.Type = JsonType::Number;
+
+                  auto number = std::from_chars(Ptr, End, res.Number);
+                  if (number.ec != std::errc())
+                     return false;
+
+                  Ptr = number.ptr;
+                  return true;
+               }
+            }
+         }
+      };
+
+      const JsonValue* JsonValue::Find(const std::string_view& key) const
+      {
+         for (auto& member : Members)
+         {
+            if (member.first == key)
+               return &member.second;
+         }
+
+         return nullptr;
+      }
+
+      double JsonValue::GetNumber(const std::string_view& key, const double defaultValue) const
+      {
+         const JsonValue* value = Find(key);
+
+         return value && value->Type == JsonType::Number ? value->Number : defaultValue;
+      }
+
+      int64_t JsonValue::GetIndex() const
+      {
+         //Indices are bounded by the sizes of the arrays, so anything above 2^32 is invalid anyway
+         if (Type != JsonType::Number || !(Number >= 0.0 && Number <= 4294967295.0) || std::floor(Number) != Number)
+            return -1;
+
+         return static_cast<int64_t>(Number);
+      }
+
+      int64_t JsonValue::GetIndex(const std::string_view& key) const
+      {
+         const JsonValue* value = Find(key);
+
+         return value ? value->GetIndex() : -1;
+      }
+
+      bool ParseJson(const char* text, const size_t size, JsonValue& res)
+      {
+         res = JsonValue();
+
+         JsonParser parser(text, size);
+
+         return parser.ParseValue(res, 0) && parser.IsEnd();
+      }
+   }
+}
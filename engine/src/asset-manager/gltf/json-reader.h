@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string_view>
+#include <utility>
+
+//Minimal JSON reader for the glTF documents
+//
+//Strings are the views into the source text with the escapes kept as is, glTF keys and enums never have them
+//so the source text must outlive the values
+
+namespace assets
+{
+   namespace gltf
+   {
+      enum class JsonType : uint8_t
+      {
+         Null,
+         Bool,
+         Number,
+         String,
+         Array,
+         Object
+      };
+
+      class JsonValue
+      {
+      public:
+         JsonType Type = JsonType::Null;
+
+         bool Bool = false;
+
+         double Number = 0.0;
+
+         std::string_view String;
+
+         std::vector<JsonValue> Elements;
+
+         std::vector<std::pair<std::string_view, JsonValue>> Members;
+
+         //Null when the value isn't the object or doesn't have the key
+         const JsonValue* Find(const std::string_view& key) const;
+
+         inline bool IsArray() const
+         {
+            return Type == JsonType::Array;
+         }
+
+         inline bool IsObject() const
+         {
+            return Type == JsonType::Object;
+         }
+
+         //Member of the object if it is the number, otherwise the defaultValue
+         double GetNumber(const std::string_view& key, const double defaultValue) const;
+
+         //Value itself or the member of the object if it is the non negative integer, otherwise -1
+         int64_t GetIndex() const;
+
+         int64_t GetIndex(const std::string_view& key) const;
+      };
+
+      //Whole text must be the single value, nesting deeper than 64 levels is rejected
+      bool ParseJson(const char* text, const size_t size, JsonValue& res);
+   }
+}
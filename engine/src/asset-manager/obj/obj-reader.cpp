@@ -0,0 +1,342 @@
+#include "obj-reader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <memory>
+
+namespace assets
+{
+   namespace obj
+   {
+      constexpr uint32_t NoCorner = UINT32_MAX;
+
+      //Tokenizer over the single line, the text isn't null terminated
+      class TextReader
+      {
+      private:
+         const char* Ptr;
+         const char* End;
+      public:
+         inline TextReader(const char* begin, const char* end)
+            : Ptr(begin), End(end) {}
+
+         inline void SkipSpaces()
+         {
+            while (Ptr < End && (*Ptr == ' ' || *Ptr == '\t' || *Ptr == '\r'))
+               ++Ptr;
+         }
+
+         inline std::string_view ReadToken()
+         {
+            SkipSpaces();
+
+            const char* begin = Ptr;
+            while (Ptr < End && *Ptr != ' ' && *Ptr != '\t' && *Ptr != '\r')
+               ++Ptr;
+
+            return std::string_view(begin, Ptr - begin);
+         }
+
+         template<typename T>
+         inline bool Read(T& value)
+         {
+            SkipSpaces();
+
+            auto res = std::from_chars(Ptr, End, value);
+            if (res.ec != std::errc())
+               return false;
+
+            Ptr = res.ptr;
+            return true;
+         }
+
+         inline bool Skip(const char c)
+         {
+            if (Ptr >= End || *Ptr != c)
+               return false;
+
+            ++Ptr;
+            return true;
+         }
+      };
+
+      ObjReader::ObjReader(const size_t memoryLimit, const size_t extraBytes)
+         : MemoryLimit(memoryLimit), ExtraBytes(extraBytes), PeakBytes(extraBytes) {}
+
+      //Grows by 1.5, the new storage is counted together with the old one as both of them exist during the copy
+      //Near the limit the growth is cut to what still fits
+      template<typename T>
+      bool ObjReader::Push(std::vector<T>& vector, const T& value)
+      {
+         if (vector.size() == vector.capacity())
+         {
+            const size_t capacity = vector.capacity();
+            size_t newCapacity = std::max<size_t>(capacity + capacity / 2, 64);
+
+            if (MemoryLimit)
+            {
+               const size_t available = MemoryLimit - std::min(MemoryLimit, UsedBytes + ExtraBytes + Carry.capacity());
+               newCapacity = std::min(newCapacity, available / sizeof(T));
+
+               if (newCapacity <= capacity)
+               {
+                  Error = "OBJ import exceeds the memory limit";
+                  return false;
+               }
+            }
+
+            vector.reserve(newCapacity);
+
+            PeakBytes = std::max(PeakBytes, UsedBytes + ExtraBytes + Carry.capacity() + vector.capacity() * sizeof(T));
+            UsedBytes += (vector.capacity() - capacity) * sizeof(T);
+         }
+
+         vector.push_back(value);
+         return true;
+      }
+
+      //Line cut by the window is kept whole, so the long line is bounded by the limit like the vectors
+      bool ObjReader::AppendCarry(const char* begin, const char* end)
+      {
+         const size_t size = Carry.size() + (end - begin);
+
+         if (size > Carry.capacity())
+         {
+            const size_t capacity = Carry.capacity();
+            size_t newCapacity = std::max(size, capacity + capacity / 2);
+
+            if (MemoryLimit)
+            {
+               const size_t available = MemoryLimit - std::min(MemoryLimit, UsedBytes + ExtraBytes + capacity);
+               newCapacity = std::min(newCapacity, available);
+
+               if (newCapacity < size)
+               {
+                  Error = "OBJ line exceeds the memory limit";
+                  return false;
+               }
+            }
+
+            Carry.reserve(newCapacity);
+            PeakBytes = std::max(PeakBytes, UsedBytes + ExtraBytes + capacity + Carry.capacity());
+         }
+
+         Carry.append(begin, end);
+         return true;
+      }
+
+      bool ObjReader::ParseLine(const char* begin, const char* end)
+      {
+         TextReader reader(begin, end);
+
+         const std::string_view header = reader.ReadToken();
+
+         if (header == "v")
+         {
+            mm::vec3 v;
+            if (!(reader.Read(v.x) && reader.Read(v.y) && reader.Read(v.z)))
+            {
+               Error = "Invalid vertex attribute in the trig model";
+               return false;
+            }
+
+            return Push(SourcePositions, v) && Push(CornerHeads, NoCorner);
+         }
+         else if (header == "vn")
+         {
+            mm::vec3 v;
+            if (!(reader.Read(v.x) && reader.Read(v.y) && reader.Read(v.z)))
+            {
+               Error = "Invalid vertex attribute in the trig model";
+               return false;
+            }
+
+            return Push(SourceNormals, v);
+         }
+         else if (header == "vt")
+         {
+            mm::vec2 v;
+            if (!(reader.Read(v.x) && reader.Read(v.y)))
+            {
+               Error = "Invalid vertex attribute in the trig model";
+               return false;
+            }
+
+            return Push(SourceUVs, v);
+         }
+         else if (header == "f")
+         {
+            for (size_t i = 0; i < 3; ++i)
+            {
+               uint32_t p, t, n;
+
+               if (!(reader.Read(p) && reader.Skip('/')
+                     && reader.Read(t) && reader.Skip('/')
+                     && reader.Read(n)))
+               {
+                  Error = "Only triangulated faces with positions, uvs and normals are supported";
+                  return false;
+               }
+
+               if (p == 0 || p > SourcePositions.size()
+                   || t == 0 || t > SourceUVs.size()
+                   || n == 0 || n > SourceNormals.size())
+               {
+                  Error = "Face references undefined vertex";
+                  return false;
+               }
+
+               --p;
+               --t;
+               --n;
+
+               uint32_t vertex = CornerHeads[p];
+               while (vertex != NoCorner && (Corners[vertex].UV != t || Corners[vertex].Normal != n))
+                  vertex = Corners[vertex].Next;
+
+               if (vertex == NoCorner)
+               {
+                  vertex = static_cast<uint32_t>(Mesh.Positions.size());
+
+                  if (vertex == NoCorner)
+                  {
+                     Error = "Trig model has too many vertices";
+                     return false;
+                  }
+
+                  if (!(Push(Mesh.Positions, SourcePositions[p]) && Push(Mesh.Normals, SourceNormals[n]) && Push(Mesh.UVs, SourceUVs[t])
+                        && Push(Corners, Corner{ CornerHeads[p], t, n })))
+                  {
+                     return false;
+                  }
+
+                  CornerHeads[p] = vertex;
+               }
+
+               if (!Push(Mesh.Indices, vertex))
+                  return false;
+            }
+         }
+
+         return true;
+      }
+
+      bool ObjReader::Feed(const char* data, const size_t size)
+      {
+         if (Error)
+            return false;
+
+         const char* ptr = data;
+         const char* end = data + size;
+
+         //Line cut by the previous window is completed first
+         if (!Carry.empty())
+         {
+            const char* lineEnd = static_cast<const char*>(memchr(ptr, '\n', size));
+
+            if (!AppendCarry(ptr, lineEnd ? lineEnd : end))
+               return false;
+
+            if (!lineEnd)
+               return true;
+
+            if (!ParseLine(Carry.data(), Carry.data() + Carry.size()))
+               return false;
+
+            Carry.clear();
+            ptr = lineEnd + 1;
+         }
+
+         while (ptr < end)
+         {
+            const char* lineEnd = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+
+            if (!lineEnd)
+               return AppendCarry(ptr, end);
+
+            if (!ParseLine(ptr, lineEnd))
+               return false;
+
+            ptr = lineEnd + 1;
+         }
+
+         return true;
+      }
+
+      bool ObjReader::Finish(ObjMesh& res)
+      {
+         if (!Error && !Carry.empty())
+            ParseLine(Carry.data(), Carry.data() + Carry.size());
+
+         if (Error)
+            return false;
+
+         res = std::move(Mesh);
+
+         SourcePositions = {};
+         SourceNormals = {};
+         SourceUVs = {};
+         CornerHeads = {};
+         Corners = {};
+         Mesh = ObjMesh();
+         Carry = {};
+         UsedBytes = 0;
+
+         return true;
+      }
+
+      bool ReadObjFile(const std::string_view& filepath, const ObjReadParams& params, ObjMesh& res, size_t& peakBytes, const char*& error)
+      {
+         peakBytes = 0;
+         error = nullptr;
+
+         const std::string path(filepath); //Path must be null terminated
+
+         FILE* file = fopen(path.c_str(), "rb");
+         if (!file)
+         {
+            error = "Couldn't open the file";
+            return false;
+         }
+
+         const size_t windowSize = std::max<size_t>(params.WindowSize, 1);
+         std::unique_ptr<char[]> window(new char[windowSize]);
+
+         ObjReader reader(params.MemoryLimit, windowSize);
+
+         bool isRead = true;
+
+         while (isRead)
+         {
+            const size_t size = fread(window.get(), 1, windowSize, file);
+
+            if (size < windowSize)
+            {
+               isRead = false;
+
+               if (ferror(file))
+               {
+                  fclose(file);
+
+                  error = "Couldn't read the file";
+                  return false;
+               }
+            }
+
+            if (!reader.Feed(window.get(), size))
+               break;
+         }
+
+         fclose(file);
+
+         const bool isFinished = reader.Finish(res);
+
+         peakBytes = reader.GetPeakBytes();
+         error = reader.GetError();
+
+         return isFinished;
+      }
+   }
+}
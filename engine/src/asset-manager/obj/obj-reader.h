@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "math/math.h"
+
+//Incremental OBJ parser for the scans that don't fit into memory several times
+//
+//Text is fed by the windows of any size, only the line cut by the window end is copied. Face corners are welded by their
+//position/UV/normal indices as they are read, so the result is the indexed mesh without the intermediate triangle soup
+//
+//Memory is the source attributes, the welded vertices, the indices and 16 bytes of the weld links per vertex. Every growth
+//is checked against the limit before it is done, so the peak of the reader never exceeds it
+
+namespace assets
+{
+   namespace obj
+   {
+      struct ObjReadParams
+      {
+         //Bytes read from the file at once
+         size_t WindowSize = 4 * 1024 * 1024;
+
+         //Peak bytes of the reader including the window, 0 is unlimited
+         size_t MemoryLimit = 0;
+      };
+
+      struct ObjMesh
+      {
+         std::vector<mm::vec3> Positions;
+
+         std::vector<mm::vec3> Normals;
+
+         std::vector<mm::vec2> UVs;
+
+         std::vector<uint32_t> Indices;
+      };
+
+      class ObjReader
+      {
+      private:
+         //Welded vertices that are made of the same source position are linked into the list
+         struct Corner
+         {
+            uint32_t Next;
+            uint32_t UV;
+            uint32_t Normal;
+         };
+
+         std::vector<mm::vec3> SourcePositions;
+         std::vector<mm::vec3> SourceNormals;
+         std::vector<mm::vec2> SourceUVs;
+
+         std::vector<uint32_t> CornerHeads; //First welded vertex of every source position
+         std::vector<Corner> Corners;       //One per welded vertex
+
+         ObjMesh Mesh;
+
+         std::string Carry; //Last line of the window without its line break, it is counted in the limit
+
+         size_t MemoryLimit;
+         size_t ExtraBytes = 0; //Memory of the caller that is counted in the limit, e.g. the read window
+         size_t UsedBytes = 0;
+         size_t PeakBytes = 0;
+
+         const char* Error = nullptr;
+
+         template<typename T>
+         bool Push(std::vector<T>& vector, const T& value);
+
+         bool AppendCarry(const char* begin, const char* end);
+         bool ParseLine(const char* begin, const char* end);
+      public:
+         ObjReader(const size_t memoryLimit = 0, const size_t extraBytes = 0);
+
+         //Lines are parsed up to the last line break, the rest is kept until the next window
+         bool Feed(const char* data, const size_t size);
+
+         //Parses the last line and moves out the mesh, the reader is empty after it
+         bool Finish(ObjMesh& res);
+
+         inline size_t GetPeakBytes() const
+         {
+            return PeakBytes;
+         }
+
+         //Null until the first error, the reader ignores the input after it
+         inline const char* GetError() const
+         {
+            return Error;
+         }
+      };
+
+      //Reads the file by the windows, the file is never in memory whole
+      //Error is set to the reason of the failure, including the failure to open the file
+      bool ReadObjFile(const std::string_view& filepath, const ObjReadParams& params, ObjMesh& res, size_t& peakBytes, const char*& error);
+   }
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//Byte oriented LZ77 codec in the spirit of LZ4
+//Decompression speed is the priority, because archives are packed once and read every run
+//
+//Stream is the sequence of the blocks:
+//   token      - high nibble is literals count, low nibble is match length minus MinMatch
+//                value 15 in any nibble means that the length continues in the next bytes
+//   literals   - raw bytes
+//   offset     - 2 bytes little endian distance back to the match (absent in the last block)
+//   match len  - extended match length bytes
+//Extended lengths are sums of bytes, where each 255 means that one more byte follows
+
+namespace assets
+{
+   namespace lz
+   {
+      inline constexpr size_t MinMatch = 4;
+      inline constexpr size_t MaxOffset = 0xFFFF;
+
+      inline constexpr size_t HashBits = 14;
+
+      //Matches are not searched at the end of stream, so the last bytes are always literals
+      inline constexpr size_t LastLiterals = 5;
+
+      namespace internal
+      {
+         inline uint32_t Read32(const uint8_t* p)
+         {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+         }
+
+         inline uint32_t HashSequence(const uint32_t sequence)
+         {
+            return (sequence * 2654435761u) >> (32 - HashBits);
+         }
+
+         inline void WriteLength(std::vector<uint8_t>& dst, size_t length)
+         {
+            while (length >= 255)
+            {
+               dst.push_back(255);
+               length -= 255;
+            }
+
+            dst.push_back(static_cast<uint8_t>(length));
+         }
+
+         inline bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+         {
+            uint8_t b;
+            do
+            {
+               if (ip >= end)
+                  return false;
+
+               b = *ip++;
+               length += b;
+            } while (b == 255);
+
+            return true;
+         }
+
+         inline void EmitSequence(std::vector<uint8_t>& dst,
+                                  const uint8_t* literals, const size_t literalsCount,
+                                  const size_t offset, const size_t matchLength)
+         {
+            const size_t matchCode = matchLength ? matchLength - MinMatch : 0;
+
+            uint8_t token = static_cast<uint8_t>((literalsCount < 15 ? literalsCount : 15) << 4);
+            token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+            dst.push_back(token);
+
+            if (literalsCount >= 15)
+               WriteLength(dst, literalsCount - 15);
+
+            dst.insert(dst.end(), literals, literals + literalsCount);
+
+            if (!matchLength)
+               return;
+
+            dst.push_back(static_cast<uint8_t>(offset & 0xFF));
+            dst.push_back(static_cast<uint8_t>(offset >> 8));
+
+            if (matchCode >= 15)
+               WriteLength(dst, matchCode - 15);
+         }
+      }
+
+      //Greedy compressor with the single entry hash table
+      inline std::vector<uint8_t> Compress(const uint8_t* src, const size_t size)
+      {
+         std::vector<uint8_t> dst;
+         dst.reserve(size / 2 + 16);
+
+         std::vector<uint32_t> table(size_t(1) << HashBits, UINT32_MAX);
+
+         size_t ip = 0;
+         size_t anchor = 0;
+
+         const size_t matchLimit = size > LastLiterals ? size - LastLiterals : 0;
+
+         while (ip + MinMatch <= matchLimit)
+         {
+            const uint32_t sequence = internal::Read32(src + ip);
+            const uint32_t hash = internal::HashSequence(sequence);
+
+            const uint32_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(ip);
+
+            if (candidate == UINT32_MAX
+                || ip - candidate > MaxOffset
+                || internal::Read32(src + candidate) != sequence)
+            {
+               ++ip;
+               continue;
+            }
+
+            size_t matchLength = MinMatch;
+            while (ip + matchLength < matchLimit
+                   && src[candidate + matchLength] == src[ip + matchLength])
+            {
+               ++matchLength;
+            }
+
+            internal::EmitSequence(dst, src + anchor, ip - anchor, ip - candidate, matchLength);
+
+            ip += matchLength;
+            anchor = ip;
+         }
+
+         internal::EmitSequence(dst, src + anchor, size - anchor, 0, 0);
+
+         return dst;
+      }
+
+      //Returns false if the stream is corrupted or doesn't decode exactly to the dstSize bytes
+      inline bool Decompress(const uint8_t* src, const size_t srcSize, uint8_t* dst, const size_t dstSize)
+      {
+         const uint8_t* ip = src;
+         const uint8_t* const ipEnd = src + srcSize;
+
+         uint8_t* op = dst;
+         uint8_t* const opEnd = dst + dstSize;
+
+         while (ip < ipEnd)
+         {
+            const uint8_t token = *ip++;
+
+            size_t literalsCount = token >> 4;
+            if (literalsCount == 15 && !internal::ReadLength(ip, ipEnd, literalsCount))
+               return false;
+
+            if (literalsCount > static_cast<size_t>(ipEnd - ip)
+                || literalsCount > static_cast<size_t>(opEnd - op))
+            {
+               return false;
+            }
+
+            memcpy(op, ip, literalsCount);
+            ip += literalsCount;
+            op += literalsCount;
+
+            //Last block has only literals
+            if (ip == ipEnd)
+               break;
+
+            if (ipEnd - ip < 2)
+               return false;
+
+            const size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !internal::ReadLength(ip, ipEnd, matchLength))
+               return false;
+
+            matchLength += MinMatch;
+
+            if (offset == 0
+                || offset > static_cast<size_t>(op - dst)
+                || matchLength > static_cast<size_t>(opEnd - op))
+            {
+               return false;
+            }
+
+            //Match can overlap the output, so copy byte by byte
+            const uint8_t* match = op - offset;
+            for (size_t i = 0; i < matchLength; ++i)
+               op[i] = match[i];
+
+            op += matchLength;
+         }
+
+         return op == opEnd;
+      }
+   }
+}
@@ -0,0 +1,108 @@
+#include "pak-archive.h"
+
+#include <algorithm>
+
+#include "lz-codec.h"
+
+#include "debug/globals.h"
+
+namespace assets
+{
+   namespace pak
+   {
+      bool Archive::Mount(const std::string_view& filepath)
+      {
+         Path = filepath;
+
+         //Entries are read all over the archive, the read ahead of the whole file would only waste the memory
+         if (!File.Open(filepath, utils::FileAccess::Random))
+         {
+            LOG_WARNING("Couldn't open asset archive: %s (%s)", Path.c_str(), File.GetError().c_str());
+            return false;
+         }
+
+         if (File.GetSize() < sizeof(Header))
+         {
+            LOG_ERROR("Asset archive is too small: %s", Path.c_str());
+            return false;
+         }
+
+         const Header* header = reinterpret_cast<const Header*>(File.GetData());
+
+         if (header->Magic != Magic || header->Version != Version)
+         {
+            LOG_ERROR("Asset archive has invalid header or version: %s", Path.c_str());
+            return false;
+         }
+
+         const uint64_t tocSize = static_cast<uint64_t>(header->EntriesCount) * sizeof(TocEntry);
+
+         if (header->TocOffset % EntryAlignment != 0
+             || header->TocOffset > File.GetSize()
+             || tocSize > File.GetSize() - header->TocOffset)
+         {
+            LOG_ERROR("Asset archive table of contents is out of file: %s", Path.c_str());
+            return false;
+         }
+
+         Toc = reinterpret_cast<const TocEntry*>(File.GetData() + header->TocOffset);
+         EntriesCount = header->EntriesCount;
+
+         return true;
+      }
+
+      const TocEntry* Archive::Find(const uint64_t pathHash) const
+      {
+         const TocEntry* end = Toc + EntriesCount;
+
+         const TocEntry* entry = std::lower_bound(Toc, end, pathHash, [](const TocEntry& e, const uint64_t hash)
+            {
+               return e.PathHash < hash;
+            });
+
+         return entry != end && entry->PathHash == pathHash ? entry : nullptr;
+      }
+
+      bool Archive::Read(const TocEntry& entry, RawData& data) const
+      {
+         if (entry.Offset > File.GetSize()
+             || entry.StoredSize > File.GetSize() - entry.Offset)
+         {
+            LOG_ERROR("Asset archive entry is out of file: %s", Path.c_str());
+            return false;
+         }
+
+         const uint8_t* stored = File.GetData() + entry.Offset;
+
+         //Entry itself is read from the start to the end
+         File.Advise(utils::FileAccess::Sequential, entry.Offset, entry.StoredSize);
+
+         if (!(entry.Flags & EF_COMPRESSED))
+         {
+            //Size is only checked by the StoredSize above, so the bigger one would expose the bytes after the entry
+            if (entry.Size != entry.StoredSize)
+            {
+               LOG_ERROR("Asset archive entry is corrupted: %s", Path.c_str());
+               return false;
+            }
+
+            data.Data = stored;
+            data.Size = entry.Size;
+            return true;
+         }
+
+         data.Storage.resize(entry.Size);
+
+         if (!lz::Decompress(stored, entry.StoredSize, data.Storage.data(), data.Storage.size()))
+         {
+            LOG_ERROR("Asset archive entry is corrupted: %s", Path.c_str());
+            return false;
+         }
+
+         data.Data = data.Storage.data();
+         data.Size = data.Storage.size();
+
+         return true;
+      }
+   }
+}
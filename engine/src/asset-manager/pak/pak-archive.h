@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+#include "pak-format.h"
+
+#include "asset-manager/raw-data.h"
+#include "utils/file-view.h"
+
+namespace assets
+{
+   namespace pak
+   {
+      //Mounted archive keeps the whole file mapped, so all reads are just memory accesses
+      class Archive
+      {
+      private:
+         utils::FileView File;
+
+         const TocEntry* Toc = nullptr;
+         uint32_t EntriesCount = 0;
+
+         std::string Path;
+      public:
+         bool Mount(const std::string_view& filepath);
+
+         const TocEntry* Find(const uint64_t pathHash) const;
+
+         //Uncompressed entries are returned without the copy, pointing into the mapping
+         bool Read(const TocEntry& entry, RawData& data) const;
+
+         inline const std::string& GetPath() const
+         {
+            return Path;
+         }
+      };
+   }
+}
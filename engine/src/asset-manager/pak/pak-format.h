@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+
+//Layout of the packed asset archive (.pak):
+//   Header
+//   Entries data, every entry starts at the EntryAlignment boundary
+//   Table of contents, array of TocEntry sorted by the PathHash
+//
+//All values are little endian
+
+namespace assets
+{
+   namespace pak
+   {
+      inline constexpr uint32_t Magic = 0x4B415052; //"RPAK"
+      inline constexpr uint32_t Version = 2; //Version 2 switched path hashes to the stable FNV-1a
+
+      //Entries are aligned to the cache line, so the mapped data can be used directly by the loaders
+      inline constexpr uint64_t EntryAlignment = 64;
+
+      enum EntryFlags : uint32_t
+      {
+         EF_NONE = 0,
+         EF_COMPRESSED = 1 << 0,
+         EF_COOKED = 1 << 1 //Entry holds the cooked asset instead of the source file, for ex. cook::TextureHeader for the images
+      };
+
+      struct Header
+      {
+         uint32_t Magic;
+         uint32_t Version;
+
+         uint32_t EntriesCount;
+         uint32_t Reserved;
+
+         uint64_t TocOffset;
+      };
+
+      struct TocEntry
+      {
+         uint64_t PathHash; //utils::HashFnv1a of the path that is passed to the AssetManager::ToLoad
+
+         uint64_t Offset;
+         uint64_t StoredSize; //Size in the archive
+         uint64_t Size;       //Size after decompression
+
+         uint32_t Flags;
+         uint32_t Reserved;
+      };
+
+      static_assert(sizeof(Header) == 24, "Pak header layout is changed");
+      static_assert(sizeof(TocEntry) == 40, "Pak toc entry layout is changed");
+
+      constexpr uint64_t AlignOffset(const uint64_t offset)
+      {
+         return (offset + EntryAlignment - 1) & ~(EntryAlignment - 1);
+      }
+   }
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+
+#include "pak-format.h"
+#include "lz-codec.h"
+
+namespace assets
+{
+   namespace pak
+   {
+      //Compressed data is stored only when it saves at least this part of the entry
+      inline constexpr float MinCompressionGain = 0.1f;
+
+      //Entries data is streamed to the file right away, only the table of contents is kept in memory
+      class Writer
+      {
+      private:
+         FILE* File = nullptr;
+
+         uint64_t CurrentOffset = 0;
+
+         std::vector<TocEntry> Toc;
+         std::unordered_set<uint64_t> PathHashes;
+
+         inline bool WriteBytes(const void* data, const size_t size)
+         {
+            if (size && fwrite(data, 1, size, File) != size)
+               return false;
+
+            CurrentOffset += size;
+            return true;
+         }
+
+         inline bool WritePadding(const uint64_t alignedOffset)
+         {
+            static const uint8_t zeros[EntryAlignment] = { 0 };
+            return WriteBytes(zeros, alignedOffset - CurrentOffset);
+         }
+      public:
+         Writer() = default;
+
+         inline ~Writer()
+         {
+            if (File)
+               fclose(File);
+         }
+
+         Writer(const Writer&) = delete;
+         Writer& operator = (const Writer&) = delete;
+
+         inline bool Open(const std::string_view& filepath)
+         {
+            File = fopen(std::string(filepath).c_str(), "wb");
+            if (!File)
+               return false;
+
+            //Real header is written in the Finish, when the toc offset is known
+            Header header = {};
+            return WriteBytes(&header, sizeof(header));
+         }
+
+         //Returns false if the entry with the same hash was already added or the write failed
+         //Flags other than EF_COMPRESSED are stored as is
+         inline bool AddEntry(const uint64_t pathHash, const uint8_t* data, const size_t size, const bool compress,
+                              const uint32_t flags = EF_NONE)
+         {
+            if (PathHashes.count(pathHash))
+               return false;
+
+            TocEntry entry = {};
+            entry.PathHash = pathHash;
+            entry.Size = size;
+            entry.Offset = AlignOffset(CurrentOffset);
+
+            if (!WritePadding(entry.Offset))
+               return false;
+
+            std::vector<uint8_t> compressed;
+            if (compress)
+               compressed = lz::Compress(data, size);
+
+            if (compress && compressed.size() < size * (1.0f - MinCompressionGain))
+            {
+               entry.Flags = (flags & ~EF_COMPRESSED) | EF_COMPRESSED;
+               entry.StoredSize = compressed.size();
+
+               if (!WriteBytes(compressed.data(), compressed.size()))
+                  return false;
+            }
+            else
+            {
+               entry.Flags = flags & ~EF_COMPRESSED;
+               entry.StoredSize = size;
+
+               if (!WriteBytes(data, size))
+                  return false;
+            }
+
+            Toc.push_back(entry);
+            PathHashes.insert(pathHash);
+
+            return true;
+         }
+
+         inline bool Finish()
+         {
+            std::sort(Toc.begin(), Toc.end(), [](const TocEntry& l, const TocEntry& r)
+               {
+                  return l.PathHash < r.PathHash;
+               });
+
+            Header header = {};
+            header.Magic = Magic;
+            header.Version = Version;
+            header.EntriesCount = static_cast<uint32_t>(Toc.size());
+            header.TocOffset = AlignOffset(CurrentOffset);
+
+            if (!WritePadding(header.TocOffset)
+                || !WriteBytes(Toc.data(), Toc.size() * sizeof(TocEntry)))
+            {
+               return false;
+            }
+
+            if (fseek(File, 0, SEEK_SET) != 0
+                || fwrite(&header, sizeof(header), 1, File) != 1)
+            {
+               return false;
+            }
+
+            const bool closed = fclose(File) == 0;
+            File = nullptr;
+
+            return closed;
+         }
+
+         inline const std::vector<TocEntry>& GetToc() const
+         {
+            return Toc;
+         }
+      };
+   }
+}
@@ -0,0 +1,222 @@
+#include "pixel-pool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+#include "utils/sync/spin-lock.h"
+
+namespace assets
+{
+   namespace internal
+   {
+      constexpr uint32_t DirectClass = UINT32_MAX;
+
+      //Keeps the returned pointer aligned as the malloc result
+      struct alignas(16) BlockHeader
+      {
+         uint32_t ClassIndex;
+         size_t   Size; //Requested size, used by the Reallocate to copy only the valid part
+      };
+
+      constexpr uint32_t ClassIndexFor(const size_t size)
+      {
+         uint32_t index = 0;
+         for (size_t classSize = PixelPool::MinClassSize; classSize < size; classSize <<= 1)
+            ++index;
+
+         return index;
+      }
+
+      constexpr size_t ClassSize(const uint32_t index)
+      {
+         return PixelPool::MinClassSize << index;
+      }
+
+      constexpr uint32_t ClassesCount = ClassIndexFor(PixelPool::MaxClassSize) + 1;
+
+      struct PoolState
+      {
+         utils::sync::SpinLock Lock;
+
+         std::vector<void*> FreeBlocks[ClassesCount];
+
+         size_t CacheBudget = PixelPool::DefaultCacheBudget;
+
+         PixelPoolStats Stats = {};
+
+         //Frees the cached blocks starting from the biggest ones until the cache fits the budget, called under the lock
+         inline void FitBudget()
+         {
+            for (uint32_t c = ClassesCount; c-- > 0 && Stats.CachedBytes > CacheBudget;)
+            {
+               while (!FreeBlocks[c].empty() && Stats.CachedBytes > CacheBudget)
+               {
+                  free(FreeBlocks[c].back());
+                  FreeBlocks[c].pop_back();
+
+                  Stats.CachedBytes -= ClassSize(c);
+               }
+            }
+         }
+      };
+
+      PoolState& GetState()
+      {
+         static PoolState state;
+         return state;
+      }
+
+      inline BlockHeader* GetHeader(void* ptr)
+      {
+         return reinterpret_cast<BlockHeader*>(ptr) - 1;
+      }
+   }
+
+   using namespace internal;
+
+   void* PixelPool::Allocate(const size_t size)
+   {
+      BlockHeader* header = nullptr;
+
+      if (size < MinClassSize || size > MaxClassSize)
+      {
+         header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+         if (!header)
+            return nullptr;
+
+         header->ClassIndex = DirectClass;
+      }
+      else
+      {
+         const uint32_t classIndex = ClassIndexFor(size);
+         PoolState& state = GetState();
+
+         {
+            std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+
+            auto& freeBlocks = state.FreeBlocks[classIndex];
+            if (!freeBlocks.empty())
+            {
+               header = static_cast<BlockHeader*>(freeBlocks.back());
+               freeBlocks.pop_back();
+
+               state.Stats.CachedBytes -= ClassSize(classIndex);
+               ++state.Stats.Hits;
+            }
+            else
+            {
+               ++state.Stats.Misses;
+            }
+
+            state.Stats.LiveBytes += ClassSize(classIndex);
+            state.Stats.PeakLiveBytes = std::max(state.Stats.PeakLiveBytes, state.Stats.LiveBytes);
+         }
+
+         if (!header)
+         {
+            header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + ClassSize(classIndex)));
+            if (!header)
+            {
+               std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+               state.Stats.LiveBytes -= ClassSize(classIndex);
+               return nullptr;
+            }
+         }
+
+         header->ClassIndex = classIndex;
+      }
+
+      header->Size = size;
+
+      return header + 1;
+   }
+
+   void* PixelPool::Reallocate(void* ptr, const size_t size)
+   {
+      if (!ptr)
+         return Allocate(size);
+
+      BlockHeader* header = GetHeader(ptr);
+
+      //Block of the same class already has the room
+      if (header->ClassIndex != DirectClass
+          && size >= MinClassSize && size <= ClassSize(header->ClassIndex))
+      {
+         header->Size = size;
+         return ptr;
+      }
+
+      void* newPtr = Allocate(size);
+      if (!newPtr)
+         return nullptr;
+
+      memcpy(newPtr, ptr, std::min(size, header->Size));
+      Free(ptr);
+
+      return newPtr;
+   }
+
+   void PixelPool::Free(void* ptr)
+   {
+      if (!ptr)
+         return;
+
+      BlockHeader* header = GetHeader(ptr);
+
+      if (header->ClassIndex == DirectClass)
+      {
+         free(header);
+         return;
+      }
+
+      const uint32_t classIndex = header->ClassIndex;
+      PoolState& state = GetState();
+
+      {
+         std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+
+         state.Stats.LiveBytes -= ClassSize(classIndex);
+
+         if (state.Stats.CachedBytes + ClassSize(classIndex) <= state.CacheBudget)
+         {
+            state.FreeBlocks[classIndex].push_back(header);
+            state.Stats.CachedBytes += ClassSize(classIndex);
+            return;
+         }
+      }
+
+      free(header);
+   }
+
+   void PixelPool::SetCacheBudget(const size_t bytes)
+   {
+      PoolState& state = GetState();
+      std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+
+      state.CacheBudget = bytes;
+      state.FitBudget();
+   }
+
+   void PixelPool::Trim()
+   {
+      PoolState& state = GetState();
+      std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+
+      const size_t budget = state.CacheBudget;
+
+      state.CacheBudget = 0;
+      state.FitBudget();
+      state.CacheBudget = budget;
+   }
+
+   PixelPoolStats PixelPool::GetStats()
+   {
+      PoolState& state = GetState();
+      std::lock_guard<utils::sync::SpinLock> l(state.Lock);
+
+      return state.Stats;
+   }
+}
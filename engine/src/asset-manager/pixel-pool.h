@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace assets
+{
+   struct PixelPoolStats
+   {
+      size_t LiveBytes;      //Size classes of the buffers that are currently in use
+      size_t PeakLiveBytes;
+      size_t CachedBytes;    //Released buffers kept for the reuse
+
+      size_t Hits;           //Allocations served from the cache
+      size_t Misses;         //Allocations that went to the system allocator
+   };
+
+   //Size classed pool for the decoded images and the decoder temporaries
+   //Classes are powers of two, so the repeated loads of the same assets reuse the same buffers
+   //Released buffers are cached up to the budget, everything above it goes back to the system
+   class PixelPool
+   {
+   public:
+      static constexpr size_t MinClassSize = 4 * 1024;          //Smaller allocations go straight to the malloc
+      static constexpr size_t MaxClassSize = 256 * 1024 * 1024; //Bigger allocations too, they are too rare to cache
+      static constexpr size_t DefaultCacheBudget = 256 * 1024 * 1024;
+
+      struct Deleter
+      {
+         inline void operator()(void* ptr) const
+         {
+            Free(ptr);
+         }
+      };
+
+      static void* Allocate(const size_t size);
+      static void* Reallocate(void* ptr, const size_t size);
+      static void Free(void* ptr);
+
+      //Drops the cached buffers above the new budget right away
+      static void SetCacheBudget(const size_t bytes);
+
+      static void Trim();
+
+      static PixelPoolStats GetStats();
+   };
+
+   using PixelBuffer = std::unique_ptr<uint8_t[], PixelPool::Deleter>;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "utils/file-view.h"
+
+namespace assets
+{
+   //Asset file bytes before any processing
+   //Data points either into the mounted archive mapping, into the File of the loose asset or into the Storage
+   struct RawData
+   {
+      const uint8_t* Data = nullptr;
+      size_t Size = 0;
+
+      std::vector<uint8_t> Storage;
+      utils::FileView File;
+   };
+}
@@ -26,6 +26,7 @@ namespace app
          graphics::cfg::ShadowBias = map.at("Shadow_Bias").GetAsFloat();
          graphics::cfg::LightSize = map.at("Light_Size").GetAsFloat();
          graphics::cfg::SoftShadows = map.at("Soft_Shadows").GetAsInt32();
+         graphics::cfg::PackedVertices = map.at("Packed_Vertices").GetAsInt32();
       };
 
       utils::ConfigFile configFile("config.cef", updateFunc);
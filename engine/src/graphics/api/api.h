@@ -23,7 +23,11 @@ namespace graphics
       RGBA16,
       Depth16,
       Depth24,
-      Depth32
+      Depth32,
+      BC1,  //Block compressed formats are filled only by the UpdateCompressedData
+      BC3,
+      BC5,
+      BC7
    };
 
    enum class Format : uint8_t
@@ -39,6 +43,9 @@ namespace graphics
    {
       Ubyte,
       Uint,
+      Short,
+      Ushort,
+      Half,
       Float
    };
 
@@ -7,6 +7,7 @@
 #include "platforms/opengl/gl-texture2d.h"
 #include "platforms/opengl/gl-cubemap.h"
 #include "platforms/opengl/gl-vertex-buffer.h"
+#include "platforms/opengl/gl-index-buffer.h"
 #include "platforms/opengl/gl-uniform-buffer.h"
 #include "platforms/opengl/gl-shader-buffer.h"
 #include "platforms/opengl/gl-compute-shader.h"
@@ -51,6 +52,11 @@ namespace graphics
          return std::make_shared<gl::VertexBufferGL>();
       }
 
+      inline std::shared_ptr<IndexBuffer> CreateIBO() override
+      {
+         return std::make_shared<gl::IndexBufferGL>();
+      }
+
       inline std::shared_ptr<UniformBuffer> CreateUBO() override
       {
          return std::make_shared<gl::UniformBufferGL>();
@@ -83,14 +89,28 @@ namespace graphics
           glDisable(OGL_FEATURE(feature));
       }
 
-      inline void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount) const override
+      inline void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount, const size_t firstVertex = 0) const override
+      {
+         auto& glProgram = std::static_pointer_cast<gl::ShaderProgramGL>(program);
+
+         glProgram->Use();
+         glBindVertexArray(glProgram->Vao);
+
+         glDrawArrays(GL_TRIANGLES, firstVertex, verticesCount);
+      }
+
+      inline void DrawIndexedTriangles(const std::shared_ptr<ShaderProgram>& program, const void* const* indexOffsets, const int32_t* indicesCounts,
+                                       const size_t rangesCount, const int32_t* baseVertices = nullptr) const override
       {
          auto& glProgram = std::static_pointer_cast<gl::ShaderProgramGL>(program);
 
          glProgram->Use();
          glBindVertexArray(glProgram->Vao);
 
-         glDrawArrays(GL_TRIANGLES, 0, verticesCount);
+         if (baseVertices)
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, indicesCounts, GL_UNSIGNED_INT, indexOffsets, rangesCount, baseVertices);
+         else
+            glMultiDrawElements(GL_TRIANGLES, indicesCounts, GL_UNSIGNED_INT, indexOffsets, rangesCount);
       }
 
       inline void Clear() override
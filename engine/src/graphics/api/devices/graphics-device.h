@@ -7,6 +7,7 @@
 #include "graphics/api/texture2d.h"
 #include "graphics/api/cubemap.h"
 #include "graphics/api/vertex-buffer.h"
+#include "graphics/api/index-buffer.h"
 #include "graphics/api/uniform-buffer.h"
 #include "graphics/api/shader-buffer.h"
 #include "graphics/api/framebuffer.h"
@@ -33,6 +34,8 @@ namespace graphics
 
       virtual std::shared_ptr<VertexBuffer> CreateVBO() = 0;
 
+      virtual std::shared_ptr<IndexBuffer> CreateIBO() = 0;
+
       virtual std::shared_ptr<UniformBuffer> CreateUBO() = 0;
 
       virtual std::shared_ptr<ShaderBuffer> CreateSBO() = 0;
@@ -58,6 +61,11 @@ namespace graphics
 
       virtual void SetCullingFace(const Face face) const = 0;
 
-      virtual void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount) const = 0;
+      virtual void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount, const size_t firstVertex = 0) const = 0;
+
+      //Draws the several ranges of the bound index buffer by the single call, the offsets are in bytes
+      //Base vertex of every range is added to its indices, null is zero for all of them
+      virtual void DrawIndexedTriangles(const std::shared_ptr<ShaderProgram>& program, const void* const* indexOffsets, const int32_t* indicesCounts,
+                                        const size_t rangesCount, const int32_t* baseVertices = nullptr) const = 0;
    };
 }
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+
+namespace graphics
+{
+   //Indices are always 32 bit, meshes over 65k vertices are common
+   class IndexBuffer
+   {
+   public:
+      IndexBuffer() = default;
+      virtual ~IndexBuffer() = default;
+
+      virtual void InitData(const size_t size, const void* data) = 0;
+
+      //Offset is in bytes
+      virtual void UpdateData(const size_t size, const void* data, const size_t offset = 0) = 0;
+
+      //Copies inside of the buffer, the ranges must not overlap
+      virtual void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) = 0;
+   };
+}
@@ -14,5 +14,8 @@ namespace graphics
       virtual void UpdateData(const size_t offset, const size_t size, void* data) = 0;
       
       virtual void GetData(const size_t offset, const size_t size, void* buffer) = 0;
+
+      //Copies inside of the buffer, the ranges must not overlap
+      virtual void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) = 0;
    };
 }
@@ -9,6 +9,7 @@
 #include "uniform-buffer.h"
 #include "shader-buffer.h"
 #include "vertex-buffer.h"
+#include "index-buffer.h"
 #include "api.h"
 
 namespace graphics
@@ -32,8 +33,13 @@ namespace graphics
 
       virtual void AddShader(const ShaderType& type, const std::string_view& src) = 0;
 
+      //Normalized integer elements are read by the shader as the floats in [0, 1] or [-1, 1]
       virtual void AddInputBuffer(const std::shared_ptr<VertexBuffer>& vbo, const uint8_t elements, const uint8_t attribIndex, 
-                                  const size_t stride, const Type type, const size_t offset = 0, const size_t elementsOffset = 0) = 0;
+                                  const size_t stride, const Type type, const size_t offset = 0, const size_t elementsOffset = 0,
+                                  const bool isNormalized = false) = 0;
+
+      //Indexed draws of the program read the indices from this buffer
+      virtual void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& ibo) = 0;
 
       virtual void AddInputBuffer(const std::shared_ptr<UniformBuffer>& ubo, const std::string_view& name, const size_t dataSize, const size_t dataOffset = 0) = 0;
 
@@ -15,7 +15,8 @@ namespace graphics
    enum class TextureFilter
    {
       Nearest,
-      Linear
+      Linear,
+      LinearMipmapLinear //Only for the min filter of the textures with mips
    };
 
    struct TextureParams
@@ -32,16 +33,28 @@ namespace graphics
       Texture2D() = default;
       virtual ~Texture2D() = default;
 
+      //Storage for all the levels is allocated at once, every level is then filled by the UpdateData
+      //Calling it again replaces the storage, all the data is lost
       virtual void InitData(const uint16_t sizeX, const uint16_t sizeY,
                             const InternalFormat internalFormat, const Format format,
-                            const Type type, const TextureParams& params) = 0;
+                            const Type type, const TextureParams& params,
+                            const uint16_t levelsCount = 1) = 0;
       
-      virtual void UpdateData(const size_t sizeX, const size_t sizeY, const void* data) = 0;
+      virtual void UpdateData(const size_t sizeX, const size_t sizeY, const void* data, const uint16_t level = 0) = 0;
+
+      //Data is the blocks of the whole level in the block compressed internal format of the texture
+      virtual void UpdateCompressedData(const size_t sizeX, const size_t sizeY, const void* data, const size_t dataSize, const uint16_t level = 0) = 0;
       
+      //Replaces the storage by the one of the levelsCount levels, the old level i is the new level i + levelShift
+      //Levels that are in both storages are copied on the GPU, the others are empty until they are updated
+      virtual void Reallocate(const uint16_t sizeX, const uint16_t sizeY, const uint16_t levelsCount, const int32_t levelShift) = 0;
+
       //Through OpenGL api you should call this before init function
       virtual void SetBorderColor(const mm::vec4& color) const = 0;
 
       virtual uint16_t GetSizeX() const = 0;
       virtual uint16_t GetSizeY() const = 0;
+
+      virtual uint16_t GetLevelsCount() const = 0;
    };
 }
@@ -11,6 +11,10 @@ namespace graphics
 
       virtual void InitData(const size_t size, const void* data) = 0;
 
-      virtual void UpdateData(const size_t size, const void* data) = 0;
+      //Offset is in bytes
+      virtual void UpdateData(const size_t size, const void* data, const size_t offset = 0) = 0;
+
+      //Copies inside of the buffer, the ranges must not overlap
+      virtual void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) = 0;
    };
 }
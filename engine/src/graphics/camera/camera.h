@@ -13,6 +13,10 @@ namespace graphics
       MoveDown
    };
 
+   //Depth range of the perspective projection
+   inline constexpr float PerspectiveNear = 0.01f;
+   inline constexpr float PerspectiveFar = 1000.0f;
+
    //TODO rework this class, reason is a lot of C code
    struct Camera
    {
@@ -56,7 +60,7 @@ namespace graphics
       inline mm::mat4 GetCameraProjection() const
       {
          if(Perspective)
-            return mm::perspective(Fov, Aspect, 0.01f, 1000.0f);
+            return mm::perspective(Fov, Aspect, PerspectiveNear, PerspectiveFar);
          else
             return mm::ortho(Size, Size, Far, Near);
       }
@@ -0,0 +1,243 @@
+#include "culling.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <xmmintrin.h>
+
+namespace graphics
+{
+   Frustum ExtractFrustum(const mm::mat4& viewProjection)
+   {
+      auto row = [&viewProjection](const size_t r)
+         {
+            return mm::vec4(viewProjection.Data[r * 4], viewProjection.Data[r * 4 + 1],
+                            viewProjection.Data[r * 4 + 2], viewProjection.Data[r * 4 + 3]);
+         };
+
+      const mm::vec4 x = row(0);
+      const mm::vec4 y = row(1);
+      const mm::vec4 w = row(3);
+
+      Frustum frustum;
+      frustum.Planes[0] = w + x;
+      frustum.Planes[1] = w - x;
+      frustum.Planes[2] = w + y;
+      frustum.Planes[3] = w - y;
+      frustum.Planes[4] = w;
+      frustum.Planes[5] = mm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+      for (auto& plane : frustum.Planes)
+      {
+         const float length = mm::length(mm::vec3(plane));
+         if (length > 0.0f)
+            plane = plane / length;
+      }
+
+      return frustum;
+   }
+
+   Frustum ExtractFrustum(const Camera& camera)
+   {
+      Frustum frustum = ExtractFrustum(camera.GetCameraProjection() * camera.GetCameraViewMatrix());
+
+      const float nearDepth = camera.Perspective ? PerspectiveNear : camera.Near;
+      const float farDepth = camera.Perspective ? PerspectiveFar : camera.Far;
+
+      const mm::vec3& forward = camera.ForwardAxis;
+      const float cameraDepth = mm::dot(camera.Position, forward);
+
+      //Depth of the point is dot(p, forward) - cameraDepth
+      frustum.Planes[4] = mm::vec4(forward.x, forward.y, forward.z, -cameraDepth - nearDepth);
+      frustum.Planes[5] = mm::vec4(-forward.x, -forward.y, -forward.z, cameraDepth + farDepth);
+
+      return frustum;
+   }
+
+   bool IsSphereVisible(const Frustum& frustum, const mm::vec3& center, const float radius)
+   {
+      for (auto& plane : frustum.Planes)
+      {
+         if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+            return false;
+      }
+
+      return true;
+   }
+
+   size_t CullSpheres(const Frustum& frustum, const SphereBounds& bounds, uint32_t* resVisible)
+   {
+      const size_t count = bounds.GetCount();
+      const size_t simdCount = count & ~static_cast<size_t>(3);
+
+      //Every component of every plane is in all the 4 lanes
+      __m128 planeX[6];
+      __m128 planeY[6];
+      __m128 planeZ[6];
+      __m128 planeW[6];
+
+      for (size_t p = 0; p < 6; ++p)
+      {
+         planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+         planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+         planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+         planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+      }
+
+      const __m128 signMask = _mm_set1_ps(-0.0f);
+
+      size_t visibleCount = 0;
+
+      for (size_t i = 0; i < simdCount; i += 4)
+      {
+         const __m128 x = _mm_loadu_ps(bounds.X.data() + i);
+         const __m128 y = _mm_loadu_ps(bounds.Y.data() + i);
+         const __m128 z = _mm_loadu_ps(bounds.Z.data() + i);
+         const __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(bounds.Radius.data() + i), signMask);
+
+         __m128 outside = _mm_setzero_ps();
+
+         //Sums and the comparison are the ones of the scalar test, so both give the same result at the planes and for the NaNs
+         for (size_t p = 0; p < 6; ++p)
+         {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y));
+            distance = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(planeZ[p], z)), planeW[p]);
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+         }
+
+         //Indices are written always and kept by the count, so there is no branch per sphere
+         const uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_ps(outside));
+
+         for (uint32_t lane = 0; lane < 4; ++lane)
+         {
+            resVisible[visibleCount] = static_cast<uint32_t>(i + lane);
+            visibleCount += (mask >> lane) & 1;
+         }
+      }
+
+      for (size_t i = simdCount; i < count; ++i)
+      {
+         if (IsSphereVisible(frustum, mm::vec3(bounds.X[i], bounds.Y[i], bounds.Z[i]), bounds.Radius[i]))
+            resVisible[visibleCount++] = static_cast<uint32_t>(i);
+      }
+
+      return visibleCount;
+   }
+
+   size_t CullSpheresScalar(const Frustum& frustum, const SphereBounds& bounds, uint32_t* resVisible)
+   {
+      size_t visibleCount = 0;
+
+      for (size_t i = 0; i < bounds.GetCount(); ++i)
+      {
+         if (IsSphereVisible(frustum, mm::vec3(bounds.X[i], bounds.Y[i], bounds.Z[i]), bounds.Radius[i]))
+            resVisible[visibleCount++] = static_cast<uint32_t>(i);
+      }
+
+      return visibleCount;
+   }
+
+   bool IsConeBackfacing(const mm::vec3& center, const float radius, const mm::vec3& coneAxis, const float coneCos, const float coneSin,
+                         const mm::vec3& cameraPosition)
+   {
+      if (coneCos <= 0.0f)
+         return false;
+
+      //The view direction to any point of the sphere is within the asin(radius / distance) from the direction to the center
+      //Triangle faces away when the angle between its normal and the view direction is below 90 degrees,
+      //so the angle to the center plus the cone angle must leave the room for the sphere:
+      //distance * cos(angle to the axis + cone angle) >= radius
+      const mm::vec3 view = center - cameraPosition;
+      const float distance = mm::length(view);
+
+      if (distance <= radius)
+         return false;
+
+      const float axisCos = mm::dot(view, coneAxis) / distance;
+      const float axisSin = sqrtf(std::max(1.0f - axisCos * axisCos, 0.0f));
+
+      return distance * (axisCos * coneCos - axisSin * coneSin) >= radius;
+   }
+
+   void TransformSphere(const mm::mat4& transform, const mm::vec3& center, const float radius, mm::vec3& resCenter, float& resRadius)
+   {
+      const float* m = transform.Data;
+      const mm::vec3& c = center;
+
+      resCenter = mm::vec3(m[0] * c.x + m[1] * c.y + m[2] * c.z + m[3],
+                           m[4] * c.x + m[5] * c.y + m[6] * c.z + m[7],
+                           m[8] * c.x + m[9] * c.y + m[10] * c.z + m[11]);
+
+      const float scaleX = m[0] * m[0] + m[4] * m[4] + m[8] * m[8];
+      const float scaleY = m[1] * m[1] + m[5] * m[5] + m[9] * m[9];
+      const float scaleZ = m[2] * m[2] + m[6] * m[6] + m[10] * m[10];
+
+      const float maxScale = scaleX > scaleY ? (scaleX > scaleZ ? scaleX : scaleZ) : (scaleY > scaleZ ? scaleY : scaleZ);
+
+      resRadius = radius * sqrtf(maxScale);
+   }
+
+   //Scale of the rotation with the uniform scale, zero for the other transforms, they don't keep the angles of the normals
+   static float GetConformalScale(const mm::mat4& transform)
+   {
+      const float* m = transform.Data;
+
+      const mm::vec3 x(m[0], m[4], m[8]);
+      const mm::vec3 y(m[1], m[5], m[9]);
+      const mm::vec3 z(m[2], m[6], m[10]);
+
+      const float scale = mm::length(x);
+      const float tolerance = scale * 1e-4f;
+
+      if (scale <= 0.0f || fabsf(mm::length(y) - scale) > tolerance || fabsf(mm::length(z) - scale) > tolerance)
+         return 0.0f;
+
+      if (fabsf(mm::dot(x, y)) > tolerance * scale || fabsf(mm::dot(x, z)) > tolerance * scale || fabsf(mm::dot(y, z)) > tolerance * scale)
+         return 0.0f;
+
+      //Mirroring flips the facing
+      return mm::dot(mm::cross(x, y), z) > 0.0f ? scale : 0.0f;
+   }
+
+   size_t CullMeshlets(const std::vector<assets::cook::Meshlet>& meshlets, const MeshletCullParams& params,
+                       std::vector<DrawRange>& resRanges)
+   {
+      const mm::mat4& transform = *params.Transform;
+      const float* m = transform.Data;
+
+      const float coneScale = GetConformalScale(transform);
+
+      size_t visibleCount = 0;
+
+      for (auto& meshlet : meshlets)
+      {
+         mm::vec3 center;
+         float radius;
+         TransformSphere(transform, meshlet.Center, meshlet.Radius, center, radius);
+
+         if (!IsSphereVisible(*params.ViewFrustum, center, radius))
+            continue;
+
+         if (coneScale > 0.0f)
+         {
+            const mm::vec3& a = meshlet.ConeAxis;
+            const mm::vec3 axis = mm::vec3(m[0] * a.x + m[1] * a.y + m[2] * a.z,
+                                           m[4] * a.x + m[5] * a.y + m[6] * a.z,
+                                           m[8] * a.x + m[9] * a.y + m[10] * a.z) / coneScale;
+
+            if (IsConeBackfacing(center, radius, axis, meshlet.ConeCos, meshlet.ConeSin, params.CameraPosition))
+               continue;
+         }
+
+         if (!resRanges.empty() && resRanges.back().FirstIndex + resRanges.back().IndicesCount == meshlet.FirstIndex)
+            resRanges.back().IndicesCount += meshlet.IndicesCount;
+         else
+            resRanges.push_back({ meshlet.FirstIndex, meshlet.IndicesCount });
+
+         visibleCount += meshlet.IndicesCount;
+      }
+
+      return visibleCount;
+   }
+}
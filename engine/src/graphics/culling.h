@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "math/math.h"
+#include "asset-manager/cook/meshlets.h"
+#include "graphics/camera/camera.h"
+
+//CPU culling of the draws and of the meshlets, done for every view
+
+namespace graphics
+{
+   struct Frustum
+   {
+      //Normalized planes, the points inside have dot(plane.xyz, p) + plane.w >= 0
+      //Side planes, the near and the far ones
+      mm::vec4 Planes[6];
+   };
+
+   //Side planes are taken from the rows of the clip matrix, so it works for any projection
+   //Depth range isn't known from the matrix, so the near plane is the plane of the camera and the far one is open
+   Frustum ExtractFrustum(const mm::mat4& viewProjection);
+
+   //Depth planes are at the near and the far distances of the camera along its view direction
+   Frustum ExtractFrustum(const Camera& camera);
+
+   bool IsSphereVisible(const Frustum& frustum, const mm::vec3& center, const float radius);
+
+   //Bounding sphere of the transformed sphere, the radius is scaled by the biggest scale of the axes
+   void TransformSphere(const mm::mat4& transform, const mm::vec3& center, const float radius, mm::vec3& resCenter, float& resRadius);
+
+   //World bounding spheres of the draws, every component is in its own array for the SIMD culling
+   struct SphereBounds
+   {
+      std::vector<float> X;
+      std::vector<float> Y;
+      std::vector<float> Z;
+      std::vector<float> Radius;
+
+      inline void Reserve(const size_t count)
+      {
+         X.reserve(count);
+         Y.reserve(count);
+         Z.reserve(count);
+         Radius.reserve(count);
+      }
+
+      inline void Clear()
+      {
+         X.clear();
+         Y.clear();
+         Z.clear();
+         Radius.clear();
+      }
+
+      inline void Push(const mm::vec3& center, const float radius)
+      {
+         X.push_back(center.x);
+         Y.push_back(center.y);
+         Z.push_back(center.z);
+         Radius.push_back(radius);
+      }
+
+      inline size_t GetCount() const
+      {
+         return X.size();
+      }
+   };
+
+   //Tests 4 spheres against the 6 planes by the single SSE instruction per plane, the tail is tested by the scalar code
+   //Indices of the visible spheres are written in the ascending order, resVisible must have the room for all the spheres
+   //Returns the count of the visible ones
+   size_t CullSpheres(const Frustum& frustum, const SphereBounds& bounds, uint32_t* resVisible);
+
+   //Same result by the IsSphereVisible for every sphere
+   size_t CullSpheresScalar(const Frustum& frustum, const SphereBounds& bounds, uint32_t* resVisible);
+
+   //True when every triangle inside of the sphere with the normals in the cone faces away from the camera
+   bool IsConeBackfacing(const mm::vec3& center, const float radius, const mm::vec3& coneAxis, const float coneCos, const float coneSin,
+                         const mm::vec3& cameraPosition);
+
+   struct DrawRange
+   {
+      uint32_t FirstIndex;
+      uint32_t IndicesCount;
+   };
+
+   struct MeshletCullParams
+   {
+      const Frustum* ViewFrustum;
+      mm::vec3 CameraPosition;
+
+      //Object to world transform of the draw, the meshlet bounds are in the object space
+      const mm::mat4* Transform;
+   };
+
+   //Visible meshlets are appended to the ranges, the neighbour ones are merged into the single range
+   //Cones are tested only for the rotation with the uniform scale, the shear, the other scales and the mirroring change the normals
+   //Returns the count of the visible indices
+   size_t CullMeshlets(const std::vector<assets::cook::Meshlet>& meshlets, const MeshletCullParams& params,
+                       std::vector<DrawRange>& resRanges);
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <cmath>
+#include <vector>
 
 #include "graphics/render-manager.h"
 #include "graphics/mesh-render.h"
@@ -9,136 +10,177 @@
 namespace graphics
 {
    //This manager will be later used to control the objects lifetime, so it isn't useless
+   //Primitives are built once with the unit size and registered in the RenderManager, every call only pushes the draw
+   //with the transform that places them
    class DebugPrimitiveManager
    {
    private:
       std::shared_ptr<DebugPrimitiveMaterial> MaterialInstance;
       std::shared_ptr<RenderManager> RM;
-   public:
-      DebugPrimitiveManager(const std::shared_ptr<RenderManager>& rm)
-         : RM(rm)
-      {
-         MaterialInstance = std::make_shared<DebugPrimitiveMaterial>();
-      }
 
-      void AddAACube(const mm::vec3& color,
-                     const mm::vec3& center, const mm::vec3& size)
+      MeshHandle CubeMesh = InvalidMeshHandle;
+      std::vector<std::pair<uint8_t, MeshHandle>> SphereMeshes; //By the sections
+
+      std::vector<std::pair<mm::vec3, MaterialHandle>> ColorMaterials;
+
+      MaterialHandle GetColorMaterial(const mm::vec3& color)
       {
-         Mesh mesh;
-         
-         mesh.Vertices.Positions.emplace_back(center);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center);
-                                 
-         mesh.Vertices.Positions.emplace_back(center.x, center.y + size.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y + size.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center + size);
-         mesh.Vertices.Positions.emplace_back(center + size);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y + size.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y + size.y, center.z);
-                                 
-         mesh.Vertices.Positions.emplace_back(center.x, center.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y + size.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y + size.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y + size.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y, center.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y, center.z);
-                                 
-         mesh.Vertices.Positions.emplace_back(center.x, center.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y + size.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center + size);
-         mesh.Vertices.Positions.emplace_back(center + size);
-         mesh.Vertices.Positions.emplace_back(center.x + size.x, center.y, center.z + size.z);
-         mesh.Vertices.Positions.emplace_back(center.x, center.y, center.z + size.z);
-
-         auto& material = std::make_shared<DebugPrimitiveMaterial>(*MaterialInstance);
+         for (auto& [materialColor, handle] : ColorMaterials)
+         {
+            if (materialColor.x == color.x && materialColor.y == color.y && materialColor.z == color.z)
+               return handle;
+         }
 
+         auto material = std::make_shared<DebugPrimitiveMaterial>(*MaterialInstance);
          material->Color = color;
 
-         RenderKey key;
-         key.Depth = 0;
-         key.MaterialId = material->GetId();
-         key.Opaque = 1;
-         key.Layer = graphics::Layer::Debug;
+         const MaterialHandle handle = RM->RegisterMaterial(material);
+         ColorMaterials.push_back({ color, handle });
 
-         mesh.Material = material;
+         return handle;
+      }
+
+      MeshHandle RegisterPrimitive(assets::TrigVertices&& vertices)
+      {
+         //Primitives aren't cooked, so their bounds for the culling are computed here
+         vertices.Bounds = assets::cook::ComputeMeshBounds(vertices.Positions.data(), vertices.Positions.size());
 
-         RM->PushRenderRequest(key, mesh);
+         auto mesh = std::make_shared<Mesh>();
+         mesh->Vertices = std::move(vertices);
+         mesh->Material = MaterialInstance;
+
+         return RM->RegisterMesh(mesh);
       }
 
-      void AddAASphere(const mm::vec3& color, const uint8_t sections,
-                       const mm::vec3& center, const float radius)
+      //Cube from the origin to 1
+      MeshHandle GetCubeMesh()
       {
-         ASSERT(sections % 6 == 0, "Sphere sections must be divisible by 6");
+         if (CubeMesh != InvalidMeshHandle)
+            return CubeMesh;
+
+         assets::TrigVertices vertices;
+
+         vertices.Positions.emplace_back(0.0f, 0.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 0.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 0.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 0.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 0.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 0.0f, 0.0f);
+
+         vertices.Positions.emplace_back(0.0f, 1.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 1.0f, 0.0f);
+
+         vertices.Positions.emplace_back(0.0f, 0.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 1.0f, 0.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 0.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 0.0f);
+         vertices.Positions.emplace_back(1.0f, 0.0f, 0.0f);
+         vertices.Positions.emplace_back(0.0f, 0.0f, 0.0f);
+
+         vertices.Positions.emplace_back(0.0f, 0.0f, 1.0f);
+         vertices.Positions.emplace_back(0.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 1.0f, 1.0f);
+         vertices.Positions.emplace_back(1.0f, 0.0f, 1.0f);
+         vertices.Positions.emplace_back(0.0f, 0.0f, 1.0f);
+
+         CubeMesh = RegisterPrimitive(std::move(vertices));
+
+         return CubeMesh;
+      }
+
+      //Three circles of the radius 1 around the origin
+      MeshHandle GetSphereMesh(const uint8_t sections)
+      {
+         for (auto& [sphereSections, handle] : SphereMeshes)
+         {
+            if (sphereSections == sections)
+               return handle;
+         }
 
-         Mesh mesh;
+         assets::TrigVertices vertices;
 
-         float angleStep = mm::TAU / sections;
+         const float angleStep = mm::TAU / sections;
 
          for (size_t i = 0; i <= sections; ++i)
          {
-            mesh.Vertices.Positions.emplace_back(center.x + radius * cos(angleStep * i),
-                                                 center.y + radius * sin(angleStep * i),
-                                                 center.z);
+            vertices.Positions.emplace_back(cos(angleStep * i), sin(angleStep * i), 0.0f);
 
             if (i % 2 == 0
                 && i != 0
                 && i != sections)
             {
-               mesh.Vertices.Positions.emplace_back(center.x + radius * cos(angleStep * i),
-                                                    center.y + radius * sin(angleStep * i),
-                                                    center.z);
+               vertices.Positions.emplace_back(cos(angleStep * i), sin(angleStep * i), 0.0f);
             }
          }
 
          for (size_t i = 0; i <= sections; ++i)
          {
-            mesh.Vertices.Positions.emplace_back(center.x + radius * cos(angleStep * i),
-                                                 center.y,
-                                                 center.z + radius * sin(angleStep * i));
+            vertices.Positions.emplace_back(cos(angleStep * i), 0.0f, sin(angleStep * i));
 
             if (i % 2 == 0
                 && i != 0
                 && i != sections)
             {
-               mesh.Vertices.Positions.emplace_back(center.x + radius * cos(angleStep * i),
-                                                    center.y,
-                                                    center.z + radius * sin(angleStep * i));
+               vertices.Positions.emplace_back(cos(angleStep * i), 0.0f, sin(angleStep * i));
             }
          }
 
          for (size_t i = 0; i <= sections; ++i)
          {
-            mesh.Vertices.Positions.emplace_back(center.x,
-                                                 center.y + radius * cos(angleStep * i),
-                                                 center.z + radius * sin(angleStep * i));
+            vertices.Positions.emplace_back(0.0f, cos(angleStep * i), sin(angleStep * i));
 
             if (i % 2 == 0
                && i != 0
                && i != sections)
             {
-               mesh.Vertices.Positions.emplace_back(center.x,
-                                                    center.y + radius * cos(angleStep * i),
-                                                    center.z + radius * sin(angleStep * i));
+               vertices.Positions.emplace_back(0.0f, cos(angleStep * i), sin(angleStep * i));
             }
          }
 
-         auto& material = std::make_shared<DebugPrimitiveMaterial>(*MaterialInstance);
+         const MeshHandle handle = RegisterPrimitive(std::move(vertices));
+         SphereMeshes.push_back({ sections, handle });
 
-         material->Color = color;
+         return handle;
+      }
+
+      void PushPrimitive(const MeshHandle mesh, const mm::vec3& color, const mm::vec3& translate, const mm::vec3& scale)
+      {
+         const MaterialHandle material = GetColorMaterial(color);
+
+         mm::mat4 transform;
+         transform = mm::translate(transform, translate);
+         transform = mm::scale(transform, scale);
 
-         RenderKey key;
-         key.Depth = 0;
-         key.MaterialId = material->GetId();
-         key.Opaque = 1;
-         key.Layer = graphics::Layer::Debug;
+         RenderKeyParams keyParams;
+         keyParams.Layer = graphics::Layer::Debug;
+         keyParams.MaterialId = material;
 
-         mesh.Material = material;
+         RM->PushRenderRequest(BuildRenderKey(keyParams), mesh, material, RM->PushTransform(transform));
+      }
+   public:
+      DebugPrimitiveManager(const std::shared_ptr<RenderManager>& rm)
+         : RM(rm)
+      {
+         MaterialInstance = std::make_shared<DebugPrimitiveMaterial>();
+      }
+
+      void AddAACube(const mm::vec3& color,
+                     const mm::vec3& center, const mm::vec3& size)
+      {
+         PushPrimitive(GetCubeMesh(), color, center, size);
+      }
+
+      void AddAASphere(const mm::vec3& color, const uint8_t sections,
+                       const mm::vec3& center, const float radius)
+      {
+         ASSERT(sections % 6 == 0, "Sphere sections must be divisible by 6");
 
-         RM->PushRenderRequest(key, mesh);
+         PushPrimitive(GetSphereMesh(sections), color, center, mm::vec3(radius));
       }
    };
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+
+#include "mesh-render.h"
+
+#include "graphics/render-sort.h"
+
+namespace graphics
+{
+   //Draw is the POD record that references the data kept by the RenderManager, so the queue is filled every frame
+   //without copying the meshes
+   struct DrawItem
+   {
+      RenderKey Key;
+
+      MeshHandle Mesh;
+      MaterialHandle Material;
+
+      uint32_t Transform; //Index into the transforms of the frame
+      uint32_t Lod;       //Level 0 is the mesh itself, the others are its LODs
+   };
+
+   static_assert(sizeof(DrawItem) == 24, "Draw item is kept compact for the sort");
+
+   //Queue and transforms are reserved for this many draws, they grow above it and keep the capacity
+   inline constexpr size_t InitialDrawItems = 4096;
+
+   //Draws of the frame and their transforms, the Clear keeps the capacities for the next frames
+   class DrawQueue
+   {
+   private:
+      std::vector<DrawItem> Items;
+      std::vector<mm::mat4> Transforms;
+   public:
+      inline void Reserve(const size_t count)
+      {
+         Items.reserve(count);
+         Transforms.reserve(count);
+      }
+
+      //Transform is valid till the Clear, several draws may share it
+      inline uint32_t PushTransform(const mm::mat4& transform)
+      {
+         Transforms.push_back(transform);
+         return static_cast<uint32_t>(Transforms.size() - 1);
+      }
+
+      //LOD above the lodsCount of the mesh is drawn as the mesh itself
+      inline void Push(const RenderKey& key, const MeshHandle mesh, const MaterialHandle material, const uint32_t transform,
+                       const size_t lod, const size_t lodsCount)
+      {
+         const size_t level = lod > lodsCount ? 0 : lod;
+
+         Items.push_back({ key, mesh, material, transform, static_cast<uint32_t>(level) });
+      }
+
+      inline void Clear()
+      {
+         Items.clear();
+         Transforms.clear();
+      }
+
+      inline const std::vector<DrawItem>& GetItems() const
+      {
+         return Items;
+      }
+
+      inline const mm::mat4& GetTransform(const uint32_t index) const
+      {
+         return Transforms[index];
+      }
+
+      inline size_t GetCapacity() const
+      {
+         return Items.capacity();
+      }
+   };
+
+   //Vertices of the drawn level are the ones of the registered mesh, nothing is copied for the draw
+   inline const assets::TrigVertices& GetDrawLevel(const Mesh& mesh, const DrawItem& item)
+   {
+      return item.Lod ? *mesh.Vertices.Lods[item.Lod - 1] : mesh.Vertices;
+   }
+}
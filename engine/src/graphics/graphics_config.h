@@ -12,5 +12,8 @@ namespace graphics
 		inline float ShadowBias = 0.005f;
 		inline float LightSize = 0.5f;
 		inline int SoftShadows = 1;
+
+		//Read only at the start, the loaded meshes and the materials keep the layout
+		inline int PackedVertices = 0;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "lod-selection.h"
+
+#include <cmath>
+
+namespace graphics
+{
+   float GetProjectedError(const float error, const LodSelectionParams& params)
+   {
+      if (params.Distance <= 0.0f)
+         return INFINITY;
+
+      return error * params.Scale / (params.Distance * tanf(params.Fov * 0.5f)) * params.ViewportHeight * 0.5f;
+   }
+
+   size_t SelectLod(const float* errors, const size_t errorsCount, const LodSelectionParams& params)
+   {
+      size_t level = 0;
+
+      //Errors only grow along the chain, so the first level that is too coarse ends the search
+      for (size_t i = 0; i < errorsCount; ++i)
+      {
+         if (GetProjectedError(errors[i], params) > params.MaxPixelError)
+            break;
+
+         level = i + 1;
+      }
+
+      return level;
+   }
+}
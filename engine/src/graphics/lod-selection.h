@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+//Runtime side of the mesh LODs, picks the level by the size of its error on the screen
+
+namespace graphics
+{
+   struct LodSelectionParams
+   {
+      float Scale;          //Largest scale of the mesh, the errors are in the object space
+      float Distance;       //From the camera to the mesh origin
+      float Fov;            //Vertical field of view in radians
+      float ViewportHeight; //In pixels
+      float MaxPixelError = 1.0f;
+   };
+
+   //Size of the object space distance on the screen in pixels
+   float GetProjectedError(const float error, const LodSelectionParams& params);
+
+   //Errors are of the simplified levels from the finest to the coarsest, the level 0 is the source mesh without the error
+   //Returns the coarsest level which error stays within the MaxPixelError
+   size_t SelectLod(const float* errors, const size_t errorsCount, const LodSelectionParams& params);
+}
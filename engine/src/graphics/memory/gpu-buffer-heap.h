@@ -0,0 +1,148 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "tlsf-allocator.h"
+
+#include "graphics/api/vertex-buffer.h"
+#include "graphics/api/index-buffer.h"
+#include "graphics/api/shader-buffer.h"
+
+namespace graphics
+{
+   inline void WriteBufferRange(VertexBuffer& buffer, const size_t offset, const size_t size, const void* data)
+   {
+      buffer.UpdateData(size, data, offset);
+   }
+
+   inline void WriteBufferRange(IndexBuffer& buffer, const size_t offset, const size_t size, const void* data)
+   {
+      buffer.UpdateData(size, data, offset);
+   }
+
+   inline void WriteBufferRange(ShaderBuffer& buffer, const size_t offset, const size_t size, const void* data)
+   {
+      buffer.UpdateData(offset, size, const_cast<void*>(data));
+   }
+
+   struct GpuHeapStats
+   {
+      TlsfStats Ranges; //In the elements of the heap
+
+      size_t MovesCount;   //By the defragmentation since the start
+      uint64_t MovedBytes;
+   };
+
+   //Sub-allocates the ranges of the few large buffers instead of the buffer per object
+   //Heap is addressed by the elements, e.g. the vertices: every stream is the buffer with its own stride and the range
+   //of the allocation is the same in all of them, so the attributes of the vertex have the same index
+   //Byte heap is the heap with the stride 1
+   //
+   //Buffer is the VertexBuffer, IndexBuffer or ShaderBuffer, the bookkeeping is done by the TlsfAllocator on the CPU
+   template<typename Buffer>
+   class GpuBufferHeap
+   {
+   private:
+      struct Stream
+      {
+         std::shared_ptr<Buffer> Data;
+         size_t Stride;
+      };
+
+      TlsfAllocator Allocator;
+      uint64_t Capacity;
+
+      std::vector<Stream> Streams;
+
+      std::vector<TlsfMove> Moves;
+
+      size_t MovesCount = 0;
+      uint64_t MovedBytes = 0;
+
+      //Moves to the lower offset, so the copies by the chunks of the move distance never overlap
+      //There are at most MaxMovePieces of them, the allocator doesn't make the shorter moves
+      void CopyRange(Stream& stream, const TlsfMove& move)
+      {
+         const uint64_t distance = move.From - move.To;
+
+         for (uint64_t copied = 0; copied < move.Size; copied += distance)
+         {
+            const uint64_t count = move.Size - copied < distance ? move.Size - copied : distance;
+
+            stream.Data->CopyData(static_cast<size_t>((move.From + copied) * stream.Stride), static_cast<size_t>((move.To + copied) * stream.Stride),
+                                  static_cast<size_t>(count * stream.Stride));
+         }
+
+         MovedBytes += move.Size * stream.Stride;
+      }
+   public:
+      //Shorter moves would be copied by the more pieces, they free too little space for the copies
+      static constexpr uint64_t MaxMovePieces = 8;
+
+      explicit GpuBufferHeap(const uint64_t capacity)
+         : Allocator(capacity), Capacity(capacity) {}
+
+      GpuBufferHeap(const GpuBufferHeap&) = delete;
+      GpuBufferHeap& operator = (const GpuBufferHeap&) = delete;
+
+      //Buffer gets the storage for the whole heap, returns the index of the stream
+      inline uint32_t AddStream(const std::shared_ptr<Buffer>& buffer, const size_t stride)
+      {
+         buffer->InitData(static_cast<size_t>(Capacity * stride), nullptr);
+         Streams.push_back({ buffer, stride });
+
+         return static_cast<uint32_t>(Streams.size() - 1);
+      }
+
+      inline const std::shared_ptr<Buffer>& GetStream(const uint32_t stream) const
+      {
+         return Streams[stream].Data;
+      }
+
+      //Offset of the allocation is changed by the Defragment, so it is taken by the GetOffset when it is used
+      inline bool Allocate(const uint64_t count, const uint64_t alignment, TlsfAllocation& resAllocation)
+      {
+         return Allocator.Allocate(count, alignment, resAllocation);
+      }
+
+      inline void Free(const AllocationId id)
+      {
+         Allocator.Free(id);
+      }
+
+      inline uint64_t GetOffset(const AllocationId id) const
+      {
+         return Allocator.GetOffset(id);
+      }
+
+      //Offset and count are in the elements
+      inline void Write(const uint32_t stream, const uint64_t offset, const void* data, const uint64_t count)
+      {
+         const Stream& s = Streams[stream];
+         WriteBufferRange(*s.Data, static_cast<size_t>(offset * s.Stride), static_cast<size_t>(count * s.Stride), data);
+      }
+
+      //Compacts the allocations by the GPU copies, at most maxMoves allocations are moved by the call
+      //Allocation isn't moved by the distance below the 1 / MaxMovePieces of its size
+      inline size_t Defragment(const size_t maxMoves = SIZE_MAX)
+      {
+         Moves.clear();
+
+         const size_t movesCount = Allocator.Defragment(Moves, maxMoves, MaxMovePieces);
+
+         for (auto& move : Moves)
+            for (auto& stream : Streams)
+               CopyRange(stream, move);
+
+         MovesCount += movesCount;
+
+         return movesCount;
+      }
+
+      inline GpuHeapStats GetStats() const
+      {
+         return { Allocator.GetStats(), MovesCount, MovedBytes };
+      }
+   };
+}
@@ -0,0 +1,399 @@
+#include "tlsf-allocator.h"
+
+#ifdef WINDOWS
+#include <intrin.h>
+#endif
+
+#include "debug/globals.h"
+
+namespace graphics
+{
+   static inline uint32_t FindLowestBit(const uint64_t value)
+   {
+#ifdef WINDOWS
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return index;
+#else
+      return __builtin_ctzll(value);
+#endif
+   }
+
+   static inline uint32_t FindHighestBit(const uint64_t value)
+   {
+#ifdef WINDOWS
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return index;
+#else
+      return 63 - __builtin_clzll(value);
+#endif
+   }
+
+   static inline uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+   {
+      return (value + alignment - 1) / alignment * alignment;
+   }
+
+   //Size class of the block, the sizes below the SecondLevelCount are the first level 0 one by one
+   template<uint32_t SecondLevelBits>
+   static inline void MapSize(const uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+   {
+      constexpr uint64_t SecondLevelCount = 1ull << SecondLevelBits;
+
+      if (size < SecondLevelCount)
+      {
+         firstLevel = 0;
+         secondLevel = static_cast<uint32_t>(size);
+         return;
+      }
+
+      const uint32_t highest = FindHighestBit(size);
+
+      firstLevel = highest - SecondLevelBits + 1;
+      secondLevel = static_cast<uint32_t>((size >> (highest - SecondLevelBits)) - SecondLevelCount);
+   }
+
+   TlsfAllocator::TlsfAllocator(const uint64_t capacity)
+      : Capacity(capacity)
+   {
+      for (auto& lists : FreeLists)
+         for (auto& list : lists)
+            list = NullBlock;
+
+      FirstBlock = CreateBlock(0, capacity);
+
+      if (capacity)
+         InsertFree(FirstBlock);
+   }
+
+   uint32_t TlsfAllocator::CreateBlock(const uint64_t offset, const uint64_t size)
+   {
+      uint32_t block;
+
+      if (!UnusedBlocks.empty())
+      {
+         block = UnusedBlocks.back();
+         UnusedBlocks.pop_back();
+      }
+      else
+      {
+         block = static_cast<uint32_t>(Blocks.size());
+         Blocks.emplace_back();
+      }
+
+      Blocks[block] = { offset, size, NullBlock, NullBlock, NullBlock, NullBlock, 1, false, false };
+
+      return block;
+   }
+
+   void TlsfAllocator::DestroyBlock(const uint32_t block)
+   {
+      Block& b = Blocks[block];
+
+      if (b.PrevPhysical != NullBlock)
+         Blocks[b.PrevPhysical].NextPhysical = b.NextPhysical;
+
+      if (b.NextPhysical != NullBlock)
+         Blocks[b.NextPhysical].PrevPhysical = b.PrevPhysical;
+
+      b.IsFree = false;
+      b.IsAllocated = false;
+
+      UnusedBlocks.push_back(block);
+   }
+
+   void TlsfAllocator::InsertFree(const uint32_t block)
+   {
+      Block& b = Blocks[block];
+
+      uint32_t firstLevel, secondLevel;
+      MapSize<SecondLevelBits>(b.Size, firstLevel, secondLevel);
+
+      uint32_t& head = FreeLists[firstLevel][secondLevel];
+
+      b.IsFree = true;
+      b.PrevFree = NullBlock;
+      b.NextFree = head;
+
+      if (head != NullBlock)
+         Blocks[head].PrevFree = block;
+
+      head = block;
+
+      FirstLevelBitmap |= 1ull << firstLevel;
+      SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+
+      ++FreeBlocksCount;
+   }
+
+   void TlsfAllocator::RemoveFree(const uint32_t block)
+   {
+      Block& b = Blocks[block];
+
+      uint32_t firstLevel, secondLevel;
+      MapSize<SecondLevelBits>(b.Size, firstLevel, secondLevel);
+
+      if (b.PrevFree != NullBlock)
+         Blocks[b.PrevFree].NextFree = b.NextFree;
+      else
+         FreeLists[firstLevel][secondLevel] = b.NextFree;
+
+      if (b.NextFree != NullBlock)
+         Blocks[b.NextFree].PrevFree = b.PrevFree;
+
+      if (FreeLists[firstLevel][secondLevel] == NullBlock)
+      {
+         SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+         if (!SecondLevelBitmaps[firstLevel])
+            FirstLevelBitmap &= ~(1ull << firstLevel);
+      }
+
+      b.IsFree = false;
+
+      --FreeBlocksCount;
+   }
+
+   uint32_t TlsfAllocator::FindFree(const uint64_t size) const
+   {
+      //Size is rounded up to the next class, so any block of the found class fits
+      uint64_t searchSize = size;
+
+      if (size >= SecondLevelCount)
+         searchSize += (1ull << (FindHighestBit(size) - SecondLevelBits)) - 1;
+
+      uint32_t firstLevel, secondLevel;
+      MapSize<SecondLevelBits>(searchSize, firstLevel, secondLevel);
+
+      if (firstLevel < FirstLevelCount)
+      {
+         uint32_t secondMap = SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+         if (!secondMap)
+         {
+            const uint64_t firstMap = firstLevel + 1 < FirstLevelCount ? FirstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+
+            if (firstMap)
+            {
+               firstLevel = FindLowestBit(firstMap);
+               secondMap = SecondLevelBitmaps[firstLevel];
+            }
+         }
+
+         if (secondMap)
+            return FreeLists[firstLevel][FindLowestBit(secondMap)];
+      }
+
+      //Blocks of the class of the size itself may still fit, e.g. the last free space is allocated whole
+      MapSize<SecondLevelBits>(size, firstLevel, secondLevel);
+
+      for (uint32_t block = FreeLists[firstLevel][secondLevel]; block != NullBlock; block = Blocks[block].NextFree)
+      {
+         if (Blocks[block].Size >= size)
+            return block;
+      }
+
+      return NullBlock;
+   }
+
+   void TlsfAllocator::SplitTail(const uint32_t block, const uint64_t size)
+   {
+      if (Blocks[block].Size == size)
+         return;
+
+      const uint32_t tail = CreateBlock(Blocks[block].Offset + size, Blocks[block].Size - size);
+
+      //Blocks may have grown by the CreateBlock
+      Block& b = Blocks[block];
+      Block& t = Blocks[tail];
+
+      t.PrevPhysical = block;
+      t.NextPhysical = b.NextPhysical;
+
+      if (b.NextPhysical != NullBlock)
+         Blocks[b.NextPhysical].PrevPhysical = tail;
+
+      b.NextPhysical = tail;
+      b.Size = size;
+
+      InsertFree(MergeFree(tail));
+   }
+
+   uint32_t TlsfAllocator::MergeFree(uint32_t block)
+   {
+      const uint32_t next = Blocks[block].NextPhysical;
+
+      if (next != NullBlock && Blocks[next].IsFree)
+      {
+         RemoveFree(next);
+
+         Blocks[block].Size += Blocks[next].Size;
+         DestroyBlock(next);
+      }
+
+      const uint32_t prev = Blocks[block].PrevPhysical;
+
+      if (prev != NullBlock && Blocks[prev].IsFree)
+      {
+         RemoveFree(prev);
+
+         Blocks[prev].Size += Blocks[block].Size;
+         DestroyBlock(block);
+
+         block = prev;
+      }
+
+      return block;
+   }
+
+   bool TlsfAllocator::Allocate(const uint64_t size, const uint64_t alignment, TlsfAllocation& resAllocation)
+   {
+      ASSERT(size > 0 && alignment > 0, "Allocation of the zero size or alignment");
+
+      //Block that fits the size with any padding before the aligned offset
+      uint32_t block = FindFree(size + alignment - 1);
+      if (block == NullBlock)
+         return false;
+
+      RemoveFree(block);
+
+      const uint64_t padding = AlignUp(Blocks[block].Offset, alignment) - Blocks[block].Offset;
+
+      //Padding stays the free block before the allocation
+      if (padding)
+      {
+         const uint32_t head = block;
+
+         SplitTail(head, padding);
+         block = Blocks[head].NextPhysical;
+
+         RemoveFree(block);
+         InsertFree(head);
+      }
+
+      SplitTail(block, size);
+
+      Block& b = Blocks[block];
+      b.Alignment = alignment;
+      b.IsAllocated = true;
+
+      UsedSize += size;
+      ++AllocationsCount;
+
+      resAllocation = { block, b.Offset, b.Size };
+
+      return true;
+   }
+
+   void TlsfAllocator::Free(const AllocationId id)
+   {
+      ASSERT(id < Blocks.size() && Blocks[id].IsAllocated, "Freed allocation isn't allocated");
+
+      UsedSize -= Blocks[id].Size;
+      --AllocationsCount;
+
+      Blocks[id].IsAllocated = false;
+
+      InsertFree(MergeFree(id));
+   }
+
+   size_t TlsfAllocator::Defragment(std::vector<TlsfMove>& resMoves, const size_t maxMoves, const uint64_t maxPieces)
+   {
+      size_t movesCount = 0;
+
+      uint32_t block = FirstBlock;
+
+      while (block != NullBlock && movesCount < maxMoves)
+      {
+         const uint32_t next = Blocks[block].NextPhysical;
+
+         if (!Blocks[block].IsFree || next == NullBlock)
+         {
+            block = next;
+            continue;
+         }
+
+         //Free block is always followed by the allocated one, as the neighbour free blocks are merged
+         const uint64_t from = Blocks[next].Offset;
+         const uint64_t to = AlignUp(Blocks[block].Offset, Blocks[next].Alignment);
+
+         //Pieces are ceil(size / distance)
+         if (to >= from || (Blocks[next].Size - 1) / (from - to) >= maxPieces)
+         {
+            block = next;
+            continue;
+         }
+
+         RemoveFree(block);
+
+         //Free space after the moved allocation, it joins the free block after it
+         const uint32_t gap = CreateBlock(0, 0);
+
+         Block& f = Blocks[block];
+         Block& a = Blocks[next];
+         Block& g = Blocks[gap];
+
+         g.Offset = to + a.Size;
+         g.Size = from - to;
+         g.PrevPhysical = next;
+         g.NextPhysical = a.NextPhysical;
+
+         if (a.NextPhysical != NullBlock)
+            Blocks[a.NextPhysical].PrevPhysical = gap;
+
+         a.NextPhysical = gap;
+         a.Offset = to;
+
+         //Padding for the alignment stays free before the allocation
+         if (to > f.Offset)
+         {
+            f.Size = to - f.Offset;
+            InsertFree(block);
+         }
+         else
+         {
+            if (block == FirstBlock)
+               FirstBlock = next;
+
+            DestroyBlock(block);
+         }
+
+         resMoves.push_back({ next, from, to, a.Size });
+         ++movesCount;
+
+         block = MergeFree(gap);
+         InsertFree(block);
+      }
+
+      return movesCount;
+   }
+
+   TlsfStats TlsfAllocator::GetStats() const
+   {
+      TlsfStats stats = {};
+      stats.Capacity = Capacity;
+      stats.UsedSize = UsedSize;
+      stats.FreeSize = Capacity - UsedSize;
+      stats.AllocationsCount = AllocationsCount;
+      stats.FreeBlocksCount = FreeBlocksCount;
+
+      //Largest block is in the highest size class
+      if (FirstLevelBitmap)
+      {
+         const uint32_t firstLevel = FindHighestBit(FirstLevelBitmap);
+         const uint32_t secondLevel = FindHighestBit(SecondLevelBitmaps[firstLevel]);
+
+         for (uint32_t block = FreeLists[firstLevel][secondLevel]; block != NullBlock; block = Blocks[block].NextFree)
+         {
+            if (Blocks[block].Size > stats.LargestFreeBlock)
+               stats.LargestFreeBlock = Blocks[block].Size;
+         }
+      }
+
+      if (stats.FreeSize)
+         stats.Fragmentation = 1.0f - static_cast<float>(static_cast<double>(stats.LargestFreeBlock) / stats.FreeSize);
+
+      return stats;
+   }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//Two level segregated fit allocator of the ranges, it only keeps the books and never touches the memory
+//So it sub-allocates anything that is addressed by the offsets, e.g. the GPU buffers
+
+namespace graphics
+{
+   using AllocationId = uint32_t;
+
+   inline constexpr AllocationId InvalidAllocation = UINT32_MAX;
+
+   struct TlsfAllocation
+   {
+      AllocationId Id = InvalidAllocation;
+
+      uint64_t Offset = 0;
+      uint64_t Size = 0;
+   };
+
+   //Allocation is moved by the defragmentation, the owner copies its data
+   struct TlsfMove
+   {
+      AllocationId Id;
+
+      uint64_t From;
+      uint64_t To;
+      uint64_t Size;
+   };
+
+   struct TlsfStats
+   {
+      uint64_t Capacity;
+      uint64_t UsedSize;
+      uint64_t FreeSize;
+      uint64_t LargestFreeBlock;
+
+      size_t AllocationsCount;
+      size_t FreeBlocksCount;
+
+      //Part of the free space that isn't in the largest free block, 0 when the free space is the single block
+      float Fragmentation;
+   };
+
+   //Free blocks are kept in the lists by their size class: the first level is the power of two, the second one splits it
+   //into SecondLevelCount parts, so the allocation and the free take the constant time
+   //Neighbour free blocks are always merged
+   class TlsfAllocator
+   {
+   private:
+      static constexpr uint32_t SecondLevelBits = 4;
+      static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+      static constexpr uint32_t FirstLevelCount = 64;
+
+      static constexpr uint32_t NullBlock = UINT32_MAX;
+
+      struct Block
+      {
+         uint64_t Offset;
+         uint64_t Size;
+
+         //Neighbours in the address order
+         uint32_t PrevPhysical;
+         uint32_t NextPhysical;
+
+         //Neighbours in the free list of the size class
+         uint32_t PrevFree;
+         uint32_t NextFree;
+
+         uint64_t Alignment; //Of the allocation, the defragmentation keeps it
+
+         bool IsFree;
+         bool IsAllocated; //Unused slots of the Blocks are neither free nor allocated
+      };
+
+      uint64_t Capacity;
+
+      std::vector<Block> Blocks;
+      std::vector<uint32_t> UnusedBlocks;
+
+      uint64_t FirstLevelBitmap = 0;
+      uint32_t SecondLevelBitmaps[FirstLevelCount] = { 0 };
+      uint32_t FreeLists[FirstLevelCount][SecondLevelCount];
+
+      uint32_t FirstBlock; //Block at the offset 0
+
+      uint64_t UsedSize = 0;
+      size_t AllocationsCount = 0;
+      size_t FreeBlocksCount = 0;
+
+      uint32_t CreateBlock(const uint64_t offset, const uint64_t size);
+      void DestroyBlock(const uint32_t block);
+
+      void InsertFree(const uint32_t block);
+      void RemoveFree(const uint32_t block);
+
+      uint32_t FindFree(const uint64_t size) const;
+
+      //Splits the tail after the size into the free block
+      void SplitTail(const uint32_t block, const uint64_t size);
+
+      //Merges the free block with its free neighbours, returns the merged block
+      uint32_t MergeFree(uint32_t block);
+   public:
+      explicit TlsfAllocator(const uint64_t capacity);
+
+      //Alignment isn't needed to be the power of two, e.g. it is the size of the vertex
+      //Returns false when there isn't the free block that fits
+      bool Allocate(const uint64_t size, const uint64_t alignment, TlsfAllocation& resAllocation);
+
+      void Free(const AllocationId id);
+
+      inline uint64_t GetOffset(const AllocationId id) const
+      {
+         return Blocks[id].Offset;
+      }
+
+      inline uint64_t GetSize(const AllocationId id) const
+      {
+         return Blocks[id].Size;
+      }
+
+      //Moves the allocations to the start in the address order, so the free space gathers into the single block at the end
+      //Moves go to the lower offsets and are listed in the address order, so the data of every one is copied before the next one
+      //Stops after maxMoves moves, the rest is moved by the next calls, returns the count of the moves
+      //Move into the overlapping range is copied by the pieces of its distance, the allocations that would take more than maxPieces
+      //pieces stay and keep the small free block before them
+      size_t Defragment(std::vector<TlsfMove>& resMoves, const size_t maxMoves = SIZE_MAX, const uint64_t maxPieces = UINT64_MAX);
+
+      TlsfStats GetStats() const;
+   };
+}
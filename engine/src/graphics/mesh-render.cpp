@@ -1,48 +1,73 @@
 #pragma once
 #include "mesh-render.h"
 #include "entry-point/global_systems.h"
+#include "utils/file-view.h"
 
 #include <sstream>
+#include <cstddef>
 
 namespace graphics
 {
+   static void OpenShaderFile(utils::FileView& file, const std::string_view& filepath)
+   {
+      if (!file.Open(filepath, utils::FileAccess::Sequential))
+         PRINT_AND_TERMINATE("Couldn't read shader file: %s (%s)", std::string(filepath).c_str(), file.GetError().c_str());
+
+      if (!file.GetSize())
+         PRINT_AND_TERMINATE("Shader file is empty: %s", std::string(filepath).c_str());
+   }
+
    BaseMaterial::BaseMaterial(const std::string_view& vertexShaderPath, const std::string_view& fragmentShaderPath,
                               const std::string_view& geomShaderPath)
       : InstanceId(GenerateMaterialId())
    {
       ShaderProgram = g_GraphicsDevice->CreateShaderProgram();
 
-      std::string_view vertexShaderSrc;
-      std::string_view fragmentShaderSrc;
+      //Program keeps the views of the sources until it is compiled, so the files stay open till the end of the constructor
+      utils::FileView vertexShaderFile;
+      utils::FileView fragmentShaderFile;
+      utils::FileView geomShaderFile;
 
-      if ((vertexShaderSrc = utils::ReadFromFile(vertexShaderPath)) == "")
-         PRINT_AND_TERMINATE("Couldn't read vertex shader file: %s", &vertexShaderPath[0]);  
-      if ((fragmentShaderSrc = utils::ReadFromFile(fragmentShaderPath)) == "")
-         PRINT_AND_TERMINATE("Couldn't read fragment shader file: %s", &fragmentShaderPath[0]);
+      OpenShaderFile(vertexShaderFile, vertexShaderPath);
+      OpenShaderFile(fragmentShaderFile, fragmentShaderPath);
 
-      ShaderProgram->AddShader(ShaderType::Vertex, vertexShaderSrc);
-      ShaderProgram->AddShader(ShaderType::Fragment, fragmentShaderSrc);
+      ShaderProgram->AddShader(ShaderType::Vertex, vertexShaderFile.GetText());
+      ShaderProgram->AddShader(ShaderType::Fragment, fragmentShaderFile.GetText());
 
       if (!geomShaderPath.empty())
       {
-         std::string_view geomShaderSrc;
-         if ((geomShaderSrc = utils::ReadFromFile(geomShaderPath)) == "")
-            PRINT_AND_TERMINATE("Couldn't read geometry shader file: %s", &geomShaderPath[0]);
+         OpenShaderFile(geomShaderFile, geomShaderPath);
 
-         ShaderProgram->AddShader(ShaderType::Geometry, geomShaderSrc);
+         ShaderProgram->AddShader(ShaderType::Geometry, geomShaderFile.GetText());
       }
 
       ShaderProgram->Compile();
    }
 
    PhongMaterial::PhongMaterial()
-      : BaseMaterial("res/shaders/phong-shading.vs",
+      : BaseMaterial(cfg::PackedVertices ? "res/shaders/phong-shading-packed.vs" : "res/shaders/phong-shading.vs",
                      "res/shaders/phong-shading.fs")
    {
-      ShaderProgram->AddInputBuffer(g_RenderManager->PositionsVBO, 3, 0, sizeof(mm::vec3), Type::Float);
-      ShaderProgram->AddInputBuffer(g_RenderManager->NormalsVBO, 3, 1, sizeof(mm::vec3), Type::Float);
-      ShaderProgram->AddInputBuffer(g_RenderManager->UVsVBO, 2, 2, sizeof(mm::vec2), Type::Float);
-      ShaderProgram->AddInputBuffer(g_RenderManager->TangentsVBO, 3, 3, sizeof(mm::vec3), Type::Float);
+      if (cfg::PackedVertices)
+      {
+         using assets::cook::PackedVertex;
+
+         auto& vbo = g_RenderManager->PackedVBO;
+
+         ShaderProgram->AddInputBuffer(vbo, 4, 0, sizeof(PackedVertex), Type::Ushort, 0, offsetof(PackedVertex, Position), true);
+         ShaderProgram->AddInputBuffer(vbo, 2, 1, sizeof(PackedVertex), Type::Short, 0, offsetof(PackedVertex, Normal), true);
+         ShaderProgram->AddInputBuffer(vbo, 2, 2, sizeof(PackedVertex), Type::Half, 0, offsetof(PackedVertex, UV));
+         ShaderProgram->AddInputBuffer(vbo, 2, 3, sizeof(PackedVertex), Type::Short, 0, offsetof(PackedVertex, Tangent), true);
+      }
+      else
+      {
+         ShaderProgram->AddInputBuffer(g_RenderManager->PositionsVBO, 3, 0, sizeof(mm::vec3), Type::Float);
+         ShaderProgram->AddInputBuffer(g_RenderManager->NormalsVBO, 3, 1, sizeof(mm::vec3), Type::Float);
+         ShaderProgram->AddInputBuffer(g_RenderManager->UVsVBO, 2, 2, sizeof(mm::vec2), Type::Float);
+         ShaderProgram->AddInputBuffer(g_RenderManager->TangentsVBO, 3, 3, sizeof(mm::vec3), Type::Float);
+      }
+
+      ShaderProgram->SetIndexBuffer(g_RenderManager->IndicesIBO);
 
       ShaderProgram->AddInputBuffer(g_RenderManager->LightsUBO, "LightBlock", (sizeof(PointLightAligned16) + sizeof(SpotlightAligned16)) 
                                                                                * (MaxPointLights + MaxSpotlights));
@@ -7,13 +7,20 @@
 #include "graphics/api/shader-program.h"
 #include "graphics/api/texture2d.h"
 #include "graphics/api/devices/graphics-device.h"
-#include "utils/read-from-file.h"
+#include "graphics/mesh-residency.h"
 #include "debug/globals.h"
 
 namespace graphics
 {
    class BaseMaterial;
 
+   //Indices of the data kept by the RenderManager, the draw items reference it by them
+   using MeshHandle = uint32_t;
+   using MaterialHandle = uint32_t;
+
+   inline constexpr MeshHandle InvalidMeshHandle = UINT32_MAX;
+   inline constexpr MaterialHandle InvalidMaterialHandle = UINT32_MAX;
+
    struct Mesh
    {
       assets::TrigVertices Vertices;
@@ -23,6 +30,12 @@ namespace graphics
       mm::vec3 Scale;
       mm::vec4 Rotation; //This later will be replaced
       mm::vec3 Translate;
+
+      //Set by the RenderManager::MakeResident, the vertices of the resident mesh aren't uploaded by its draws
+      ResidencyHandle Residency = InvalidResidency;
+
+      //Set by the RenderManager::RegisterMesh
+      MeshHandle Handle = InvalidMeshHandle;
    };
 
    inline size_t GenerateMaterialId()
@@ -68,6 +81,9 @@ namespace graphics
       //You shouldn't bind shader in this function
       virtual void ResolveUniforms() {}
 
+      //Used by the texture streaming to find the meshes that need the texture
+      virtual void CollectTextures(std::vector<Texture2D*>& textures) const {}
+
 
       //Through this functions render supply global information to shader
       
@@ -77,6 +93,9 @@ namespace graphics
       virtual void SetCameraPosition(const mm::vec3& position) {}
       virtual void SetSpotlightsCount(const size_t count) {}
       virtual void SetPointLightsCount(const size_t count) {}
+
+      //Packed positions are the unorm inside of these bounds, see assets::cook::PackedVertex
+      virtual void SetVertexBounds(const mm::vec3& offset, const mm::vec3& scale) {}
    };
 
    class PhongMaterial : public BaseMaterial
@@ -101,6 +120,15 @@ namespace graphics
 
       virtual void ResolveUniforms() override;
 
+      virtual void CollectTextures(std::vector<Texture2D*>& textures) const override
+      {
+         for (auto texture : { &DiffuseTexture, &SpecularTexture, &NormalTexture, &EmissiveTexture, &GlossinessTexture })
+         {
+            if (*texture)
+               textures.push_back(texture->get());
+         }
+      }
+
       virtual void SetObjectToWorldMatrix(const mm::mat4& mat) override
       {
          ShaderProgram->SetFloats("ToWorld", mat);
@@ -130,6 +158,12 @@ namespace graphics
       {
          ShaderProgram->SetInt("PointLightsCount", count);
       }
+
+      virtual void SetVertexBounds(const mm::vec3& offset, const mm::vec3& scale) override
+      {
+         ShaderProgram->SetFloats("PositionOffset", offset);
+         ShaderProgram->SetFloats("PositionScale", scale);
+      }
    }; 
 
    class DebugPrimitiveMaterial : public BaseMaterial
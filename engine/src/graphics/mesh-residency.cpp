@@ -0,0 +1,214 @@
+#include "mesh-residency.h"
+
+namespace graphics
+{
+   template<typename T>
+   static uint64_t WriteStream(VertexBuffer& buffer, const std::vector<T>& stream, const uint32_t firstVertex)
+   {
+      if (stream.empty())
+         return 0;
+
+      const size_t size = stream.size() * sizeof(T);
+      buffer.UpdateData(size, stream.data(), static_cast<size_t>(firstVertex) * sizeof(T));
+
+      return size;
+   }
+
+   MeshResidency::MeshResidency(GraphicsDevice& gd, const MeshResidencyParams& params)
+      : Params(params), VertexHeap(static_cast<uint64_t>(params.DynamicVertices) + params.ResidentVertices),
+        IndexHeap(static_cast<uint64_t>(params.DynamicIndices) + params.ResidentIndices)
+   {
+      PositionsVBO = gd.CreateVBO();
+      NormalsVBO = gd.CreateVBO();
+      UVsVBO = gd.CreateVBO();
+      TangentsVBO = gd.CreateVBO();
+      PackedVBO = gd.CreateVBO();
+      IndicesIBO = gd.CreateIBO();
+
+      const size_t dynamicVertices = Params.DynamicVertices;
+
+      if (Params.Format == assets::cook::VertexFormat::Packed)
+      {
+         VertexHeap.AddStream(PackedVBO, sizeof(assets::cook::PackedVertex));
+
+         PositionsVBO->InitData(dynamicVertices * sizeof(mm::vec3), nullptr);
+         NormalsVBO->InitData(dynamicVertices * sizeof(mm::vec3), nullptr);
+         UVsVBO->InitData(dynamicVertices * sizeof(mm::vec2), nullptr);
+         TangentsVBO->InitData(dynamicVertices * sizeof(mm::vec3), nullptr);
+      }
+      else
+      {
+         VertexHeap.AddStream(PositionsVBO, sizeof(mm::vec3));
+         VertexHeap.AddStream(NormalsVBO, sizeof(mm::vec3));
+         VertexHeap.AddStream(UVsVBO, sizeof(mm::vec2));
+         VertexHeap.AddStream(TangentsVBO, sizeof(mm::vec3));
+
+         PackedVBO->InitData(dynamicVertices * sizeof(assets::cook::PackedVertex), nullptr);
+      }
+
+      IndexHeap.AddStream(IndicesIBO, sizeof(uint32_t));
+
+      //Dynamic part is the first allocation of the empty heap, so it is at the offset 0 and the defragmentation never moves it
+      TlsfAllocation dynamic;
+
+      if (Params.DynamicVertices)
+         VertexHeap.Allocate(Params.DynamicVertices, 1, dynamic);
+
+      if (Params.DynamicIndices)
+         IndexHeap.Allocate(Params.DynamicIndices, 1, dynamic);
+   }
+
+   uint64_t MeshResidency::WriteVertices(const assets::TrigVertices& level, const uint32_t firstVertex)
+   {
+      if (!level.PackedVertices.empty())
+         return WriteStream(*PackedVBO, level.PackedVertices, firstVertex);
+
+      return WriteStream(*PositionsVBO, level.Positions, firstVertex) + WriteStream(*NormalsVBO, level.Normals, firstVertex)
+           + WriteStream(*UVsVBO, level.UVs, firstVertex) + WriteStream(*TangentsVBO, level.Tangents, firstVertex);
+   }
+
+   ResidencyHandle MeshResidency::Upload(const assets::TrigVertices& mesh)
+   {
+      const bool isPacked = !mesh.PackedVertices.empty();
+      if (isPacked != (Params.Format == assets::cook::VertexFormat::Packed))
+         return InvalidResidency;
+
+      size_t verticesCount = mesh.GetVerticesCount();
+      size_t indicesCount = mesh.Indices.size();
+
+      for (auto& lod : mesh.Lods)
+      {
+         verticesCount += lod->GetVerticesCount();
+         indicesCount += lod->Indices.size();
+      }
+
+      if (!verticesCount)
+         return InvalidResidency;
+
+      TlsfAllocation vertices;
+      TlsfAllocation indices;
+
+      const bool isAllocated = VertexHeap.Allocate(verticesCount, 1, vertices);
+
+      if (!isAllocated || (indicesCount && !IndexHeap.Allocate(indicesCount, 1, indices)))
+      {
+         if (isAllocated)
+            VertexHeap.Free(vertices.Id);
+
+         LOG_WARNING("Mesh doesn't fit into the resident geometry, it is uploaded by every draw: %s", mesh.Name.c_str());
+         return InvalidResidency;
+      }
+
+      ResidencyHandle handle;
+
+      if (!FreeHandles.empty())
+      {
+         handle = FreeHandles.back();
+         FreeHandles.pop_back();
+      }
+      else
+      {
+         handle = static_cast<ResidencyHandle>(Meshes.size());
+         Meshes.emplace_back();
+      }
+
+      ResidentMesh& resident = Meshes[handle];
+      resident.Vertices = vertices.Id;
+      resident.Indices = indices.Id;
+
+      GeometryRange range = { 0, 0, 0, 0 };
+
+      for (size_t i = 0; i <= mesh.Lods.size(); ++i)
+      {
+         const assets::TrigVertices& level = i ? *mesh.Lods[i - 1] : mesh;
+
+         range.VerticesCount = static_cast<uint32_t>(level.GetVerticesCount());
+         range.IndicesCount = static_cast<uint32_t>(level.Indices.size());
+
+         Stats.ResidentBytes += WriteVertices(level, static_cast<uint32_t>(vertices.Offset) + range.FirstVertex);
+
+         //Indices stay relative to the level, the draw adds its first vertex as the base vertex
+         if (range.IndicesCount)
+         {
+            IndexHeap.Write(0, indices.Offset + range.FirstIndex, level.Indices.data(), range.IndicesCount);
+            Stats.ResidentBytes += range.IndicesCount * sizeof(uint32_t);
+         }
+
+         resident.Levels.push_back(range);
+
+         range.FirstVertex += range.VerticesCount;
+         range.FirstIndex += range.IndicesCount;
+      }
+
+      ++Stats.MeshesCount;
+
+      return handle;
+   }
+
+   void MeshResidency::Release(const ResidencyHandle handle)
+   {
+      ResidentMesh& resident = Meshes[handle];
+
+      VertexHeap.Free(resident.Vertices);
+
+      if (resident.Indices != InvalidAllocation)
+         IndexHeap.Free(resident.Indices);
+
+      resident = ResidentMesh();
+      FreeHandles.push_back(handle);
+
+      --Stats.MeshesCount;
+   }
+
+   GeometryRange MeshResidency::GetLevel(const ResidencyHandle handle, const size_t lod) const
+   {
+      const ResidentMesh& resident = Meshes[handle];
+
+      GeometryRange range = resident.Levels[lod < resident.Levels.size() ? lod : resident.Levels.size() - 1];
+      range.FirstVertex += static_cast<uint32_t>(VertexHeap.GetOffset(resident.Vertices));
+
+      if (resident.Indices != InvalidAllocation)
+         range.FirstIndex += static_cast<uint32_t>(IndexHeap.GetOffset(resident.Indices));
+
+      return range;
+   }
+
+   bool MeshResidency::UploadDynamic(const assets::TrigVertices& level, const size_t indicesCount, GeometryRange& resRange)
+   {
+      const size_t verticesCount = level.GetVerticesCount();
+
+      if (verticesCount > Params.DynamicVertices || indicesCount > Params.DynamicIndices)
+      {
+         LOG_WARNING("Mesh is too big to be drawn without the residency: %s", level.Name.c_str());
+         return false;
+      }
+
+      Stats.DynamicBytes += WriteVertices(level, 0);
+
+      if (indicesCount)
+      {
+         const size_t size = indicesCount * sizeof(uint32_t);
+         IndicesIBO->UpdateData(size, level.Indices.data());
+
+         Stats.DynamicBytes += size;
+      }
+
+      resRange = { 0, static_cast<uint32_t>(verticesCount), 0, static_cast<uint32_t>(indicesCount) };
+
+      return true;
+   }
+
+   size_t MeshResidency::Defragment(const size_t maxMoves)
+   {
+      size_t movesCount = 0;
+
+      //Compact heap has the single free block at its end
+      if (VertexHeap.GetStats().Ranges.FreeBlocksCount > 1)
+         movesCount += VertexHeap.Defragment(maxMoves);
+
+      if (IndexHeap.GetStats().Ranges.FreeBlocksCount > 1)
+         movesCount += IndexHeap.Defragment(maxMoves);
+
+      return movesCount;
+   }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+#include "asset-manager/asset-manager.h"
+#include "graphics/api/devices/graphics-device.h"
+#include "graphics/memory/gpu-buffer-heap.h"
+
+//Geometry of the meshes that stays on the GPU, so the static meshes aren't uploaded by the draws
+
+namespace graphics
+{
+   using ResidencyHandle = uint32_t;
+
+   inline constexpr ResidencyHandle InvalidResidency = UINT32_MAX;
+
+   //Part of the shared buffers with the single level, the FirstVertex is the base vertex of its indices
+   struct GeometryRange
+   {
+      uint32_t FirstVertex;
+      uint32_t VerticesCount;
+
+      uint32_t FirstIndex;
+      uint32_t IndicesCount;
+   };
+
+   struct MeshResidencyParams
+   {
+      //Layout of the resident meshes, the meshes of the other one are drawn through the dynamic part
+      assets::cook::VertexFormat Format = assets::cook::VertexFormat::Float;
+
+      //Start of the buffers is rewritten by every draw of the mesh that isn't resident, e.g. the debug primitives
+      uint32_t DynamicVertices = 500'000;
+      uint32_t DynamicIndices = 1'500'000;
+
+      uint32_t ResidentVertices = 2'000'000;
+      uint32_t ResidentIndices = 6'000'000;
+   };
+
+   struct ResidencyStats
+   {
+      size_t MeshesCount;
+
+      //Bytes sent to the buffers since the start
+      uint64_t ResidentBytes;
+      uint64_t DynamicBytes;
+   };
+
+   //Vertices and indices of the meshes are sub-allocated from the two heaps, the vertex heap has the stream for every
+   //attribute of the resident layout, the same buffers as the materials bind
+   //Mesh is uploaded with all its levels once and then the draws only point to the ranges
+   //Released ranges are reused and the Defragment compacts the heaps, so the ranges are read by the GetLevel at the draw
+   class MeshResidency
+   {
+   private:
+      //Levels are relative to the allocations of the mesh
+      struct ResidentMesh
+      {
+         AllocationId Vertices = InvalidAllocation;
+         AllocationId Indices = InvalidAllocation;
+
+         std::vector<GeometryRange> Levels;
+      };
+
+      MeshResidencyParams Params;
+
+      GpuBufferHeap<VertexBuffer> VertexHeap;
+      GpuBufferHeap<IndexBuffer> IndexHeap;
+
+      std::vector<ResidentMesh> Meshes;
+      std::vector<ResidencyHandle> FreeHandles;
+
+      ResidencyStats Stats = {};
+
+      uint64_t WriteVertices(const assets::TrigVertices& level, const uint32_t firstVertex);
+   public:
+      std::shared_ptr<VertexBuffer> PositionsVBO;
+      std::shared_ptr<VertexBuffer> NormalsVBO;
+      std::shared_ptr<VertexBuffer> UVsVBO;
+      std::shared_ptr<VertexBuffer> TangentsVBO;
+
+      //Interleaved assets::cook::PackedVertex, it replaces the 4 buffers above for the packed meshes
+      std::shared_ptr<VertexBuffer> PackedVBO;
+
+      std::shared_ptr<IndexBuffer> IndicesIBO;
+
+      //Buffers of the other layout have only the dynamic part
+      MeshResidency(GraphicsDevice& gd, const MeshResidencyParams& params);
+
+      //Uploads the mesh and its LODs, returns the InvalidResidency when the mesh doesn't fit or has the other layout
+      ResidencyHandle Upload(const assets::TrigVertices& mesh);
+
+      //Ranges of the mesh are given back to the heaps
+      void Release(const ResidencyHandle handle);
+
+      //Level 0 is the mesh itself, the others are its LODs
+      GeometryRange GetLevel(const ResidencyHandle handle, const size_t lod) const;
+
+      //Writes the level into the dynamic part, only the first indicesCount indices are written
+      bool UploadDynamic(const assets::TrigVertices& level, const size_t indicesCount, GeometryRange& resRange);
+
+      //Moves at most maxMoves ranges of each heap to close the holes left by the released meshes
+      size_t Defragment(const size_t maxMoves);
+
+      inline const ResidencyStats& GetStats() const
+      {
+         return Stats;
+      }
+
+      inline GpuHeapStats GetVertexHeapStats() const
+      {
+         return VertexHeap.GetStats();
+      }
+
+      inline GpuHeapStats GetIndexHeapStats() const
+      {
+         return IndexHeap.GetStats();
+      }
+   };
+}
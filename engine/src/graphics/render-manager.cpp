@@ -8,6 +8,9 @@
 #include "GL/glew.h"
 #include "platforms/opengl/gl-compute-shader.h"
 
+#include "utils/flat-hash-map.h"
+#include "jobs/job-system.h"
+
 namespace graphics
 {
    struct BoundingSphere
@@ -26,17 +29,24 @@ namespace graphics
 
       //Setup VBO's
 
-      PositionsVBO = GD->CreateVBO();
-      PositionsVBO->InitData(MaxVerticesPerDraw * sizeof(mm::vec3), nullptr);
+      MeshResidencyParams geometryParams;
+      geometryParams.Format = cfg::PackedVertices ? assets::cook::VertexFormat::Packed : assets::cook::VertexFormat::Float;
+      geometryParams.DynamicVertices = MaxVerticesPerDraw;
+      geometryParams.DynamicIndices = MaxIndicesPerDraw;
+      geometryParams.ResidentVertices = MaxResidentVertices;
+      geometryParams.ResidentIndices = MaxResidentIndices;
 
-      NormalsVBO = GD->CreateVBO();
-      NormalsVBO->InitData(MaxVerticesPerDraw * sizeof(mm::vec3), nullptr);
+      Geometry = std::make_unique<MeshResidency>(*GD, geometryParams);
 
-      UVsVBO = GD->CreateVBO();
-      UVsVBO->InitData(MaxVerticesPerDraw * sizeof(mm::vec2), nullptr);
+      PositionsVBO = Geometry->PositionsVBO;
+      NormalsVBO = Geometry->NormalsVBO;
+      UVsVBO = Geometry->UVsVBO;
+      TangentsVBO = Geometry->TangentsVBO;
+      PackedVBO = Geometry->PackedVBO;
+      IndicesIBO = Geometry->IndicesIBO;
 
-      TangentsVBO = GD->CreateVBO();
-      TangentsVBO->InitData(MaxVerticesPerDraw * sizeof(mm::vec3), nullptr);
+      CurrentRenderQueue.Reserve(InitialDrawItems);
+      DrawBounds.Reserve(InitialDrawItems);
 
       
       //UBO's setup
@@ -66,29 +76,127 @@ namespace graphics
       GeneralShadowFBO = GD->CreateFBO();
    }
 
-   void RenderManager::ShadowPass(const Camera& camera)
+   MeshHandle RenderManager::RegisterMesh(const std::shared_ptr<Mesh>& mesh)
    {
-      GeneralShadowFBO->Bind();
+      if (mesh->Handle != InvalidMeshHandle)
+         return mesh->Handle;
 
-      GD->SetViewport({ 0, 0 }, { GeneralShadowMap->GetSizeX(), 
-                                  GeneralShadowMap->GetSizeY() });
+      MeshHandle handle;
 
-      GD->EnableFeature(graphics::Feature::Depth);
+      if (!FreeMeshHandles.empty())
+      {
+         handle = FreeMeshHandles.back();
+         FreeMeshHandles.pop_back();
+      }
+      else
+      {
+         handle = static_cast<MeshHandle>(Meshes.size());
+         Meshes.emplace_back();
+         MeshMaterials.emplace_back();
+      }
 
-      //Cause artifacts
-      //GD->SetCullingFace(graphics::Face::Front);
+      Meshes[handle] = mesh;
+      MeshMaterials[handle] = RegisterMaterial(mesh->Material);
 
+      mesh->Handle = handle;
 
-      GeneralShadowFBO->AttachTexture2D(graphics::Attachment::Depth, GeneralShadowMap);
+      MakeResident(*mesh);
 
-      for (size_t i = 0; i < SpotlightCounter; ++i)
+      return handle;
+   }
+
+   void RenderManager::UnregisterMesh(Mesh& mesh)
+   {
+      const MeshHandle handle = mesh.Handle;
+      if (handle == InvalidMeshHandle)
+         return;
+
+      ReleaseResidency(mesh);
+
+      mesh.Handle = InvalidMeshHandle;
+      FreeMeshHandles.push_back(handle);
+
+      //Can be the last owner of the mesh
+      Meshes[handle] = nullptr;
+   }
+
+   MaterialHandle RenderManager::RegisterMaterial(const std::shared_ptr<BaseMaterial>& material)
+   {
+      if (!material)
+         return InvalidMaterialHandle;
+
+      auto [it, isInserted] = MaterialHandles.try_emplace(material.get(), static_cast<MaterialHandle>(Materials.size()));
+
+      if (isInserted)
+         Materials.push_back(material);
+
+      return it->second;
+   }
+
+   static inline mm::vec3 GetTranslation(const mm::mat4& transform)
+   {
+      return mm::vec3(transform.Data[3], transform.Data[7], transform.Data[11]);
+   }
+
+   //Debug the tiled rendering, the volumes are pushed before the views take the queue
+   void RenderManager::PushLightVolumes()
+   {
+      std::vector<BoundingSphere> BoundingSphereList;
+
+      for (size_t i = 0; i < PointLightCounter; ++i)
       {
-         GD->Clear();
+         auto& pl = PointLightList[i];
 
-         auto& sl = SpotlightList[i];
+         float disc = 4 * pl.Offset * pl.Offset - 4 * (pl.Offset * pl.Offset - 10 * pl.Stretch); //10 is the reverse fraction of 1/10 because here we solve fraction equation
+                                                                                                 //This number means what maximum attenuation we will account
 
-         float textureAR = GeneralShadowMap->GetSizeX()
-                           / GeneralShadowMap->GetSizeY();
+         float x = (-2 * pl.Offset + sqrt(disc)) / 2;
+
+         g_DebugManager->AddAASphere({ 1.0f }, 24, PointLightList[i].Position, x);
+
+         BoundingSphere sphere;
+         sphere.Center = pl.Position;
+         sphere.Point = pl.Position + mm::vec4(x, 0.0f, 0.0f, 0.0f);
+
+         BoundingSphereList.push_back(sphere);
+      }
+   }
+
+   //Sphere of the mesh is moved by the transform and grows by its largest scale, so it stays around the rotated mesh too
+   void RenderManager::ComputeDrawBounds()
+   {
+      DrawBounds.Clear();
+
+      for (auto& item : CurrentRenderQueue.GetItems())
+      {
+         const assets::cook::MeshBounds& bounds = Meshes[item.Mesh]->Vertices.Bounds;
+
+         mm::vec3 center;
+         float radius;
+         TransformSphere(CurrentRenderQueue.GetTransform(item.Transform), bounds.Center, bounds.Radius, center, radius);
+
+         DrawBounds.Push(center, radius);
+      }
+   }
+
+   void RenderManager::AddView(const Camera& camera)
+   {
+      if (ViewsCount == Views.size())
+         Views.emplace_back();
+
+      Views[ViewsCount++].ViewCamera = camera;
+   }
+
+   void RenderManager::PrepareViews(const Camera& camera)
+   {
+      ViewsCount = 0;
+
+      float textureAR = GeneralShadowMap->GetSizeX()
+                        / GeneralShadowMap->GetSizeY();
+
+      for (size_t i = 0; i < SpotlightCounter; ++i)
+      {
+         auto& sl = SpotlightList[i];
 
          Camera lightCamera(sl.Position, sl.Direction, textureAR, sl.OuterAngle, 0.0f);
 
@@ -96,43 +204,118 @@ namespace graphics
 
          sl.FrustrumWidth = lightCamera.Fov * lightCamera.Aspect * 2;
 
-         GeometryPass(lightCamera);
-
-         ShadowMaps[i] = GeneralShadowMap;
+         AddView(lightCamera);
       }
 
-      
+      static utils::FlatHashMap<CubeFace, mm::vec3> cubeFaceDirections =
+      {
+         { CubeFace::Top, mm::vec3(0.0f, 1.0f, 0.0f) },
+         { CubeFace::Bottom, mm::vec3(0.0f, -1.0f, 0.0f) },
+         { CubeFace::Front, mm::vec3(0.0f, 0.0f, 1.0f) },
+         { CubeFace::Backward, mm::vec3(0.0f, 0.0f, -1.0f) },
+         { CubeFace::Left, mm::vec3(-1.0f, 0.0f, 0.0f) },
+         { CubeFace::Right, mm::vec3(1.0f, 0.0f, 0.0f) }
+      };
+
       for (size_t i = 0; i < PointLightCounter; ++i)
       {
-         static std::unordered_map<CubeFace, mm::vec3> cubeFaceDirections =
-         {
-            { CubeFace::Top, mm::vec3(0.0f, 1.0f, 0.0f) },
-            { CubeFace::Bottom, mm::vec3(0.0f, -1.0f, 0.0f) },
-            { CubeFace::Front, mm::vec3(0.0f, 0.0f, 1.0f) },
-            { CubeFace::Backward, mm::vec3(0.0f, 0.0f, -1.0f) },
-            { CubeFace::Left, mm::vec3(-1.0f, 0.0f, 0.0f) },
-            { CubeFace::Right, mm::vec3(1.0f, 0.0f, 0.0f) }
-         };
+         auto& pl = PointLightList[i];
 
          for (uint8_t f = 0; f < 6; ++f)
          {
-            GeneralShadowFBO->AttachTexture2D(graphics::Attachment::Depth, static_cast<CubeFace>(f), GeneralCubeShadowMap);
+            Camera lightCamera(pl.Position, cubeFaceDirections.at(static_cast<CubeFace>(f)), textureAR, 1.0f, 0.0f);
 
-            GD->Clear();
+            pl.Cameras[f] = mm::transpose(lightCamera.GetCameraProjection() * lightCamera.GetCameraViewMatrix());
 
-            
-            auto& pl = PointLightList[i];
+            pl.FrustrumWidth = lightCamera.Fov * lightCamera.Aspect * 2;
 
-            float textureAR = GeneralShadowMap->GetSizeX()
-                              / GeneralShadowMap->GetSizeY();
+            AddView(lightCamera);
+         }
+      }
 
-            Camera lightCamera(pl.Position, cubeFaceDirections.at(static_cast<CubeFace>(f)), textureAR, 1.0f, 0.0f);
+      AddView(camera);
 
-            pl.Cameras[f] = mm::transpose(lightCamera.GetCameraProjection() * lightCamera.GetCameraViewMatrix());
+      ComputeDrawBounds();
 
-            pl.FrustrumWidth = lightCamera.Fov * lightCamera.Aspect * 2;
+      //Views only read the queue, so they are built on the job workers
+      core::JobSystem::ParallelFor(ViewsCount, 1, [this](const size_t begin, const size_t end)
+         {
+            for (size_t i = begin; i < end; ++i)
+               BuildView(Views[i]);
+         });
+
+      for (size_t i = 0; i < ViewsCount; ++i)
+         FrameStats.CulledDraws += Views[i].CulledCount;
+   }
+
+   void RenderManager::BuildView(RenderView& view)
+   {
+      const Camera& camera = view.ViewCamera;
+      const float farDepth = camera.Perspective ? PerspectiveFar : camera.Far;
+
+      view.ViewFrustum = ExtractFrustum(camera);
+
+      view.Visible.resize(CurrentRenderQueue.GetItems().size());
 
-            GeometryPass(lightCamera);
+      const size_t visibleCount = CullSpheres(view.ViewFrustum, DrawBounds, view.Visible.data());
+      view.CulledCount = CurrentRenderQueue.GetItems().size() - visibleCount;
+
+      view.Draws.resize(visibleCount);
+
+      //Layer, material and transparency of the key stay, only the depth is of this view
+      for (size_t i = 0; i < visibleCount; ++i)
+      {
+         const uint32_t index = view.Visible[i];
+         const DrawItem& item = CurrentRenderQueue.GetItems()[index];
+
+         const float viewDepth = mm::dot(GetTranslation(CurrentRenderQueue.GetTransform(item.Transform)) - camera.Position, camera.ForwardAxis);
+
+         RenderKey key = item.Key;
+         key.Depth = QuantizeRenderDepth(viewDepth, farDepth, key.Translucent);
+
+         view.Draws[i] = { key.KeyId, index };
+      }
+
+      view.Sorter.Sort(view.Draws);
+   }
+
+   void RenderManager::ShadowPass()
+   {
+      GeneralShadowFBO->Bind();
+
+      GD->SetViewport({ 0, 0 }, { GeneralShadowMap->GetSizeX(), 
+                                  GeneralShadowMap->GetSizeY() });
+
+      GD->EnableFeature(graphics::Feature::Depth);
+
+      //Cause artifacts
+      //GD->SetCullingFace(graphics::Face::Front);
+
+
+      GeneralShadowFBO->AttachTexture2D(graphics::Attachment::Depth, GeneralShadowMap);
+
+      //Views are in the order of the PrepareViews
+      size_t view = 0;
+
+      for (size_t i = 0; i < SpotlightCounter; ++i)
+      {
+         GD->Clear();
+
+         GeometryPass(Views[view++]);
+
+         ShadowMaps[i] = GeneralShadowMap;
+      }
+
+      
+      for (size_t i = 0; i < PointLightCounter; ++i)
+      {
+         for (uint8_t f = 0; f < 6; ++f)
+         {
+            GeneralShadowFBO->AttachTexture2D(graphics::Attachment::Depth, static_cast<CubeFace>(f), GeneralCubeShadowMap);
+
+            GD->Clear();
+
+            GeometryPass(Views[view++]);
 
             CubeShadowMaps[i] = GeneralCubeShadowMap;
          }
@@ -147,63 +330,88 @@ namespace graphics
       GeneralShadowFBO->Unbind();
    }
 
-   void RenderManager::LightPass(const Camera& camera)
+   void RenderManager::LightPass()
    {
       LightsUBO->UpdateData(sizeof(PointLightAligned16) * PointLightCounter, PointLightList);
       LightsUBO->UpdateData(sizeof(SpotlightAligned16) * SpotlightCounter, SpotlightList, sizeof(PointLightAligned16) * MaxPointLights);
 
-      std::vector<BoundingSphere> BoundingSphereList;
+      //Main camera is the last view
+      GeometryPass(Views[ViewsCount - 1]);
 
-      //Debug the tiled rendering
-      for (size_t i = 0; i < PointLightCounter; ++i)
+      //Scene update render data every frame
+      //So this values if fully useable till the light pass
+      PointLightCounter = 0;
+      SpotlightCounter = 0;
+   }
+
+   void RenderManager::GeometryPass(const RenderView& view)
+   {
+      const Camera& camera = view.ViewCamera;
+
+      MaterialHandle lastMaterial = InvalidMaterialHandle;
+
+      for (auto& sorted : view.Draws)
       {
-         auto& pl = PointLightList[i];
+         const DrawItem& item = CurrentRenderQueue.GetItems()[sorted.Index];
+         const Mesh& mesh = *Meshes[item.Mesh];
 
-         float disc = 4 * pl.Offset * pl.Offset - 4 * (pl.Offset * pl.Offset - 10 * pl.Stretch); //10 is the reverse fraction of 1/10 because here we solve fraction equation
-                                                                                                 //This number means what maximum attenuation we will account
+         const bool isResident = mesh.Residency != InvalidResidency;
 
-         float x = (-2 * pl.Offset + sqrt(disc)) / 2;
+         const assets::TrigVertices& level = GetDrawLevel(mesh, item);
 
-         g_DebugManager->AddAASphere({ 1.0f }, 24, PointLightList[i].Position, x);
+         const bool isPacked = !level.PackedVertices.empty();
 
-         BoundingSphere sphere;
-         sphere.Center = pl.Position;
-         sphere.Point = pl.Position + mm::vec4(x, 0.0f, 0.0f, 0.0f);
+         const size_t verticesCount = level.GetVerticesCount();
+         const size_t indicesCount = level.Indices.size();
 
-         BoundingSphereList.push_back(sphere);
-      }
+         //Meshes without the meshlets, e.g. the debug ones, are drawn whole
+         VisibleRanges.clear();
 
-      GeometryPass(camera);
+         if (!level.Meshlets.empty())
+         {
+            MeshletCullParams params;
+            params.ViewFrustum = &view.ViewFrustum;
+            params.CameraPosition = camera.Position;
+            params.Transform = &CurrentRenderQueue.GetTransform(item.Transform);
 
-      //Scene update render data every frame
-      //So this values if fully useable till the light pass
-      PointLightCounter = 0;
-      SpotlightCounter = 0;
-   }
+            const size_t visibleCount = CullMeshlets(level.Meshlets, params, VisibleRanges);
 
-   void RenderManager::GeometryPass(const Camera& camera)
-   {
-      std::sort(CurrentRenderQueue.begin(), CurrentRenderQueue.end(),
-                [](auto& left, auto& right)
-                {
-                   return left.first > right.first;
-                });
+            FrameStats.SubmittedIndices += visibleCount;
+            FrameStats.CulledIndices += indicesCount - visibleCount;
 
-      for (auto& renderer : CurrentRenderQueue)
-      {
-         RenderKey lastKey = { INT64_MAX };
+            if (VisibleRanges.empty())
+               continue;
+         }
+         else if (indicesCount > 0)
+         {
+            VisibleRanges.push_back({ 0, static_cast<uint32_t>(indicesCount) });
+            FrameStats.SubmittedIndices += indicesCount;
+         }
+         else
+         {
+            FrameStats.SubmittedIndices += verticesCount;
+         }
 
-         auto& mesh = renderer.second;
+         GeometryRange range;
 
-         //TODO implement rotation
-         mm::mat4 worldTransform;
-         worldTransform = mm::translate(worldTransform, mesh.Translate);
-         worldTransform = mm::scale(worldTransform, mesh.Scale);
+         if (isResident)
+            range = Geometry->GetLevel(mesh.Residency, item.Lod);
+         else
+         {
+            //Indices after the last visible range aren't needed
+            const size_t uploadCount = VisibleRanges.empty() ? 0 : VisibleRanges.back().FirstIndex + VisibleRanges.back().IndicesCount;
+
+            if (!Geometry->UploadDynamic(level, uploadCount, range))
+               continue;
+         }
 
-         auto& material = mesh.Material;
+         auto& material = Materials[item.Material];
 
-         if (renderer.first.MaterialId != lastKey.MaterialId)
+         //Draws of the same material follow each other after the sort, so its program and camera are set once
+         if (item.Material != lastMaterial)
          {
+            lastMaterial = item.Material;
+
             material->ShaderProgram->Use();
 
             material->SetCameraPosition(camera.Position);
@@ -216,26 +424,58 @@ namespace graphics
             material->ResolveUniforms();
          }
 
-         material->SetObjectToWorldMatrix(worldTransform);
-         material->ResolveUniforms();
+         material->SetObjectToWorldMatrix(CurrentRenderQueue.GetTransform(item.Transform));
 
-         PositionsVBO->UpdateData(mesh.Vertices.Positions.size() * sizeof(mm::vec3), &mesh.Vertices.Positions[0]);
-         NormalsVBO->UpdateData(mesh.Vertices.Normals.size() * sizeof(mm::vec3), &mesh.Vertices.Normals[0]);
-         UVsVBO->UpdateData(mesh.Vertices.UVs.size() * sizeof(mm::vec2), &mesh.Vertices.UVs[0]);
-         TangentsVBO->UpdateData(mesh.Vertices.Tangents.size() * sizeof(mm::vec3), &mesh.Vertices.Tangents[0]);
+         if (isPacked)
+            material->SetVertexBounds(level.PackedBounds.Offset, level.PackedBounds.Scale);
 
-         GD->DrawTriangles(material->ShaderProgram, mesh.Vertices.Positions.size());
+         if (VisibleRanges.empty())
+         {
+            GD->DrawTriangles(material->ShaderProgram, verticesCount, range.FirstVertex);
+            continue;
+         }
+
+         RangeIndexOffsets.clear();
+         RangeIndicesCounts.clear();
+         RangeBaseVertices.clear();
+
+         //Indices of the level start from 0, the FirstVertex of the range is their base vertex
+         for (auto& visible : VisibleRanges)
+         {
+            RangeIndexOffsets.push_back(reinterpret_cast<const void*>((static_cast<size_t>(range.FirstIndex) + visible.FirstIndex) * sizeof(uint32_t)));
+            RangeIndicesCounts.push_back(static_cast<int32_t>(visible.IndicesCount));
+            RangeBaseVertices.push_back(static_cast<int32_t>(range.FirstVertex));
+         }
+
+         GD->DrawIndexedTriangles(material->ShaderProgram, RangeIndexOffsets.data(), RangeIndicesCounts.data(), VisibleRanges.size(),
+                                  RangeBaseVertices.data());
       }
    }
 
    void RenderManager::Update(const Camera& camera)
    {
-      ShadowPass(camera);
+      PushLightVolumes();
+
+      PrepareViews(camera);
+
+      ShadowPass();
+
+      LightPass();
+
+
+      CurrentRenderQueue.Clear();
+
+      //Draws of the frame are issued, so the moved ranges are read by the next one
+      Geometry->Defragment(MaxGeometryMovesPerFrame);
 
-      LightPass(camera);
+      const ResidencyStats& residency = Geometry->GetStats();
+      const uint64_t uploadedBytes = residency.ResidentBytes + residency.DynamicBytes;
 
+      FrameStats.UploadedBytes = uploadedBytes - LastUploadedBytes;
+      LastUploadedBytes = uploadedBytes;
 
-      CurrentRenderQueue.clear();
+      Stats = FrameStats;
+      FrameStats = RenderStats();
 
       PointLightCounter = 0;
       SpotlightCounter = 0;
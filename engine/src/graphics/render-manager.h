@@ -1,6 +1,5 @@
 #pragma once
 #include <vector>
-#include <unordered_map>
 #include <functional>
 
 #include "graphics_config.h"
@@ -8,12 +7,17 @@
 #include "mesh-render.h"
 
 #include "graphics/camera/camera.h"
+#include "graphics/culling.h"
+#include "graphics/draw-queue.h"
+#include "graphics/render-sort.h"
 #include "graphics/light/lights.h"
 
 #include "graphics/api/devices/graphics-device.h"
 #include "graphics/api/vertex-buffer.h"
 #include "graphics/api/uniform-buffer.h"
 
+#include "utils/flat-hash-map.h"
+
 namespace graphics
 {
    struct RenderCfg
@@ -26,34 +30,6 @@ namespace graphics
       int SoftShadows = cfg::SoftShadows;
    };
 
-   union RenderKey
-   {
-      uint64_t KeyId;
-
-      struct
-      {
-         uint32_t Depth : 32;
-         uint32_t MaterialId : 16;
-         uint32_t Opaque : 1;
-         uint32_t Layer : 15;
-      };
-
-      inline bool operator > (const RenderKey& rk) const
-      {
-         return KeyId > rk.KeyId;
-      }
-   };
-
-   struct Layer
-   {
-      enum : uint32_t
-      {
-         Normal,
-         Debug,
-         Hud
-      };
-   };
-
    struct alignas(16) PointLightAligned16
    {
       mm::mat4 Cameras[6];
@@ -86,7 +62,41 @@ namespace graphics
    };
 
 
-   inline constexpr size_t MaxVerticesPerDraw = 500'000;
+   //Meshes that aren't resident are uploaded by every draw into the start of the buffers, so they are limited by these
+   inline constexpr uint32_t MaxVerticesPerDraw = 500'000;
+   inline constexpr uint32_t MaxIndicesPerDraw = 1'500'000;
+
+   inline constexpr uint32_t MaxResidentVertices = 2'000'000;
+   inline constexpr uint32_t MaxResidentIndices = 6'000'000;
+
+   //Released meshes leave the holes in the resident geometry, they are closed by this many moves per frame
+   inline constexpr size_t MaxGeometryMovesPerFrame = 4;
+
+   //Counters of the last frame, every view that draws the mesh counts it again
+   //Indexed meshes count the indices, the triangle soups count the vertices
+   struct RenderStats
+   {
+      size_t SubmittedIndices = 0;
+      size_t CulledIndices = 0;
+
+      size_t CulledDraws = 0; //Draws outside of the view frustum by their bounding spheres
+
+      uint64_t UploadedBytes = 0; //Geometry sent to the GPU, it is zero for the frames that draw only the resident meshes
+   };
+
+   //Camera with its own order of the draws, it is built once per frame and every pass of the view only iterates it
+   struct RenderView
+   {
+      Camera ViewCamera;
+      Frustum ViewFrustum;
+
+      //Draws of the queue inside of the frustum, sorted by the key with the depth from this camera
+      std::vector<SortItem> Draws;
+      RenderSorter Sorter;
+
+      std::vector<uint32_t> Visible; //Scratch of the culling
+      size_t CulledCount = 0;
+   };
 
    inline constexpr size_t MaxPointLights = 32;
    inline constexpr size_t MaxSpotlights = 32;
@@ -100,7 +110,34 @@ namespace graphics
       mm::mat4 ortho;
       mm::mat4 view;
 
-      std::vector<std::pair<RenderKey, Mesh>> CurrentRenderQueue;
+      DrawQueue CurrentRenderQueue;
+
+      //World bounds of every draw of the queue, they are shared by all the views
+      SphereBounds DrawBounds;
+
+      //Views of the frame: the spotlights, the faces of the point lights and the main camera last
+      //Elements above the ViewsCount are kept with their capacities for the next frames
+      std::vector<RenderView> Views;
+      size_t ViewsCount = 0;
+
+      //Data referenced by the draw items, it lives till it is unregistered
+      std::vector<std::shared_ptr<Mesh>> Meshes;
+      std::vector<MaterialHandle> MeshMaterials;
+      std::vector<MeshHandle> FreeMeshHandles;
+
+      std::vector<std::shared_ptr<BaseMaterial>> Materials;
+      utils::FlatHashMap<const BaseMaterial*, MaterialHandle> MaterialHandles;
+
+      //Scratch of the meshlet culling, kept to not allocate per draw
+      std::vector<DrawRange> VisibleRanges;
+      std::vector<const void*> RangeIndexOffsets;
+      std::vector<int32_t> RangeIndicesCounts;
+      std::vector<int32_t> RangeBaseVertices;
+
+      RenderStats Stats;
+      RenderStats FrameStats;
+
+      uint64_t LastUploadedBytes = 0;
 
       PointLightAligned16 PointLightList[MaxPointLights];
       SpotlightAligned16 SpotlightList[MaxSpotlights];
@@ -110,15 +147,31 @@ namespace graphics
 
       std::shared_ptr<GraphicsDevice> GD;
 
-      void ShadowPass(const Camera& camera);
-      void LightPass(const Camera& camera);
-      void GeometryPass(const Camera& camera);
+      std::unique_ptr<MeshResidency> Geometry;
+
+      void PushLightVolumes();
+
+      void ComputeDrawBounds();
+
+      void PrepareViews(const Camera& camera);
+      void AddView(const Camera& camera);
+      void BuildView(RenderView& view);
+
+      void ShadowPass();
+      void LightPass();
+      void GeometryPass(const RenderView& view);
    public:
+      //Buffers of the MeshResidency, the materials bind them
       std::shared_ptr<VertexBuffer> PositionsVBO;
       std::shared_ptr<VertexBuffer> NormalsVBO;
       std::shared_ptr<VertexBuffer> UVsVBO;
       std::shared_ptr<VertexBuffer> TangentsVBO;
 
+      //Interleaved assets::cook::PackedVertex, it replaces the 4 buffers above for the packed meshes
+      std::shared_ptr<VertexBuffer> PackedVBO;
+
+      std::shared_ptr<IndexBuffer> IndicesIBO;
+
       std::shared_ptr<UniformBuffer> LightsUBO;
       std::shared_ptr<UniformBuffer> RenderCfgUBO;
 
@@ -129,9 +182,72 @@ namespace graphics
 
       void Update(const Camera& camera);
 
-      inline void PushRenderRequest(const RenderKey& key, const Mesh& mesh)
+      inline const RenderStats& GetStats() const
       {
-         CurrentRenderQueue.emplace_back(key, mesh);
+         return Stats;
+      }
+
+      inline const ResidencyStats& GetResidencyStats() const
+      {
+         return Geometry->GetStats();
+      }
+
+      //Uploads the mesh with its LODs once, the mesh that doesn't fit stays uploaded by every draw
+      inline void MakeResident(Mesh& mesh)
+      {
+         if (mesh.Residency == InvalidResidency)
+            mesh.Residency = Geometry->Upload(mesh.Vertices);
+      }
+
+      //Geometry of the mesh is given back, the mesh is drawn through the dynamic part after it
+      inline void ReleaseResidency(Mesh& mesh)
+      {
+         if (mesh.Residency == InvalidResidency)
+            return;
+
+         Geometry->Release(mesh.Residency);
+         mesh.Residency = InvalidResidency;
+      }
+
+      //Mesh is kept by the manager and made resident, its draws reference it by the Mesh::Handle
+      MeshHandle RegisterMesh(const std::shared_ptr<Mesh>& mesh);
+
+      //Mesh must not be in the queue of the current frame
+      void UnregisterMesh(Mesh& mesh);
+
+      //Same material is registered once, the materials are kept till the end
+      MaterialHandle RegisterMaterial(const std::shared_ptr<BaseMaterial>& material);
+
+      //Transform is valid till the end of the frame, several draws may share it
+      inline uint32_t PushTransform(const mm::mat4& transform)
+      {
+         return CurrentRenderQueue.PushTransform(transform);
+      }
+
+      inline void PushRenderRequest(const RenderKey& key, const MeshHandle mesh, const MaterialHandle material, const uint32_t transform,
+                                    const size_t lod = 0)
+      {
+         ASSERT(mesh < Meshes.size() && Meshes[mesh], "Drawn mesh isn't registered");
+
+         CurrentRenderQueue.Push(key, mesh, material, transform, lod, Meshes[mesh]->Vertices.Lods.size());
+      }
+
+      inline MaterialHandle GetMaterial(const Mesh& mesh) const
+      {
+         return MeshMaterials[mesh.Handle];
+      }
+
+      //Draws the registered mesh with its material, placed by its Translate and Scale
+      inline void PushRenderRequest(const RenderKey& key, const Mesh& mesh, const size_t lod = 0)
+      {
+         ASSERT(mesh.Handle != InvalidMeshHandle, "Drawn mesh isn't registered");
+
+         //TODO implement rotation
+         mm::mat4 worldTransform;
+         worldTransform = mm::translate(worldTransform, mesh.Translate);
+         worldTransform = mm::scale(worldTransform, mesh.Scale);
+
+         PushRenderRequest(key, mesh.Handle, MeshMaterials[mesh.Handle], PushTransform(worldTransform), lod);
       }
 
 
@@ -0,0 +1,147 @@
+#include "render-sort.h"
+
+#include <cstring>
+#include <thread>
+
+#include "jobs/job-system.h"
+
+namespace graphics
+{
+   uint32_t QuantizeRenderDepth(const float viewDepth, const float farDepth, const bool isTranslucent)
+   {
+      constexpr uint32_t MaxDepth = (1u << RenderKeyDepthBits) - 1;
+
+      float depth = farDepth > 0.0f ? viewDepth / farDepth : 0.0f;
+      depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+
+      const uint32_t quantized = static_cast<uint32_t>(depth * MaxDepth);
+
+      return isTranslucent ? MaxDepth - quantized : quantized;
+   }
+
+   RenderKey BuildRenderKey(const RenderKeyParams& params)
+   {
+      RenderKey key = {};
+      key.Layer = params.Layer;
+      key.Translucent = params.IsTranslucent;
+      key.MaterialId = params.IsTranslucent ? 0 : params.MaterialId & 0xFFFF;
+      key.Depth = QuantizeRenderDepth(params.ViewDepth, params.FarDepth, params.IsTranslucent);
+
+      return key;
+   }
+
+   //Only the passes of the bytes that differ between the keys are counted
+   template<uint32_t PassesCount, uint32_t DigitBits>
+   static void CountDigits(const SortItem* items, const size_t count, const uint32_t* passes, const uint32_t passesCount,
+                           uint32_t (&resCounts)[PassesCount][1 << DigitBits])
+   {
+      constexpr uint64_t DigitMask = (1 << DigitBits) - 1;
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         const uint64_t key = items[i].Key;
+
+         for (uint32_t p = 0; p < passesCount; ++p)
+            ++resCounts[passes[p]][(key >> (passes[p] * DigitBits)) & DigitMask];
+      }
+   }
+
+   void RenderSorter::Sort(std::vector<SortItem>& items, const bool isParallel)
+   {
+      const size_t count = items.size();
+      if (count < 2)
+         return;
+
+      //Bits that differ from the first key, the bytes without them don't change the order
+      const uint64_t firstKey = items[0].Key;
+      uint64_t varyingBits = 0;
+
+      for (size_t i = 1; i < count; ++i)
+         varyingBits |= items[i].Key ^ firstKey;
+
+      uint32_t passes[PassesCount];
+      uint32_t passesCount = 0;
+
+      for (uint32_t pass = 0; pass < PassesCount; ++pass)
+      {
+         if ((varyingBits >> (pass * DigitBits)) & (DigitsCount - 1))
+            passes[passesCount++] = pass;
+      }
+
+      if (!passesCount)
+         return;
+
+      Scratch.resize(count);
+
+      DigitCounts counts;
+      memset(&counts, 0, sizeof(counts));
+
+      size_t batchesCount = 1;
+
+      if (isParallel && count >= MinParallelItems * 2)
+      {
+         const size_t maxBatches = std::thread::hardware_concurrency() + 1;
+
+         batchesCount = count / MinParallelItems;
+         batchesCount = batchesCount < maxBatches ? batchesCount : maxBatches;
+      }
+
+      if (batchesCount > 1)
+      {
+         BatchCounts.resize(batchesCount);
+
+         const size_t batchSize = (count + batchesCount - 1) / batchesCount;
+
+         core::JobSystem::ParallelFor(batchesCount, 1, [&](const size_t begin, const size_t end)
+            {
+               for (size_t batch = begin; batch < end; ++batch)
+               {
+                  const size_t first = batch * batchSize;
+                  const size_t last = first + batchSize < count ? first + batchSize : count;
+
+                  memset(&BatchCounts[batch], 0, sizeof(DigitCounts));
+
+                  if (first < last)
+                     CountDigits<PassesCount, DigitBits>(items.data() + first, last - first, passes, passesCount, BatchCounts[batch].Counts);
+               }
+            });
+
+         for (auto& batch : BatchCounts)
+            for (uint32_t p = 0; p < passesCount; ++p)
+               for (uint32_t digit = 0; digit < DigitsCount; ++digit)
+                  counts.Counts[passes[p]][digit] += batch.Counts[passes[p]][digit];
+      }
+      else
+      {
+         CountDigits<PassesCount, DigitBits>(items.data(), count, passes, passesCount, counts.Counts);
+      }
+
+      SortItem* source = items.data();
+      SortItem* destination = Scratch.data();
+
+      for (uint32_t p = 0; p < passesCount; ++p)
+      {
+         const uint32_t shift = passes[p] * DigitBits;
+         uint32_t* passCounts = counts.Counts[passes[p]];
+
+         //Counts become the offsets of the digits
+         uint32_t offset = 0;
+
+         for (uint32_t digit = 0; digit < DigitsCount; ++digit)
+         {
+            const uint32_t digitCount = passCounts[digit];
+            passCounts[digit] = offset;
+            offset += digitCount;
+         }
+
+         for (size_t i = 0; i < count; ++i)
+            destination[passCounts[(source[i].Key >> shift) & (DigitsCount - 1)]++] = source[i];
+
+         std::swap(source, destination);
+      }
+
+      //Odd count of the passes leaves the result in the scratch
+      if (source != items.data())
+         items.swap(Scratch);
+   }
+}
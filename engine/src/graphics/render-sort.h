@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//Order of the draws, the keys are sorted as the integers by the radix sort
+
+namespace graphics
+{
+   //Draws go in the ascending order of the KeyId: by the layer, the opaque ones before the translucent ones,
+   //then by the material and the depth
+   union RenderKey
+   {
+      uint64_t KeyId;
+
+      struct
+      {
+         uint32_t Depth : 32;
+         uint32_t MaterialId : 16;
+         uint32_t Translucent : 1;
+         uint32_t Layer : 15;
+      };
+
+      inline bool operator < (const RenderKey& rk) const
+      {
+         return KeyId < rk.KeyId;
+      }
+
+      inline bool operator > (const RenderKey& rk) const
+      {
+         return KeyId > rk.KeyId;
+      }
+   };
+
+   struct Layer
+   {
+      enum : uint32_t
+      {
+         Normal,
+         Debug,
+         Hud
+      };
+   };
+
+   //Depth is quantized to fewer bits than its field, so the sort skips the passes of its high bytes
+   //Opaque draws need only the rough front to back order, the translucent ones still get 65536 steps up to the far depth
+   inline constexpr uint32_t RenderKeyDepthBits = 16;
+
+   struct RenderKeyParams
+   {
+      uint32_t Layer = Layer::Normal;
+      bool IsTranslucent = false;
+
+      uint32_t MaterialId = 0; //Only the low 16 bits are kept
+
+      float ViewDepth = 0.0f; //Distance along the view direction
+      float FarDepth = 1.0f;  //Depths beyond it share the last value
+   };
+
+   //Depth field of the key, the translucent depth is reversed to go from the back
+   uint32_t QuantizeRenderDepth(const float viewDepth, const float farDepth, const bool isTranslucent);
+
+   //Opaque draws are grouped by the material and go from the front to the back inside of it
+   //Translucent draws ignore the material and go from the back to the front, as the blending needs
+   RenderKey BuildRenderKey(const RenderKeyParams& params);
+
+   struct SortItem
+   {
+      uint64_t Key;
+      uint32_t Index; //Of the draw in the queue
+   };
+
+   //LSD radix sort of the keys by the bytes, the bytes that are equal in all the keys are neither counted nor sorted
+   //Keeps the scratch buffers, so the sort of every frame doesn't allocate
+   class RenderSorter
+   {
+   private:
+      static constexpr uint32_t DigitBits = 8;
+      static constexpr uint32_t DigitsCount = 1 << DigitBits;
+      static constexpr uint32_t PassesCount = 64 / DigitBits;
+
+      struct DigitCounts
+      {
+         uint32_t Counts[PassesCount][DigitsCount];
+      };
+
+      std::vector<SortItem> Scratch;
+      std::vector<DigitCounts> BatchCounts;
+   public:
+      //Items are counted on the job workers when there are at least this many of them
+      static constexpr size_t MinParallelItems = 16'384;
+
+      //Sorts by the key in the ascending order, the items with the same key keep their order
+      //Histograms of the parallel sort are counted by the batches on the job workers, the scatter stays on the calling thread
+      void Sort(std::vector<SortItem>& items, const bool isParallel = false);
+   };
+}
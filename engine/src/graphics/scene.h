@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 
 #include "entry-point/global_systems.h"
+#include "graphics/lod-selection.h"
 
 namespace scene
 {
@@ -19,11 +21,26 @@ namespace scene
       scene.SceneCamera = camera;
    };
 
+   //Mesh is uploaded to the GPU here, so its draws don't upload it again
    inline void Register(Scene& scene, const std::shared_ptr<graphics::Mesh>& mesh)
    {
+      g_RenderManager->RegisterMesh(mesh);
+
       scene.RegisteredMeshes.push_back(mesh);
    };
 
+   //Resident geometry of the mesh is freed, the hole is closed by the defragmentation of the next frames
+   inline void Unregister(Scene& scene, const std::shared_ptr<graphics::Mesh>& mesh)
+   {
+      auto it = std::find(scene.RegisteredMeshes.begin(), scene.RegisteredMeshes.end(), mesh);
+      if (it == scene.RegisteredMeshes.end())
+         return;
+
+      g_RenderManager->UnregisterMesh(*mesh);
+
+      scene.RegisteredMeshes.erase(it);
+   }
+
    inline void Register(Scene& scene, const std::shared_ptr<graphics::PointLight>& pl)
    {
       scene.RegisteredPointLights.push_back(pl);
@@ -34,17 +51,39 @@ namespace scene
       scene.RegisteredSpotlights.push_back(sl);
    }
 
+   //Coarsest level of the mesh which error is below the pixel on the screen
+   inline size_t SelectLod(const graphics::Mesh& mesh, const graphics::Camera& camera, const float viewportHeight)
+   {
+      constexpr size_t MaxLods = 8;
+
+      float errors[MaxLods];
+      const size_t lodsCount = std::min(mesh.Vertices.Lods.size(), MaxLods);
+
+      for (size_t i = 0; i < lodsCount; ++i)
+         errors[i] = mesh.Vertices.Lods[i]->LodError;
+
+      graphics::LodSelectionParams params;
+      params.Scale = std::max({ fabsf(mesh.Scale.x), fabsf(mesh.Scale.y), fabsf(mesh.Scale.z) });
+      params.Distance = mm::length(camera.Position - mesh.Translate);
+      params.Fov = camera.Fov;
+      params.ViewportHeight = viewportHeight;
+
+      return graphics::SelectLod(errors, lodsCount, params);
+   }
+
    inline void UpdateAndRender(const Scene& scene)
    {
+      const float viewportHeight = static_cast<float>(g_Window->GetCanvas()->GetHeight());
+
       for(auto& mesh : scene.RegisteredMeshes)
       {
-         graphics::RenderKey rk;
-         rk.Depth = ceilf(-mm::length(scene.SceneCamera->Position - mesh->Translate));
-         rk.MaterialId = 0;
-         rk.Opaque = 1;
-         rk.Layer = graphics::Layer::Normal;
+         graphics::RenderKeyParams keyParams;
+         keyParams.Layer = graphics::Layer::Normal;
+         keyParams.MaterialId = g_RenderManager->GetMaterial(*mesh);
+         keyParams.ViewDepth = mm::dot(mesh->Translate - scene.SceneCamera->Position, scene.SceneCamera->ForwardAxis);
+         keyParams.FarDepth = graphics::PerspectiveFar;
 
-         g_RenderManager->PushRenderRequest(rk, *mesh); 
+         g_RenderManager->PushRenderRequest(graphics::BuildRenderKey(keyParams), *mesh, SelectLod(*mesh, *scene.SceneCamera, viewportHeight));
       }
 
       for(auto& pl : scene.RegisteredPointLights)
@@ -0,0 +1,85 @@
+#include "mip-selection.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "asset-manager/cook/mip-chain.h"
+
+namespace graphics
+{
+   namespace streaming
+   {
+      float GetProjectedSize(const MipSelectionParams& params)
+      {
+         if (params.Distance <= params.BoundingRadius)
+            return params.ViewportHeight;
+
+         return params.BoundingRadius / (params.Distance * tanf(params.Fov * 0.5f)) * params.ViewportHeight;
+      }
+
+      uint16_t SelectMipLevel(const int32_t width, const int32_t height, const MipSelectionParams& params)
+      {
+         const size_t lastLevel = assets::cook::GetMipsCount(width, height) - 1;
+
+         if (params.Distance <= params.BoundingRadius)
+            return 0;
+
+         const float projectedSize = GetProjectedSize(params);
+         if (projectedSize <= 0.0f)
+            return static_cast<uint16_t>(lastLevel);
+
+         const float texels = static_cast<float>(std::max(width, height));
+         const float level = floorf(log2f(texels / projectedSize) + params.Bias);
+
+         return static_cast<uint16_t>(std::clamp(level, 0.0f, static_cast<float>(lastLevel)));
+      }
+
+      uint64_t GetResidentSize(const ResidencyRequest& request, const uint16_t firstLevel)
+      {
+         uint64_t size = 0;
+         for (uint16_t i = firstLevel; i < request.LevelsCount; ++i)
+            size += request.LevelSizes[i];
+
+         return size;
+      }
+
+      uint64_t FitResidencyBudget(std::vector<ResidencyRequest>& requests, const uint64_t budget)
+      {
+         uint64_t total = 0;
+
+         for (auto& request : requests)
+         {
+            request.ResidentLevel = std::min<uint16_t>(request.WantedLevel, request.LevelsCount - 1);
+            total += GetResidentSize(request, request.ResidentLevel);
+         }
+
+         while (total > budget)
+         {
+            ResidencyRequest* victim = nullptr;
+            float victimPriority = 0.0f;
+
+            for (auto& request : requests)
+            {
+               if (request.ResidentLevel + 1 >= request.LevelsCount)
+                  continue;
+
+               const float priority = ldexpf(request.Priority, 2 * (request.ResidentLevel - request.WantedLevel));
+
+               if (!victim || priority < victimPriority)
+               {
+                  victim = &request;
+                  victimPriority = priority;
+               }
+            }
+
+            if (!victim)
+               break;
+
+            total -= victim->LevelSizes[victim->ResidentLevel];
+            ++victim->ResidentLevel;
+         }
+
+         return total;
+      }
+   }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//CPU side of the texture streaming, it doesn't touch the GPU, so it is tested without the device
+
+namespace graphics
+{
+   namespace streaming
+   {
+      constexpr size_t MaxStreamedLevels = 16;
+
+      struct MipSelectionParams
+      {
+         float BoundingRadius; //World space radius of the mesh bounds
+         float Distance;       //From the camera to the center of the bounds
+         float Fov;            //Vertical field of view in radians
+         float ViewportHeight; //In pixels
+         float Bias = 0.0f;    //Positive values pick the lower resolution levels
+      };
+
+      //Bounds size on the screen in pixels, the priority of the textures of the mesh
+      float GetProjectedSize(const MipSelectionParams& params);
+
+      //Assumes the texture is mapped once across the bounds, so the mesh that covers N pixels needs N texels
+      //Camera inside of the bounds always needs the level 0
+      uint16_t SelectMipLevel(const int32_t width, const int32_t height, const MipSelectionParams& params);
+
+      struct ResidencyRequest
+      {
+         uint64_t LevelSizes[MaxStreamedLevels];
+         uint16_t LevelsCount;
+
+         uint16_t WantedLevel;
+         float Priority;
+
+         uint16_t ResidentLevel; //Result, levels from it to the end of the chain stay on the GPU
+      };
+
+      //Bytes of the levels from the firstLevel to the end of the chain
+      uint64_t GetResidentSize(const ResidencyRequest& request, const uint16_t firstLevel);
+
+      //Starts from the wanted levels and drops the biggest levels of the least important textures until the budget is met
+      //Every dropped level makes the next drop of the same texture 4 times more costly, so the textures degrade evenly
+      //The last level of every texture is always kept, returns the total resident size
+      uint64_t FitResidencyBudget(std::vector<ResidencyRequest>& requests, const uint64_t budget);
+   }
+}
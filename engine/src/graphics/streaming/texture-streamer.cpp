@@ -0,0 +1,295 @@
+#include "texture-streamer.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "asset-manager/cook/mip-chain.h"
+
+namespace graphics
+{
+   void InitTexture(Texture2D& texture, const assets::PixelsData& image, const TextureParams& params)
+   {
+      static const utils::FlatHashMap<assets::cook::BlockFormat, InternalFormat> compressedFormats =
+      {
+         { assets::cook::BlockFormat::BC1, InternalFormat::BC1 },
+         { assets::cook::BlockFormat::BC3, InternalFormat::BC3 },
+         { assets::cook::BlockFormat::BC5, InternalFormat::BC5 },
+         { assets::cook::BlockFormat::BC7, InternalFormat::BC7 }
+      };
+
+      const bool hasAlpha = image.Channels == 4;
+      const bool isCompressed = image.Compression != assets::cook::BlockFormat::None;
+
+      const InternalFormat internalFormat = isCompressed ? compressedFormats.at(image.Compression)
+                                          : hasAlpha ? InternalFormat::RGBA8 : InternalFormat::RGB8;
+
+      //Storage holds only the loaded levels: the streamed texture doesn't allocate the levels it hasn't read, the atlas chain is cut
+      //before the 1x1 level and the missing levels would make the texture incomplete. Max level of the sampler is set from the same count
+      const size_t levelsCount = image.Mips.size();
+
+      texture.InitData(image.Mips[0].Width, image.Mips[0].Height, internalFormat,
+         hasAlpha ? Format::RGBA : Format::RGB,
+         Type::Ubyte, params, static_cast<uint16_t>(levelsCount));
+
+      UploadLevels(texture, image, static_cast<uint16_t>(image.FirstLevel));
+   }
+
+   void UploadLevels(Texture2D& texture, const assets::PixelsData& image, const uint16_t storageLevel)
+   {
+      const bool isCompressed = image.Compression != assets::cook::BlockFormat::None;
+
+      for (size_t i = 0; i < image.Mips.size(); ++i)
+      {
+         if (image.FirstLevel + i < storageLevel)
+            continue;
+
+         const assets::MipLevel& mip = image.Mips[i];
+         const uint16_t level = static_cast<uint16_t>(image.FirstLevel + i - storageLevel);
+
+         if (isCompressed)
+            texture.UpdateCompressedData(mip.Width, mip.Height, image.GetMipData(i), static_cast<size_t>(mip.Size), level);
+         else
+            texture.UpdateData(mip.Width, mip.Height, image.GetMipData(i), level);
+      }
+   }
+
+   namespace streaming
+   {
+      TextureStreamer::TextureStreamer(GraphicsDevice& gd, LoadLevelsFunc loadLevels, uintptr_t loadArgs, const TextureParams& params,
+                                       const uint64_t budget, const size_t maxLoadsInFlight)
+         : GD(gd), LoadLevels(loadLevels), LoadArgs(loadArgs), Params(params), Budget(budget), MaxLoadsInFlight(maxLoadsInFlight) {}
+
+      TextureStreamer::~TextureStreamer()
+      {
+         core::JobSystem::Wait(Loads);
+      }
+
+      std::shared_ptr<Texture2D> TextureStreamer::Register(const std::string_view& filepath)
+      {
+         //The first level is clamped, so only the last one is loaded
+         assets::PixelsData image = LoadLevels(filepath, MaxStreamedLevels, SIZE_MAX, LoadArgs);
+
+         if (!image.IsValid)
+            PRINT_AND_TERMINATE("Invalid streamed texture: %s", filepath.data());
+
+         const size_t levelsCount = assets::cook::GetMipsCount(image.Width, image.Height);
+         ASSERT(levelsCount <= MaxStreamedLevels, "Streamed texture is too big: %s", filepath.data());
+
+         StreamedTexture texture;
+         texture.Path = filepath;
+         texture.Texture = GD.CreateTexture2D();
+         texture.Width = image.Width;
+         texture.Height = image.Height;
+         texture.ResidentLevel = static_cast<uint16_t>(image.FirstLevel);
+         texture.IsLoading = false;
+
+         InitTexture(*texture.Texture, image, Params);
+
+         ResidencyRequest request = {};
+         request.LevelsCount = static_cast<uint16_t>(levelsCount);
+
+         for (size_t i = 0; i < levelsCount; ++i)
+         {
+            const int32_t width = std::max(1, image.Width >> i);
+            const int32_t height = std::max(1, image.Height >> i);
+
+            request.LevelSizes[i] = assets::cook::GetLevelSize(image.Compression, width, height, image.Channels);
+         }
+
+         TextureLookup[texture.Texture.get()] = Textures.size();
+
+         Textures.push_back(std::move(texture));
+         Requests.push_back(request);
+
+         return Textures.back().Texture;
+      }
+
+      float TextureStreamer::GetBoundingRadius(const Mesh& mesh)
+      {
+         auto find = MeshRadiusLookup.find(&mesh);
+
+         float radius = 0.0f;
+
+         if (find != MeshRadiusLookup.end())
+         {
+            radius = find->second;
+         }
+         else
+         {
+            for (auto& position : mesh.Vertices.Positions)
+               radius = std::max(radius, mm::length(position));
+
+            //Packed meshes have only the bounds, their farthest corner is close enough
+            if (!mesh.Vertices.PackedVertices.empty())
+            {
+               const assets::cook::VertexBounds& bounds = mesh.Vertices.PackedBounds;
+
+               for (size_t corner = 0; corner < 8; ++corner)
+               {
+                  const mm::vec3 position(bounds.Offset.x + (corner & 1 ? bounds.Scale.x : 0.0f),
+                                          bounds.Offset.y + (corner & 2 ? bounds.Scale.y : 0.0f),
+                                          bounds.Offset.z + (corner & 4 ? bounds.Scale.z : 0.0f));
+
+                  radius = std::max(radius, mm::length(position));
+               }
+            }
+
+            MeshRadiusLookup[&mesh] = radius;
+         }
+
+         return radius * std::max({ fabsf(mesh.Scale.x), fabsf(mesh.Scale.y), fabsf(mesh.Scale.z) });
+      }
+
+      void TextureStreamer::SetResidentLevel(const size_t index, const uint16_t level)
+      {
+         StreamedTexture& texture = Textures[index];
+
+         const int32_t width = std::max(1, texture.Width >> level);
+         const int32_t height = std::max(1, texture.Height >> level);
+
+         texture.Texture->Reallocate(static_cast<uint16_t>(width), static_cast<uint16_t>(height),
+                                     static_cast<uint16_t>(Requests[index].LevelsCount - level),
+                                     texture.ResidentLevel - level);
+         texture.ResidentLevel = level;
+      }
+
+      void TextureStreamer::StartLoad(const size_t index, const uint16_t firstLevel)
+      {
+         StreamedTexture& texture = Textures[index];
+
+         //Levels from the resident one are already on the GPU
+         auto load = std::make_unique<LevelsLoad>();
+         load->Streamer = this;
+         load->Path = texture.Path;
+         load->TextureIndex = index;
+         load->FirstLevel = firstLevel;
+         load->LevelsCount = texture.ResidentLevel - firstLevel;
+
+         texture.IsLoading = true;
+         ++Stats.LoadsInFlight;
+
+         core::JobSystem::Execute([](uintptr_t params)
+            {
+               std::unique_ptr<LevelsLoad> load(reinterpret_cast<LevelsLoad*>(params));
+               TextureStreamer& streamer = *load->Streamer;
+
+               load->Image = streamer.LoadLevels(load->Path, load->FirstLevel, load->LevelsCount, streamer.LoadArgs);
+
+               std::lock_guard<utils::sync::SpinLock> l(streamer.FinishedLock);
+               streamer.FinishedLoads.push_back(std::move(load));
+            }, reinterpret_cast<uintptr_t>(load.release()), &Loads);
+      }
+
+      void TextureStreamer::UploadFinishedLoads()
+      {
+         {
+            std::lock_guard<utils::sync::SpinLock> l(FinishedLock);
+            UploadQueue.swap(FinishedLoads);
+         }
+
+         for (auto& load : UploadQueue)
+         {
+            StreamedTexture& texture = Textures[load->TextureIndex];
+
+            texture.IsLoading = false;
+            --Stats.LoadsInFlight;
+
+            //Failed texture is sampled from the levels it has, the next updates try it again
+            if (!load->Image.IsValid)
+            {
+               LOG_ERROR("Failed to stream texture levels: %s", texture.Path.c_str());
+               continue;
+            }
+
+            //Storage could be cut while the levels were read, then they don't continue it and the next updates load them again
+            if (load->FirstLevel + load->LevelsCount != texture.ResidentLevel)
+               continue;
+
+            //Budget could drop some of the read levels meanwhile
+            const uint16_t level = std::max(load->FirstLevel, Requests[load->TextureIndex].ResidentLevel);
+            if (level >= texture.ResidentLevel)
+               continue;
+
+            SetResidentLevel(load->TextureIndex, level);
+            UploadLevels(*texture.Texture, load->Image, level);
+         }
+
+         UploadQueue.clear();
+      }
+
+      void TextureStreamer::Update(const Camera& camera, const std::vector<std::shared_ptr<Mesh>>& meshes, const float viewportHeight)
+      {
+         //Textures that no mesh uses keep only the last level
+         for (auto& request : Requests)
+         {
+            request.WantedLevel = request.LevelsCount - 1;
+            request.Priority = 0.0f;
+         }
+
+         for (auto& mesh : meshes)
+         {
+            if (!mesh->Material)
+               continue;
+
+            MaterialTextures.clear();
+            mesh->Material->CollectTextures(MaterialTextures);
+
+            MipSelectionParams params;
+            params.BoundingRadius = GetBoundingRadius(*mesh);
+            params.Distance = mm::length(camera.Position - mesh->Translate);
+            params.Fov = camera.Fov;
+            params.ViewportHeight = viewportHeight;
+
+            const float priority = GetProjectedSize(params);
+
+            for (auto texture : MaterialTextures)
+            {
+               auto find = TextureLookup.find(texture);
+               if (find == TextureLookup.end())
+                  continue;
+
+               const StreamedTexture& streamed = Textures[find->second];
+               ResidencyRequest& request = Requests[find->second];
+
+               request.WantedLevel = std::min(request.WantedLevel, SelectMipLevel(streamed.Width, streamed.Height, params));
+               request.Priority = std::max(request.Priority, priority);
+            }
+         }
+
+         Stats.WantedBytes = 0;
+         for (auto& request : Requests)
+            Stats.WantedBytes += GetResidentSize(request, request.WantedLevel);
+
+         FitResidencyBudget(Requests, Budget);
+
+         UploadFinishedLoads();
+
+         //Dropped levels are freed right away, the missing ones are loaded and meanwhile the texture uses the levels it has
+         PendingLoads.clear();
+         for (size_t i = 0; i < Textures.size(); ++i)
+         {
+            const StreamedTexture& texture = Textures[i];
+            const uint16_t level = Requests[i].ResidentLevel;
+
+            if (level > texture.ResidentLevel)
+               SetResidentLevel(i, level);
+            else if (level < texture.ResidentLevel && !texture.IsLoading)
+               PendingLoads.push_back(i);
+         }
+
+         //Most visible textures are loaded first
+         std::sort(PendingLoads.begin(), PendingLoads.end(), [this](const size_t a, const size_t b)
+            {
+               return Requests[a].Priority > Requests[b].Priority;
+            });
+
+         Stats.LoadsCount = 0;
+         for (size_t i = 0; i < PendingLoads.size() && Stats.LoadsInFlight < MaxLoadsInFlight; ++i, ++Stats.LoadsCount)
+            StartLoad(PendingLoads[i], Requests[PendingLoads[i]].ResidentLevel);
+
+         Stats.ResidentBytes = 0;
+         for (size_t i = 0; i < Textures.size(); ++i)
+            Stats.ResidentBytes += GetResidentSize(Requests[i], Textures[i].ResidentLevel);
+      }
+   }
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mip-selection.h"
+
+#include "asset-manager/asset-manager.h"
+#include "graphics/api/texture2d.h"
+#include "graphics/api/devices/graphics-device.h"
+#include "graphics/camera/camera.h"
+#include "graphics/mesh-render.h"
+#include "jobs/job-system.h"
+#include "utils/flat-hash-map.h"
+#include "utils/sync/spin-lock.h"
+
+namespace graphics
+{
+   //Creates the storage of the loaded levels only and uploads them, the level 0 of the storage is the first loaded level
+   //Block compressed images are uploaded as is
+   void InitTexture(Texture2D& texture, const assets::PixelsData& image, const TextureParams& params);
+
+   //Uploads the loaded levels into the storage whose level 0 is the storageLevel of the chain, the levels before it are skipped
+   void UploadLevels(Texture2D& texture, const assets::PixelsData& image, const uint16_t storageLevel);
+
+   namespace streaming
+   {
+      //Reads the levelsCount levels of the image from the firstLevel, the firstLevel is clamped to the last level
+      using LoadLevelsFunc = assets::PixelsData(*)(const std::string_view& filepath, const size_t firstLevel, const size_t levelsCount,
+                                                   uintptr_t args);
+
+      //Args are the AssetManager, loose images are decoded in full, with the open derived data cache only the first time
+      inline assets::PixelsData LoadAssetLevels(const std::string_view& filepath, const size_t firstLevel, const size_t levelsCount,
+                                                uintptr_t args)
+      {
+         return reinterpret_cast<const assets::AssetManager*>(args)->LoadImageLevels(filepath, firstLevel, levelsCount);
+      }
+
+      struct StreamingStats
+      {
+         uint64_t ResidentBytes; //Storage of the textures, only the sampled levels are allocated
+         uint64_t WantedBytes;   //Levels that the visible meshes need without the budget
+         size_t LoadsCount;      //Level loads started by the last update
+         size_t LoadsInFlight;   //Level loads that aren't uploaded yet
+      };
+
+      //Keeps sampled only the mip levels that the meshes need, within the memory budget
+      //Every update picks the wanted level of each texture from the size of the mesh bounds on the screen
+      //and fits the levels into the budget. Missing levels are read by the jobs and uploaded by the later updates,
+      //until then the texture is sampled from the levels it already has
+      //Storage holds only the resident levels: dropping the levels reallocates it smaller right away, raising the residency
+      //reallocates it once the missing levels are read. The texture object stays the same, so the materials keep using it
+      class TextureStreamer
+      {
+      private:
+         struct StreamedTexture
+         {
+            std::string Path;
+            std::shared_ptr<Texture2D> Texture;
+
+            int32_t Width;
+            int32_t Height;
+
+            uint16_t ResidentLevel; //Level 0 of the storage, the levels from it to the end of the chain are sampled
+            bool IsLoading;
+         };
+
+         //Levels read by the job, the next update uploads them on the frame thread
+         struct LevelsLoad
+         {
+            TextureStreamer* Streamer;
+            std::string Path;
+            size_t TextureIndex;
+
+            uint16_t FirstLevel;
+            uint16_t LevelsCount;
+
+            assets::PixelsData Image;
+         };
+
+         GraphicsDevice& GD;
+
+         LoadLevelsFunc LoadLevels;
+         uintptr_t LoadArgs;
+
+         TextureParams Params;
+
+         uint64_t Budget;
+         size_t MaxLoadsInFlight;
+
+         //Indices of the textures and their requests are the same
+         std::vector<StreamedTexture> Textures;
+         std::vector<ResidencyRequest> Requests;
+
+         utils::FlatHashMap<const Texture2D*, size_t> TextureLookup;
+         utils::FlatHashMap<const Mesh*, float> MeshRadiusLookup; //Radius of the vertices before the scale
+
+         std::vector<Texture2D*> MaterialTextures;
+         std::vector<size_t> PendingLoads;
+
+         core::JobGroup Loads;
+
+         //Filled by the jobs, the uploads take the whole list under the lock
+         std::vector<std::unique_ptr<LevelsLoad>> FinishedLoads;
+         std::vector<std::unique_ptr<LevelsLoad>> UploadQueue;
+         utils::sync::SpinLock FinishedLock;
+
+         StreamingStats Stats = {};
+
+         float GetBoundingRadius(const Mesh& mesh);
+
+         //Storage is reallocated to the levels from the level, the levels of both storages are kept
+         void SetResidentLevel(const size_t index, const uint16_t level);
+
+         void StartLoad(const size_t index, const uint16_t firstLevel);
+         void UploadFinishedLoads();
+      public:
+         //Levels are read by the loadLevels on the job threads
+         TextureStreamer(GraphicsDevice& gd, LoadLevelsFunc loadLevels, uintptr_t loadArgs, const TextureParams& params,
+                         const uint64_t budget, const size_t maxLoadsInFlight = 2);
+
+         //Waits for the loads in flight, they refer to the streamer
+         ~TextureStreamer();
+
+         //Texture has only the smallest level until the updates stream in the rest
+         std::shared_ptr<Texture2D> Register(const std::string_view& filepath);
+
+         void Update(const Camera& camera, const std::vector<std::shared_ptr<Mesh>>& meshes, const float viewportHeight);
+
+         inline void SetBudget(const uint64_t budget)
+         {
+            Budget = budget;
+         }
+
+         inline const StreamingStats& GetStats() const
+         {
+            return Stats;
+         }
+      };
+   }
+}
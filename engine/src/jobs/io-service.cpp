@@ -0,0 +1,408 @@
+#include "io-service.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "job-system.h"
+#include "debug/globals.h"
+
+#ifdef __linux__
+   #include <sys/uio.h>
+
+   #include "platforms/posix/io-uring.h"
+#endif
+
+namespace core
+{
+   constexpr uint32_t NoChunk = UINT32_MAX;
+
+   //Completion of the entry with this id stops the io_uring thread
+   constexpr uint64_t StopUserData = UINT64_MAX;
+
+#ifdef __linux__
+   struct IoService::UringInfo
+   {
+      utils::IoUring Ring;
+
+      //One per chunk slot, the kernel may read the vector until the chunk is done
+      std::vector<iovec> Vectors;
+
+      std::thread Thread;
+   };
+#else
+   struct IoService::UringInfo {};
+#endif
+
+   static bool HasChunks(const uint64_t nextOffset, const uint64_t size, const size_t retries)
+   {
+      return retries != 0 || nextOffset < size;
+   }
+
+   IoService::IoService(const IoServiceParams& params)
+      : Params(params)
+   {
+      Params.QueueDepth = std::max<uint32_t>(Params.QueueDepth, 1);
+      Params.ChunkSize = std::max<size_t>(Params.ChunkSize, 4096);
+      Params.ReadAheadChunks = std::max<uint32_t>(Params.ReadAheadChunks, 1);
+      Params.FallbackThreads = std::max<uint32_t>(Params.FallbackThreads, 1);
+
+      Chunks.resize(Params.QueueDepth);
+
+      for (uint32_t i = 0; i < Params.QueueDepth; ++i)
+         Chunks[i].NextFree = i + 1 < Params.QueueDepth ? i + 1 : NoChunk;
+
+      FreeChunk = 0;
+
+#ifdef __linux__
+      if (Params.IsUringAllowed)
+      {
+         auto uring = std::make_unique<UringInfo>();
+         std::string error;
+
+         //One more entry for the stop
+         if (uring->Ring.Setup(Params.QueueDepth + 1, error))
+         {
+            uring->Vectors.resize(Params.QueueDepth);
+
+            Uring = std::move(uring);
+            Uring->Thread = std::thread([this]() { RunUringThread(); });
+
+            return;
+         }
+
+         LOG_WARNING("%s, the files are read by the IO threads", error.c_str());
+      }
+#endif
+
+      for (uint32_t i = 0; i < Params.FallbackThreads; ++i)
+         Threads.emplace_back([this]() { RunFallbackThread(); });
+   }
+
+   IoService::~IoService()
+   {
+      Submit();
+
+      //Reads in flight write into the buffers of their files, so they are waited
+      while (true)
+      {
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+
+            if (InFlight == 0 && Active.empty())
+            {
+               IsStopping = true;
+
+#ifdef __linux__
+               if (Uring)
+               {
+                  io_uring_sqe* sqe = Uring->Ring.GetSqe();
+                  while (!sqe)
+                  {
+                     Uring->Ring.Submit();
+                     sqe = Uring->Ring.GetSqe();
+                  }
+
+                  sqe->opcode = IORING_OP_NOP;
+                  sqe->user_data = StopUserData;
+
+                  Uring->Ring.Submit();
+               }
+#endif
+               break;
+            }
+         }
+
+         std::this_thread::yield();
+      }
+
+      ChunkCV.notify_all();
+
+      for (auto& thread : Threads)
+         thread.join();
+
+#ifdef __linux__
+      if (Uring)
+         Uring->Thread.join();
+#endif
+   }
+
+   void IoService::Read(const std::string_view& filepath, ReadCallback callback, uintptr_t args)
+   {
+      ReadOp* op = new ReadOp();
+      op->Result.Path = filepath;
+      op->Callback = callback;
+      op->Args = args;
+
+      op->File = utils::OpenIoFile(filepath, op->Size, op->Result.Error);
+
+      //Nothing to read, the callback is called right away
+      if (op->File == utils::InvalidIoFile || op->Size == 0)
+      {
+         Finish({ op });
+         return;
+      }
+
+      op->Result.Data.resize(static_cast<size_t>(op->Size));
+
+      std::lock_guard<std::mutex> l(Mutex);
+      Queued.push_back(op);
+   }
+
+   void IoService::Submit()
+   {
+      std::lock_guard<std::mutex> l(Mutex);
+
+      if (Queued.empty())
+         return;
+
+      for (ReadOp* op : Queued)
+      {
+         op->IsActive = true;
+         Active.push_back(op);
+      }
+
+      Queued.clear();
+
+      IssueChunks();
+   }
+
+   void IoService::IssueChunks()
+   {
+      size_t issuedCount = 0;
+
+      while (InFlight < Params.QueueDepth && !Active.empty())
+      {
+         ReadOp* op = Active.front();
+         Active.pop_front();
+
+         uint64_t offset;
+         size_t size;
+
+         if (!op->Retries.empty())
+         {
+            offset = op->Retries.back().first;
+            size = op->Retries.back().second;
+
+            op->Retries.pop_back();
+         }
+         else
+         {
+            offset = op->NextOffset;
+            size = static_cast<size_t>(std::min<uint64_t>(Params.ChunkSize, op->Size - offset));
+
+            op->NextOffset += size;
+         }
+
+         const uint32_t id = FreeChunk;
+         FreeChunk = Chunks[id].NextFree;
+
+         Chunks[id] = { op, offset, size, NoChunk };
+
+         ++InFlight;
+         ++op->InFlight;
+
+         Stats.MaxChunksInFlight = std::max(Stats.MaxChunksInFlight, InFlight);
+
+         //File takes the turn again while it has the chunks and the room in its read ahead window
+         op->IsActive = HasChunks(op->NextOffset, op->Size, op->Retries.size()) && op->InFlight < Params.ReadAheadChunks;
+
+         if (op->IsActive)
+            Active.push_back(op);
+
+#ifdef __linux__
+         if (Uring)
+         {
+            iovec& vector = Uring->Vectors[id];
+            vector.iov_base = op->Result.Data.data() + offset;
+            vector.iov_len = size;
+
+            //Queue is as deep as the chunk slots, but the kernel could still hold the entries of the failed submit
+            io_uring_sqe* sqe = Uring->Ring.GetSqe();
+            while (!sqe)
+            {
+               Uring->Ring.Submit();
+               sqe = Uring->Ring.GetSqe();
+            }
+
+            sqe->opcode = IORING_OP_READV;
+            sqe->fd = static_cast<int32_t>(op->File);
+            sqe->addr = reinterpret_cast<uint64_t>(&vector);
+            sqe->len = 1;
+            sqe->off = offset;
+            sqe->user_data = id;
+
+            ++issuedCount;
+            continue;
+         }
+#endif
+
+         ReadyChunks.push_back(id);
+         ++issuedCount;
+      }
+
+      if (!issuedCount)
+         return;
+
+#ifdef __linux__
+      if (Uring)
+      {
+         Uring->Ring.Submit();
+         return;
+      }
+#endif
+
+      if (issuedCount == 1)
+         ChunkCV.notify_one();
+      else
+         ChunkCV.notify_all();
+   }
+
+   void IoService::CompleteChunk(const uint32_t chunkId, const int64_t res, const std::string& error, std::vector<ReadOp*>& finished)
+   {
+      const Chunk chunk = Chunks[chunkId];
+
+      Chunks[chunkId].NextFree = FreeChunk;
+      FreeChunk = chunkId;
+
+      --InFlight;
+
+      ReadOp* op = chunk.Op;
+      --op->InFlight;
+
+      ++Stats.ChunksRead;
+
+      //Failed file issues no more chunks, the ones in flight are still waited
+      if (res < 0 || (res == 0 && chunk.Size != 0))
+      {
+         if (op->Result.Error.empty())
+            op->Result.Error = res < 0 ? "Couldn't read: " + error : "Couldn't read: Unexpected end of file";
+
+         op->NextOffset = op->Size;
+         op->Retries.clear();
+      }
+      else
+      {
+         Stats.BytesRead += static_cast<uint64_t>(res);
+
+         //Short read, e.g. of the network storage, the rest is read again
+         if (static_cast<size_t>(res) < chunk.Size)
+            op->Retries.push_back({ chunk.Offset + res, chunk.Size - static_cast<size_t>(res) });
+      }
+
+      const bool hasChunks = HasChunks(op->NextOffset, op->Size, op->Retries.size());
+
+      if (hasChunks && !op->IsActive)
+      {
+         op->IsActive = true;
+         Active.push_back(op);
+      }
+
+      if (!hasChunks && op->InFlight == 0)
+      {
+         ++Stats.FilesRead;
+         finished.push_back(op);
+      }
+   }
+
+   void IoService::Finish(const std::vector<ReadOp*>& finished)
+   {
+      for (ReadOp* op : finished)
+      {
+         if (op->File != utils::InvalidIoFile)
+            utils::CloseIoFile(op->File);
+
+         op->Result.IsSucceeded = op->Result.Error.empty();
+
+         JobSystem::Execute([](uintptr_t params)
+            {
+               std::unique_ptr<ReadOp> op(reinterpret_cast<ReadOp*>(params));
+               op->Callback(op->Result, op->Args);
+            }, reinterpret_cast<uintptr_t>(op));
+      }
+   }
+
+   void IoService::RunFallbackThread()
+   {
+      std::vector<ReadOp*> finished;
+
+      std::unique_lock<std::mutex> l(Mutex);
+
+      while (true)
+      {
+         ChunkCV.wait(l, [this]() { return IsStopping || !ReadyChunks.empty(); });
+
+         if (ReadyChunks.empty())
+            return;
+
+         const uint32_t id = ReadyChunks.front();
+         ReadyChunks.pop_front();
+
+         const Chunk chunk = Chunks[id];
+
+         l.unlock();
+
+         const int64_t res = utils::ReadIoFile(chunk.Op->File, chunk.Offset, chunk.Op->Result.Data.data() + chunk.Offset, chunk.Size);
+         const std::string error = res < 0 ? utils::GetIoError() : std::string();
+
+         l.lock();
+
+         CompleteChunk(id, res, error, finished);
+         IssueChunks();
+
+         if (!finished.empty())
+         {
+            l.unlock();
+
+            Finish(finished);
+            finished.clear();
+
+            l.lock();
+         }
+      }
+   }
+
+   void IoService::RunUringThread()
+   {
+#ifdef __linux__
+      std::vector<ReadOp*> finished;
+
+      bool isStopped = false;
+
+      while (!isStopped)
+      {
+         Uring->Ring.Wait();
+
+         {
+            std::lock_guard<std::mutex> l(Mutex);
+
+            Uring->Ring.ForEachCompletion([&](const uint64_t userData, const int32_t res)
+               {
+                  if (userData == StopUserData)
+                  {
+                     isStopped = true;
+                     return;
+                  }
+
+                  CompleteChunk(static_cast<uint32_t>(userData), res, res < 0 ? strerror(-res) : "", finished);
+               });
+
+            IssueChunks();
+         }
+
+         Finish(finished);
+         finished.clear();
+      }
+#endif
+   }
+
+   bool IoService::IsUring() const
+   {
+      return Uring != nullptr;
+   }
+
+   IoStats IoService::GetStats()
+   {
+      std::lock_guard<std::mutex> l(Mutex);
+      return Stats;
+   }
+}
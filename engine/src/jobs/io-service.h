@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "utils/io-file.h"
+
+namespace core
+{
+   struct ReadResult
+   {
+      std::string Path;
+      std::vector<uint8_t> Data;
+
+      bool IsSucceeded = false;
+      std::string Error;
+   };
+
+   //Runs as the job, the result can be moved out
+   using ReadCallback = void(*)(ReadResult& result, uintptr_t args);
+
+   struct IoServiceParams
+   {
+      //Chunks that are read at once across all the files, it is the depth of the device queue
+      uint32_t QueueDepth = 64;
+
+      size_t ChunkSize = 256 * 1024;
+
+      //Chunks of the single file that are read at once, the next one is issued when any of them is done
+      //So the big file is read ahead of the consumer while the small files still get the device
+      uint32_t ReadAheadChunks = 8;
+
+      //Threads of the fallback, they block on the reads instead of the job threads
+      uint32_t FallbackThreads = 4;
+
+      bool IsUringAllowed = true;
+   };
+
+   struct IoStats
+   {
+      uint64_t BytesRead;
+      size_t FilesRead;
+      size_t ChunksRead;
+      uint32_t MaxChunksInFlight;
+   };
+
+   //Reads the whole files asynchronously, so the job threads never wait for the disk
+   //
+   //Reads are queued by the Read and issued together by the Submit. Every file is split into the chunks and up to the
+   //QueueDepth of them are in flight at once, which is what keeps the NVMe and the network storage busy. On Linux the
+   //chunks go through the io_uring, elsewhere or when it isn't available the small pool of the IO threads reads them
+   //
+   //Callback of the file is executed by the JobSystem when all its chunks are done
+   class IoService
+   {
+   private:
+      struct ReadOp
+      {
+         ReadResult Result;
+         ReadCallback Callback;
+         uintptr_t Args;
+
+         utils::IoFile File;
+         uint64_t Size;
+         uint64_t NextOffset = 0;
+
+         //Parts of the short reads that are read again before the new chunks
+         std::vector<std::pair<uint64_t, size_t>> Retries;
+
+         uint32_t InFlight = 0;
+         bool IsActive = false; //Is in the Active queue
+      };
+
+      struct Chunk
+      {
+         ReadOp* Op;
+         uint64_t Offset;
+         size_t Size;
+
+         uint32_t NextFree;
+      };
+
+      struct UringInfo;
+      std::unique_ptr<UringInfo> Uring;
+
+      IoServiceParams Params;
+
+      std::mutex Mutex;
+      std::condition_variable ChunkCV; //Fallback threads wait for the chunks on it
+
+      std::vector<ReadOp*> Queued;  //Waiting for the Submit
+      std::deque<ReadOp*> Active;   //Have the chunks to issue, they take the turns
+
+      std::vector<Chunk> Chunks;    //QueueDepth slots, the index is the id of the read in flight
+      uint32_t FreeChunk;
+      uint32_t InFlight = 0;
+
+      std::deque<uint32_t> ReadyChunks; //Issued to the fallback threads
+      std::vector<std::thread> Threads;
+
+      bool IsStopping = false;
+
+      IoStats Stats = {};
+
+      //Called under the lock
+      void IssueChunks();
+
+      //Called under the lock, res is the bytes read or the negative value with the error text
+      void CompleteChunk(const uint32_t chunkId, const int64_t res, const std::string& error, std::vector<ReadOp*>& finished);
+
+      void Finish(const std::vector<ReadOp*>& finished);
+
+      void RunFallbackThread();
+
+      void RunUringThread();
+   public:
+      IoService(const IoServiceParams& params = IoServiceParams());
+
+      //Waits for the reads in flight, their callbacks are still run by the jobs
+      ~IoService();
+
+      IoService(const IoService&) = delete;
+      IoService& operator = (const IoService&) = delete;
+
+      //File is opened right away, the failure to open it is reported by the callback as well
+      void Read(const std::string_view& filepath, ReadCallback callback, uintptr_t args);
+
+      //Issues the reads queued since the last call in the single batch
+      void Submit();
+
+      bool IsUring() const;
+
+      IoStats GetStats();
+   };
+}
@@ -19,20 +19,18 @@ namespace core
             {
                while (true)
                {
-                  if (JobList.Empty())
+                  JobInfo job;
+
                   {
+                     //Jobs are added under the same mutex, so the notify can't be lost between the check and the wait
                      std::unique_lock<std::mutex> l(Mutex);
-                     JobNotifyCV.wait(l);
-                  }
+                     JobNotifyCV.wait(l, []() { return !JobList.Empty(); });
 
-                  JobInfo job = JobList.GetNext();
-
-                  for (uint16_t i = 0; i < job.InstanceCount; ++i)
-                  {
-                     job.EntryPoint(job.Params);
+                     if (!JobList.TryGetNext(job))
+                        continue; //Other thread took the job first
                   }
 
-                  FinishedJobCounter.fetch_add(1);
+                  Run(job);
                }
             });
 
@@ -1,7 +1,10 @@
 #pragma once
 #include <thread>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <any>
@@ -12,11 +15,26 @@ namespace core
 {
    using JobFunc = void(*)(uintptr_t params);
 
+   //Counts the unfinished jobs of the group, so the part of the work can be waited without the global Wait
+   class JobGroup
+   {
+   private:
+      friend class JobSystem;
+
+      std::atomic_size_t Pending = 0;
+   public:
+      inline bool IsDone() const
+      {
+         return Pending.load(std::memory_order_acquire) == 0;
+      }
+   };
+
    struct JobInfo
    {
       JobFunc    EntryPoint;
       uintptr_t  Params;
       uint16_t   InstanceCount;
+      JobGroup*  Group;
    };
 
    class AsyncJobList
@@ -32,14 +50,18 @@ namespace core
          List.emplace_back(info);
       }
 
-      inline JobInfo GetNext() const
+      //Returns false if the list is empty, the check and the pop are done under the same lock
+      inline bool TryGetNext(JobInfo& job) const
       {
          std::lock_guard<utils::sync::SpinLock> l(SpinLock);
 
-         JobInfo job = List.front();
+         if (List.empty())
+            return false;
+
+         job = List.front();
          List.pop_front();
 
-         return job;
+         return true;
       }
 
       inline bool Empty() const
@@ -55,27 +77,113 @@ namespace core
       static inline AsyncJobList JobList;
 
       static inline std::atomic_size_t FinishedJobCounter;
-      static volatile inline size_t JobCounter;
+      static inline std::atomic_size_t JobCounter;
 
       static inline std::condition_variable JobNotifyCV;
       static inline std::mutex Mutex;
+
+      static inline void Run(const JobInfo& job)
+      {
+         for (uint16_t i = 0; i < job.InstanceCount; ++i)
+         {
+            job.EntryPoint(job.Params);
+         }
+
+         if (job.Group)
+            job.Group->Pending.fetch_sub(1, std::memory_order_acq_rel);
+
+         FinishedJobCounter.fetch_add(1);
+      }
+
+      template<typename F>
+      struct ParallelForBatch
+      {
+         const F* Func;
+         size_t Begin;
+         size_t End;
+      };
    public:
       static void Setup();
 
-      inline static void Execute(JobFunc func, uintptr_t params = 0)
+      //Runs one job on the calling thread, returns false if there was nothing to run
+      static inline bool RunNext()
       {
-         std::lock_guard l(Mutex);
+         JobInfo job;
+         if (!JobList.TryGetNext(job))
+            return false;
+
+         Run(job);
+         return true;
+      }
 
-         JobList.AddJob({ func, params, 1 });
+      inline static void Execute(JobFunc func, uintptr_t params = 0, JobGroup* group = nullptr)
+      {
+         if (group)
+            group->Pending.fetch_add(1, std::memory_order_relaxed);
 
          ++JobCounter;
 
+         std::lock_guard l(Mutex);
+
+         JobList.AddJob({ func, params, 1, group });
+
          JobNotifyCV.notify_one();
       }
 
       inline static void Wait()
       {
-         while (FinishedJobCounter.load() < JobCounter);
+         while (FinishedJobCounter.load() < JobCounter.load());
+      }
+
+      //Waiting thread runs the queued jobs itself, so it is safe to wait for the group from inside of a job
+      inline static void Wait(const JobGroup& group)
+      {
+         while (!group.IsDone())
+         {
+            if (!RunNext())
+               std::this_thread::yield();
+         }
+      }
+
+      //Splits [0, count) into the batches of at least minBatchSize and calls func(begin, end) for each of them
+      //Calling thread takes the part of the work and returns when all the batches are done
+      template<typename F>
+      static void ParallelFor(const size_t count, const size_t minBatchSize, const F& func)
+      {
+         if (!count)
+            return;
+
+         const size_t maxBatches = std::thread::hardware_concurrency() + 1;
+         const size_t batchSize = std::max(minBatchSize, (count + maxBatches - 1) / maxBatches);
+
+         if (batchSize >= count)
+         {
+            func(size_t(0), count);
+            return;
+         }
+
+         const size_t batchesCount = (count + batchSize - 1) / batchSize;
+
+         std::vector<ParallelForBatch<F>> batches(batchesCount);
+         JobGroup group;
+
+         for (size_t i = 0; i < batchesCount; ++i)
+         {
+            batches[i] = { &func, i * batchSize, std::min(count, (i + 1) * batchSize) };
+
+            if (i == 0)
+               continue;
+
+            Execute([](uintptr_t params)
+               {
+                  auto batch = reinterpret_cast<const ParallelForBatch<F>*>(params);
+                  (*batch->Func)(batch->Begin, batch->End);
+               }, reinterpret_cast<uintptr_t>(&batches[i]), &group);
+         }
+
+         func(batches[0].Begin, batches[0].End);
+
+         Wait(group);
       }
    };
-}
\ No newline at end of file
+}
@@ -0,0 +1,178 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "job-system.h"
+
+namespace core
+{
+   Pipeline::Pipeline(const std::vector<PipelineStage>& stages, const size_t queueCapacity)
+      : Stages(stages), States(stages.size()), QueueCapacity(std::max<size_t>(queueCapacity, 1)) {}
+
+   Pipeline::~Pipeline()
+   {
+      auto isRunning = [this]()
+      {
+         return std::any_of(States.begin(), States.end(), [](const StageState& state) { return state.Running != 0; });
+      };
+
+      while (isRunning())
+      {
+         CollectFinished();
+         std::this_thread::yield();
+      }
+   }
+
+   void Pipeline::Add(const uintptr_t item)
+   {
+      StageState& first = States[0];
+
+      first.Queued.push_back(item);
+      first.Stats.MaxQueued = std::max(first.Stats.MaxQueued, first.Queued.size());
+
+      ++Pending;
+   }
+
+   void Pipeline::Complete(const uint32_t stage, const uintptr_t item, const bool isSucceeded)
+   {
+      std::lock_guard<utils::sync::SpinLock> l(FinishedSL);
+      FinishedItems.push_back({ stage, item, isSucceeded });
+   }
+
+   bool Pipeline::CanStart(const uint32_t stage) const
+   {
+      const StageState& state = States[stage];
+
+      if (state.Queued.empty() || state.Running >= Stages[stage].Concurrency)
+         return false;
+
+      //Last stage has nowhere to put its items, they leave the pipeline
+      if (stage + 1 == Stages.size())
+         return true;
+
+      return state.Running + States[stage + 1].Queued.size() < QueueCapacity;
+   }
+
+   void Pipeline::Finish(const uint32_t stage, const uintptr_t item, const bool isSucceeded)
+   {
+      StageState& state = States[stage];
+
+      --state.Running;
+      ++state.Stats.Processed;
+
+      if (!isSucceeded)
+         ++state.Stats.Failed;
+
+      if (!isSucceeded || stage + 1 == Stages.size())
+      {
+         --Pending;
+         return;
+      }
+
+      StageState& next = States[stage + 1];
+
+      next.Queued.push_back(item);
+      next.Stats.MaxQueued = std::max(next.Stats.MaxQueued, next.Queued.size());
+   }
+
+   void Pipeline::CollectFinished()
+   {
+      std::vector<FinishedItem> finished;
+
+      {
+         std::lock_guard<utils::sync::SpinLock> l(FinishedSL);
+         finished.swap(FinishedItems);
+      }
+
+      for (auto& item : finished)
+         Finish(item.Stage, item.Item, item.IsSucceeded);
+   }
+
+   void Pipeline::Pump()
+   {
+      CollectFinished();
+
+      //Later stages go first, so the items they take free the room for the earlier ones in the same pump
+      for (uint32_t stage = static_cast<uint32_t>(Stages.size()); stage-- > 0;)
+      {
+         const PipelineStage& desc = Stages[stage];
+         StageState& state = States[stage];
+
+         if (desc.IsMainThread)
+         {
+            for (uint16_t i = 0; i < desc.Concurrency && CanStart(stage); ++i)
+            {
+               const uintptr_t item = state.Queued.front();
+               state.Queued.pop_front();
+
+               ++state.Running;
+               state.Stats.MaxRunning = std::max(state.Stats.MaxRunning, state.Running);
+
+               Finish(stage, item, desc.Func(item, desc.Args));
+            }
+
+            continue;
+         }
+
+         if (desc.IsAsync)
+         {
+            bool isStarted = false;
+
+            while (CanStart(stage))
+            {
+               const uintptr_t item = state.Queued.front();
+               state.Queued.pop_front();
+
+               ++state.Running;
+               state.Stats.MaxRunning = std::max(state.Stats.MaxRunning, state.Running);
+
+               isStarted = true;
+
+               if (!desc.Func(item, desc.Args))
+                  Finish(stage, item, false);
+            }
+
+            if (isStarted && desc.Flush)
+               desc.Flush(desc.Args);
+
+            continue;
+         }
+
+         while (CanStart(stage))
+         {
+            StageJob* job = new StageJob({ this, stage, state.Queued.front() });
+            state.Queued.pop_front();
+
+            ++state.Running;
+            state.Stats.MaxRunning = std::max(state.Stats.MaxRunning, state.Running);
+
+            JobSystem::Execute([](uintptr_t args)
+               {
+                  StageJob* job = reinterpret_cast<StageJob*>(args);
+                  Pipeline* owner = job->Owner;
+
+                  const PipelineStage& desc = owner->Stages[job->Stage];
+                  owner->Complete(job->Stage, job->Item, desc.Func(job->Item, desc.Args));
+
+                  delete job;
+               }, reinterpret_cast<uintptr_t>(job));
+         }
+      }
+   }
+
+   void Pipeline::Drain()
+   {
+      while (true)
+      {
+         Pump();
+
+         if (IsDone())
+            break;
+
+         if (!JobSystem::RunNext())
+            std::this_thread::yield();
+      }
+   }
+}
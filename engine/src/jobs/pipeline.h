@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+
+#include "utils/sync/spin-lock.h"
+
+namespace core
+{
+   //Stage returns false when the item failed, the item doesn't go to the later stages then
+   using StageFunc = bool(*)(uintptr_t item, uintptr_t args);
+
+   using StageFlushFunc = void(*)(uintptr_t args);
+
+   struct PipelineStage
+   {
+      StageFunc Func;
+      uintptr_t Args = 0;
+
+      //Items of the stage that run at once, main thread stage runs this many items per Pump
+      uint16_t Concurrency = 1;
+
+      //Stage runs inside of the Pump on the calling thread instead of the job threads, e.g. the GPU upload
+      bool IsMainThread = false;
+
+      //Func only starts the item on the pumping thread, e.g. issues the read, and the item is done by the Pipeline::Complete
+      //False returned by the Func fails the item right away and the Complete isn't called for it then
+      bool IsAsync = false;
+
+      //Called by the Pump after it has started the items of the async stage, e.g. to submit their reads in the single batch
+      StageFlushFunc Flush = nullptr;
+   };
+
+   struct StageStats
+   {
+      size_t Processed = 0;
+      size_t Failed = 0;
+
+      uint16_t MaxRunning = 0;
+      size_t MaxQueued = 0; //Items that waited for the stage at once
+   };
+
+   //Items go through the stages in order, every stage takes the next item as soon as it has the free slot
+   //So the stages of the different items overlap, e.g. the disk reads the next file while the CPU parses the current one
+   //
+   //Queue between the stages is bounded: the stage doesn't start the item while its finished and running items fill
+   //the queue of the next stage, so the slow stage holds back the earlier ones instead of piling up their results
+   //
+   //Scheduling is done only by the Pump, so the pipeline is used from the single thread
+   class Pipeline
+   {
+   private:
+      struct StageState
+      {
+         std::deque<uintptr_t> Queued;
+         uint16_t Running = 0;
+
+         StageStats Stats;
+      };
+
+      struct FinishedItem
+      {
+         uint32_t Stage;
+         uintptr_t Item;
+         bool IsSucceeded;
+      };
+
+      struct StageJob
+      {
+         Pipeline* Owner;
+         uint32_t Stage;
+         uintptr_t Item;
+      };
+
+      std::vector<PipelineStage> Stages;
+      std::vector<StageState> States;
+
+      size_t QueueCapacity;
+      size_t Pending = 0; //Items that are still in the pipeline
+
+      std::vector<FinishedItem> FinishedItems;
+      utils::sync::SpinLock FinishedSL;
+
+      bool CanStart(const uint32_t stage) const;
+
+      void Finish(const uint32_t stage, const uintptr_t item, const bool isSucceeded);
+
+      void CollectFinished();
+   public:
+      Pipeline(const std::vector<PipelineStage>& stages, const size_t queueCapacity);
+
+      //Waits for the running jobs, as they point to the pipeline
+      ~Pipeline();
+
+      Pipeline(const Pipeline&) = delete;
+      Pipeline& operator=(const Pipeline&) = delete;
+
+      //Input of the first stage isn't bounded
+      void Add(const uintptr_t item);
+
+      //Finishes the item of the async stage, it may be called from any thread
+      void Complete(const uint32_t stage, const uintptr_t item, const bool isSucceeded);
+
+      //Moves the finished items to the next stages, starts the items that fit and runs the main thread stages
+      void Pump();
+
+      //Pumps until every item has left the pipeline, in between the calling thread runs the queued jobs like the JobSystem::Wait
+      void Drain();
+
+      inline bool IsDone() const
+      {
+         return Pending == 0;
+      }
+
+      inline const StageStats& GetStats(const size_t stage) const
+      {
+         return States[stage].Stats;
+      }
+   };
+}
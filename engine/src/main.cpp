@@ -9,8 +9,6 @@
 
 #include "events/subject.h"
 
-#include "utils/read-from-file.h"
-
 #include "entry-point/entry-point.h"
 
 #include "graphics/api/devices/gl-device.h"
@@ -23,6 +21,8 @@
 
 #include "graphics/scene.h"
 
+#include "graphics/streaming/texture-streamer.h"
+
 #include "math/math.h"
 
 #include "math/many-math/matrices.h"
@@ -80,58 +80,44 @@ int main()
    constexpr auto brickDifPath = "res/textures/brickwall.jpg";
    constexpr auto brickNormPath = "res/textures/brickwall_normal.jpg";
 
+   //Everything that isn't found in the archive is loaded from the loose files
+   AssetManager.Mount("res.pak");
+
+   //Materials pick the vertex layout by the same setting
+   AssetManager.SetMeshVertexFormat(graphics::cfg::PackedVertices ? assets::cook::VertexFormat::Packed : assets::cook::VertexFormat::Float);
+
+   //Cooked meshes are reused by the next runs until their sources change
+   AssetManager.OpenDerivedCache("derived-cache", 1024ull * 1024 * 1024);
+
    AssetManager.ToLoad(pistolPath);
    AssetManager.ToLoad(cubePath);
 
-   AssetManager.ToLoad(pistolDifPath);
-   AssetManager.ToLoad(pistolNormPath);
-   AssetManager.ToLoad(brickDifPath);
-   AssetManager.ToLoad(brickNormPath);
-
    {
       utils::Timer assetTimer(true);
       AssetManager.Load();
-      LOG_WARNING("Assets loading time: %f ms", assetTimer.GetElapsedTime());
+
+      const assets::cook::DerivedCacheStats cacheStats = AssetManager.GetDerivedCacheStats();
+      LOG_WARNING("Assets loading time: %f ms, derived cache hits %zu misses %zu", assetTimer.GetElapsedTime(), cacheStats.Hits, cacheStats.Misses);
    }
 
    auto pistolData = AssetManager.GetData<assets::TrigVertices>(pistolPath);
    auto cubeData = AssetManager.GetData<assets::TrigVertices>(cubePath);
 
-   auto pistolDifData = AssetManager.GetData<assets::PixelsData>(pistolDifPath);
-   auto pistolNormData = AssetManager.GetData<assets::PixelsData>(pistolNormPath);
-
-   auto brickDifData = AssetManager.GetData<assets::PixelsData>(brickDifPath);
-   auto brickNormData = AssetManager.GetData<assets::PixelsData>(brickNormPath);
-
    graphics::TextureParams params;
-   params.MagFilter = graphics::TextureFilter::Nearest;
-   params.MinFilter = graphics::TextureFilter::Nearest;
+   params.MagFilter = graphics::TextureFilter::Linear;
+   params.MinFilter = graphics::TextureFilter::LinearMipmapLinear;
    params.WrapS = graphics::TextureWrap::ClampToEdge;
    params.WrapT = graphics::TextureWrap::ClampToEdge;
 
-   auto& pistolDiffuse = g_GraphicsDevice->CreateTexture2D();
-   pistolDiffuse->InitData(pistolDifData->Width, pistolDifData->Height,
-      graphics::InternalFormat::RGB8, graphics::Format::RGB,
-      graphics::Type::Ubyte, params);
-   pistolDiffuse->UpdateData(pistolDifData->Width, pistolDifData->Height, pistolDifData->Pixels);
-
-   auto& pistolNorm = g_GraphicsDevice->CreateTexture2D();
-   pistolNorm->InitData(pistolNormData->Width, pistolNormData->Height,
-      graphics::InternalFormat::RGB8, graphics::Format::RGB,
-      graphics::Type::Ubyte, params);
-   pistolNorm->UpdateData(pistolNormData->Width, pistolNormData->Height, pistolNormData->Pixels);
-
-   auto& cubeDiffuse = g_GraphicsDevice->CreateTexture2D();
-   cubeDiffuse->InitData(brickDifData->Width, brickDifData->Height,
-      graphics::InternalFormat::RGB8, graphics::Format::RGB,
-      graphics::Type::Ubyte, params);
-   cubeDiffuse->UpdateData(brickDifData->Width, brickDifData->Height, brickDifData->Pixels);
-
-   auto& cubeNorm = g_GraphicsDevice->CreateTexture2D();
-   cubeNorm->InitData(brickNormData->Width, brickNormData->Height,
-      graphics::InternalFormat::RGB8, graphics::Format::RGB,
-      graphics::Type::Ubyte, params);
-   cubeNorm->UpdateData(brickNormData->Width, brickNormData->Height, brickNormData->Pixels);
+   //Textures start with the smallest level, the rest is streamed in by the distance to the camera
+   graphics::streaming::TextureStreamer textureStreamer(*g_GraphicsDevice, graphics::streaming::LoadAssetLevels,
+                                                        reinterpret_cast<uintptr_t>(&AssetManager), params, 64 * 1024 * 1024);
+
+   auto pistolDiffuse = textureStreamer.Register(pistolDifPath);
+   auto pistolNorm = textureStreamer.Register(pistolNormPath);
+
+   auto cubeDiffuse = textureStreamer.Register(brickDifPath);
+   auto cubeNorm = textureStreamer.Register(brickNormPath);
 
    auto pistolM = std::make_shared<graphics::PhongMaterial>();
    pistolM->Diffuse = { 1.0f, 0.2f, 0.5f, 1.0f };
@@ -174,6 +160,8 @@ int main()
       {
          //pistolMesh->Translate.x -= 0.1f * app::g_DeltaTime;
          
+         textureStreamer.Update(*MainCamera, scene.RegisteredMeshes, g_Window->GetCanvas()->GetHeight());
+
          scene::UpdateAndRender(scene);
       });
 
@@ -28,7 +28,11 @@ namespace graphics
          { InternalFormat::RGBA16, GL_RGBA16 },
          { InternalFormat::Depth16, GL_DEPTH_COMPONENT16 },
          { InternalFormat::Depth24, GL_DEPTH_COMPONENT24 },
-         { InternalFormat::Depth32, GL_DEPTH_COMPONENT32 }
+         { InternalFormat::Depth32, GL_DEPTH_COMPONENT32 },
+         { InternalFormat::BC1, GL_COMPRESSED_RGB_S3TC_DXT1_EXT },
+         { InternalFormat::BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+         { InternalFormat::BC5, GL_COMPRESSED_RG_RGTC2 },
+         { InternalFormat::BC7, GL_COMPRESSED_RGBA_BPTC_UNORM }
       };
 
       inline std::unordered_map<Format, GLenum> FormatLookupMap =
@@ -44,6 +48,9 @@ namespace graphics
       {
          { Type::Ubyte, GL_UNSIGNED_BYTE },
          { Type::Uint, GL_UNSIGNED_INT },
+         { Type::Short, GL_SHORT },
+         { Type::Ushort, GL_UNSIGNED_SHORT },
+         { Type::Half, GL_HALF_FLOAT },
          { Type::Float, GL_FLOAT }
       };
 
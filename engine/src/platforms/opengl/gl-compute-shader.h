@@ -38,7 +38,8 @@ namespace graphics
             GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
 
             const char* src = shaderSrc.data();
-            glShaderSource(shader, 1, &src, NULL);
+            const GLint length = static_cast<GLint>(shaderSrc.size());
+            glShaderSource(shader, 1, &src, &length);
             glCompileShader(shader);
 
             GLint res;
@@ -0,0 +1,40 @@
+#pragma once
+#include "graphics/api/index-buffer.h"
+#include "GL/glew.h"
+
+namespace graphics
+{
+   namespace gl
+   {
+      class IndexBufferGL : public IndexBuffer
+      {
+      public:
+         GLuint BindId;
+
+         inline IndexBufferGL()
+         {
+            glCreateBuffers(1, &BindId);
+         }
+
+         inline ~IndexBufferGL()
+         {
+            glDeleteBuffers(1, &BindId);
+         }
+
+         inline void InitData(const size_t size, const void* data) override
+         {
+            glNamedBufferData(BindId, size, data, GL_DYNAMIC_DRAW);
+         }
+
+         inline void UpdateData(const size_t size, const void* data, const size_t offset = 0) override
+         {
+            glNamedBufferSubData(BindId, offset, size, data);
+         }
+
+         inline void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+         {
+            glCopyNamedBufferSubData(BindId, BindId, srcOffset, dstOffset, size);
+         }
+      };
+   }
+}
@@ -42,6 +42,13 @@ namespace graphics
 
             glGetNamedBufferSubData(BindId, 0, size, buffer);
          }
+
+         inline void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+         {
+            ASSERT(srcOffset + size <= Size && dstOffset + size <= Size, "Copy is out of buffer range!");
+
+            glCopyNamedBufferSubData(BindId, BindId, static_cast<GLintptr>(srcOffset), static_cast<GLintptr>(dstOffset), size);
+         }
       };
    }
 }
@@ -6,6 +6,7 @@
 #include "gl-texture2d.h"
 #include "gl-cubemap.h"
 #include "gl-vertex-buffer.h"
+#include "gl-index-buffer.h"
 #include "gl-uniform-buffer.h"
 #include "gl-shader-buffer.h"
 #include "GL/glew.h"
@@ -64,7 +65,8 @@ namespace graphics
          }
 
          inline void AddInputBuffer(const std::shared_ptr<VertexBuffer>& vbo, const uint8_t elements, const uint8_t attribIndex,
-                                    const size_t stride, const Type type, const size_t offset = 0, const size_t elementsOffset = 0) override
+                                    const size_t stride, const Type type, const size_t offset = 0, const size_t elementsOffset = 0,
+                                    const bool isNormalized = false) override
          {
             auto& glVbo = std::static_pointer_cast<VertexBufferGL>(vbo);
 
@@ -72,11 +74,18 @@ namespace graphics
 
             glEnableVertexArrayAttrib(Vao, attribIndex);
             glVertexArrayAttribBinding(Vao, attribIndex, BufferCounter);
-            glVertexArrayAttribFormat(Vao, attribIndex, elements, OGL_TYPE(type), GL_FALSE, elementsOffset);
+            glVertexArrayAttribFormat(Vao, attribIndex, elements, OGL_TYPE(type), isNormalized ? GL_TRUE : GL_FALSE, elementsOffset);
 
             ++BufferCounter;
          }
 
+         inline void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& ibo) override
+         {
+            auto& glIbo = std::static_pointer_cast<IndexBufferGL>(ibo);
+
+            glVertexArrayElementBuffer(Vao, glIbo->BindId);
+         }
+
          inline void AddInputBuffer(const std::shared_ptr<UniformBuffer>& ubo, const std::string_view& name, const size_t dataSize, const size_t dataOffset = 0) override
          {
             auto& glUBO = std::static_pointer_cast<UniformBufferGL>(ubo);
@@ -117,8 +126,10 @@ namespace graphics
 
                GLuint shader = glCreateShader(oglShaderType);
 
+               //Sources are the views of the files, they aren't null terminated
                const char* src = ShaderArr[i].data();
-               glShaderSource(shader, 1, &src, NULL);
+               const GLint length = static_cast<GLint>(ShaderArr[i].size());
+               glShaderSource(shader, 1, &src, &length);
                glCompileShader(shader);
 
                GLint res;
@@ -19,7 +19,8 @@ namespace graphics
       inline std::unordered_map<TextureFilter, GLenum> TextureFilterLookupMap =
       {
          { TextureFilter::Nearest, GL_NEAREST },
-         { TextureFilter::Linear, GL_LINEAR }
+         { TextureFilter::Linear, GL_LINEAR },
+         { TextureFilter::LinearMipmapLinear, GL_LINEAR_MIPMAP_LINEAR }
       };
 
 #define OGL_TEXTURE_WRAP(w) TextureWrappLookupMap.at(w)
@@ -28,11 +29,15 @@ namespace graphics
       class Texture2dGL : public Texture2D
       {
       public:
-         GLuint64 Handle;
-         GLuint BindId;
+         GLuint64 Handle = 0;
+         GLuint BindId = 0;
          uint16_t SizeX;
          uint16_t SizeY;
+         uint16_t LevelsCount;
 
+         TextureParams Params;
+
+         InternalFormat CurrentInternalFormat;
          Format CurrentFormat;
          Type CurrentType;
 
@@ -44,37 +49,104 @@ namespace graphics
 
          inline ~Texture2dGL() override
          {
+            Release();
+         }
+
+         inline void Release()
+         {
+            if (!BindId)
+               return;
+
+            glMakeTextureHandleNonResidentARB(Handle);
             glDeleteTextures(1, &BindId);
+
+            Handle = 0;
+            BindId = 0;
+         }
+
+         inline void SetSamplerParams(const GLuint id, const uint16_t levelsCount) const
+         {
+            glTextureParameteri(id, GL_TEXTURE_WRAP_S, OGL_TEXTURE_WRAP(Params.WrapS));
+            glTextureParameteri(id, GL_TEXTURE_WRAP_T, OGL_TEXTURE_WRAP(Params.WrapT));
+            glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, OGL_TEXTURE_FILTER(Params.MinFilter));
+            glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, OGL_TEXTURE_FILTER(Params.MagFilter));
+
+            glTextureParameterfv(id, GL_TEXTURE_BORDER_COLOR, BorderColor.Data);
+
+            glTextureParameteri(id, GL_TEXTURE_MAX_LEVEL, levelsCount - 1);
          }
 
          inline void InitData(const uint16_t sizeX, const uint16_t sizeY,
                        const InternalFormat internalFormat, const Format format,
-                       const Type type, const TextureParams& params) override
+                       const Type type, const TextureParams& params,
+                       const uint16_t levelsCount = 1) override
          {
+            //Storage is immutable, so the new one is created
+            Release();
+
             SizeX = sizeX;
             SizeY = sizeY;
+            LevelsCount = levelsCount;
 
+            CurrentInternalFormat = internalFormat;
             CurrentFormat = format;
             CurrentType = type;
+            Params = params;
 
             glCreateTextures(GL_TEXTURE_2D, 1, &BindId);
          
-            glTextureParameteri(BindId, GL_TEXTURE_WRAP_S, OGL_TEXTURE_WRAP(params.WrapS));
-            glTextureParameteri(BindId, GL_TEXTURE_WRAP_T, OGL_TEXTURE_WRAP(params.WrapT));
-            glTextureParameteri(BindId, GL_TEXTURE_MIN_FILTER, OGL_TEXTURE_FILTER(params.MinFilter));
-            glTextureParameteri(BindId, GL_TEXTURE_MAG_FILTER, OGL_TEXTURE_FILTER(params.MagFilter));
+            SetSamplerParams(BindId, levelsCount);
+
+            glTextureStorage2D(BindId, levelsCount, OGL_IFORMAT(internalFormat), sizeX, sizeY);
 
-            glTextureParameterfv(BindId, GL_TEXTURE_BORDER_COLOR, BorderColor.Data);
+            Handle = glGetTextureHandleARB(BindId);
+            glMakeTextureHandleResidentARB(Handle);
+         }
 
-            glTextureStorage2D(BindId, 1, OGL_IFORMAT(internalFormat), sizeX, sizeY);
+         inline void Reallocate(const uint16_t sizeX, const uint16_t sizeY, const uint16_t levelsCount, const int32_t levelShift) override
+         {
+            GLuint storage;
+            glCreateTextures(GL_TEXTURE_2D, 1, &storage);
+
+            SetSamplerParams(storage, levelsCount);
+
+            glTextureStorage2D(storage, levelsCount, OGL_IFORMAT(CurrentInternalFormat), sizeX, sizeY);
+
+            //Whole levels are copied, so the small levels of the block compressed textures don't need to be block aligned
+            for (int32_t level = 0; level < LevelsCount; ++level)
+            {
+               const int32_t newLevel = level + levelShift;
+               if (newLevel < 0 || newLevel >= levelsCount)
+                  continue;
+
+               const GLsizei width = SizeX >> level ? SizeX >> level : 1;
+               const GLsizei height = SizeY >> level ? SizeY >> level : 1;
+
+               glCopyImageSubData(BindId, GL_TEXTURE_2D, level, 0, 0, 0, storage, GL_TEXTURE_2D, newLevel, 0, 0, 0, width, height, 1);
+            }
+
+            Release();
+
+            BindId = storage;
+            SizeX = sizeX;
+            SizeY = sizeY;
+            LevelsCount = levelsCount;
 
             Handle = glGetTextureHandleARB(BindId);
             glMakeTextureHandleResidentARB(Handle);
          }
          
-         inline void UpdateData(const size_t sizeX, const size_t sizeY, const void* data) override
+         inline void UpdateData(const size_t sizeX, const size_t sizeY, const void* data, const uint16_t level = 0) override
+         {
+            //Rows of the small mips aren't 4 bytes aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            glTextureSubImage2D(BindId, level, 0, 0, sizeX, sizeY, OGL_FORMAT(CurrentFormat), OGL_TYPE(CurrentType), data);
+         }
+
+         inline void UpdateCompressedData(const size_t sizeX, const size_t sizeY, const void* data, const size_t dataSize, const uint16_t level = 0) override
          {
-            glTextureSubImage2D(BindId, 0, 0, 0, sizeX, sizeY, OGL_FORMAT(CurrentFormat), OGL_TYPE(CurrentType), data);
+            glCompressedTextureSubImage2D(BindId, level, 0, 0, sizeX, sizeY, OGL_IFORMAT(CurrentInternalFormat), dataSize, data);
          }
 
          inline void SetBorderColor(const mm::vec4& color) const override
@@ -91,6 +163,11 @@ namespace graphics
          {
             return SizeY;
          }
+
+         inline uint16_t GetLevelsCount() const override
+         {
+            return LevelsCount;
+         }
       };
    }
 }
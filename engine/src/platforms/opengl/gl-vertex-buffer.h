@@ -26,9 +26,14 @@ namespace graphics
             glNamedBufferData(BindId, size, data, GL_DYNAMIC_DRAW);
          }
 
-         inline void UpdateData(const size_t size, const void* data) override
+         inline void UpdateData(const size_t size, const void* data, const size_t offset = 0) override
          {
-            glNamedBufferSubData(BindId, 0, size, data);
+            glNamedBufferSubData(BindId, offset, size, data);
+         }
+
+         inline void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+         {
+            glCopyNamedBufferSubData(BindId, BindId, srcOffset, dstOffset, size);
          }
       };
    }
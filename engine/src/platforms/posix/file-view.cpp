@@ -0,0 +1,199 @@
+#ifndef WINDOWS
+
+#include "utils/file-view.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils
+{
+   struct FileView::NativeInfo
+   {
+      int Fd = -1;
+   };
+
+   static int GetAdvice(const FileAccess access)
+   {
+      switch (access)
+      {
+      case FileAccess::Sequential:
+         return MADV_SEQUENTIAL;
+      case FileAccess::Random:
+         return MADV_RANDOM;
+      default:
+         return MADV_NORMAL;
+      }
+   }
+
+   static std::string MakeError(const char* what)
+   {
+      return std::string(what) + ": " + strerror(errno);
+   }
+
+   //Size of the special files isn't known upfront, so they are read by the chunks until the end
+   static bool ReadWhole(const int fd, std::unique_ptr<uint8_t[]>& storage, size_t& size)
+   {
+      std::vector<uint8_t> buffer;
+      size_t readSize = 0;
+
+      while (true)
+      {
+         if (buffer.size() - readSize < 4096)
+            buffer.resize(buffer.size() + std::max<size_t>(buffer.size(), 64 * 1024));
+
+         const ssize_t res = read(fd, buffer.data() + readSize, buffer.size() - readSize);
+
+         if (res < 0)
+         {
+            if (errno == EINTR)
+               continue;
+
+            return false;
+         }
+
+         if (res == 0)
+            break;
+
+         readSize += static_cast<size_t>(res);
+      }
+
+      storage.reset(new uint8_t[readSize ? readSize : 1]);
+      memcpy(storage.get(), buffer.data(), readSize);
+      size = readSize;
+
+      return true;
+   }
+
+   FileView::FileView() = default;
+
+   FileView::FileView(const std::string_view& filepath, const FileAccess access)
+   {
+      Open(filepath, access);
+   }
+
+   FileView::~FileView()
+   {
+      Close();
+   }
+
+   FileView::FileView(FileView&& view) noexcept
+      : Native(std::move(view.Native)), Data(view.Data), Size(view.Size), Storage(std::move(view.Storage)), Error(std::move(view.Error))
+   {
+      view.Data = nullptr;
+      view.Size = 0;
+   }
+
+   FileView& FileView::operator = (FileView&& view) noexcept
+   {
+      if (this != &view)
+      {
+         Close();
+
+         Native = std::move(view.Native);
+         Data = view.Data;
+         Size = view.Size;
+         Storage = std::move(view.Storage);
+         Error = std::move(view.Error);
+
+         view.Data = nullptr;
+         view.Size = 0;
+      }
+
+      return *this;
+   }
+
+   bool FileView::Open(const std::string_view& filepath, const FileAccess access)
+   {
+      Close();
+      Error.clear();
+
+      const std::string path(filepath); //Path must be null terminated
+
+      int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+      {
+         Error = MakeError("Couldn't open");
+         return false;
+      }
+
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+      {
+         Error = MakeError("Couldn't get the size");
+         close(fd);
+         return false;
+      }
+
+      //Empty files can't be mapped
+      if (S_ISREG(st.st_mode) && st.st_size > 0)
+      {
+         void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+         if (data != MAP_FAILED)
+         {
+            Data = static_cast<const uint8_t*>(data);
+            Size = static_cast<size_t>(st.st_size);
+
+            if (access != FileAccess::Normal)
+               madvise(data, Size, GetAdvice(access));
+         }
+      }
+
+      //File system without the mapping or the file without the size, e.g. the pipe or the /proc file
+      //Truly empty file gives nothing to read, so it stays the valid view with the null data
+      if (!Data)
+      {
+         if (!ReadWhole(fd, Storage, Size))
+         {
+            Error = MakeError("Couldn't read");
+            close(fd);
+            return false;
+         }
+
+         Data = Size ? Storage.get() : nullptr;
+      }
+
+      Native = std::make_unique<NativeInfo>();
+      Native->Fd = fd;
+
+      return true;
+   }
+
+   void FileView::Advise(const FileAccess access, const size_t offset, const size_t size) const
+   {
+      if (!IsMapped() || offset >= Size)
+         return;
+
+      //Advice works on the whole pages
+      const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      const size_t begin = offset / pageSize * pageSize;
+      const size_t end = std::min(Size, offset + size);
+
+      madvise(const_cast<uint8_t*>(Data) + begin, end - begin, GetAdvice(access));
+   }
+
+   void FileView::Close()
+   {
+      if (!Native)
+         return;
+
+      if (Data && !Storage)
+         munmap(const_cast<uint8_t*>(Data), Size);
+
+      close(Native->Fd);
+
+      Native.reset();
+      Storage.reset();
+      Data = nullptr;
+      Size = 0;
+   }
+}
+
+#endif
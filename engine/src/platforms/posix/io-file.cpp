@@ -0,0 +1,74 @@
+#ifndef WINDOWS
+
+#include "utils/io-file.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils
+{
+   IoFile OpenIoFile(const std::string_view& filepath, uint64_t& size, std::string& error)
+   {
+      const std::string path(filepath); //Path must be null terminated
+
+      const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+      {
+         error = "Couldn't open: " + GetIoError();
+         return InvalidIoFile;
+      }
+
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+      {
+         error = "Couldn't get the size: " + GetIoError();
+         close(fd);
+         return InvalidIoFile;
+      }
+
+      //Size of the special files isn't known upfront, the FileView reads them instead
+      if (!S_ISREG(st.st_mode))
+      {
+         error = "Couldn't read: Not a regular file";
+         close(fd);
+         return InvalidIoFile;
+      }
+
+      size = static_cast<uint64_t>(st.st_size);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+      posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+      return fd;
+   }
+
+   int64_t ReadIoFile(const IoFile file, const uint64_t offset, uint8_t* buffer, const size_t size)
+   {
+      while (true)
+      {
+         const ssize_t res = pread(static_cast<int>(file), buffer, size, static_cast<off_t>(offset));
+
+         if (res < 0 && errno == EINTR)
+            continue;
+
+         return res;
+      }
+   }
+
+   void CloseIoFile(const IoFile file)
+   {
+      close(static_cast<int>(file));
+   }
+
+   std::string GetIoError()
+   {
+      return strerror(errno);
+   }
+}
+
+#endif
@@ -0,0 +1,159 @@
+#ifdef __linux__
+
+#include "io-uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef __NR_io_uring_setup
+   #define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+   #define __NR_io_uring_enter 426
+#endif
+
+namespace utils
+{
+   static int Enter(const int fd, const uint32_t toSubmit, const uint32_t minComplete, const uint32_t flags)
+   {
+      while (true)
+      {
+         const long res = syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+
+         if (res < 0 && errno == EINTR)
+            continue;
+
+         return res < 0 ? -errno : static_cast<int>(res);
+      }
+   }
+
+   IoUring::~IoUring()
+   {
+      if (Sqes)
+         munmap(Sqes, SqesSize);
+
+      if (CqRing && CqRing != SqRing)
+         munmap(CqRing, CqRingSize);
+
+      if (SqRing)
+         munmap(SqRing, SqRingSize);
+
+      if (Fd >= 0)
+         close(Fd);
+   }
+
+   bool IoUring::Setup(const uint32_t entries, std::string& error)
+   {
+      io_uring_params params;
+      memset(&params, 0, sizeof(params));
+
+      Fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+      if (Fd < 0)
+      {
+         error = std::string("io_uring isn't available: ") + strerror(errno);
+         return false;
+      }
+
+      SqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+      CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+      //Newer kernels put both rings into the single mapping
+      const bool isSingleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (isSingleMap)
+         SqRingSize = CqRingSize = std::max(SqRingSize, CqRingSize);
+
+      SqRing = mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_SQ_RING);
+      if (SqRing == MAP_FAILED)
+      {
+         SqRing = nullptr;
+         error = std::string("Couldn't map the io_uring: ") + strerror(errno);
+         return false;
+      }
+
+      if (isSingleMap)
+         CqRing = SqRing;
+      else
+      {
+         CqRing = mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_CQ_RING);
+         if (CqRing == MAP_FAILED)
+         {
+            CqRing = nullptr;
+            error = std::string("Couldn't map the io_uring: ") + strerror(errno);
+            return false;
+         }
+      }
+
+      SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+      void* sqes = mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, IORING_OFF_SQES);
+      if (sqes == MAP_FAILED)
+      {
+         error = std::string("Couldn't map the io_uring: ") + strerror(errno);
+         return false;
+      }
+
+      Sqes = static_cast<io_uring_sqe*>(sqes);
+
+      uint8_t* sq = static_cast<uint8_t*>(SqRing);
+      SqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+      SqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+      SqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+      SqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+      SqEntries = params.sq_entries;
+
+      uint8_t* cq = static_cast<uint8_t*>(CqRing);
+      CqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+      CqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+      Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+      CqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+
+      return true;
+   }
+
+   io_uring_sqe* IoUring::GetSqe()
+   {
+      const uint32_t head = __atomic_load_n(SqHead, __ATOMIC_ACQUIRE);
+      const uint32_t tail = *SqTail + Unsubmitted;
+
+      if (tail - head >= SqEntries)
+         return nullptr;
+
+      const uint32_t index = tail & SqMask;
+      SqArray[index] = index;
+
+      ++Unsubmitted;
+
+      io_uring_sqe* sqe = &Sqes[index];
+      memset(sqe, 0, sizeof(io_uring_sqe));
+
+      return sqe;
+   }
+
+   int IoUring::Submit()
+   {
+      if (!Unsubmitted)
+         return 0;
+
+      //Kernel sees the entries only after the tail is moved past them
+      const uint32_t tail = *SqTail + Unsubmitted;
+      __atomic_store_n(SqTail, tail, __ATOMIC_RELEASE);
+
+      Unsubmitted = 0;
+
+      //Entries that the kernel didn't take by the previous call, e.g. on EAGAIN, are passed again
+      return Enter(Fd, tail - __atomic_load_n(SqHead, __ATOMIC_ACQUIRE), 0, 0);
+   }
+
+   int IoUring::Wait()
+   {
+      return Enter(Fd, 0, 1, IORING_ENTER_GETEVENTS);
+   }
+}
+
+#endif
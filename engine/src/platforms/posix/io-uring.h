@@ -0,0 +1,85 @@
+#pragma once
+#ifdef __linux__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include <linux/io_uring.h>
+
+namespace utils
+{
+   //Minimal io_uring over the raw system calls, so the engine doesn't depend on the liburing
+   //Submission side is used by one thread at a time and the completion side by the single thread, they may run at once
+   class IoUring
+   {
+   private:
+      int Fd = -1;
+
+      void* SqRing = nullptr;
+      void* CqRing = nullptr;
+      size_t SqRingSize = 0;
+      size_t CqRingSize = 0;
+
+      io_uring_sqe* Sqes = nullptr;
+      size_t SqesSize = 0;
+
+      uint32_t* SqHead;
+      uint32_t* SqTail;
+      uint32_t* SqArray;
+      uint32_t SqMask;
+      uint32_t SqEntries;
+
+      uint32_t* CqHead;
+      uint32_t* CqTail;
+      io_uring_cqe* Cqes;
+      uint32_t CqMask;
+
+      uint32_t Unsubmitted = 0; //Entries filled after the last Submit
+   public:
+      IoUring() = default;
+      ~IoUring();
+
+      IoUring(const IoUring&) = delete;
+      IoUring& operator = (const IoUring&) = delete;
+
+      //Fails when the kernel doesn't have the io_uring or it is forbidden, e.g. by the container seccomp policy
+      bool Setup(const uint32_t entries, std::string& error);
+
+      //Zeroed entry of the submission queue, null when the queue is full
+      io_uring_sqe* GetSqe();
+
+      //Passes the filled entries to the kernel in the single call, returns their count or -errno
+      int Submit();
+
+      //Blocks until there is at least one completion
+      int Wait();
+
+      //Calls func(userData, res) for every completion that is ready and returns their count
+      template<typename F>
+      size_t ForEachCompletion(F&& func)
+      {
+         uint32_t head = *CqHead;
+         const uint32_t tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+
+         size_t count = 0;
+
+         for (; head != tail; ++head, ++count)
+         {
+            const io_uring_cqe& cqe = Cqes[head & CqMask];
+            func(cqe.user_data, cqe.res);
+         }
+
+         __atomic_store_n(CqHead, head, __ATOMIC_RELEASE);
+
+         return count;
+      }
+
+      inline uint32_t GetEntriesCount() const
+      {
+         return SqEntries;
+      }
+   };
+}
+
+#endif
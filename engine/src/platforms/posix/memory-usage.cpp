@@ -0,0 +1,25 @@
+#ifndef WINDOWS
+
+#include "utils/memory-usage.h"
+
+#include <sys/resource.h>
+
+namespace utils
+{
+   size_t GetPeakResidentBytes()
+   {
+      struct rusage usage;
+
+      if (getrusage(RUSAGE_SELF, &usage) != 0)
+         return 0;
+
+      //Linux reports the kilobytes, macOS the bytes
+#ifdef __APPLE__
+      return static_cast<size_t>(usage.ru_maxrss);
+#else
+      return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+   }
+}
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef WINDOWS
+
+#include "utils/process/process.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+   #include <sys/prctl.h>
+#endif
+
+#include "debug/globals.h"
+
+namespace utils
+{
+   static bool WriteAll(const int fd, const void* data, size_t size)
+   {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+      while (size)
+      {
+         const ssize_t written = write(fd, bytes, size);
+
+         if (written < 0 && errno == EINTR)
+            continue;
+
+         if (written <= 0)
+            return false;
+
+         bytes += written;
+         size -= static_cast<size_t>(written);
+      }
+
+      return true;
+   }
+
+   static bool ReadAll(const int fd, void* data, size_t size)
+   {
+      uint8_t* bytes = static_cast<uint8_t*>(data);
+
+      while (size)
+      {
+         const ssize_t read = ::read(fd, bytes, size);
+
+         if (read < 0 && errno == EINTR)
+            continue;
+
+         //End of the pipe, the other side has exited
+         if (read <= 0)
+            return false;
+
+         bytes += read;
+         size -= static_cast<size_t>(read);
+      }
+
+      return true;
+   }
+
+   static void CloseFd(int& fd)
+   {
+      if (fd >= 0)
+         close(fd);
+
+      fd = -1;
+   }
+
+   //Ends are close on exec from the start, so the child forked by another thread meanwhile doesn't inherit them
+   //Child keeps only its own ends, dup2 into its stdin and stdout clears the flag
+   static bool CreatePipe(int (&fds)[2])
+   {
+#ifdef __APPLE__
+      //There is no pipe2, so the flags are set right after
+      if (pipe(fds) != 0)
+         return false;
+
+      fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+      fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+      return true;
+#else
+      return pipe2(fds, O_CLOEXEC) == 0;
+#endif
+   }
+
+   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir, const bool isPiped)
+   {
+      ProcessInfo info;
+
+      //Everything the child needs is prepared before the fork, after it only the async signal safe calls are allowed
+      std::vector<std::string> args;
+
+      size_t start = 0;
+      while (start < execLocation.size())
+      {
+         const size_t end = std::min(execLocation.find(' ', start), execLocation.size());
+
+         if (end > start)
+            args.emplace_back(execLocation.substr(start, end - start));
+
+         start = end + 1;
+      }
+
+      if (args.empty())
+      {
+         LOG_ERROR("Error in process creation: %s", "the command line is empty");
+         return info;
+      }
+
+      std::vector<char*> argv;
+      for (auto& arg : args)
+         argv.push_back(arg.data());
+
+      argv.push_back(nullptr);
+
+      const std::string dir(workingDir);
+
+      int input[2] = { -1, -1 };
+      int output[2] = { -1, -1 };
+
+      if (isPiped)
+      {
+         //Write to the crashed child fails with the EPIPE instead of killing the engine by the SIGPIPE
+         signal(SIGPIPE, SIG_IGN);
+
+         if (!CreatePipe(input) || !CreatePipe(output))
+         {
+            LOG_ERROR("Error in process creation: %s", strerror(errno));
+
+            CloseFd(input[0]);
+            CloseFd(input[1]);
+
+            return info;
+         }
+      }
+
+#ifdef __linux__
+      const pid_t parent = getpid();
+#endif
+
+      const pid_t pid = fork();
+
+      if (pid == 0)
+      {
+#ifdef __linux__
+         prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+         //Parent could die before the prctl
+         if (getppid() != parent)
+            _exit(127);
+#endif
+
+         if (isPiped)
+         {
+            dup2(input[0], STDIN_FILENO);
+            dup2(output[1], STDOUT_FILENO);
+
+            close(input[0]);
+            close(output[1]);
+         }
+
+         if (!dir.empty() && chdir(dir.c_str()) != 0)
+            _exit(127);
+
+         execv(argv[0], argv.data());
+         _exit(127);
+      }
+
+      if (isPiped)
+      {
+         CloseFd(input[0]);
+         CloseFd(output[1]);
+      }
+
+      if (pid < 0)
+      {
+         LOG_ERROR("Error in process creation: %s", strerror(errno));
+
+         CloseFd(input[1]);
+         CloseFd(output[0]);
+
+         return info;
+      }
+
+      info.Pid = pid;
+      info.InputFd = input[1];
+      info.OutputFd = output[0];
+
+      return info;
+   }
+
+   void DestroyProcess(const ProcessInfo& processInfo)
+   {
+      if (processInfo.InputFd >= 0)
+         close(processInfo.InputFd);
+
+      if (processInfo.OutputFd >= 0)
+         close(processInfo.OutputFd);
+
+      if (processInfo.Pid <= 0)
+         return;
+
+      kill(processInfo.Pid, SIGKILL);
+
+      while (waitpid(processInfo.Pid, nullptr, 0) < 0 && errno == EINTR);
+   }
+
+   bool IsProcessRunning(const ProcessInfo& info)
+   {
+      if (info.Pid <= 0)
+         return false;
+
+      //Exited child isn't reaped here, so the DestroyProcess still waits for it
+      siginfo_t status;
+      status.si_pid = 0;
+
+      return waitid(P_PID, info.Pid, &status, WEXITED | WNOHANG | WNOWAIT) == 0 && status.si_pid == 0;
+   }
+
+   bool WriteToProcess(const ProcessInfo& info, const void* data, const size_t size)
+   {
+      return WriteAll(info.InputFd, data, size);
+   }
+
+   bool ReadFromProcess(const ProcessInfo& info, void* data, const size_t size)
+   {
+      return ReadAll(info.OutputFd, data, size);
+   }
+
+   ParentPipe OpenParentPipe()
+   {
+      ParentPipe pipe;
+      pipe.Input = STDIN_FILENO;
+      pipe.Output = dup(STDOUT_FILENO);
+
+      //Prints of the child go to the stderr, so they don't break the messages
+      dup2(STDERR_FILENO, STDOUT_FILENO);
+
+      return pipe;
+   }
+
+   bool ReadFromParent(const ParentPipe& pipe, void* data, const size_t size)
+   {
+      return ReadAll(static_cast<int>(pipe.Input), data, size);
+   }
+
+   bool WriteToParent(const ParentPipe& pipe, const void* data, const size_t size)
+   {
+      return WriteAll(static_cast<int>(pipe.Output), data, size);
+   }
+}
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+#include <string_view>
+
+#include <sys/types.h>
+
+namespace utils
+{
+   struct ProcessInfo
+   {
+      pid_t Pid = -1;
+
+      //Ends of the pipes to the stdin and from the stdout of the piped child
+      int InputFd = -1;
+      int OutputFd = -1;
+   };
+
+   //Command line is split by the spaces, the first part is the executable, relative paths are resolved against the workingDir
+   //Child is killed with the parent on Linux, so it doesn't outlive the crashed engine
+   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir, const bool isPiped = false);
+
+   //Kills the child when it is still running
+   void DestroyProcess(const ProcessInfo& processInfo);
+
+   bool IsProcessRunning(const ProcessInfo& info);
+}
@@ -0,0 +1,118 @@
+#ifndef WINDOWS
+
+#include "utils/shared-memory.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace utils
+{
+   struct SharedMemory::NativeInfo
+   {
+      std::string Name;
+      bool IsOwner;
+   };
+
+   static std::string MakeError(const char* what)
+   {
+      return std::string(what) + ": " + strerror(errno);
+   }
+
+   SharedMemory::SharedMemory() = default;
+
+   SharedMemory::~SharedMemory()
+   {
+      Close();
+   }
+
+   bool SharedMemory::Create(const std::string_view& name, const size_t size)
+   {
+      Close();
+
+      const std::string path = "/" + std::string(name);
+
+      const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd < 0)
+      {
+         Error = MakeError("Couldn't create shared memory");
+         return false;
+      }
+
+      if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+      {
+         Error = MakeError("Couldn't resize shared memory");
+
+         close(fd);
+         shm_unlink(path.c_str());
+
+         return false;
+      }
+
+      void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+
+      if (data == MAP_FAILED)
+      {
+         Error = MakeError("Couldn't map shared memory");
+         shm_unlink(path.c_str());
+
+         return false;
+      }
+
+      Native = std::make_unique<NativeInfo>(NativeInfo({ path, true }));
+      Data = static_cast<uint8_t*>(data);
+      Size = size;
+      Error.clear();
+
+      return true;
+   }
+
+   bool SharedMemory::Open(const std::string_view& name, const size_t size)
+   {
+      Close();
+
+      const std::string path = "/" + std::string(name);
+
+      const int fd = shm_open(path.c_str(), O_RDWR, 0);
+      if (fd < 0)
+      {
+         Error = MakeError("Couldn't open shared memory");
+         return false;
+      }
+
+      void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+
+      if (data == MAP_FAILED)
+      {
+         Error = MakeError("Couldn't map shared memory");
+         return false;
+      }
+
+      Native = std::make_unique<NativeInfo>(NativeInfo({ path, false }));
+      Data = static_cast<uint8_t*>(data);
+      Size = size;
+      Error.clear();
+
+      return true;
+   }
+
+   void SharedMemory::Close()
+   {
+      if (Data)
+         munmap(Data, Size);
+
+      if (Native && Native->IsOwner)
+         shm_unlink(Native->Name.c_str());
+
+      Native.reset();
+      Data = nullptr;
+      Size = 0;
+   }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include "utils/file-view.h"
+
+#include <string>
+#include <algorithm>
+
+#include "win64-dev.h"
+
+namespace utils
+{
+   struct FileView::NativeInfo
+   {
+      HANDLE File = INVALID_HANDLE_VALUE;
+      HANDLE Mapping = NULL;
+   };
+
+   static std::string MakeError(const char* what)
+   {
+      const DWORD code = GetLastError();
+
+      char message[256] = { 0 };
+      FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, code, 0, message, sizeof(message), NULL);
+
+      //System message ends with the line break
+      std::string text(message);
+      while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == ' '))
+         text.pop_back();
+
+      return std::string(what) + ": " + text + " (" + std::to_string(code) + ")";
+   }
+
+   static DWORD GetAccessFlags(const FileAccess access)
+   {
+      switch (access)
+      {
+      case FileAccess::Sequential:
+         return FILE_FLAG_SEQUENTIAL_SCAN;
+      case FileAccess::Random:
+         return FILE_FLAG_RANDOM_ACCESS;
+      default:
+         return FILE_ATTRIBUTE_NORMAL;
+      }
+   }
+
+   FileView::FileView() = default;
+
+   FileView::FileView(const std::string_view& filepath, const FileAccess access)
+   {
+      Open(filepath, access);
+   }
+
+   FileView::~FileView()
+   {
+      Close();
+   }
+
+   FileView::FileView(FileView&& view) noexcept
+      : Native(std::move(view.Native)), Data(view.Data), Size(view.Size), Storage(std::move(view.Storage)), Error(std::move(view.Error))
+   {
+      view.Data = nullptr;
+      view.Size = 0;
+   }
+
+   FileView& FileView::operator = (FileView&& view) noexcept
+   {
+      if (this != &view)
+      {
+         Close();
+
+         Native = std::move(view.Native);
+         Data = view.Data;
+         Size = view.Size;
+         Storage = std::move(view.Storage);
+         Error = std::move(view.Error);
+
+         view.Data = nullptr;
+         view.Size = 0;
+      }
+
+      return *this;
+   }
+
+   bool FileView::Open(const std::string_view& filepath, const FileAccess access)
+   {
+      Close();
+      Error.clear();
+
+      const std::string path(filepath); //Path must be null terminated
+
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, GetAccessFlags(access), NULL);
+      if (file == INVALID_HANDLE_VALUE)
+      {
+         Error = MakeError("Couldn't open");
+         return false;
+      }
+
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(file, &fileSize))
+      {
+         Error = MakeError("Couldn't get the size");
+         CloseHandle(file);
+         return false;
+      }
+
+      auto native = std::make_unique<NativeInfo>();
+      native->File = file;
+
+      //Empty files can't be mapped, but they are still valid files
+      if (fileSize.QuadPart > 0)
+      {
+         native->Mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+         if (native->Mapping)
+         {
+            Data = static_cast<const uint8_t*>(MapViewOfFile(native->Mapping, FILE_MAP_READ, 0, 0, 0));
+
+            if (!Data)
+            {
+               CloseHandle(native->Mapping);
+               native->Mapping = NULL;
+            }
+         }
+
+         //File system without the mapping, the file is read into the memory of the view
+         if (!Data)
+         {
+            Size = static_cast<size_t>(fileSize.QuadPart);
+            Storage.reset(new uint8_t[Size]);
+
+            size_t readSize = 0;
+            while (readSize < Size)
+            {
+               const DWORD chunk = static_cast<DWORD>(std::min<size_t>(Size - readSize, 1u << 30));
+
+               DWORD read = 0;
+               if (!ReadFile(file, Storage.get() + readSize, chunk, &read, NULL) || read == 0)
+               {
+                  Error = MakeError("Couldn't read");
+
+                  Storage.reset();
+                  Size = 0;
+                  CloseHandle(file);
+                  return false;
+               }
+
+               readSize += read;
+            }
+
+            Data = Storage.get();
+         }
+
+         Size = static_cast<size_t>(fileSize.QuadPart);
+      }
+
+      Native = std::move(native);
+
+      return true;
+   }
+
+   void FileView::Advise(const FileAccess access, const size_t offset, const size_t size) const
+   {
+      if (!IsMapped() || offset >= Size || access != FileAccess::Sequential)
+         return;
+
+      //Only the read ahead has the API here, the range is faulted in upfront
+      WIN32_MEMORY_RANGE_ENTRY range;
+      range.VirtualAddress = const_cast<uint8_t*>(Data) + offset;
+      range.NumberOfBytes = std::min(Size - offset, size);
+
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+   }
+
+   void FileView::Close()
+   {
+      if (!Native)
+         return;
+
+      if (Data && !Storage)
+         UnmapViewOfFile(Data);
+
+      if (Native->Mapping)
+         CloseHandle(Native->Mapping);
+
+      CloseHandle(Native->File);
+
+      Native.reset();
+      Storage.reset();
+      Data = nullptr;
+      Size = 0;
+   }
+}
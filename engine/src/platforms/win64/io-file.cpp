@@ -0,0 +1,67 @@
+#include "utils/io-file.h"
+
+#include "win64-dev.h"
+
+namespace utils
+{
+   IoFile OpenIoFile(const std::string_view& filepath, uint64_t& size, std::string& error)
+   {
+      const std::string path(filepath); //Path must be null terminated
+
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+      if (file == INVALID_HANDLE_VALUE)
+      {
+         error = "Couldn't open: " + GetIoError();
+         return InvalidIoFile;
+      }
+
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(file, &fileSize))
+      {
+         error = "Couldn't get the size: " + GetIoError();
+         CloseHandle(file);
+         return InvalidIoFile;
+      }
+
+      size = static_cast<uint64_t>(fileSize.QuadPart);
+
+      return reinterpret_cast<IoFile>(file);
+   }
+
+   int64_t ReadIoFile(const IoFile file, const uint64_t offset, uint8_t* buffer, const size_t size)
+   {
+      //Offset of the synchronous handle is given per read, so the reads of the threads don't share the file position
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = static_cast<DWORD>(offset);
+      overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+      DWORD read = 0;
+      const DWORD toRead = static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30));
+
+      if (!ReadFile(reinterpret_cast<HANDLE>(file), buffer, toRead, &read, &overlapped))
+         return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+
+      return read;
+   }
+
+   void CloseIoFile(const IoFile file)
+   {
+      CloseHandle(reinterpret_cast<HANDLE>(file));
+   }
+
+   std::string GetIoError()
+   {
+      const DWORD code = GetLastError();
+
+      char message[256] = { 0 };
+      FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, code, 0, message, sizeof(message), NULL);
+
+      //System message ends with the line break
+      std::string text(message);
+      while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == ' '))
+         text.pop_back();
+
+      return text + " (" + std::to_string(code) + ")";
+   }
+}
@@ -0,0 +1,17 @@
+#include "utils/memory-usage.h"
+
+#include "win64-dev.h"
+#include <Psapi.h>
+
+namespace utils
+{
+   size_t GetPeakResidentBytes()
+   {
+      PROCESS_MEMORY_COUNTERS counters;
+
+      if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+         return 0;
+
+      return counters.PeakWorkingSetSize;
+   }
+}
@@ -1,11 +1,58 @@
-#include "process.h"
+#include "utils/process/process.h"
+
+#include <string>
+
+#include <io.h>
+#include <fcntl.h>
 
-#include "debug/globals.h"
 #include "debug/globals.h"
 
 namespace utils
 {
-   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir)
+   static void CloseHandleIfValid(HANDLE& handle)
+   {
+      if (handle)
+         CloseHandle(handle);
+
+      handle = NULL;
+   }
+
+   static bool WriteAll(HANDLE handle, const void* data, size_t size)
+   {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+      while (size)
+      {
+         DWORD written = 0;
+         if (!WriteFile(handle, bytes, static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30)), &written, NULL) || !written)
+            return false;
+
+         bytes += written;
+         size -= written;
+      }
+
+      return true;
+   }
+
+   static bool ReadAll(HANDLE handle, void* data, size_t size)
+   {
+      uint8_t* bytes = static_cast<uint8_t*>(data);
+
+      while (size)
+      {
+         //Broken pipe is the exited child
+         DWORD read = 0;
+         if (!ReadFile(handle, bytes, static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30)), &read, NULL) || !read)
+            return false;
+
+         bytes += read;
+         size -= read;
+      }
+
+      return true;
+   }
+
+   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir, const bool isPiped)
    {
       ProcessInfo info;
 
@@ -24,17 +71,64 @@ namespace utils
 
       info.StartupInfo.cb = sizeof(info.StartupInfo);
 
-      ASSERT(CreateProcessA(NULL,
-             const_cast<char*>(execLocation.data()),
-             NULL,
-             NULL,
-             FALSE,
-             CREATE_NO_WINDOW,
-             NULL,
-             const_cast<char*>(workingDir.data()),
-             &info.StartupInfo,
-             &info.ProcessInfo),
-      "Error in process creation!");
+      HANDLE inputRead = NULL;
+      HANDLE outputWrite = NULL;
+
+      if (isPiped)
+      {
+         SECURITY_ATTRIBUTES attributes = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+
+         if (!CreatePipe(&inputRead, &info.InputWrite, &attributes, 0) || !CreatePipe(&info.OutputRead, &outputWrite, &attributes, 0))
+         {
+            LOG_ERROR("Error in process creation: %lu", GetLastError());
+
+            CloseHandleIfValid(inputRead);
+            CloseHandleIfValid(info.InputWrite);
+            CloseHandleIfValid(info.JobHandle);
+
+            return info;
+         }
+
+         //Only the child ends are inherited
+         SetHandleInformation(info.InputWrite, HANDLE_FLAG_INHERIT, 0);
+         SetHandleInformation(info.OutputRead, HANDLE_FLAG_INHERIT, 0);
+
+         info.StartupInfo.dwFlags |= STARTF_USESTDHANDLES;
+         info.StartupInfo.hStdInput = inputRead;
+         info.StartupInfo.hStdOutput = outputWrite;
+         info.StartupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+      }
+
+      //Command line is modified by the call, so it is the null terminated copy
+      std::string commandLine(execLocation);
+      const std::string dir(workingDir);
+
+      const BOOL isCreated = CreateProcessA(NULL,
+                                            commandLine.data(),
+                                            NULL,
+                                            NULL,
+                                            isPiped,
+                                            CREATE_NO_WINDOW,
+                                            NULL,
+                                            dir.empty() ? NULL : dir.c_str(),
+                                            &info.StartupInfo,
+                                            &info.ProcessInfo);
+
+      CloseHandleIfValid(inputRead);
+      CloseHandleIfValid(outputWrite);
+
+      if (!isCreated)
+      {
+         LOG_ERROR("Error in process creation: %lu", GetLastError());
+
+         CloseHandleIfValid(info.InputWrite);
+         CloseHandleIfValid(info.OutputRead);
+         CloseHandleIfValid(info.JobHandle);
+
+         ZeroMemory(&info.ProcessInfo, sizeof(info.ProcessInfo));
+
+         return info;
+      }
 
       AssignProcessToJobObject(info.JobHandle, info.ProcessInfo.hProcess);
 
@@ -43,9 +137,59 @@ namespace utils
 
    void DestroyProcess(const ProcessInfo& processInfo)
    {
-      CloseHandle(processInfo.JobHandle);
+      if (processInfo.InputWrite)
+         CloseHandle(processInfo.InputWrite);
+
+      if (processInfo.OutputRead)
+         CloseHandle(processInfo.OutputRead);
+
+      //Closing the job kills the child
+      if (processInfo.JobHandle)
+         CloseHandle(processInfo.JobHandle);
+
+      if (processInfo.ProcessInfo.hProcess)
+      {
+         WaitForSingleObject(processInfo.ProcessInfo.hProcess, INFINITE);
+
+         CloseHandle(processInfo.ProcessInfo.hProcess);
+         CloseHandle(processInfo.ProcessInfo.hThread);
+      }
+   }
+
+   bool WriteToProcess(const ProcessInfo& info, const void* data, const size_t size)
+   {
+      return WriteAll(info.InputWrite, data, size);
+   }
+
+   bool ReadFromProcess(const ProcessInfo& info, void* data, const size_t size)
+   {
+      return ReadAll(info.OutputRead, data, size);
+   }
+
+   ParentPipe OpenParentPipe()
+   {
+      //Redirected stdout descriptor closes its handle, so the pipe is kept by the duplicate
+      HANDLE output = NULL;
+      DuplicateHandle(GetCurrentProcess(), GetStdHandle(STD_OUTPUT_HANDLE), GetCurrentProcess(), &output, 0, FALSE, DUPLICATE_SAME_ACCESS);
+
+      ParentPipe pipe;
+      pipe.Input = reinterpret_cast<intptr_t>(GetStdHandle(STD_INPUT_HANDLE));
+      pipe.Output = reinterpret_cast<intptr_t>(output);
+
+      //Prints of the child go to the stderr, so they don't break the messages
+      SetStdHandle(STD_OUTPUT_HANDLE, GetStdHandle(STD_ERROR_HANDLE));
+      _dup2(_fileno(stderr), _fileno(stdout));
 
-      CloseHandle(processInfo.ProcessInfo.hProcess);
-      CloseHandle(processInfo.ProcessInfo.hThread);
+      return pipe;
+   }
+
+   bool ReadFromParent(const ParentPipe& pipe, void* data, const size_t size)
+   {
+      return ReadAll(reinterpret_cast<HANDLE>(pipe.Input), data, size);
+   }
+
+   bool WriteToParent(const ParentPipe& pipe, const void* data, const size_t size)
+   {
+      return WriteAll(reinterpret_cast<HANDLE>(pipe.Output), data, size);
    }
-}
\ No newline at end of file
+}
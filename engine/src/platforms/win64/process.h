@@ -7,18 +7,23 @@ namespace utils
 {
    struct ProcessInfo
    {
-      HANDLE JobHandle;
+      HANDLE JobHandle = NULL;
 
       STARTUPINFO StartupInfo;
-      PROCESS_INFORMATION ProcessInfo;
+      PROCESS_INFORMATION ProcessInfo = {};
+
+      //Ends of the pipes to the stdin and from the stdout of the piped child
+      HANDLE InputWrite = NULL;
+      HANDLE OutputRead = NULL;
    };
 
-   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir);
+   //Child is in the job that kills it with the parent, so it doesn't outlive the crashed engine
+   ProcessInfo CreateChildProcess(const std::string_view& execLocation, const std::string_view& workingDir, const bool isPiped = false);
 
    void DestroyProcess(const ProcessInfo& processInfo);
 
    inline bool IsProcessRunning(const ProcessInfo& info)
    {
-      return WaitForSingleObject(info.ProcessInfo.hProcess, 0) == WAIT_TIMEOUT;
+      return info.ProcessInfo.hProcess && WaitForSingleObject(info.ProcessInfo.hProcess, 0) == WAIT_TIMEOUT;
    }
-}
\ No newline at end of file
+}
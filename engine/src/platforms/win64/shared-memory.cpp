@@ -0,0 +1,104 @@
+#include "utils/shared-memory.h"
+
+#include "win64-dev.h"
+
+namespace utils
+{
+   struct SharedMemory::NativeInfo
+   {
+      HANDLE Mapping;
+   };
+
+   static std::string MakeError(const char* what)
+   {
+      return std::string(what) + ": " + std::to_string(GetLastError());
+   }
+
+   SharedMemory::SharedMemory() = default;
+
+   SharedMemory::~SharedMemory()
+   {
+      Close();
+   }
+
+   bool SharedMemory::Create(const std::string_view& name, const size_t size)
+   {
+      Close();
+
+      //Local namespace is of the session, so no privileges are needed
+      const std::string path = "Local\\" + std::string(name);
+
+      const uint64_t size64 = size;
+
+      HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                          static_cast<DWORD>(size64), path.c_str());
+      if (!mapping || GetLastError() == ERROR_ALREADY_EXISTS)
+      {
+         Error = MakeError("Couldn't create shared memory");
+
+         if (mapping)
+            CloseHandle(mapping);
+
+         return false;
+      }
+
+      void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+      if (!data)
+      {
+         Error = MakeError("Couldn't map shared memory");
+         CloseHandle(mapping);
+
+         return false;
+      }
+
+      Native = std::make_unique<NativeInfo>(NativeInfo({ mapping }));
+      Data = static_cast<uint8_t*>(data);
+      Size = size;
+      Error.clear();
+
+      return true;
+   }
+
+   bool SharedMemory::Open(const std::string_view& name, const size_t size)
+   {
+      Close();
+
+      const std::string path = "Local\\" + std::string(name);
+
+      HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+      if (!mapping)
+      {
+         Error = MakeError("Couldn't open shared memory");
+         return false;
+      }
+
+      void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+      if (!data)
+      {
+         Error = MakeError("Couldn't map shared memory");
+         CloseHandle(mapping);
+
+         return false;
+      }
+
+      Native = std::make_unique<NativeInfo>(NativeInfo({ mapping }));
+      Data = static_cast<uint8_t*>(data);
+      Size = size;
+      Error.clear();
+
+      return true;
+   }
+
+   void SharedMemory::Close()
+   {
+      if (Data)
+         UnmapViewOfFile(Data);
+
+      if (Native)
+         CloseHandle(Native->Mapping);
+
+      Native.reset();
+      Data = nullptr;
+      Size = 0;
+   }
+}
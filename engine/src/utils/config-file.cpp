@@ -1,7 +1,6 @@
 #include "config-file.h"
 
 #include <chrono>
-#include <sstream>
 
 #include "jobs/job-system.h"
 
@@ -9,20 +8,28 @@ namespace utils
 {
    static std::vector<ConfigFile*> ConfigFilesArr;
 
-   static std::map<std::string, ValueWrapper> ParseConfigFile(std::ifstream& file)
+   static std::map<std::string, ValueWrapper> ParseConfigFile(const std::string_view& text)
    {
       ConfigMap resMap;
 
-      std::string line;
-      while(std::getline(file, line))
+      size_t lineBegin = 0;
+      while (lineBegin < text.size())
       {
-         std::stringstream ss(line);
-         
-         std::string key;
-         std::getline(ss, key, ':');
+         size_t lineEnd = text.find('\n', lineBegin);
+         if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
 
-         std::string value;
-         std::getline(ss, value);
+         std::string_view line = text.substr(lineBegin, lineEnd - lineBegin);
+         lineBegin = lineEnd + 1;
+
+         //File is read as the bytes, so the CR of the Windows line breaks is still there
+         if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+         const size_t separator = line.find(':');
+
+         std::string key(line.substr(0, separator));
+         std::string value(separator != std::string_view::npos ? line.substr(separator + 1) : std::string_view());
 
          if(!(key.empty() && value.empty()))
             resMap[key] = value; 
@@ -50,25 +57,23 @@ namespace utils
 
    void ConfigFile::OpenFile()
    {
-      FileHandler.open(Path);
-
-      if (!FileHandler.is_open())
+      if (!File.Open(Path.string(), FileAccess::Sequential))
       {
-         LOG_ERROR("Invalid config file path specified!");
+         LOG_ERROR("Couldn't open config file: %s (%s)", Path.string().c_str(), File.GetError().c_str());
          return;
       }
    }
 
    void ConfigFile::CloseFile()
    {
-      FileHandler.close();
+      File.Close();
    }
 
    void ConfigFile::Callback()
    {
       try
       {
-         OnFileUpdate(ParseConfigFile(FileHandler));
+         OnFileUpdate(ParseConfigFile(File.GetText()));
       }
       catch (...)
       {
@@ -4,10 +4,10 @@
 #include <map>
 #include <functional>
 #include <stdexcept>
-#include <fstream>
 #include <filesystem>
 
 #include "debug/globals.h"
+#include "utils/file-view.h"
 
 namespace utils
 {
@@ -69,7 +69,7 @@ namespace utils
    private:
       std::filesystem::path Path;
 
-      std::ifstream FileHandler;
+      FileView File;
         
       //This function is called when the file opens first time and later when the file modify
       std::function<void(const ConfigMap&)> OnFileUpdate;
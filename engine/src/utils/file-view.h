@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+   //How the view is going to be read, the OS uses it for the read ahead of the mapped pages
+   enum class FileAccess
+   {
+      Normal,
+      Sequential, //Read once from the start to the end, e.g. the loose asset or the shader source
+      Random      //Small reads all over the file, e.g. the entries of the archive
+   };
+
+   //Read-only view of the whole file contents that is backed by the OS file mapping
+   //Pages are loaded lazily on access, so opening a big file doesn't copy anything
+   //Files that can't be mapped, e.g. the pipes or the special files, are read into the memory owned by the view
+   class FileView
+   {
+   private:
+      struct NativeInfo;
+      std::unique_ptr<NativeInfo> Native;
+
+      const uint8_t* Data = nullptr;
+      size_t Size = 0;
+
+      std::unique_ptr<uint8_t[]> Storage; //Contents of the file that wasn't mapped
+
+      std::string Error;
+   public:
+      FileView();
+      FileView(const std::string_view& filepath, const FileAccess access = FileAccess::Normal);
+      ~FileView();
+
+      FileView(FileView&& view) noexcept;
+      FileView& operator = (FileView&& view) noexcept;
+
+      FileView(const FileView&) = delete;
+      FileView& operator = (const FileView&) = delete;
+
+      //Empty file is opened successfully with the null data, so only the result tells it from the failure
+      bool Open(const std::string_view& filepath, const FileAccess access = FileAccess::Normal);
+      void Close();
+
+      //Hint for the part of the mapped file, e.g. the range that is going to be read next
+      void Advise(const FileAccess access, const size_t offset, const size_t size) const;
+
+      inline bool IsOpen() const
+      {
+         return Native != nullptr;
+      }
+
+      inline bool IsMapped() const
+      {
+         return Native != nullptr && Storage == nullptr && Data != nullptr;
+      }
+
+      inline const uint8_t* GetData() const
+      {
+         return Data;
+      }
+
+      inline size_t GetSize() const
+      {
+         return Size;
+      }
+
+      //Contents as the text, it isn't null terminated
+      inline std::string_view GetText() const
+      {
+         return std::string_view(reinterpret_cast<const char*>(Data), Size);
+      }
+
+      //Reason of the last Open failure with the OS message, empty when the file is open
+      inline const std::string& GetError() const
+      {
+         return Error;
+      }
+   };
+}
@@ -0,0 +1,550 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <iterator>
+
+#include "utils/hashed-string.h"
+#include "debug/globals.h"
+
+//Open addressing hash map with the Robin Hood linear probing
+//
+//All the elements live in the single array, so the lookup is a hash, a multiply and a short linear scan
+//without the pointer chasing of the std::unordered_map nodes
+//
+//Differences from the std::unordered_map:
+//   - Insert and erase invalidate the iterators and the references to the elements
+//   - Elements are moved during the insertion, so Key and Value must be move constructible
+//   - Hasher with the is_transparent tag enables the lookup by any compatible key type (std::string by std::string_view)
+
+namespace utils
+{
+   //Strings are hashed with the FNV-1a, so std::string, std::string_view and literals with the same text give the same hash
+   struct StringHash
+   {
+      using is_transparent = void;
+
+      inline size_t operator()(const std::string_view& str) const
+      {
+         return static_cast<size_t>(HashFnv1a(str));
+      }
+   };
+
+   template<typename T>
+   struct FlatHash : std::hash<T> {};
+
+   template<>
+   struct FlatHash<std::string> : StringHash {};
+
+   template<>
+   struct FlatHash<std::string_view> : StringHash {};
+
+
+   template<typename Key, typename Value, typename Hasher = FlatHash<Key>, typename KeyEqual = std::equal_to<>>
+   class FlatHashMap
+   {
+   public:
+      using key_type = Key;
+      using mapped_type = Value;
+      using value_type = std::pair<Key, Value>;
+      using size_type = size_t;
+
+   private:
+      //Load factor is kept high, because the Robin Hood probing keeps the probe sequences short even for the full table
+      static constexpr size_t MaxLoadNumerator = 7;
+      static constexpr size_t MaxLoadDenominator = 8;
+
+      static constexpr size_t MinCapacity = 8;
+
+      //When any probe sequence gets longer than this the table is grown early on the next insert
+      //Only when the table is at least half full, because growing doesn't help when the hashes are just equal
+      static constexpr uint16_t MaxProbeDistance = 128;
+
+      //Distances[i] is 0 for the empty slot, otherwise it is the distance from the slot the element is hashed to plus 1
+      //One more element past the end is never 0, so the iterators stop there without the bounds check
+      value_type* Slots = nullptr;
+      uint16_t* Distances = EmptyTable();
+
+      size_t Capacity = 0;
+      size_t Size = 0;
+      size_t GrowthLimit = 0;
+
+      uint32_t Shift = 64;
+
+      bool GrowRequested = false;
+
+      static inline uint16_t* EmptyTable()
+      {
+         static uint16_t sentinel = 1;
+         return &sentinel;
+      }
+
+      //Fibonacci hashing spreads the bits of the weak hashes (std::hash of the integers is the identity), so the low bits are usable
+      inline size_t IndexFor(const size_t hash) const
+      {
+         return static_cast<size_t>((static_cast<uint64_t>(hash) * 11400714819323198485ull) >> Shift);
+      }
+
+      template<typename K>
+      inline size_t FindIndex(const K& key) const
+      {
+         if (!Size)
+            return Capacity;
+
+         const size_t mask = Capacity - 1;
+
+         size_t index = IndexFor(Hasher{}(key));
+         uint16_t distance = 1;
+
+         //Elements are ordered by the distance, so the richer element means that the key isn't in the table
+         while (Distances[index] >= distance)
+         {
+            if (Distances[index] == distance && KeyEqual{}(Slots[index].first, key))
+               return index;
+
+            index = (index + 1) & mask;
+            ++distance;
+         }
+
+         return Capacity;
+      }
+
+      inline size_t FindExistingIndex(const Key& key) const
+      {
+         const size_t index = FindIndex(key);
+
+         if (index == Capacity)
+         {
+            PRINT_AND_TERMINATE("Key isn't in the flat hash map");
+
+            //Debug version of the macro only breaks
+            abort();
+         }
+
+         return index;
+      }
+
+      //Key must not be in the table, returns the index where the element ended up
+      inline size_t InsertUnique(value_type&& element, const size_t hash)
+      {
+         const size_t mask = Capacity - 1;
+
+         size_t index = IndexFor(hash);
+         uint16_t distance = 1;
+
+         size_t result = Capacity;
+
+         value_type current(std::move(element));
+
+         while (true)
+         {
+            if (Distances[index] == 0)
+            {
+               new (&Slots[index]) value_type(std::move(current));
+               Distances[index] = distance;
+
+               return result != Capacity ? result : index;
+            }
+
+            //Take the slot from the element that is closer to its home and carry that element further
+            if (Distances[index] < distance)
+            {
+               std::swap(current, Slots[index]);
+               std::swap(distance, Distances[index]);
+
+               if (result == Capacity)
+                  result = index;
+            }
+
+            index = (index + 1) & mask;
+            ++distance;
+
+            if (distance > MaxProbeDistance)
+               GrowRequested = true;
+         }
+      }
+
+      inline void Rehash(size_t newCapacity)
+      {
+         value_type* oldSlots = Slots;
+         uint16_t* oldDistances = Distances;
+         const size_t oldCapacity = Capacity;
+
+         uint32_t shift = 64;
+         for (size_t c = newCapacity; c > 1; c >>= 1)
+            --shift;
+
+         Slots = std::allocator<value_type>().allocate(newCapacity);
+         Distances = new uint16_t[newCapacity + 1]();
+         Distances[newCapacity] = 1;
+
+         Capacity = newCapacity;
+         GrowthLimit = newCapacity * MaxLoadNumerator / MaxLoadDenominator;
+         Shift = shift;
+         GrowRequested = false;
+
+         for (size_t i = 0; i < oldCapacity; ++i)
+         {
+            if (!oldDistances[i])
+               continue;
+
+            const size_t hash = Hasher{}(oldSlots[i].first);
+            InsertUnique(std::move(oldSlots[i]), hash);
+
+            oldSlots[i].~value_type();
+         }
+
+         if (oldCapacity)
+         {
+            std::allocator<value_type>().deallocate(oldSlots, oldCapacity);
+            delete[] oldDistances;
+         }
+      }
+
+      static inline size_t CapacityFor(const size_t count)
+      {
+         const size_t required = (count * MaxLoadDenominator + MaxLoadNumerator - 1) / MaxLoadNumerator;
+
+         size_t capacity = MinCapacity;
+         while (capacity < required)
+            capacity <<= 1;
+
+         return capacity;
+      }
+
+      inline void Release()
+      {
+         clear();
+
+         if (Capacity)
+         {
+            std::allocator<value_type>().deallocate(Slots, Capacity);
+            delete[] Distances;
+         }
+
+         Slots = nullptr;
+         Distances = EmptyTable();
+         Capacity = 0;
+         GrowthLimit = 0;
+         Shift = 64;
+      }
+
+      template<typename K, typename... Args>
+      inline std::pair<size_t, bool> TryEmplaceIndex(K&& key, Args&&... args)
+      {
+         const size_t existing = FindIndex(key);
+         if (existing != Capacity)
+            return { existing, false };
+
+         if (Size + 1 > GrowthLimit || (GrowRequested && Size >= Capacity / 2))
+            Rehash(Capacity ? Capacity * 2 : MinCapacity);
+
+         const size_t hash = Hasher{}(key);
+
+         value_type element(std::piecewise_construct,
+                            std::forward_as_tuple(std::forward<K>(key)),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+
+         const size_t index = InsertUnique(std::move(element), hash);
+         ++Size;
+
+         return { index, true };
+      }
+
+   public:
+      template<bool IsConst>
+      class Iterator
+      {
+      private:
+         friend class FlatHashMap;
+
+         template<bool>
+         friend class Iterator;
+
+         using SlotPointer = std::conditional_t<IsConst, const typename FlatHashMap::value_type*, typename FlatHashMap::value_type*>;
+
+         SlotPointer Slot = nullptr;
+         const uint16_t* Distance = nullptr;
+
+         inline Iterator(SlotPointer slot, const uint16_t* distance)
+            : Slot(slot), Distance(distance) {}
+
+         inline void SkipEmpty()
+         {
+            while (!*Distance)
+            {
+               ++Slot;
+               ++Distance;
+            }
+         }
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = typename FlatHashMap::value_type;
+         using difference_type = ptrdiff_t;
+         using pointer = SlotPointer;
+         using reference = std::conditional_t<IsConst, const typename FlatHashMap::value_type&, typename FlatHashMap::value_type&>;
+
+         Iterator() = default;
+
+         //Non const iterator converts to the const one
+         template<bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+         inline Iterator(const Iterator<WasConst>& it)
+            : Slot(it.Slot), Distance(it.Distance) {}
+
+         inline reference operator * () const { return *Slot; }
+         inline pointer operator -> () const { return Slot; }
+
+         inline Iterator& operator ++ ()
+         {
+            ++Slot;
+            ++Distance;
+            SkipEmpty();
+
+            return *this;
+         }
+
+         inline Iterator operator ++ (int)
+         {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+         }
+
+         inline bool operator == (const Iterator& it) const { return Distance == it.Distance; }
+         inline bool operator != (const Iterator& it) const { return Distance != it.Distance; }
+      };
+
+      using iterator = Iterator<false>;
+      using const_iterator = Iterator<true>;
+
+      FlatHashMap() = default;
+
+      inline FlatHashMap(const std::initializer_list<value_type>& elements)
+      {
+         reserve(elements.size());
+
+         for (auto& e : elements)
+            TryEmplaceIndex(e.first, e.second);
+      }
+
+      inline FlatHashMap(const FlatHashMap& map)
+      {
+         reserve(map.Size);
+
+         for (auto& e : map)
+            TryEmplaceIndex(e.first, e.second);
+      }
+
+      inline FlatHashMap(FlatHashMap&& map) noexcept
+      {
+         *this = std::move(map);
+      }
+
+      inline FlatHashMap& operator = (const FlatHashMap& map)
+      {
+         if (this != &map)
+         {
+            clear();
+            reserve(map.Size);
+
+            for (auto& e : map)
+               TryEmplaceIndex(e.first, e.second);
+         }
+
+         return *this;
+      }
+
+      inline FlatHashMap& operator = (FlatHashMap&& map) noexcept
+      {
+         if (this != &map)
+         {
+            Release();
+
+            std::swap(Slots, map.Slots);
+            std::swap(Distances, map.Distances);
+            std::swap(Capacity, map.Capacity);
+            std::swap(Size, map.Size);
+            std::swap(GrowthLimit, map.GrowthLimit);
+            std::swap(Shift, map.Shift);
+            std::swap(GrowRequested, map.GrowRequested);
+         }
+
+         return *this;
+      }
+
+      inline ~FlatHashMap()
+      {
+         Release();
+      }
+
+      //Allocates enough slots for the count elements, so inserting them won't rehash
+      inline void reserve(const size_t count)
+      {
+         const size_t capacity = CapacityFor(count);
+
+         if (capacity > Capacity)
+            Rehash(capacity);
+      }
+
+      inline void clear()
+      {
+         for (size_t i = 0; i < Capacity; ++i)
+         {
+            if (Distances[i])
+            {
+               Slots[i].~value_type();
+               Distances[i] = 0;
+            }
+         }
+
+         Size = 0;
+      }
+
+      inline size_t size() const { return Size; }
+      inline bool empty() const { return Size == 0; }
+      inline size_t capacity() const { return Capacity; }
+
+      inline iterator begin()
+      {
+         iterator it(Slots, Distances);
+         it.SkipEmpty();
+         return it;
+      }
+
+      inline const_iterator begin() const
+      {
+         const_iterator it(Slots, Distances);
+         it.SkipEmpty();
+         return it;
+      }
+
+      inline iterator end() { return iterator(Slots + Capacity, Distances + Capacity); }
+      inline const_iterator end() const { return const_iterator(Slots + Capacity, Distances + Capacity); }
+
+      inline iterator find(const Key& key)
+      {
+         const size_t index = FindIndex(key);
+         return iterator(Slots + index, Distances + index);
+      }
+
+      inline const_iterator find(const Key& key) const
+      {
+         const size_t index = FindIndex(key);
+         return const_iterator(Slots + index, Distances + index);
+      }
+
+      template<typename K, typename H = Hasher, typename = typename H::is_transparent>
+      inline iterator find(const K& key)
+      {
+         const size_t index = FindIndex(key);
+         return iterator(Slots + index, Distances + index);
+      }
+
+      template<typename K, typename H = Hasher, typename = typename H::is_transparent>
+      inline const_iterator find(const K& key) const
+      {
+         const size_t index = FindIndex(key);
+         return const_iterator(Slots + index, Distances + index);
+      }
+
+      inline bool contains(const Key& key) const
+      {
+         return FindIndex(key) != Capacity;
+      }
+
+      template<typename K, typename H = Hasher, typename = typename H::is_transparent>
+      inline bool contains(const K& key) const
+      {
+         return FindIndex(key) != Capacity;
+      }
+
+      //Key must be in the map, the missing one terminates the program
+      inline Value& at(const Key& key)
+      {
+         return Slots[FindExistingIndex(key)].second;
+      }
+
+      inline const Value& at(const Key& key) const
+      {
+         return Slots[FindExistingIndex(key)].second;
+      }
+
+      template<typename K, typename... Args>
+      inline std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+      {
+         const auto res = TryEmplaceIndex(std::forward<K>(key), std::forward<Args>(args)...);
+         return { iterator(Slots + res.first, Distances + res.first), res.second };
+      }
+
+      inline std::pair<iterator, bool> insert(const value_type& element)
+      {
+         return try_emplace(element.first, element.second);
+      }
+
+      inline std::pair<iterator, bool> insert(value_type&& element)
+      {
+         return try_emplace(std::move(element.first), std::move(element.second));
+      }
+
+      inline Value& operator [] (const Key& key)
+      {
+         //Insertion can reallocate the slots, so the index must be taken before the Slots are read
+         const size_t index = TryEmplaceIndex(key).first;
+         return Slots[index].second;
+      }
+
+      inline Value& operator [] (Key&& key)
+      {
+         //Insertion can reallocate the slots, so the index must be taken before the Slots are read
+         const size_t index = TryEmplaceIndex(std::move(key)).first;
+         return Slots[index].second;
+      }
+
+      //Key is converted to the Key type only when the new element is inserted
+      template<typename K, typename H = Hasher, typename = typename H::is_transparent>
+      inline Value& operator [] (const K& key)
+      {
+         //Insertion can reallocate the slots, so the index must be taken before the Slots are read
+         const size_t index = TryEmplaceIndex(key).first;
+         return Slots[index].second;
+      }
+
+      //Backward shift deletion, the table stays as if the element was never inserted
+      template<typename K>
+      inline size_t erase(const K& key)
+      {
+         size_t index = FindIndex(key);
+         if (index == Capacity)
+            return 0;
+
+         const size_t mask = Capacity - 1;
+
+         Slots[index].~value_type();
+         Distances[index] = 0;
+
+         size_t next = (index + 1) & mask;
+         while (Distances[next] > 1)
+         {
+            new (&Slots[index]) value_type(std::move(Slots[next]));
+            Distances[index] = Distances[next] - 1;
+
+            Slots[next].~value_type();
+            Distances[next] = 0;
+
+            index = next;
+            next = (next + 1) & mask;
+         }
+
+         --Size;
+
+         return 1;
+      }
+   };
+}
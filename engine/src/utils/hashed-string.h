@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <mutex>
+
+#include "utils/sync/spin-lock.h"
+#include "debug/globals.h"
+
+//Intern table keeps the source strings of the runtime hashed strings, so the hash can be turned back into the name
+//It is enabled in debug by default, define HASHED_STRING_INTERN to enable it in the other configurations
+#if defined(DEBUG) && !defined(HASHED_STRING_INTERN)
+   #define HASHED_STRING_INTERN
+#endif
+
+namespace utils
+{
+   inline constexpr uint64_t FnvOffsetBasis = 14695981039346656037ull;
+   inline constexpr uint64_t FnvPrime = 1099511628211ull;
+
+   //64 bit FNV-1a, unlike std::hash the result is the same for every compiler and platform
+   //So it can be stored in the cooked data
+   constexpr uint64_t HashFnv1a(const char* str, const size_t size)
+   {
+      uint64_t hash = FnvOffsetBasis;
+
+      for (size_t i = 0; i < size; ++i)
+      {
+         hash ^= static_cast<uint8_t>(str[i]);
+         hash *= FnvPrime;
+      }
+
+      return hash;
+   }
+
+   constexpr uint64_t HashFnv1a(const std::string_view& str)
+   {
+      return HashFnv1a(str.data(), str.size());
+   }
+
+   static_assert(HashFnv1a("") == 0xCBF29CE484222325ull, "Invalid FNV-1a implementation");
+   static_assert(HashFnv1a("a") == 0xAF63DC4C8601EC8Cull, "Invalid FNV-1a implementation");
+
+
+   class InternTable
+   {
+   private:
+      static inline std::unordered_map<uint64_t, std::string> Names;
+      static inline sync::SpinLock Lock;
+   public:
+      static inline void Register(const uint64_t hash, const std::string_view& name)
+      {
+#ifdef HASHED_STRING_INTERN
+         std::lock_guard<sync::SpinLock> l(Lock);
+
+         auto res = Names.emplace(hash, name);
+
+         //Two different strings with the same hash would make the lookups ambiguous
+         if (!res.second && res.first->second != name)
+         {
+            PRINT_AND_TERMINATE("Hashed strings collision: %s and %s", res.first->second.c_str(), std::string(name).c_str());
+         }
+#endif
+      }
+
+      //Returned pointer is valid till the end of the program, because the names are never removed
+      static inline const char* GetName(const uint64_t hash)
+      {
+#ifdef HASHED_STRING_INTERN
+         std::lock_guard<sync::SpinLock> l(Lock);
+
+         auto name = Names.find(hash);
+         if (name != Names.end())
+            return name->second.c_str();
+#endif
+         return "<unknown>";
+      }
+   };
+
+
+   //String literals are hashed at compile time, so the lookup by the HashedString is only an integer compare
+   class HashedString
+   {
+   private:
+      uint64_t Value = 0;
+   public:
+      constexpr HashedString() = default;
+
+      //Literals are hashed at compile time in the constant expressions, e.g. the constexpr variables and the case labels
+      //Runtime pointers are hashed at runtime, neither of them is interned, so their GetDebugName is unknown
+      constexpr HashedString(const char* str)
+         : Value(HashFnv1a(std::string_view(str))) {}
+
+      //Runtime strings are also added to the intern table
+      explicit inline HashedString(const std::string_view& str)
+         : Value(HashFnv1a(str))
+      {
+         InternTable::Register(Value, str);
+      }
+
+      static constexpr HashedString FromValue(const uint64_t value)
+      {
+         HashedString res;
+         res.Value = value;
+         return res;
+      }
+
+      constexpr uint64_t GetValue() const
+      {
+         return Value;
+      }
+
+      inline const char* GetDebugName() const
+      {
+         return InternTable::GetName(Value);
+      }
+
+      constexpr bool operator == (const HashedString& hs) const
+      {
+         return Value == hs.Value;
+      }
+
+      constexpr bool operator != (const HashedString& hs) const
+      {
+         return Value != hs.Value;
+      }
+
+      constexpr bool operator < (const HashedString& hs) const
+      {
+         return Value < hs.Value;
+      }
+   };
+}
+
+namespace std
+{
+   template<>
+   struct hash<utils::HashedString>
+   {
+      size_t operator()(const utils::HashedString& hs) const
+      {
+         return static_cast<size_t>(hs.GetValue());
+      }
+   };
+}
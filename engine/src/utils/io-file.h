@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+   //OS file handle for the positional reads, it is the descriptor on the POSIX and the HANDLE on the Windows
+   using IoFile = intptr_t;
+
+   constexpr IoFile InvalidIoFile = -1;
+
+   //File is opened for the reads from the start to the end, the OS read ahead is set up for it
+   //Error gets the OS reason on the failure
+   IoFile OpenIoFile(const std::string_view& filepath, uint64_t& size, std::string& error);
+
+   //Reads at the offset without moving the shared file position, so the threads can read the same file at once
+   //Returns the bytes read, 0 at the end of the file and -1 on the failure
+   int64_t ReadIoFile(const IoFile file, const uint64_t offset, uint8_t* buffer, const size_t size);
+
+   void CloseIoFile(const IoFile file);
+
+   //Last OS error of the calling thread as the text
+   std::string GetIoError();
+}
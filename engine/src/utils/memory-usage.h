@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+
+namespace utils
+{
+   //Peak resident memory of the process since its start, in bytes
+   size_t GetPeakResidentBytes();
+}
@@ -1,5 +1,32 @@
 #pragma once
+#include <cstdint>
+#include <cstddef>
 
 #ifdef WINDOWS
    #include "platforms/win64/process.h"
-#endif
\ No newline at end of file
+#else
+   #include "platforms/posix/process.h"
+#endif
+
+namespace utils
+{
+   //Pipe calls block until the whole buffer is transferred, they return false when the other side has exited or closed it
+
+   bool WriteToProcess(const ProcessInfo& info, const void* data, const size_t size);
+
+   bool ReadFromProcess(const ProcessInfo& info, void* data, const size_t size);
+
+   //Stdin and stdout of the child that is created with the pipes
+   struct ParentPipe
+   {
+      intptr_t Input;
+      intptr_t Output;
+   };
+
+   //Takes the stdout away for the messages, the later prints of the child go to the stderr
+   ParentPipe OpenParentPipe();
+
+   bool ReadFromParent(const ParentPipe& pipe, void* data, const size_t size);
+
+   bool WriteToParent(const ParentPipe& pipe, const void* data, const size_t size);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+   //Named memory that is mapped by the several processes, e.g. for the big results of the child without the copies through the pipe
+   //Name is the plain identifier, the platform prefix is added to it
+   //Creator owns the name: on POSIX it is removed by the Close of the creator, on Windows with the last mapping
+   class SharedMemory
+   {
+   private:
+      struct NativeInfo;
+      std::unique_ptr<NativeInfo> Native;
+
+      uint8_t* Data = nullptr;
+      size_t Size = 0;
+
+      std::string Error;
+   public:
+      SharedMemory();
+      ~SharedMemory();
+
+      SharedMemory(const SharedMemory&) = delete;
+      SharedMemory& operator = (const SharedMemory&) = delete;
+
+      //Fails when the memory with the name already exists
+      bool Create(const std::string_view& name, const size_t size);
+
+      //Size must be the one the memory was created with
+      bool Open(const std::string_view& name, const size_t size);
+
+      void Close();
+
+      inline bool IsOpen() const
+      {
+         return Data != nullptr;
+      }
+
+      inline uint8_t* GetData() const
+      {
+         return Data;
+      }
+
+      inline size_t GetSize() const
+      {
+         return Size;
+      }
+
+      //Reason of the last Create or Open failure with the OS message
+      inline const std::string& GetError() const
+      {
+         return Error;
+      }
+   };
+}
@@ -1,2 +1,9 @@
+#include "asset-manager/pixel-pool.h"
+
+//Decoded images and the decoder temporaries come from the pool, so the repeated loads reuse the same memory
+#define STBI_MALLOC(size)       assets::PixelPool::Allocate(size)
+#define STBI_REALLOC(ptr, size) assets::PixelPool::Reallocate(ptr, size)
+#define STBI_FREE(ptr)          assets::PixelPool::Free(ptr)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
\ No newline at end of file
@@ -3,9 +3,10 @@
 #include <vector>
 #include <deque>
 #include <utility>
-#include <unordered_map>
+#include <string>
 
 #include "native-input-handling.h"
+#include "utils/flat-hash-map.h"
 
 namespace input
 {
@@ -62,8 +63,9 @@ namespace input
       std::vector<ActionCallbackInfo> ActionsKeyList;
       std::vector<AxisCallbackInfo> AxisesKeyList;
 
-      std::unordered_map<std::string_view, std::deque<InputEvent>> ActionKeyMap;
-      std::unordered_map<std::string_view, std::deque<std::pair<InputEvent, float>>> AxisKeyMap;
+      //Names are copied into the keys, the lookups by the std::string_view don't allocate
+      utils::FlatHashMap<std::string, std::deque<InputEvent>> ActionKeyMap;
+      utils::FlatHashMap<std::string, std::deque<std::pair<InputEvent, float>>> AxisKeyMap;
 
       std::shared_ptr<native::NativeInputManager> NativeInputManager;
    public:
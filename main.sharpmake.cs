@@ -87,6 +87,42 @@ namespace sharpmake
 
             SourceRootPath = @"[project.SharpmakeCsPath]/tests/";
 
+            //Tested engine code that isn't header only
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/asset-manager.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pak/pak-archive.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pixel-pool.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/block-compression.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mip-chain.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/atlas.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/streaming/mip-selection.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/streaming/texture-streamer.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-simplify.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/meshlets.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-optimize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/vertex-quantize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/derived-cache.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/cook-worker.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/json-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/glb.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/obj/obj-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/lod-selection.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/culling.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/mesh-residency.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/memory/tlsf-allocator.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/graphics/render-sort.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/job-system.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/pipeline.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/io-service.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/file-view.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/io-file.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/process.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/shared-memory.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/timer.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/memory-usage.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/vendors/stb/stb_image.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/globals.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/log/log.cpp");
+
             AddTargets(new Target(Platform.win64, DevEnv.vs2019, Optimization.Debug | Optimization.Release | Optimization.Retail));
         }
 
@@ -100,7 +136,9 @@ namespace sharpmake
 
 
             config.IncludePaths.Add(@"[project.SharpmakeCsPath]/tests/extern/googletest/include");
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src/vendors");
             config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src");
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/extern/imgui"); //Graphics API headers include it
 
             config.LibraryPaths.Add(@"[project.SharpmakeCsPath]/tests/extern/googletest/lib");
 
@@ -117,6 +155,198 @@ namespace sharpmake
         }
     }
 
+    [Generate]
+    public class PakPackerProject : Project
+    {
+        public PakPackerProject()
+        {
+            Name = "PakPacker";
+
+            SourceRootPath = @"[project.SharpmakeCsPath]/tools/pak-packer/src";
+
+            //Image cooking shares the code with the engine
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/vendors/stb/stb_image.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pixel-pool.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mip-chain.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/block-compression.cpp");
+
+            AddTargets(new Target(Platform.win64, DevEnv.vs2019, Optimization.Debug | Optimization.Release | Optimization.Retail));
+        }
+
+        [Configure]
+        public void ConfigureAll(Project.Configuration config, Target target)
+        {
+            config.Options.Add(Options.Vc.General.WindowsTargetPlatformVersion.Latest);
+            config.Options.Add(Options.Vc.General.WarningLevel.EnableAllWarnings);
+
+            config.Options.Add(Options.Vc.Compiler.CppLanguageStandard.CPP17);
+
+
+            if (target.Optimization == Optimization.Debug)
+                config.Defines.Add("DEBUG");
+            else
+                config.Defines.Add("RELEASE");
+
+            if (target.Platform == Platform.win64)
+                config.Defines.Add("WINDOWS");
+
+
+            config.ProjectPath = @"[project.SharpmakeCsPath]/tools/pak-packer";
+
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src/vendors");
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src");
+
+
+            config.Output = Configuration.OutputType.Exe;
+
+            config.TargetPath = @"[project.SharpmakeCsPath]/engine/binaries/[target.Optimization]";
+            config.IntermediatePath = @"[project.SharpmakeCsPath]/engine/binaries/int/pak-packer/[target.Optimization]";
+        }
+    }
+
+    [Generate]
+    public class MeshReportProject : Project
+    {
+        public MeshReportProject()
+        {
+            Name = "MeshReport";
+
+            SourceRootPath = @"[project.SharpmakeCsPath]/tools/mesh-report/src";
+
+            //Meshes are loaded and cooked by the same code as the engine does it
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/asset-manager.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pak/pak-archive.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pixel-pool.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mip-chain.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/block-compression.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/atlas.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-simplify.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/meshlets.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-optimize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/vertex-quantize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/derived-cache.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/cook-worker.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/json-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/glb.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/obj/obj-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/job-system.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/pipeline.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/io-service.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/globals.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/log/log.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/file-view.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/io-file.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/process.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/shared-memory.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/timer.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/memory-usage.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/vendors/stb/stb_image.cpp");
+
+            AddTargets(new Target(Platform.win64, DevEnv.vs2019, Optimization.Debug | Optimization.Release | Optimization.Retail));
+        }
+
+        [Configure]
+        public void ConfigureAll(Project.Configuration config, Target target)
+        {
+            config.Options.Add(Options.Vc.General.WindowsTargetPlatformVersion.Latest);
+            config.Options.Add(Options.Vc.General.WarningLevel.EnableAllWarnings);
+
+            config.Options.Add(Options.Vc.Compiler.CppLanguageStandard.CPP17);
+
+
+            if (target.Optimization == Optimization.Debug)
+                config.Defines.Add("DEBUG");
+            else
+                config.Defines.Add("RELEASE");
+
+            if (target.Platform == Platform.win64)
+                config.Defines.Add("WINDOWS");
+
+
+            config.ProjectPath = @"[project.SharpmakeCsPath]/tools/mesh-report";
+
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src/vendors");
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src");
+
+
+            config.Output = Configuration.OutputType.Exe;
+
+            config.TargetPath = @"[project.SharpmakeCsPath]/engine/binaries/[target.Optimization]";
+            config.IntermediatePath = @"[project.SharpmakeCsPath]/engine/binaries/int/mesh-report/[target.Optimization]";
+        }
+    }
+
+    [Generate]
+    public class CookWorkerProject : Project
+    {
+        public CookWorkerProject()
+        {
+            Name = "CookWorker";
+
+            SourceRootPath = @"[project.SharpmakeCsPath]/tools/cook-worker/src";
+
+            //Assets are cooked by the same code as the engine does it in its job threads
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/asset-manager.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pak/pak-archive.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/pixel-pool.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mip-chain.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/block-compression.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/atlas.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-simplify.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/meshlets.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/mesh-optimize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/vertex-quantize.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/derived-cache.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/cook/cook-worker.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/json-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/gltf/glb.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/asset-manager/obj/obj-reader.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/job-system.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/pipeline.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/jobs/io-service.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/globals.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/debug/log/log.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/file-view.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/io-file.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/process.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/shared-memory.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/platforms/win64/timer.cpp");
+            SourceFiles.Add(@"[project.SharpmakeCsPath]/engine/src/vendors/stb/stb_image.cpp");
+
+            AddTargets(new Target(Platform.win64, DevEnv.vs2019, Optimization.Debug | Optimization.Release | Optimization.Retail));
+        }
+
+        [Configure]
+        public void ConfigureAll(Project.Configuration config, Target target)
+        {
+            config.Options.Add(Options.Vc.General.WindowsTargetPlatformVersion.Latest);
+            config.Options.Add(Options.Vc.General.WarningLevel.EnableAllWarnings);
+
+            config.Options.Add(Options.Vc.Compiler.CppLanguageStandard.CPP17);
+
+
+            if (target.Optimization == Optimization.Debug)
+                config.Defines.Add("DEBUG");
+            else
+                config.Defines.Add("RELEASE");
+
+            if (target.Platform == Platform.win64)
+                config.Defines.Add("WINDOWS");
+
+
+            config.ProjectPath = @"[project.SharpmakeCsPath]/tools/cook-worker";
+
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src/vendors");
+            config.IncludePaths.Add(@"[project.SharpmakeCsPath]/engine/src");
+
+
+            config.Output = Configuration.OutputType.Exe;
+
+            config.TargetPath = @"[project.SharpmakeCsPath]/engine/binaries/[target.Optimization]";
+            config.IntermediatePath = @"[project.SharpmakeCsPath]/engine/binaries/int/cook-worker/[target.Optimization]";
+        }
+    }
+
     [Generate]
     public class MainSolution : Solution
     {
@@ -134,6 +364,9 @@ namespace sharpmake
 
             config.AddProject<RenderTestProject>(target);
             config.AddProject<TestsProject>(target);
+            config.AddProject<PakPackerProject>(target);
+            config.AddProject<MeshReportProject>(target);
+            config.AddProject<CookWorkerProject>(target);
 
             config.SetStartupProject<RenderTestProject>();
         }
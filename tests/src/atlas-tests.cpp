@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "asset-manager/cook/atlas.h"
+#include "asset-manager/asset-manager.h"
+
+using namespace assets::cook;
+
+namespace
+{
+   bool Overlaps(const AtlasRegion& a, const AtlasRegion& b, const int32_t gutter)
+   {
+      return a.X - gutter < b.X + b.Width + gutter && b.X - gutter < a.X + a.Width + gutter
+          && a.Y - gutter < b.Y + b.Height + gutter && b.Y - gutter < a.Y + a.Height + gutter;
+   }
+}
+
+TEST(SkylinePacker, FillsRows)
+{
+   SkylinePacker packer(64, 64);
+
+   int32_t x, y;
+   for (int32_t i = 0; i < 16; ++i)
+   {
+      ASSERT_TRUE(packer.Insert(16, 16, x, y));
+      EXPECT_EQ(x, i % 4 * 16);
+      EXPECT_EQ(y, i / 4 * 16);
+   }
+
+   EXPECT_FALSE(packer.Insert(1, 1, x, y));
+}
+
+TEST(SkylinePacker, FillsGaps)
+{
+   SkylinePacker packer(64, 64);
+
+   int32_t x, y;
+   ASSERT_TRUE(packer.Insert(32, 48, x, y));
+   ASSERT_TRUE(packer.Insert(32, 16, x, y));
+
+   //The lowest position is on the right next to the tall rectangle
+   ASSERT_TRUE(packer.Insert(32, 16, x, y));
+   EXPECT_EQ(x, 32);
+   EXPECT_EQ(y, 16);
+}
+
+TEST(Atlas, PackedRegionsAreSeparated)
+{
+   std::mt19937 random(3);
+
+   std::vector<std::pair<int32_t, int32_t>> sizes;
+   for (size_t i = 0; i < 100; ++i)
+      sizes.push_back({ static_cast<int32_t>(8 + random() % 120), static_cast<int32_t>(8 + random() % 120) });
+
+   AtlasLayout layout;
+   ASSERT_TRUE(PackAtlas(sizes, 4096, 8, layout));
+
+   ASSERT_EQ(layout.Regions.size(), sizes.size());
+
+   for (size_t i = 0; i < sizes.size(); ++i)
+   {
+      const AtlasRegion& region = layout.Regions[i];
+
+      EXPECT_EQ(region.Width, sizes[i].first);
+      EXPECT_EQ(region.Height, sizes[i].second);
+
+      //Aligned to the gutter, so the mip texels don't cross the images
+      EXPECT_EQ(region.X % layout.Gutter, 0);
+      EXPECT_EQ(region.Y % layout.Gutter, 0);
+
+      EXPECT_GE(region.X - layout.Gutter, 0);
+      EXPECT_GE(region.Y - layout.Gutter, 0);
+      EXPECT_LE(region.X + region.Width + layout.Gutter, layout.Width);
+      EXPECT_LE(region.Y + region.Height + layout.Gutter, layout.Height);
+
+      for (size_t j = 0; j < i; ++j)
+         EXPECT_FALSE(Overlaps(region, layout.Regions[j], layout.Gutter)) << i << " " << j;
+   }
+
+   EXPECT_FALSE(PackAtlas(sizes, 256, 8, layout));
+   EXPECT_FALSE(PackAtlas(sizes, 4096, 6, layout));
+}
+
+TEST(Atlas, MipsDontBleed)
+{
+   //Solid images of the different colors must stay solid on every level of the atlas chain
+   const std::vector<std::pair<int32_t, int32_t>> sizes = { { 37, 20 }, { 16, 16 }, { 50, 9 }, { 24, 40 } };
+   const uint8_t colors[4][3] = { { 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 255, 255, 255 } };
+
+   AtlasLayout layout;
+   ASSERT_TRUE(PackAtlas(sizes, 1024, 8, layout));
+
+   std::vector<std::vector<uint8_t>> images(sizes.size());
+   std::vector<const uint8_t*> pixels;
+   std::vector<int32_t> channels;
+
+   for (size_t i = 0; i < sizes.size(); ++i)
+   {
+      for (int32_t t = 0; t < sizes[i].first * sizes[i].second; ++t)
+         images[i].insert(images[i].end(), colors[i], colors[i] + 3);
+
+      pixels.push_back(images[i].data());
+      channels.push_back(3);
+   }
+
+   assets::PixelBuffer atlas;
+   std::vector<assets::MipLevel> mips;
+
+   ASSERT_TRUE(ComposeAtlas(layout, pixels, channels, 4, MipFilter::Linear, atlas, mips));
+   ASSERT_EQ(mips.size(), 4);
+
+   for (size_t level = 0; level < mips.size(); ++level)
+   {
+      const uint8_t* data = atlas.get() + mips[level].Offset;
+
+      for (size_t i = 0; i < sizes.size(); ++i)
+      {
+         const AtlasRegion& region = layout.Regions[i];
+
+         for (int32_t y = region.Y >> level; y < (region.Y + region.Height) >> level; ++y)
+         {
+            for (int32_t x = region.X >> level; x < (region.X + region.Width) >> level; ++x)
+            {
+               const uint8_t* texel = data + (static_cast<size_t>(y) * mips[level].Width + x) * 4;
+
+               ASSERT_EQ(memcmp(texel, colors[i], 3), 0) << "level " << level << " image " << i;
+               ASSERT_EQ(texel[3], 255);
+            }
+         }
+      }
+   }
+}
+
+TEST(Atlas, ExpandsGrayAlpha)
+{
+   //Gray with alpha, gray and RGB images in the single RGBA page
+   const std::vector<std::pair<int32_t, int32_t>> sizes = { { 4, 4 }, { 4, 4 }, { 4, 4 } };
+   const std::vector<uint8_t> texels[3] = { { 100, 30 }, { 200 }, { 10, 20, 30 } };
+   const uint8_t expected[3][4] = { { 100, 100, 100, 30 }, { 200, 200, 200, 255 }, { 10, 20, 30, 255 } };
+
+   AtlasLayout layout;
+   ASSERT_TRUE(PackAtlas(sizes, 64, 2, layout));
+
+   std::vector<std::vector<uint8_t>> images(sizes.size());
+   std::vector<const uint8_t*> pixels;
+   std::vector<int32_t> channels;
+
+   for (size_t i = 0; i < sizes.size(); ++i)
+   {
+      for (int32_t t = 0; t < sizes[i].first * sizes[i].second; ++t)
+         images[i].insert(images[i].end(), texels[i].begin(), texels[i].end());
+
+      pixels.push_back(images[i].data());
+      channels.push_back(static_cast<int32_t>(texels[i].size()));
+   }
+
+   assets::PixelBuffer atlas;
+   std::vector<assets::MipLevel> mips;
+
+   ASSERT_TRUE(ComposeAtlas(layout, pixels, channels, 4, MipFilter::Linear, atlas, mips));
+
+   for (size_t i = 0; i < sizes.size(); ++i)
+   {
+      const AtlasRegion& region = layout.Regions[i];
+
+      //Gutter repeats the edge, so it is checked too
+      for (int32_t y = region.Y - 2; y < region.Y + region.Height + 2; ++y)
+      {
+         for (int32_t x = region.X - 2; x < region.X + region.Width + 2; ++x)
+         {
+            const uint8_t* texel = atlas.get() + (static_cast<size_t>(y) * mips[0].Width + x) * 4;
+            ASSERT_EQ(memcmp(texel, expected[i], 4), 0) << "image " << i;
+         }
+      }
+   }
+}
+
+TEST(Atlas, RemapUV)
+{
+   AtlasLayout layout = { 256, 128, 8, { { 64, 32, 32, 16 } } };
+
+   float u = 0.0f, v = 1.0f;
+   RemapUV(layout, layout.Regions[0], u, v);
+
+   EXPECT_FLOAT_EQ(u, 64.0f / 256.0f);
+   EXPECT_FLOAT_EQ(v, 48.0f / 128.0f);
+}
+
+TEST(Atlas, BuildsPagesOfAtlasChain)
+{
+   assets::AssetManager manager;
+
+   auto mesh = new assets::TrigVertices();
+   mesh->Positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+   mesh->UVs = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f } };
+   mesh->Indices = { 0, 1, 2 };
+   mesh->IsValid = true;
+
+   auto image = new assets::PixelsData();
+   image->Width = 32;
+   image->Height = 32;
+   image->Channels = 4;
+   image->Pixels.reset(static_cast<uint8_t*>(assets::PixelPool::Allocate(32 * 32 * 4)));
+   image->Mips = { { 32, 32, 0, 32 * 32 * 4 } };
+   image->IsValid = true;
+
+   memset(image->Pixels.get(), 128, 32 * 32 * 4);
+
+   manager.Register("mesh.obj", *mesh);
+   manager.Register("image.png", *image);
+
+   ASSERT_TRUE(manager.BuildAtlas({ "atlas" }, { { "mesh.obj", { "image.png" } } }, 4096, 8));
+
+   auto page = manager.GetData<assets::PixelsData>("atlas");
+   ASSERT_TRUE(page);
+
+   //Chain stops at the level 3 of the 8 texels gutter, the texture storage is sized from the same count
+   EXPECT_EQ(page->FirstLevel, 0);
+   EXPECT_EQ(page->Mips.size(), 4u);
+   EXPECT_LT(page->Mips.size(), GetMipsCount(page->Width, page->Height));
+
+   EXPECT_EQ(mesh->UVs[1].x, (8.0f + 32.0f) / page->Width);
+}
@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "asset-manager/cook/block-compression.h"
+
+using namespace assets::cook;
+
+namespace
+{
+   constexpr int32_t ImageSize = 256;
+
+   struct Image
+   {
+      int32_t Width;
+      int32_t Height;
+      int32_t Channels;
+      std::vector<uint8_t> Pixels;
+   };
+
+   Image MakeImage(const int32_t width, const int32_t height, const int32_t channels)
+   {
+      return { width, height, channels, std::vector<uint8_t>(static_cast<size_t>(width) * height * channels) };
+   }
+
+   //Smooth gradients, the easiest case for every format
+   Image Gradient(const int32_t channels)
+   {
+      Image image = MakeImage(ImageSize, ImageSize, channels);
+
+      for (int32_t y = 0; y < ImageSize; ++y)
+      {
+         for (int32_t x = 0; x < ImageSize; ++x)
+         {
+            const uint8_t values[4] = { static_cast<uint8_t>(x), static_cast<uint8_t>(y),
+                                        static_cast<uint8_t>((x + y) / 2), static_cast<uint8_t>(255 - y) };
+
+            for (int32_t c = 0; c < channels; ++c)
+               image.Pixels[(y * ImageSize + x) * channels + c] = values[c];
+         }
+      }
+
+      return image;
+   }
+
+   //Cells of the unrelated colors with the borders inside of the blocks
+   Image Edges(const int32_t channels)
+   {
+      Image image = MakeImage(ImageSize, ImageSize, channels);
+      std::mt19937 random(7);
+
+      std::vector<uint8_t> cells(33 * 33 * 4);
+      for (auto& v : cells)
+         v = static_cast<uint8_t>(random());
+
+      for (int32_t y = 0; y < ImageSize; ++y)
+      {
+         for (int32_t x = 0; x < ImageSize; ++x)
+         {
+            const size_t cell = ((y + 3) / 8 * 33 + (x + 5) / 8) * 4;
+
+            for (int32_t c = 0; c < channels; ++c)
+               image.Pixels[(y * ImageSize + x) * channels + c] = cells[cell + c];
+         }
+      }
+
+      return image;
+   }
+
+   //The worst case, there is no correlation inside of the block at all
+   Image Noise(const int32_t channels)
+   {
+      Image image = MakeImage(ImageSize, ImageSize, channels);
+      std::mt19937 random(13);
+
+      for (auto& v : image.Pixels)
+         v = static_cast<uint8_t>(random());
+
+      return image;
+   }
+
+   //Only the channels stored by the format are compared
+   double Psnr(const Image& image, const BlockFormat format, const std::vector<uint8_t>& decoded)
+   {
+      const int32_t channels = format == BlockFormat::BC5 ? 2 : format == BlockFormat::BC1 ? std::min(image.Channels, 3) : image.Channels;
+
+      double error = 0.0;
+      for (size_t i = 0; i < static_cast<size_t>(image.Width) * image.Height; ++i)
+      {
+         for (int32_t c = 0; c < channels; ++c)
+         {
+            const double d = static_cast<double>(image.Pixels[i * image.Channels + c]) - decoded[i * 4 + c];
+            error += d * d;
+         }
+      }
+
+      const double mse = error / (static_cast<double>(image.Width) * image.Height * channels);
+
+      return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+   }
+
+   double Compress(const Image& image, const BlockFormat format, const CompressionQuality quality, double* mpixPerSecond = nullptr)
+   {
+      std::vector<uint8_t> blocks(GetLevelSize(format, image.Width, image.Height, image.Channels));
+      std::vector<uint8_t> decoded(static_cast<size_t>(image.Width) * image.Height * 4);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      EXPECT_TRUE(CompressImage(image.Pixels.data(), image.Width, image.Height, image.Channels, format, quality, blocks.data()));
+      auto end = std::chrono::high_resolution_clock::now();
+
+      if (mpixPerSecond)
+         *mpixPerSecond = image.Width * image.Height / std::chrono::duration<double, std::micro>(end - start).count();
+
+      EXPECT_TRUE(DecompressImage(blocks.data(), image.Width, image.Height, format, decoded.data()));
+
+      return Psnr(image, format, decoded);
+   }
+
+   const char* QualityName(const CompressionQuality quality)
+   {
+      return quality == CompressionQuality::Fast ? "fast" : quality == CompressionQuality::Normal ? "normal" : "high";
+   }
+
+   const char* FormatName(const BlockFormat format)
+   {
+      switch (format)
+      {
+      case BlockFormat::BC1: return "BC1";
+      case BlockFormat::BC3: return "BC3";
+      case BlockFormat::BC5: return "BC5";
+      default: return "BC7";
+      }
+   }
+}
+
+TEST(BlockCompression, SolidBlocks)
+{
+   uint8_t rgba[64];
+   uint8_t block[16];
+   uint8_t decoded[64];
+
+   //Exactly representable in the 565
+   for (size_t i = 0; i < 16; ++i)
+   {
+      rgba[i * 4 + 0] = 255;
+      rgba[i * 4 + 1] = 130;
+      rgba[i * 4 + 2] = 0;
+      rgba[i * 4 + 3] = 77;
+   }
+
+   EncodeBC1(rgba, CompressionQuality::High, block);
+   DecodeBC1(block, decoded);
+   EXPECT_EQ(memcmp(decoded, rgba, 3), 0);
+
+   EncodeBC3(rgba, CompressionQuality::High, block);
+   DecodeBC3(block, decoded);
+   EXPECT_EQ(memcmp(decoded, rgba, 4), 0);
+
+   EncodeBC5(rgba, CompressionQuality::High, block);
+   DecodeBC5(block, decoded);
+   EXPECT_EQ(memcmp(decoded, rgba, 2), 0);
+
+   //Mode 6 endpoints have 8 bits with the P bit, so the solid colors are within 1 step
+   EncodeBC7(rgba, CompressionQuality::High, block);
+   ASSERT_TRUE(DecodeBC7(block, decoded));
+
+   for (size_t i = 0; i < 64; ++i)
+      EXPECT_LE(abs(decoded[i] - rgba[i]), 1);
+}
+
+TEST(BlockCompression, PartialBlocks)
+{
+   const Image gradient = Gradient(4);
+
+   Image image = MakeImage(13, 7, 4);
+   for (int32_t y = 0; y < image.Height; ++y)
+      memcpy(image.Pixels.data() + y * image.Width * 4, gradient.Pixels.data() + y * ImageSize * 4, image.Width * 4);
+
+   EXPECT_EQ(GetLevelSize(BlockFormat::BC1, 13, 7, 4), 4 * 2 * 8);
+   EXPECT_EQ(GetLevelSize(BlockFormat::BC7, 13, 7, 4), 4 * 2 * 16);
+
+   EXPECT_GT(Compress(image, BlockFormat::BC3, CompressionQuality::Normal), 40.0);
+   EXPECT_GT(Compress(image, BlockFormat::BC7, CompressionQuality::Normal), 40.0);
+}
+
+TEST(BlockCompression, FormatSelection)
+{
+   EXPECT_EQ(SelectBlockFormat(MipFilter::Normal, 3, CompressionQuality::High), BlockFormat::BC5);
+   EXPECT_EQ(SelectBlockFormat(MipFilter::Srgb, 3, CompressionQuality::Normal), BlockFormat::BC1);
+   EXPECT_EQ(SelectBlockFormat(MipFilter::Srgb, 4, CompressionQuality::Normal), BlockFormat::BC3);
+   EXPECT_EQ(SelectBlockFormat(MipFilter::Srgb, 4, CompressionQuality::High), BlockFormat::BC7);
+}
+
+//Quality gates of every format and tier on the synthetic images, the throughput is only printed
+TEST(BlockCompression, QualityAndThroughput)
+{
+   struct Case
+   {
+      const char* Name;
+      Image Source;
+      double MinPsnr[4]; //BC1, BC3, BC5, BC7 with the normal quality
+   };
+
+   const Case cases[] =
+   {
+      { "gradient", Gradient(4), { 40.0, 40.0, 60.0, 46.0 } },
+      { "edges",    Edges(4),    { 22.0, 23.0, 36.0, 22.0 } },
+      { "noise",    Noise(4),    { 11.0, 12.0, 26.0, 11.0 } }
+   };
+
+   const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 };
+   const CompressionQuality qualities[] = { CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High };
+
+   for (auto& c : cases)
+   {
+      printf("%s %dx%d:\n", c.Name, c.Source.Width, c.Source.Height);
+
+      for (size_t f = 0; f < 4; ++f)
+      {
+         double psnr[3];
+
+         for (size_t q = 0; q < 3; ++q)
+         {
+            double speed = 0.0;
+            psnr[q] = Compress(c.Source, formats[f], qualities[q], &speed);
+
+            printf("   %s %-6s %6.2f dB %8.2f MPix/s\n", FormatName(formats[f]), QualityName(qualities[q]), psnr[q], speed);
+         }
+
+         EXPECT_GT(psnr[1], c.MinPsnr[f]) << c.Name << " " << FormatName(formats[f]);
+         EXPECT_GE(psnr[2], psnr[0] - 0.1) << c.Name << " " << FormatName(formats[f]);
+      }
+   }
+}
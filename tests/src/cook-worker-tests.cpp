@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+#include "asset-manager/cook/cook-worker.h"
+#include "jobs/job-system.h"
+
+using namespace assets::cook;
+
+namespace
+{
+   constexpr size_t TestSharedSize = 4096;
+
+   std::vector<uint8_t> MakeResult(const std::string& path, const size_t size)
+   {
+      std::vector<uint8_t> result(size);
+      for (size_t i = 0; i < size; ++i)
+         result[i] = static_cast<uint8_t>(path[i % path.size()] + i);
+
+      return result;
+   }
+
+   //Path picks what the worker does, the result of the "big" one doesn't fit into the initial shared memory
+   bool CookTestJob(const CookJob& job, std::vector<uint8_t>& result, std::string& error)
+   {
+      if (job.Path == "crash")
+         abort();
+
+      if (job.Path == "fail")
+      {
+         error = "Test failure";
+         return false;
+      }
+
+      result = MakeResult(job.Path, job.Path == "big" ? TestSharedSize * 3 : 100);
+      return true;
+   }
+
+   struct TestResult
+   {
+      CookResult Result;
+      std::atomic<bool> IsDone = false;
+   };
+}
+
+//Run by the tests executable that is started with the --cook-worker
+int RunTestCookWorker()
+{
+   return RunCookWorker(CookTestJob);
+}
+
+TEST(CookWorker, CooksAndSurvivesCrash)
+{
+   CookWorkerParams params;
+   params.Command = ::testing::internal::GetArgvs()[0] + " --cook-worker";
+   params.WorkersCount = 2;
+   params.SharedSize = TestSharedSize;
+   params.MaxAttempts = 2;
+
+   CookWorkerPool pool(params);
+   ASSERT_EQ(pool.GetWorkersCount(), 2);
+
+   const std::vector<std::string> paths = { "small", "crash", "big", "fail", "after-crash" };
+   std::vector<TestResult> results(paths.size());
+
+   for (size_t i = 0; i < paths.size(); ++i)
+   {
+      pool.Submit({ CookJobType::Mesh, paths[i] }, [](CookResult& result, uintptr_t args)
+         {
+            TestResult* test = reinterpret_cast<TestResult*>(args);
+            test->Result = std::move(result);
+            test->IsDone = true;
+         }, reinterpret_cast<uintptr_t>(&results[i]));
+   }
+
+   //Callbacks are executed by the JobSystem, so they are run here
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+   auto isDone = [&results]()
+   {
+      for (auto& result : results)
+         if (!result.IsDone)
+            return false;
+
+      return true;
+   };
+
+   while (!isDone() && std::chrono::steady_clock::now() < deadline)
+   {
+      if (!core::JobSystem::RunNext())
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+
+   ASSERT_TRUE(isDone());
+
+   EXPECT_TRUE(results[0].Result.IsSucceeded);
+   EXPECT_EQ(results[0].Result.Data, MakeResult("small", 100));
+
+   EXPECT_FALSE(results[1].Result.IsSucceeded);
+   EXPECT_EQ(results[1].Result.Path, "crash");
+
+   EXPECT_TRUE(results[2].Result.IsSucceeded);
+   EXPECT_EQ(results[2].Result.Data, MakeResult("big", TestSharedSize * 3));
+
+   EXPECT_FALSE(results[3].Result.IsSucceeded);
+   EXPECT_EQ(results[3].Result.Error, "Test failure");
+
+   EXPECT_TRUE(results[4].Result.IsSucceeded);
+
+   const CookWorkerStats stats = pool.GetStats();
+   EXPECT_EQ(stats.Done, 3);
+   EXPECT_EQ(stats.Failed, 2);
+   EXPECT_EQ(stats.Crashes, 2);
+   EXPECT_EQ(stats.Restarts, 2);
+}
@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "asset-manager/cook/derived-cache.h"
+
+using namespace assets::cook;
+
+namespace
+{
+   DerivedKey MakeKey(const std::string& source, const uint32_t version)
+   {
+      DerivedKeyBuilder builder;
+      builder.Add(version);
+      builder.Add(source.data(), source.size());
+
+      return builder.Finish();
+   }
+
+   std::vector<uint8_t> MakePayload(const size_t size, const uint8_t seed)
+   {
+      std::vector<uint8_t> payload(size);
+      for (size_t i = 0; i < size; ++i)
+         payload[i] = static_cast<uint8_t>(i * 7 + seed);
+
+      return payload;
+   }
+}
+
+TEST(DerivedCache, KeyDependsOnInputOnly)
+{
+   const std::string source = "source bytes of the asset that don't fit into the single word";
+
+   //Parts of any size give the same key
+   DerivedKeyBuilder split;
+   split.Add(1u);
+   split.Add(source.data(), 3);
+   split.Add(source.data() + 3, 9);
+   split.Add(source.data() + 12, source.size() - 12);
+
+   EXPECT_EQ(split.Finish(), MakeKey(source, 1));
+
+   EXPECT_NE(MakeKey(source, 1), MakeKey(source, 2));
+   EXPECT_NE(MakeKey(source, 1), MakeKey(source + std::string(1, '\0'), 1));
+   EXPECT_NE(MakeKey("a", 1), MakeKey("b", 1));
+
+   EXPECT_EQ(MakeKey(source, 1).ToString().size(), 32);
+}
+
+TEST(DerivedCache, StoresAndPrunesEntries)
+{
+   const std::string directory = "derived-cache-test";
+   std::filesystem::remove_all(directory);
+
+   const DerivedKey first = MakeKey("first", 1);
+   const DerivedKey second = MakeKey("second", 1);
+   const DerivedKey third = MakeKey("third", 1);
+
+   const std::vector<uint8_t> payload = MakePayload(1000, 1);
+
+   {
+      DerivedCache cache;
+      ASSERT_TRUE(cache.Open(directory, 2500));
+
+      std::vector<uint8_t> read;
+      EXPECT_FALSE(cache.Get(first, read));
+
+      EXPECT_TRUE(cache.Put(first, payload.data(), payload.size()));
+      EXPECT_TRUE(cache.Put(second, payload.data(), payload.size()));
+
+      ASSERT_TRUE(cache.Get(first, read));
+      EXPECT_EQ(read, payload);
+
+      const DerivedCacheStats stats = cache.GetStats();
+      EXPECT_EQ(stats.Hits, 1);
+      EXPECT_EQ(stats.Misses, 1);
+      EXPECT_EQ(stats.Writes, 2);
+      EXPECT_EQ(stats.EntriesCount, 2);
+   }
+
+   //Index is rebuilt from the files, the third entry goes over the limit and the least recently used one is pruned
+   {
+      DerivedCache cache;
+      ASSERT_TRUE(cache.Open(directory, 2500));
+      EXPECT_EQ(cache.GetStats().EntriesCount, 2);
+
+      std::vector<uint8_t> read;
+      ASSERT_TRUE(cache.Get(second, read));
+
+      EXPECT_TRUE(cache.Put(third, payload.data(), payload.size()));
+
+      const DerivedCacheStats stats = cache.GetStats();
+      EXPECT_GE(stats.Evictions, 1);
+      EXPECT_LE(stats.TotalSize, 2500);
+
+      EXPECT_FALSE(cache.Get(first, read));
+      EXPECT_TRUE(cache.Get(third, read));
+   }
+
+   std::filesystem::remove_all(directory);
+}
+
+TEST(DerivedCache, DropsDamagedEntry)
+{
+   const std::string directory = "derived-cache-damaged-test";
+   std::filesystem::remove_all(directory);
+
+   const DerivedKey key = MakeKey("damaged", 1);
+   const std::vector<uint8_t> payload = MakePayload(100, 2);
+
+   DerivedCache cache;
+   ASSERT_TRUE(cache.Open(directory, 1024 * 1024));
+   ASSERT_TRUE(cache.Put(key, payload.data(), payload.size()));
+
+   const std::string name = key.ToString();
+   const std::filesystem::path path = std::filesystem::path(directory) / name.substr(0, 2) / (name + ".ddc");
+
+   //Flips the last payload byte
+   FILE* file = fopen(path.string().c_str(), "r+b");
+   ASSERT_NE(file, nullptr);
+
+   fseek(file, -1, SEEK_END);
+   fputc(payload.back() ^ 0xFF, file);
+   fclose(file);
+
+   std::vector<uint8_t> read;
+   EXPECT_FALSE(cache.Get(key, read));
+   EXPECT_FALSE(std::filesystem::exists(path));
+
+   const DerivedCacheStats stats = cache.GetStats();
+   EXPECT_EQ(stats.Corrupted, 1);
+   EXPECT_EQ(stats.EntriesCount, 0);
+
+   std::filesystem::remove_all(directory);
+}
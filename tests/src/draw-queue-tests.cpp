@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "graphics/draw-queue.h"
+
+using namespace graphics;
+
+namespace
+{
+   //Mesh with the vertices on the heap and a single LOD, like the cooked one
+   Mesh MeshWithLod()
+   {
+      Mesh mesh;
+      mesh.Vertices.Positions.assign(300, mm::vec3(1.0f));
+      mesh.Vertices.Indices.assign(300, 0);
+
+      auto lod = std::make_shared<assets::TrigVertices>();
+      lod->Positions.assign(30, mm::vec3(2.0f));
+      lod->Indices.assign(30, 0);
+
+      mesh.Vertices.Lods.push_back(lod);
+
+      return mesh;
+   }
+}
+
+TEST(DrawQueue, ReusesCapacityAcrossFrames)
+{
+   static_assert(std::is_trivially_copyable_v<DrawItem>, "Draw item is the POD record");
+
+   DrawQueue queue;
+   queue.Reserve(InitialDrawItems);
+
+   constexpr size_t DrawsCount = InitialDrawItems + 100;
+
+   const DrawItem* firstData = nullptr;
+   size_t firstCapacity = 0;
+
+   for (size_t frame = 0; frame < 3; ++frame)
+   {
+      for (size_t i = 0; i < DrawsCount; ++i)
+      {
+         RenderKey key;
+         key.KeyId = i;
+
+         queue.Push(key, 0, 0, queue.PushTransform(mm::mat4()), 0, 0);
+      }
+
+      ASSERT_EQ(queue.GetItems().size(), DrawsCount);
+
+      //First frame grows the queue above the initial capacity, the next ones reuse it
+      if (frame == 0)
+      {
+         firstData = queue.GetItems().data();
+         firstCapacity = queue.GetCapacity();
+      }
+      else
+      {
+         EXPECT_EQ(queue.GetItems().data(), firstData);
+         EXPECT_EQ(queue.GetCapacity(), firstCapacity);
+      }
+
+      queue.Clear();
+      EXPECT_TRUE(queue.GetItems().empty());
+   }
+}
+
+TEST(DrawQueue, ItemsReferenceRegisteredMesh)
+{
+   const Mesh mesh = MeshWithLod();
+
+   DrawQueue queue;
+
+   RenderKey key;
+   key.KeyId = 0;
+
+   const uint32_t transform = queue.PushTransform(mm::translate(mm::mat4(), mm::vec3(1.0f, 2.0f, 3.0f)));
+
+   //LOD past the levels of the mesh falls back to the mesh itself
+   queue.Push(key, 7, 3, transform, 0, mesh.Vertices.Lods.size());
+   queue.Push(key, 7, 3, transform, 1, mesh.Vertices.Lods.size());
+   queue.Push(key, 7, 3, transform, 5, mesh.Vertices.Lods.size());
+
+   const std::vector<DrawItem>& items = queue.GetItems();
+   ASSERT_EQ(items.size(), 3);
+
+   for (auto& item : items)
+   {
+      EXPECT_EQ(item.Mesh, 7);
+      EXPECT_EQ(item.Material, 3);
+      EXPECT_EQ(item.Transform, transform);
+   }
+
+   EXPECT_EQ(items[0].Lod, 0);
+   EXPECT_EQ(items[1].Lod, 1);
+   EXPECT_EQ(items[2].Lod, 0);
+
+   //Levels are the vertices of the mesh, not their copies
+   EXPECT_EQ(&GetDrawLevel(mesh, items[0]), &mesh.Vertices);
+   EXPECT_EQ(&GetDrawLevel(mesh, items[1]), mesh.Vertices.Lods[0].get());
+   EXPECT_EQ(GetDrawLevel(mesh, items[1]).Positions.data(), mesh.Vertices.Lods[0]->Positions.data());
+   EXPECT_EQ(&GetDrawLevel(mesh, items[2]), &mesh.Vertices);
+
+   //Shared LOD isn't owned by the queue
+   EXPECT_EQ(mesh.Vertices.Lods[0].use_count(), 1);
+}
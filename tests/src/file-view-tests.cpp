@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "utils/file-view.h"
+
+using namespace utils;
+
+namespace
+{
+   void WriteFile(const char* path, const std::string& text)
+   {
+      FILE* file = fopen(path, "wb");
+      ASSERT_NE(file, nullptr);
+
+      fwrite(text.data(), 1, text.size(), file);
+      fclose(file);
+   }
+}
+
+TEST(FileView, MapsFileContents)
+{
+   const char* path = "file-view-test.txt";
+   WriteFile(path, "line 1\nline 2\n");
+
+   {
+      FileView view(path, FileAccess::Sequential);
+      ASSERT_TRUE(view.IsOpen());
+      EXPECT_TRUE(view.GetError().empty());
+      EXPECT_EQ(view.GetText(), "line 1\nline 2\n");
+
+      //Hints don't change the contents, the range past the end is ignored
+      view.Advise(FileAccess::Random, 7, 100);
+      view.Advise(FileAccess::Sequential, 1000, 1);
+
+      //Moved view keeps the mapping
+      FileView moved(std::move(view));
+      EXPECT_FALSE(view.IsOpen());
+      EXPECT_EQ(moved.GetText().substr(7), "line 2\n");
+   }
+
+   remove(path);
+}
+
+TEST(FileView, TellsEmptyFileFromFailure)
+{
+   const char* path = "file-view-empty.txt";
+   WriteFile(path, "");
+
+   FileView empty;
+   EXPECT_TRUE(empty.Open(path));
+   EXPECT_EQ(empty.GetSize(), 0);
+   EXPECT_TRUE(empty.GetText().empty());
+
+   empty.Close();
+   remove(path);
+
+   FileView missing;
+   EXPECT_FALSE(missing.Open("file-view-missing.txt"));
+   EXPECT_FALSE(missing.IsOpen());
+   EXPECT_FALSE(missing.GetError().empty());
+
+   //Failed open of the open view closes the old file
+   FileView reopened(path);
+   EXPECT_FALSE(reopened.IsOpen());
+}
@@ -0,0 +1,209 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/flat-hash-map.h"
+
+TEST(FlatHashMap, InsertFindErase)
+{
+   utils::FlatHashMap<uint64_t, int> map;
+
+   for (int i = 0; i < 1000; ++i)
+      map[static_cast<uint64_t>(i) * 7919] = i;
+
+   EXPECT_EQ(map.size(), 1000);
+
+   for (int i = 0; i < 1000; ++i)
+   {
+      auto it = map.find(static_cast<uint64_t>(i) * 7919);
+      ASSERT_NE(it, map.end());
+      EXPECT_EQ(it->second, i);
+   }
+
+   EXPECT_EQ(map.find(1), map.end());
+
+   for (int i = 0; i < 1000; i += 2)
+      EXPECT_EQ(map.erase(static_cast<uint64_t>(i) * 7919), 1);
+
+   EXPECT_EQ(map.erase(0), 0);
+   EXPECT_EQ(map.size(), 500);
+
+   for (int i = 0; i < 1000; ++i)
+      EXPECT_EQ(map.contains(static_cast<uint64_t>(i) * 7919), i % 2 == 1);
+
+   size_t iterated = 0;
+   for (auto& e : map)
+   {
+      EXPECT_EQ(e.first, static_cast<uint64_t>(e.second) * 7919);
+      ++iterated;
+   }
+
+   EXPECT_EQ(iterated, map.size());
+}
+
+TEST(FlatHashMap, HeterogeneousLookup)
+{
+   utils::FlatHashMap<std::string, int> map = { { "Forward", 1 }, { "Right", 2 } };
+
+   const std::string_view key = "Forward";
+   EXPECT_EQ(map.find(key)->second, 1);
+   EXPECT_EQ(map.find("Right")->second, 2);
+   EXPECT_FALSE(map.contains(std::string_view("Up")));
+
+   map[std::string_view("Up")] = 3;
+   EXPECT_EQ(map.at("Up"), 3);
+}
+
+TEST(FlatHashMap, ReserveDoesNotRehash)
+{
+   utils::FlatHashMap<uint32_t, uint32_t> map;
+   map.reserve(1000);
+
+   const size_t capacity = map.capacity();
+   for (uint32_t i = 0; i < 1000; ++i)
+      map[i] = i;
+
+   EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST(FlatHashMap, AtTerminatesOnMissingKey)
+{
+   utils::FlatHashMap<uint32_t, uint32_t> map;
+
+   EXPECT_DEATH(map.at(1), "");
+
+   map[1] = 2;
+   EXPECT_EQ(map.at(1), 2);
+   EXPECT_DEATH(map.at(3), "");
+}
+
+TEST(FlatHashMap, CollidingHashes)
+{
+   struct BadHash
+   {
+      size_t operator()(const int) const { return 42; }
+   };
+
+   utils::FlatHashMap<int, int, BadHash> map;
+   for (int i = 0; i < 300; ++i)
+      map[i] = -i;
+
+   for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(map.at(i), -i);
+
+   for (int i = 0; i < 300; i += 3)
+      map.erase(i);
+
+   for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(map.contains(i), i % 3 != 0);
+}
+
+
+//Microbenchmarks against the std::unordered_map on the key distributions used by the engine
+namespace
+{
+   template<typename F>
+   double MeasureNs(const size_t iterations, F func)
+   {
+      auto start = std::chrono::high_resolution_clock::now();
+      func();
+      auto end = std::chrono::high_resolution_clock::now();
+
+      return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+   }
+
+   template<typename Map, typename Keys, typename LookupKeys>
+   void BenchmarkMap(const char* name, const Keys& keys, const LookupKeys& lookups, const size_t rounds)
+   {
+      Map map;
+      map.reserve(keys.size());
+
+      const double insertNs = MeasureNs(keys.size(), [&]()
+         {
+            for (size_t i = 0; i < keys.size(); ++i)
+               map[keys[i]] = i;
+         });
+
+      size_t sum = 0;
+      const double findNs = MeasureNs(lookups.size() * rounds, [&]()
+         {
+            for (size_t r = 0; r < rounds; ++r)
+            {
+               for (auto& k : lookups)
+               {
+                  auto it = map.find(k);
+                  if (it != map.end())
+                     sum += it->second;
+               }
+            }
+         });
+
+      EXPECT_GT(sum, 0);
+
+      printf("   %-40s insert %7.2f ns, find %7.2f ns\n", name, insertNs, findNs);
+   }
+
+   std::vector<uint64_t> AssetHashes(const size_t count)
+   {
+      std::vector<uint64_t> res;
+      for (size_t i = 0; i < count; ++i)
+         res.push_back(utils::HashFnv1a("res/meshes/mesh_" + std::to_string(i) + ".obj"));
+
+      return res;
+   }
+
+   std::vector<std::string> ActionNames(const size_t count)
+   {
+      std::vector<std::string> res;
+      for (size_t i = 0; i < count; ++i)
+         res.push_back("Action" + std::to_string(i));
+
+      return res;
+   }
+}
+
+TEST(FlatHashMapBenchmark, AssetHashes)
+{
+   for (size_t count : { 64, 4096, 262144 })
+   {
+      auto keys = AssetHashes(count);
+
+      std::vector<uint64_t> lookups = keys;
+      std::shuffle(lookups.begin(), lookups.end(), std::mt19937(1));
+
+      const size_t rounds = 1000000 / count + 1;
+
+      printf("%zu asset hashes:\n", count);
+      BenchmarkMap<std::unordered_map<uint64_t, size_t>>("std::unordered_map", keys, lookups, rounds);
+      BenchmarkMap<utils::FlatHashMap<uint64_t, size_t>>("utils::FlatHashMap", keys, lookups, rounds);
+   }
+}
+
+TEST(FlatHashMapBenchmark, ActionNames)
+{
+   auto keys = ActionNames(32);
+
+   std::vector<std::string_view> lookups(keys.begin(), keys.end());
+   std::shuffle(lookups.begin(), lookups.end(), std::mt19937(1));
+
+   printf("32 action names, lookup by the string_view:\n");
+   BenchmarkMap<std::unordered_map<std::string_view, size_t>>("std::unordered_map<std::string_view>", keys, lookups, 10000);
+   BenchmarkMap<utils::FlatHashMap<std::string, size_t>>("utils::FlatHashMap<std::string>", keys, lookups, 10000);
+}
+
+TEST(FlatHashMapBenchmark, SmallEnum)
+{
+   enum class Face : uint8_t { A, B, C, D, E, F };
+
+   std::vector<Face> keys = { Face::A, Face::B, Face::C, Face::D, Face::E, Face::F };
+
+   printf("6 enum keys:\n");
+   BenchmarkMap<std::unordered_map<Face, size_t>>("std::unordered_map", keys, keys, 100000);
+   BenchmarkMap<utils::FlatHashMap<Face, size_t>>("utils::FlatHashMap", keys, keys, 100000);
+}
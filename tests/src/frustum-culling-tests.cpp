@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "graphics/culling.h"
+
+#include "test-fixtures.h"
+
+using namespace graphics;
+using namespace fixtures;
+
+namespace
+{
+   //Spheres around the camera, a part of them is in front of it
+   SphereBounds RandomSpheres(const size_t count)
+   {
+      std::mt19937 random(11);
+      std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+      std::uniform_real_distribution<float> radius(0.0f, 10.0f);
+
+      SphereBounds bounds;
+
+      for (size_t i = 0; i < count; ++i)
+         bounds.Push(mm::vec3(position(random), position(random), position(random)), radius(random));
+
+      return bounds;
+   }
+
+   //Objects per microsecond of the best of the runs
+   template<typename Func>
+   double MeasureSpeed(const size_t count, Func func)
+   {
+      double best = 0.0;
+
+      for (size_t run = 0; run < 20; ++run)
+      {
+         auto start = std::chrono::high_resolution_clock::now();
+         func();
+         auto end = std::chrono::high_resolution_clock::now();
+
+         const double speed = count / std::chrono::duration<double, std::micro>(end - start).count();
+         best = speed > best ? speed : best;
+      }
+
+      return best;
+   }
+}
+
+TEST(FrustumCulling, MeshBounds)
+{
+   const mm::vec3 positions[] = { { -1.0f, 0.0f, 0.0f }, { 3.0f, 2.0f, 0.0f }, { 1.0f, 1.0f, 4.0f } };
+
+   const assets::cook::MeshBounds bounds = assets::cook::ComputeMeshBounds(positions, 3);
+
+   EXPECT_FLOAT_EQ(bounds.Min.x, -1.0f);
+   EXPECT_FLOAT_EQ(bounds.Max.z, 4.0f);
+   EXPECT_FLOAT_EQ(bounds.Center.x, 1.0f);
+   EXPECT_FLOAT_EQ(bounds.Center.y, 1.0f);
+   EXPECT_FLOAT_EQ(bounds.Center.z, 2.0f);
+
+   for (auto& position : positions)
+      EXPECT_LE(mm::length(position - bounds.Center), bounds.Radius + 0.0001f);
+
+   EXPECT_EQ(assets::cook::ComputeMeshBounds(positions, 0).Radius, 0.0f);
+}
+
+TEST(FrustumCulling, DepthPlanesOfCamera)
+{
+   const Frustum frustum = ExtractFrustum(ViewCamera(mm::vec3(0.0f, 0.0f, 10.0f)));
+
+   EXPECT_TRUE(IsSphereVisible(frustum, mm::vec3(0.0f, 0.0f, 20.0f), 1.0f));
+
+   //Behind the camera, beyond the far plane and touching it
+   EXPECT_FALSE(IsSphereVisible(frustum, mm::vec3(0.0f, 0.0f, 5.0f), 1.0f));
+   EXPECT_FALSE(IsSphereVisible(frustum, mm::vec3(0.0f, 0.0f, 10.0f + PerspectiveFar + 2.0f), 1.0f));
+   EXPECT_TRUE(IsSphereVisible(frustum, mm::vec3(0.0f, 0.0f, 10.0f + PerspectiveFar + 0.5f), 1.0f));
+
+   //Outside of the side planes of the 90 degrees field of view
+   EXPECT_FALSE(IsSphereVisible(frustum, mm::vec3(30.0f, 0.0f, 20.0f), 1.0f));
+   EXPECT_FALSE(IsSphereVisible(frustum, mm::vec3(0.0f, -30.0f, 20.0f), 1.0f));
+}
+
+TEST(FrustumCulling, SimdMatchesScalar)
+{
+   const Frustum frustum = ExtractFrustum(ViewCamera(mm::vec3(0.0f)));
+
+   //Counts that aren't multiple of 4 go through the scalar tail
+   for (size_t count : { 0, 1, 3, 4, 7, 1000, 1001 })
+   {
+      const SphereBounds bounds = RandomSpheres(count);
+
+      std::vector<uint32_t> visible(count);
+      std::vector<uint32_t> expected(count);
+
+      const size_t visibleCount = CullSpheres(frustum, bounds, visible.data());
+      const size_t expectedCount = CullSpheresScalar(frustum, bounds, expected.data());
+
+      ASSERT_EQ(visibleCount, expectedCount);
+
+      for (size_t i = 0; i < visibleCount; ++i)
+         ASSERT_EQ(visible[i], expected[i]);
+
+      if (count >= 1000)
+      {
+         EXPECT_GT(visibleCount, 0);
+         EXPECT_LT(visibleCount, count);
+      }
+   }
+}
+
+TEST(FrustumCulling, Speed)
+{
+   constexpr size_t Count = 100'000;
+
+   const Frustum frustum = ExtractFrustum(ViewCamera(mm::vec3(0.0f)));
+   const SphereBounds bounds = RandomSpheres(Count);
+
+   std::vector<uint32_t> visible(Count);
+   size_t visibleCount = 0;
+
+   const double simdSpeed = MeasureSpeed(Count, [&]()
+      {
+         visibleCount = CullSpheres(frustum, bounds, visible.data());
+      });
+
+   const double scalarSpeed = MeasureSpeed(Count, [&]()
+      {
+         visibleCount = CullSpheresScalar(frustum, bounds, visible.data());
+      });
+
+   printf("%zu spheres, %zu visible: SSE %.1f objects/us, scalar %.1f objects/us\n", Count, visibleCount, simdSpeed, scalarSpeed);
+
+   EXPECT_GT(simdSpeed, 0.0);
+}
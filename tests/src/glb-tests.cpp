@@ -0,0 +1,207 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "asset-manager/gltf/glb.h"
+
+using namespace assets::gltf;
+
+namespace
+{
+   void AppendUint32(std::vector<uint8_t>& data, const uint32_t value)
+   {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+      data.insert(data.end(), bytes, bytes + sizeof(value));
+   }
+
+   template<typename T>
+   void AppendValues(std::vector<uint8_t>& data, const std::vector<T>& values)
+   {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+      data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+   }
+
+   //JSON is padded by the spaces and BIN by the zeros, as the spec wants it
+   std::vector<uint8_t> MakeGlb(std::string json, std::vector<uint8_t> bin)
+   {
+      json.resize((json.size() + 3) & ~size_t(3), ' ');
+      bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+      std::vector<uint8_t> data;
+      AppendUint32(data, 0x46546C67);
+      AppendUint32(data, 2);
+      AppendUint32(data, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+
+      AppendUint32(data, static_cast<uint32_t>(json.size()));
+      AppendUint32(data, 0x4E4F534A);
+      data.insert(data.end(), json.begin(), json.end());
+
+      AppendUint32(data, static_cast<uint32_t>(bin.size()));
+      AppendUint32(data, 0x004E4942);
+      data.insert(data.end(), bin.begin(), bin.end());
+
+      return data;
+   }
+
+   //Unit quad in the XY plane facing +Z
+   const std::vector<float> QuadPositions = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+   const std::vector<float> QuadUVs = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+   const std::vector<uint16_t> QuadIndices = { 0, 1, 2, 0, 2, 3 };
+
+   std::vector<uint8_t> QuadBin()
+   {
+      std::vector<uint8_t> bin;
+      AppendValues(bin, QuadPositions);
+      AppendValues(bin, QuadUVs);
+      AppendValues(bin, QuadIndices);
+
+      return bin;
+   }
+
+   const std::string QuadBuffers = R"(
+      "buffers": [ { "byteLength": 92 } ],
+      "bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 48 },
+                       { "buffer": 0, "byteOffset": 48, "byteLength": 32 },
+                       { "buffer": 0, "byteOffset": 80, "byteLength": 12 } ],
+      "accessors": [ { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3" },
+                     { "bufferView": 1, "componentType": 5126, "count": 4, "type": "VEC2" },
+                     { "bufferView": 2, "componentType": 5123, "count": 6, "type": "SCALAR" } ])";
+}
+
+TEST(Glb, ImportsNodeTransforms)
+{
+   //Parent moves the quad, the child mirrors it along X, the scene has only the parent as the root
+   const std::string json = R"({ "asset": { "version": "2.0" }, "scene": 0, "scenes": [ { "nodes": [ 0 ] } ],
+      "nodes": [ { "translation": [ 1, 2, 3 ], "children": [ 1 ] }, { "scale": [ -1, 1, 1 ], "mesh": 0 } ],
+      "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0, "TEXCOORD_0": 1 }, "indices": 2 },
+                                    { "attributes": { "POSITION": 0 }, "mode": 1 } ] } ],)" + QuadBuffers + "}";
+
+   const std::vector<uint8_t> glb = MakeGlb(json, QuadBin());
+
+   GlbMesh mesh;
+   ASSERT_TRUE(ImportGlb(glb.data(), glb.size(), mesh));
+
+   //Line primitive isn't imported
+   EXPECT_EQ(mesh.SkippedPrimitives, 1);
+
+   ASSERT_EQ(mesh.Positions.size(), 4);
+   EXPECT_EQ(mesh.Positions[2].x, 0.0f);
+   EXPECT_EQ(mesh.Positions[2].y, 3.0f);
+   EXPECT_EQ(mesh.Positions[2].z, 3.0f);
+
+   //UVs are flipped to the bottom left origin
+   EXPECT_EQ(mesh.UVs[0].y, 1.0f);
+   EXPECT_EQ(mesh.UVs[2].y, 0.0f);
+
+   //Mirror flips the winding, so the triangles are reversed and the computed normals still face +Z
+   EXPECT_EQ(mesh.Indices, (std::vector<uint32_t>{ 0, 2, 1, 0, 3, 2 }));
+
+   for (auto& normal : mesh.Normals)
+      EXPECT_FLOAT_EQ(normal.z, 1.0f);
+}
+
+TEST(Glb, ReadsAccessorsInPlace)
+{
+   const std::string json = R"({ "asset": { "version": "2.0" }, "nodes": [ { "mesh": 0 } ],
+      "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],)" + QuadBuffers + "}";
+
+   const std::vector<uint8_t> glb = MakeGlb(json, QuadBin());
+
+   GlbDocument document;
+   ASSERT_TRUE(document.Open(glb.data(), glb.size()));
+
+   //Float positions are the view of the file bytes
+   AccessorView positions;
+   ASSERT_TRUE(document.GetAccessor(0, positions));
+
+   Span<mm::vec3> span;
+   ASSERT_TRUE(GetSpan(positions, ComponentType::Float, 3, span));
+   EXPECT_GE(reinterpret_cast<const uint8_t*>(span.Data), glb.data());
+   EXPECT_EQ(memcmp(span.Data, QuadPositions.data(), QuadPositions.size() * sizeof(float)), 0);
+
+   //Short indices have the other layout, they are converted
+   AccessorView indices;
+   ASSERT_TRUE(document.GetAccessor(2, indices));
+
+   Span<uint32_t> indicesSpan;
+   EXPECT_FALSE(GetSpan(indices, ComponentType::Uint, 1, indicesSpan));
+
+   std::vector<uint32_t> converted(indices.Count);
+   ASSERT_TRUE(ReadIndices(indices, converted.data()));
+   EXPECT_EQ(converted, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+
+   //Scene without the scenes uses the root nodes, primitive without the indices is the triangle list
+   GlbMesh mesh;
+   ASSERT_TRUE(ImportGlb(glb.data(), glb.size(), mesh));
+   EXPECT_EQ(mesh.Indices, (std::vector<uint32_t>{ 0, 1, 2 }));
+}
+
+TEST(Glb, RejectsInvalidFiles)
+{
+   const std::string json = R"({ "asset": { "version": "2.0" }, "nodes": [ { "mesh": 0 } ],
+      "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],)" + QuadBuffers + "}";
+
+   std::vector<uint8_t> glb = MakeGlb(json, QuadBin());
+
+   GlbMesh mesh;
+
+   //Truncated BIN chunk
+   EXPECT_FALSE(ImportGlb(glb.data(), glb.size() - 4, mesh));
+
+   //Broken JSON
+   std::vector<uint8_t> broken = glb;
+   broken[20] = '[';
+   EXPECT_FALSE(ImportGlb(broken.data(), broken.size(), mesh));
+
+   //Accessor that reads past its buffer view
+   std::string outOfBounds = json;
+   outOfBounds.replace(outOfBounds.find("\"count\": 4"), 10, "\"count\": 5");
+
+   const std::vector<uint8_t> outOfBoundsGlb = MakeGlb(outOfBounds, QuadBin());
+   EXPECT_FALSE(ImportGlb(outOfBoundsGlb.data(), outOfBoundsGlb.size(), mesh));
+   EXPECT_EQ(mesh.SkippedPrimitives, 1);
+}
+
+TEST(Glb, RejectsHostileAccessors)
+{
+   const std::string json = R"({ "asset": { "version": "2.0" }, "nodes": [ { "mesh": 0 } ],
+      "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],)" + QuadBuffers + "}";
+
+   AccessorView view;
+
+   //Count whose size wraps around 2^64 with the stride of the view
+   std::string hugeCount = json;
+   hugeCount.replace(hugeCount.find("\"byteLength\": 48 }"), 18, "\"byteLength\": 48, \"byteStride\": 16 }");
+   hugeCount.replace(hugeCount.find("\"count\": 4"), 10, "\"count\": 4294967295");
+
+   const std::vector<uint8_t> hugeCountGlb = MakeGlb(hugeCount, QuadBin());
+
+   GlbDocument hugeCountDocument;
+   ASSERT_TRUE(hugeCountDocument.Open(hugeCountGlb.data(), hugeCountGlb.size()));
+   EXPECT_FALSE(hugeCountDocument.GetAccessor(0, view));
+
+   //Stride above the spec limit
+   std::string wideStride = json;
+   wideStride.replace(wideStride.find("\"byteLength\": 48 }"), 18, "\"byteLength\": 48, \"byteStride\": 256 }");
+   wideStride.replace(wideStride.find("\"count\": 4"), 10, "\"count\": 1");
+
+   const std::vector<uint8_t> wideStrideGlb = MakeGlb(wideStride, QuadBin());
+
+   GlbDocument wideStrideDocument;
+   ASSERT_TRUE(wideStrideDocument.Open(wideStrideGlb.data(), wideStrideGlb.size()));
+   EXPECT_FALSE(wideStrideDocument.GetAccessor(0, view));
+
+   //Last element doesn't need the whole stride
+   std::string tightView = json;
+   tightView.replace(tightView.find("\"byteLength\": 48 }"), 18, "\"byteLength\": 48, \"byteStride\": 16 }");
+   tightView.replace(tightView.find("\"count\": 4"), 10, "\"count\": 3");
+
+   const std::vector<uint8_t> tightViewGlb = MakeGlb(tightView, QuadBin());
+
+   GlbDocument tightViewDocument;
+   ASSERT_TRUE(tightViewDocument.Open(tightViewGlb.data(), tightViewGlb.size()));
+   EXPECT_TRUE(tightViewDocument.GetAccessor(0, view));
+   EXPECT_EQ(view.Count, 3);
+}
@@ -0,0 +1,195 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <cstring>
+
+#include "graphics/memory/gpu-buffer-heap.h"
+
+using namespace graphics;
+
+namespace
+{
+   //Keeps the bytes on the CPU, so the copies of the defragmentation can be checked
+   class MockShaderBuffer : public ShaderBuffer
+   {
+   public:
+      std::vector<uint8_t> Bytes;
+
+      void InitData(const size_t size, const void* data) override
+      {
+         Bytes.assign(size, 0);
+      }
+
+      void UpdateData(const size_t offset, const size_t size, void* data) override
+      {
+         ASSERT_LE(offset + size, Bytes.size());
+         memcpy(Bytes.data() + offset, data, size);
+      }
+
+      void GetData(const size_t offset, const size_t size, void* buffer) override
+      {
+         memcpy(buffer, Bytes.data() + offset, size);
+      }
+
+      void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+      {
+         ASSERT_LE(srcOffset + size, Bytes.size());
+         ASSERT_LE(dstOffset + size, Bytes.size());
+
+         //Overlapped copies are undefined on the GPU
+         ASSERT_TRUE(srcOffset + size <= dstOffset || dstOffset + size <= srcOffset);
+
+         memcpy(Bytes.data() + dstOffset, Bytes.data() + srcOffset, size);
+      }
+   };
+}
+
+TEST(TlsfAllocator, AllocatesAndMerges)
+{
+   TlsfAllocator allocator(1000);
+
+   TlsfAllocation a, b, c;
+   ASSERT_TRUE(allocator.Allocate(100, 1, a));
+   ASSERT_TRUE(allocator.Allocate(200, 1, b));
+   ASSERT_TRUE(allocator.Allocate(300, 1, c));
+
+   EXPECT_EQ(a.Offset, 0);
+   EXPECT_EQ(b.Offset, 100);
+   EXPECT_EQ(c.Offset, 300);
+
+   //Rest is 400, so it doesn't fit
+   TlsfAllocation big;
+   EXPECT_FALSE(allocator.Allocate(401, 1, big));
+
+   allocator.Free(b.Id);
+
+   TlsfStats stats = allocator.GetStats();
+   EXPECT_EQ(stats.UsedSize, 400);
+   EXPECT_EQ(stats.FreeBlocksCount, 2);
+   EXPECT_EQ(stats.LargestFreeBlock, 400);
+   EXPECT_FLOAT_EQ(stats.Fragmentation, 1.0f - 400.0f / 600.0f);
+
+   //Neighbours merge back into the single block
+   allocator.Free(a.Id);
+   allocator.Free(c.Id);
+
+   stats = allocator.GetStats();
+   EXPECT_EQ(stats.AllocationsCount, 0);
+   EXPECT_EQ(stats.FreeBlocksCount, 1);
+   EXPECT_EQ(stats.LargestFreeBlock, 1000);
+   EXPECT_FLOAT_EQ(stats.Fragmentation, 0.0f);
+
+   ASSERT_TRUE(allocator.Allocate(1000, 1, big));
+   EXPECT_EQ(big.Offset, 0);
+}
+
+TEST(TlsfAllocator, AlignsToAnySize)
+{
+   TlsfAllocator allocator(1000);
+
+   TlsfAllocation a, b;
+   ASSERT_TRUE(allocator.Allocate(5, 1, a));
+   ASSERT_TRUE(allocator.Allocate(24, 12, b));
+
+   EXPECT_EQ(b.Offset, 12);
+
+   //Padding before the aligned allocation stays free
+   TlsfAllocation padding;
+   ASSERT_TRUE(allocator.Allocate(7, 1, padding));
+   EXPECT_EQ(padding.Offset, 5);
+
+   allocator.Free(a.Id);
+
+   //Moved allocation keeps its alignment
+   std::vector<TlsfMove> moves;
+   EXPECT_EQ(allocator.Defragment(moves), 1);
+   ASSERT_EQ(moves.size(), 1);
+
+   EXPECT_EQ(moves[0].Id, padding.Id);
+   EXPECT_EQ(moves[0].To, 0);
+   EXPECT_EQ(allocator.GetOffset(b.Id), 12);
+   EXPECT_EQ(allocator.GetStats().FreeBlocksCount, 2);
+}
+
+TEST(TlsfAllocator, KeepsShortMoves)
+{
+   TlsfAllocator allocator(1000);
+
+   TlsfAllocation gap, a;
+   ASSERT_TRUE(allocator.Allocate(10, 1, gap));
+   ASSERT_TRUE(allocator.Allocate(100, 1, a));
+
+   allocator.Free(gap.Id);
+
+   //Move by 10 takes 10 pieces
+   std::vector<TlsfMove> moves;
+   EXPECT_EQ(allocator.Defragment(moves, SIZE_MAX, 9), 0);
+   EXPECT_EQ(allocator.GetOffset(a.Id), 10);
+
+   EXPECT_EQ(allocator.Defragment(moves, SIZE_MAX, 10), 1);
+   EXPECT_EQ(allocator.GetOffset(a.Id), 0);
+}
+
+TEST(GpuBufferHeap, DefragmentsWithCopies)
+{
+   auto buffer = std::make_shared<MockShaderBuffer>();
+
+   GpuBufferHeap<ShaderBuffer> heap(64);
+   heap.AddStream(buffer, sizeof(uint32_t));
+
+   ASSERT_EQ(buffer->Bytes.size(), 64 * sizeof(uint32_t));
+
+   //Allocations of 4, 16 and 8 elements filled with their number
+   TlsfAllocation allocations[3];
+   const uint32_t counts[3] = { 4, 16, 8 };
+
+   for (uint32_t i = 0; i < 3; ++i)
+   {
+      ASSERT_TRUE(heap.Allocate(counts[i], 1, allocations[i]));
+
+      std::vector<uint32_t> data(counts[i], i);
+      heap.Write(0, allocations[i].Offset, data.data(), counts[i]);
+   }
+
+   heap.Free(allocations[0].Id);
+   EXPECT_EQ(heap.GetStats().Ranges.FreeBlocksCount, 2);
+
+   //Distance of the moves is smaller than the sizes, so they are copied by the chunks
+   EXPECT_EQ(heap.Defragment(1), 1);
+   EXPECT_EQ(heap.GetOffset(allocations[1].Id), 0);
+   EXPECT_EQ(heap.Defragment(), 1);
+   EXPECT_EQ(heap.GetOffset(allocations[2].Id), 16);
+
+   const uint32_t* data = reinterpret_cast<const uint32_t*>(buffer->Bytes.data());
+
+   for (uint32_t i = 0; i < 16; ++i)
+      EXPECT_EQ(data[i], 1);
+
+   for (uint32_t i = 16; i < 24; ++i)
+      EXPECT_EQ(data[i], 2);
+
+   const GpuHeapStats stats = heap.GetStats();
+   EXPECT_EQ(stats.Ranges.FreeBlocksCount, 1);
+   EXPECT_EQ(stats.Ranges.LargestFreeBlock, 40);
+   EXPECT_EQ(stats.MovesCount, 2);
+   EXPECT_EQ(stats.MovedBytes, 24 * sizeof(uint32_t));
+}
+
+TEST(GpuBufferHeap, SkipsShortMoves)
+{
+   auto buffer = std::make_shared<MockShaderBuffer>();
+
+   GpuBufferHeap<ShaderBuffer> heap(256);
+   heap.AddStream(buffer, sizeof(uint32_t));
+
+   TlsfAllocation gap, big;
+   ASSERT_TRUE(heap.Allocate(1, 1, gap));
+   ASSERT_TRUE(heap.Allocate(64, 1, big));
+
+   heap.Free(gap.Id);
+
+   //Moving by the single element would be 64 copies
+   EXPECT_EQ(heap.Defragment(), 0);
+   EXPECT_EQ(heap.GetOffset(big.Id), 1);
+   EXPECT_EQ(heap.GetStats().MovedBytes, 0);
+}
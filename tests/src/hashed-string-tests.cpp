@@ -0,0 +1,24 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "utils/hashed-string.h"
+
+using namespace utils;
+
+TEST(HashedString, LiteralsHashedAtCompileTime)
+{
+   //Both are constant expressions, so they would fail to compile with the runtime hashing
+   constexpr HashedString literal("textures/wall.png");
+   static_assert(literal.GetValue() == HashFnv1a("textures/wall.png"), "Literal isn't hashed at compile time");
+
+   constexpr HashedString empty("");
+   static_assert(empty.GetValue() == FnvOffsetBasis, "Empty literal has the offset basis hash");
+
+   //Runtime strings of the same text give the same hash
+   const std::string path = "textures/wall.png";
+
+   EXPECT_EQ(HashedString(path.c_str()), literal);
+   EXPECT_EQ(HashedString(std::string_view(path)), literal);
+   EXPECT_NE(HashedString("textures/wall.jpg"), literal);
+}
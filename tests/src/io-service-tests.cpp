@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jobs/io-service.h"
+#include "jobs/job-system.h"
+
+using namespace core;
+
+namespace
+{
+   struct ReadCheck
+   {
+      std::vector<uint8_t> Expected;
+      bool IsExpectedToSucceed;
+
+      bool IsSucceeded = false;
+      bool IsMatching = false;
+      std::atomic<bool> IsDone = false;
+   };
+
+   void WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+   {
+      FILE* file = fopen(path.c_str(), "wb");
+      ASSERT_NE(file, nullptr);
+
+      if (!data.empty())
+         fwrite(data.data(), 1, data.size(), file);
+      fclose(file);
+   }
+
+   void CheckRead(ReadResult& result, uintptr_t args)
+   {
+      ReadCheck* check = reinterpret_cast<ReadCheck*>(args);
+
+      check->IsSucceeded = result.IsSucceeded;
+      check->IsMatching = result.Data == check->Expected;
+      check->IsDone = true;
+   }
+
+   //Reads the empty, the small, the multi chunk file of the odd size and the missing one
+   void ReadFiles(const bool isUringAllowed)
+   {
+      IoServiceParams params;
+      params.ChunkSize = 4096;
+      params.QueueDepth = 4;
+      params.ReadAheadChunks = 2;
+      params.FallbackThreads = 2;
+      params.IsUringAllowed = isUringAllowed;
+
+      const std::vector<size_t> sizes = { 0, 100, 4096 * 7 + 13 };
+
+      std::vector<ReadCheck> checks(sizes.size() + 1);
+
+      for (size_t i = 0; i < sizes.size(); ++i)
+      {
+         checks[i].Expected.resize(sizes[i]);
+         for (size_t j = 0; j < sizes[i]; ++j)
+            checks[i].Expected[j] = static_cast<uint8_t>(j * 31 + i);
+
+         checks[i].IsExpectedToSucceed = true;
+
+         WriteFile("io-service-test-" + std::to_string(i) + ".bin", checks[i].Expected);
+      }
+
+      checks.back().IsExpectedToSucceed = false;
+
+      {
+         IoService io(params);
+
+         if (!isUringAllowed)
+         {
+            EXPECT_FALSE(io.IsUring());
+         }
+
+         for (size_t i = 0; i < checks.size(); ++i)
+            io.Read("io-service-test-" + std::to_string(i) + ".bin", CheckRead, reinterpret_cast<uintptr_t>(&checks[i]));
+
+         io.Submit();
+
+         //Callbacks are jobs, the test runs them itself
+         for (auto& check : checks)
+         {
+            while (!check.IsDone)
+            {
+               if (!JobSystem::RunNext())
+                  std::this_thread::yield();
+            }
+         }
+
+         const IoStats stats = io.GetStats();
+         EXPECT_EQ(stats.BytesRead, sizes[1] + sizes[2]);
+         EXPECT_LE(stats.MaxChunksInFlight, params.QueueDepth);
+      }
+
+      for (auto& check : checks)
+      {
+         EXPECT_EQ(check.IsSucceeded, check.IsExpectedToSucceed);
+
+         if (check.IsExpectedToSucceed)
+         {
+            EXPECT_TRUE(check.IsMatching);
+         }
+      }
+
+      for (size_t i = 0; i < sizes.size(); ++i)
+         remove(("io-service-test-" + std::to_string(i) + ".bin").c_str());
+   }
+}
+
+TEST(IoService, ReadsFilesByChunks)
+{
+   ReadFiles(true);
+   ReadFiles(false);
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <vector>
+
+#include "jobs/job-system.h"
+
+using namespace core;
+
+//Workers aren't started, they would block the exit waiting on the destroyed condition variable
+//So the waiting thread runs every queued job by the RunNext, the same way it helps the workers
+
+namespace
+{
+   std::atomic_size_t NestedCount = 0;
+
+   JobGroup* NestedGroups = nullptr;
+}
+
+TEST(JobSystem, ParallelForVisitsEveryIndexOnce)
+{
+   for (size_t count : { 1, 2, 7, 1000, 1001, 12'345 })
+   {
+      for (size_t minBatchSize : { 1, 3, 64, 5000 })
+      {
+         std::vector<std::atomic_uint32_t> visits(count);
+
+         JobSystem::ParallelFor(count, minBatchSize, [&](const size_t begin, const size_t end)
+            {
+               EXPECT_LT(begin, end);
+               EXPECT_LE(end, count);
+
+               for (size_t i = begin; i < end; ++i)
+                  visits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+
+         for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(visits[i].load(), 1) << "count " << count << ", batch " << minBatchSize << ", index " << i;
+      }
+   }
+
+   //Nothing to do
+   JobSystem::ParallelFor(0, 1, [](const size_t, const size_t) { FAIL(); });
+}
+
+TEST(JobSystem, GroupWaitCompletesNestedWork)
+{
+   constexpr size_t OuterCount = 16;
+   constexpr size_t InnerCount = 32;
+
+   NestedCount = 0;
+
+   JobGroup outer;
+   JobGroup inner[OuterCount];
+   NestedGroups = inner;
+
+   //Every outer job adds its own inner jobs and waits for them, the wait runs the queued jobs by the RunNext
+   for (size_t i = 0; i < OuterCount; ++i)
+   {
+      JobSystem::Execute([](uintptr_t params)
+         {
+            JobGroup& group = NestedGroups[params];
+
+            for (size_t j = 0; j < InnerCount; ++j)
+            {
+               JobSystem::Execute([](uintptr_t)
+                  {
+                     NestedCount.fetch_add(1);
+                  }, 0, &group);
+            }
+
+            JobSystem::Wait(group);
+
+            EXPECT_TRUE(group.IsDone());
+         }, i, &outer);
+   }
+
+   JobSystem::Wait(outer);
+
+   EXPECT_TRUE(outer.IsDone());
+   EXPECT_EQ(NestedCount.load(), OuterCount * InnerCount);
+
+   //Everything is done, so there is nothing left to run
+   EXPECT_FALSE(JobSystem::RunNext());
+}
+
+TEST(JobSystem, RunNextRunsQueuedJob)
+{
+   std::atomic_size_t runs = 0;
+   JobGroup group;
+
+   JobSystem::Execute([](uintptr_t params)
+      {
+         reinterpret_cast<std::atomic_size_t*>(params)->fetch_add(1);
+      }, reinterpret_cast<uintptr_t>(&runs), &group);
+
+   EXPECT_FALSE(group.IsDone());
+
+   EXPECT_TRUE(JobSystem::RunNext());
+   EXPECT_FALSE(JobSystem::RunNext());
+
+   EXPECT_TRUE(group.IsDone());
+   EXPECT_EQ(runs.load(), 1);
+}
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asset-manager/pak/lz-codec.h"
+
+using namespace assets;
+
+namespace
+{
+   std::vector<uint8_t> RoundTrip(const std::vector<uint8_t>& data)
+   {
+      const std::vector<uint8_t> compressed = lz::Compress(data.data(), data.size());
+
+      std::vector<uint8_t> decompressed(data.size());
+      EXPECT_TRUE(lz::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+
+      return decompressed;
+   }
+
+   std::vector<uint8_t> RandomBytes(const size_t size, const uint32_t seed)
+   {
+      std::mt19937 random(seed);
+
+      std::vector<uint8_t> data(size);
+      for (auto& b : data)
+         b = static_cast<uint8_t>(random());
+
+      return data;
+   }
+}
+
+TEST(LzCodec, RoundTripsShortInputs)
+{
+   //Inputs up to the last literals aren't searched for the matches
+   for (size_t size = 0; size <= 2 * (lz::MinMatch + lz::LastLiterals); ++size)
+   {
+      const std::vector<uint8_t> data(size, 'a');
+      EXPECT_EQ(RoundTrip(data), data) << "size " << size;
+   }
+}
+
+TEST(LzCodec, RoundTripsRepeatedData)
+{
+   //Text with the repeated words, the runs of the single byte overlap their matches
+   std::vector<uint8_t> data;
+   for (size_t i = 0; i < 1000; ++i)
+   {
+      const std::string line = "v " + std::to_string(i % 37) + ".5 1.0 -2.25\n";
+      data.insert(data.end(), line.begin(), line.end());
+   }
+
+   data.insert(data.end(), 5000, 0);
+
+   const std::vector<uint8_t> compressed = lz::Compress(data.data(), data.size());
+   EXPECT_LT(compressed.size(), data.size() / 4);
+
+   EXPECT_EQ(RoundTrip(data), data);
+}
+
+TEST(LzCodec, RoundTripsLongLengths)
+{
+   //Literals and matches longer than 15 + 255 take several length bytes
+   std::vector<uint8_t> data = RandomBytes(1000, 1);
+   data.insert(data.end(), data.begin(), data.begin() + 900);
+
+   EXPECT_EQ(RoundTrip(data), data);
+}
+
+TEST(LzCodec, RoundTripsRandomData)
+{
+   //Matches farther than the MaxOffset aren't used
+   std::vector<uint8_t> data = RandomBytes(lz::MaxOffset + 100, 2);
+   data.insert(data.end(), data.begin(), data.begin() + 1000);
+
+   EXPECT_EQ(RoundTrip(data), data);
+}
+
+TEST(LzCodec, RejectsCorruptedStreams)
+{
+   std::vector<uint8_t> data = RandomBytes(500, 3);
+   data.insert(data.end(), data.begin(), data.begin() + 300);
+
+   const std::vector<uint8_t> compressed = lz::Compress(data.data(), data.size());
+   std::vector<uint8_t> decompressed(data.size() + 1);
+
+   //Size must match exactly
+   EXPECT_FALSE(lz::Decompress(compressed.data(), compressed.size(), decompressed.data(), data.size() - 1));
+   EXPECT_FALSE(lz::Decompress(compressed.data(), compressed.size(), decompressed.data(), data.size() + 1));
+
+   //Every truncation is either detected or decodes to fewer bytes
+   for (size_t size = 0; size < compressed.size(); ++size)
+      EXPECT_FALSE(lz::Decompress(compressed.data(), size, decompressed.data(), data.size())) << "size " << size;
+
+   //Match before the start of the output
+   const uint8_t backwards[] = { 0x10, 'a', 0x05, 0x00 };
+   EXPECT_FALSE(lz::Decompress(backwards, sizeof(backwards), decompressed.data(), 5));
+}
@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "asset-manager/cook/mesh-simplify.h"
+#include "graphics/lod-selection.h"
+
+#include "test-fixtures.h"
+
+using namespace assets::cook;
+using namespace fixtures;
+
+namespace
+{
+   //Closed sphere of the unit radius, poles are the single vertices
+   IndexedMesh Sphere(const uint32_t rings, const uint32_t segments)
+   {
+      IndexedMesh mesh;
+
+      mesh.Positions.emplace_back(0.0f, 1.0f, 0.0f);
+
+      for (uint32_t r = 1; r < rings; ++r)
+      {
+         const float theta = 3.14159265f * r / rings;
+
+         for (uint32_t s = 0; s < segments; ++s)
+         {
+            const float phi = 2.0f * 3.14159265f * s / segments;
+            mesh.Positions.emplace_back(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+         }
+      }
+
+      mesh.Positions.emplace_back(0.0f, -1.0f, 0.0f);
+
+      const uint32_t bottom = static_cast<uint32_t>(mesh.Positions.size() - 1);
+      auto ring = [segments](const uint32_t r, const uint32_t s) { return 1 + (r - 1) * segments + s % segments; };
+
+      for (uint32_t s = 0; s < segments; ++s)
+      {
+         mesh.Indices.insert(mesh.Indices.end(), { 0, ring(1, s + 1), ring(1, s) });
+         mesh.Indices.insert(mesh.Indices.end(), { bottom, ring(rings - 1, s), ring(rings - 1, s + 1) });
+      }
+
+      for (uint32_t r = 1; r + 1 < rings; ++r)
+      {
+         for (uint32_t s = 0; s < segments; ++s)
+         {
+            mesh.Indices.insert(mesh.Indices.end(), { ring(r, s), ring(r, s + 1), ring(r + 1, s) });
+            mesh.Indices.insert(mesh.Indices.end(), { ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s) });
+         }
+      }
+
+      return mesh;
+   }
+
+   graphics::LodSelectionParams Params(const float distance)
+   {
+      graphics::LodSelectionParams params;
+      params.Scale = 1.0f;
+      params.Distance = distance;
+      params.Fov = 3.14159265f / 2.0f;
+      params.ViewportHeight = 1000.0f;
+
+      return params;
+   }
+}
+
+TEST(MeshSimplify, WeldsEqualVertices)
+{
+   //Two triangles of the quad as the soup, the diagonal vertices are repeated
+   const std::vector<mm::vec3> positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f },
+                                             { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+   std::vector<mm::vec2> uvs = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f },
+                                 { 0.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+   std::vector<uint32_t> remap;
+   std::vector<uint32_t> unique;
+
+   WeldVertices({ positions.data(), uvs.data() }, { sizeof(mm::vec3), sizeof(mm::vec2) }, positions.size(), remap, unique);
+
+   EXPECT_EQ(unique, (std::vector<uint32_t>{ 0, 1, 2, 5 }));
+   EXPECT_EQ(remap, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+
+   //Vertex on the UV seam stays separate
+   uvs[4] = { 0.5f, 1.0f };
+   WeldVertices({ positions.data(), uvs.data() }, { sizeof(mm::vec3), sizeof(mm::vec2) }, positions.size(), remap, unique);
+
+   EXPECT_EQ(unique.size(), 5);
+}
+
+TEST(MeshSimplify, FlatGridKeepsItsBorder)
+{
+   const IndexedMesh grid = Grid(16);
+
+   std::vector<uint32_t> indices;
+   const float error = SimplifyMesh(grid.Positions.data(), grid.Positions.size(), grid.Indices, 0, 0.001f, indices);
+
+   //Inner vertices of the plane are free, so only the border keeps the triangles
+   EXPECT_LT(error, 0.001f);
+   EXPECT_LT(indices.size(), grid.Indices.size() / 4);
+   ASSERT_FALSE(indices.empty());
+
+   //Corners can't move without the error
+   for (const mm::vec3 corner : { mm::vec3(0.0f, 0.0f, 0.0f), mm::vec3(16.0f, 0.0f, 0.0f), mm::vec3(0.0f, 0.0f, 16.0f), mm::vec3(16.0f, 0.0f, 16.0f) })
+   {
+      bool isFound = false;
+      for (uint32_t index : indices)
+         isFound |= grid.Positions[index].x == corner.x && grid.Positions[index].z == corner.z;
+
+      EXPECT_TRUE(isFound) << corner.x << " " << corner.z;
+   }
+
+   //Plane stays facing up
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const mm::vec3 normal = mm::cross(grid.Positions[indices[i + 1]] - grid.Positions[indices[i]],
+                                        grid.Positions[indices[i + 2]] - grid.Positions[indices[i]]);
+      EXPECT_GT(normal.y, 0.0f);
+   }
+}
+
+TEST(MeshSimplify, LodChainOfSphere)
+{
+   const IndexedMesh sphere = Sphere(48, 96);
+
+   const std::vector<LodLevel> levels = BuildLodChain(sphere.Positions.data(), sphere.Positions.size(), sphere.Indices, 4);
+   ASSERT_EQ(levels.size(), 4);
+
+   size_t previousCount = sphere.Indices.size();
+   float previousError = 0.0f;
+
+   for (auto& level : levels)
+   {
+      printf("%zu triangles, error %f\n", level.Indices.size() / 3, level.Error);
+
+      EXPECT_LE(level.Indices.size(), previousCount / 2 + 3);
+      EXPECT_GE(level.Error, previousError);
+
+      //Every vertex of the level stays on the sphere, the error bounds how far its faces are
+      for (uint32_t index : level.Indices)
+         EXPECT_NEAR(mm::length(sphere.Positions[index]), 1.0f, 0.001f);
+
+      previousCount = level.Indices.size();
+      previousError = level.Error;
+   }
+
+   //16 times less triangles than the source and still a sphere
+   EXPECT_LT(levels.back().Error, 0.1f);
+}
+
+TEST(LodSelection, FollowsScreenError)
+{
+   const float errors[] = { 0.001f, 0.004f, 0.016f };
+
+   //Projected error is error / distance * height / 2, so the levels switch at 0.5, 2 and 8
+   EXPECT_EQ(graphics::SelectLod(errors, 3, Params(0.4f)), 0);
+   EXPECT_EQ(graphics::SelectLod(errors, 3, Params(1.0f)), 1);
+   EXPECT_EQ(graphics::SelectLod(errors, 3, Params(4.0f)), 2);
+   EXPECT_EQ(graphics::SelectLod(errors, 3, Params(100.0f)), 3);
+
+   //Larger mesh keeps the finer level at the same distance
+   graphics::LodSelectionParams scaled = Params(4.0f);
+   scaled.Scale = 4.0f;
+   EXPECT_EQ(graphics::SelectLod(errors, 3, scaled), 1);
+
+   EXPECT_EQ(graphics::SelectLod(errors, 0, Params(100.0f)), 0);
+   EXPECT_EQ(graphics::SelectLod(errors, 3, Params(0.0f)), 0);
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include <array>
+#include <random>
+#include <algorithm>
+#include <vector>
+
+#include "asset-manager/cook/mesh-optimize.h"
+
+#include "test-fixtures.h"
+
+using namespace assets::cook;
+using namespace fixtures;
+
+namespace
+{
+   std::vector<std::array<uint32_t, 3>> SortedTriangles(const std::vector<uint32_t>& indices)
+   {
+      std::vector<std::array<uint32_t, 3>> triangles;
+
+      for (size_t i = 0; i < indices.size(); i += 3)
+         triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+
+      std::sort(triangles.begin(), triangles.end());
+
+      return triangles;
+   }
+}
+
+TEST(MeshOptimize, AnalyzesKnownOrders)
+{
+   const std::vector<uint32_t> triangle = { 0, 1, 2 };
+   const VertexCacheStats single = AnalyzeVertexCache(triangle.data(), triangle.size(), 3);
+
+   EXPECT_FLOAT_EQ(single.Acmr, 3.0f);
+   EXPECT_FLOAT_EQ(single.Atvr, 1.0f);
+
+   //Quad shares the edge, its second triangle transforms only the single vertex
+   const std::vector<uint32_t> quad = { 0, 1, 2, 2, 1, 3 };
+   EXPECT_FLOAT_EQ(AnalyzeVertexCache(quad.data(), quad.size(), 4).Acmr, 2.0f);
+
+   //Cache of 3 entries loses the vertex 0 before it is used again
+   const std::vector<uint32_t> fan = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+   EXPECT_FLOAT_EQ(AnalyzeVertexCache(fan.data(), fan.size(), 5, 3).Acmr, 2.0f);
+   EXPECT_FLOAT_EQ(AnalyzeVertexCache(fan.data(), fan.size(), 5, 16).Acmr, 5.0f / 3.0f);
+}
+
+TEST(MeshOptimize, VertexCacheOrderOfShuffledGrid)
+{
+   const uint32_t size = 32;
+   const size_t verticesCount = (size + 1) * (size + 1);
+
+   std::vector<uint32_t> indices = GridIndices(size);
+
+   //Triangles in the random order miss the cache almost on every vertex
+   std::vector<std::array<uint32_t, 3>> triangles;
+   for (size_t i = 0; i < indices.size(); i += 3)
+      triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+
+   std::mt19937 random(42);
+   std::shuffle(triangles.begin(), triangles.end(), random);
+
+   for (size_t i = 0; i < triangles.size(); ++i)
+      std::copy(triangles[i].begin(), triangles[i].end(), indices.begin() + i * 3);
+
+   const VertexCacheStats before = AnalyzeVertexCache(indices.data(), indices.size(), verticesCount);
+
+   std::vector<uint32_t> optimized(indices.size());
+   OptimizeVertexCache(indices.data(), indices.size(), optimized.data());
+
+   const VertexCacheStats after = AnalyzeVertexCache(optimized.data(), optimized.size(), verticesCount);
+
+   printf("ACMR %f -> %f, ATVR %f -> %f\n", before.Acmr, after.Acmr, before.Atvr, after.Atvr);
+
+   //Same triangles with the same winding, only in the other order
+   EXPECT_EQ(SortedTriangles(optimized), SortedTriangles(indices));
+
+   //Regular grid is close to 0.5 at best, the strips along the grid give ~1
+   EXPECT_GT(before.Acmr, 2.0f);
+   EXPECT_LT(after.Acmr, 0.8f);
+   EXPECT_LT(after.Atvr, 1.6f);
+
+   //Optimizer works in place too
+   OptimizeVertexCache(indices.data(), indices.size(), indices.data());
+   EXPECT_EQ(indices, optimized);
+}
+
+TEST(MeshOptimize, OverdrawDrawsOuterMeshletsFirst)
+{
+   //Two triangles facing +Z, the one at -Z faces the mesh center and is hidden behind the other one from the outside
+   const std::vector<mm::vec3> positions = { { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, -1.0f },
+                                             { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f } };
+   std::vector<uint32_t> indices = { 0, 1, 2, 3, 4, 5 };
+
+   std::vector<Meshlet> meshlets(2);
+
+   for (size_t i = 0; i < 2; ++i)
+   {
+      meshlets[i].FirstIndex = static_cast<uint32_t>(i * 3);
+      meshlets[i].IndicesCount = 3;
+      meshlets[i].Center = positions[i * 3];
+      meshlets[i].Radius = 1.0f;
+      meshlets[i].ConeAxis = mm::vec3(0.0f, 0.0f, 1.0f);
+      meshlets[i].ConeCos = 1.0f;
+      meshlets[i].ConeSin = 0.0f;
+   }
+
+   OptimizeOverdraw(positions.data(), indices, meshlets);
+
+   EXPECT_EQ(indices, (std::vector<uint32_t>{ 3, 4, 5, 0, 1, 2 }));
+   EXPECT_EQ(meshlets[0].Center.z, 1.0f);
+   EXPECT_EQ(meshlets[0].FirstIndex, 0);
+   EXPECT_EQ(meshlets[1].FirstIndex, 3);
+}
+
+TEST(MeshOptimize, VertexFetchFollowsFirstUse)
+{
+   std::vector<uint32_t> indices = { 5, 2, 7, 7, 2, 0 };
+   std::vector<uint32_t> vertices;
+
+   OptimizeVertexFetch(indices, 8, vertices);
+
+   EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3 }));
+   EXPECT_EQ(vertices, (std::vector<uint32_t>{ 5, 2, 7, 0 }));
+}
@@ -0,0 +1,288 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <cstring>
+
+#include "graphics/mesh-residency.h"
+
+using namespace graphics;
+
+namespace
+{
+   //Buffers keep their bytes on the CPU and count what is written into them
+   struct MockStorage
+   {
+      std::vector<uint8_t> Bytes;
+      uint64_t UploadedBytes = 0;
+
+      void Write(const size_t size, const void* data, const size_t offset)
+      {
+         ASSERT_LE(offset + size, Bytes.size());
+
+         memcpy(Bytes.data() + offset, data, size);
+         UploadedBytes += size;
+      }
+
+      //Copies on the GPU don't count as the upload
+      void Copy(const size_t srcOffset, const size_t dstOffset, const size_t size)
+      {
+         ASSERT_LE(srcOffset + size, Bytes.size());
+         ASSERT_LE(dstOffset + size, Bytes.size());
+
+         memmove(Bytes.data() + dstOffset, Bytes.data() + srcOffset, size);
+      }
+   };
+
+   class MockVertexBuffer : public VertexBuffer
+   {
+   public:
+      MockStorage Storage;
+
+      void InitData(const size_t size, const void* data) override
+      {
+         Storage.Bytes.assign(size, 0);
+      }
+
+      void UpdateData(const size_t size, const void* data, const size_t offset = 0) override
+      {
+         Storage.Write(size, data, offset);
+      }
+
+      void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+      {
+         Storage.Copy(srcOffset, dstOffset, size);
+      }
+   };
+
+   class MockIndexBuffer : public IndexBuffer
+   {
+   public:
+      MockStorage Storage;
+
+      void InitData(const size_t size, const void* data) override
+      {
+         Storage.Bytes.assign(size, 0);
+      }
+
+      void UpdateData(const size_t size, const void* data, const size_t offset = 0) override
+      {
+         Storage.Write(size, data, offset);
+      }
+
+      void CopyData(const size_t srcOffset, const size_t dstOffset, const size_t size) override
+      {
+         Storage.Copy(srcOffset, dstOffset, size);
+      }
+   };
+
+   //Only the buffers are created, the draws aren't needed for the residency
+   class MockGraphicsDevice : public GraphicsDevice
+   {
+   public:
+      std::vector<std::shared_ptr<MockVertexBuffer>> VBOs;
+      std::vector<std::shared_ptr<MockIndexBuffer>> IBOs;
+
+      std::shared_ptr<Canvas> CreateCanvas(const uint16_t sizeX, const uint16_t sizeY, const std::string_view& title) override { return nullptr; }
+      std::shared_ptr<ShaderProgram> CreateShaderProgram() override { return nullptr; }
+      std::shared_ptr<ComputeShader> CreateComputeShader() override { return nullptr; }
+      std::shared_ptr<Texture2D> CreateTexture2D() override { return nullptr; }
+      std::shared_ptr<Cubemap> CreateCubemap() override { return nullptr; }
+
+      std::shared_ptr<VertexBuffer> CreateVBO() override
+      {
+         return VBOs.emplace_back(std::make_shared<MockVertexBuffer>());
+      }
+
+      std::shared_ptr<IndexBuffer> CreateIBO() override
+      {
+         return IBOs.emplace_back(std::make_shared<MockIndexBuffer>());
+      }
+
+      std::shared_ptr<UniformBuffer> CreateUBO() override { return nullptr; }
+      std::shared_ptr<ShaderBuffer> CreateSBO() override { return nullptr; }
+      std::shared_ptr<Framebuffer> CreateFBO() override { return nullptr; }
+
+      std::string GetDeviceInfo() const override { return "mock"; }
+      void EnableFeature(const Feature feature) const override {}
+      void DisableFeature(const Feature feature) const override {}
+      void Clear() override {}
+      void SetViewport(const mm::ivec2& origin, const mm::ivec2& size) const override {}
+      void SetClearColor(const mm::vec4& color) const override {}
+      void SetBlendSettings(const BlendFunc func, const BlendValue src, const BlendValue dst) const override {}
+      void SetCullingFace(const Face face) const override {}
+      void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount, const size_t firstVertex = 0) const override {}
+      void DrawIndexedTriangles(const std::shared_ptr<ShaderProgram>& program, const void* const* indexOffsets, const int32_t* indicesCounts,
+                                const size_t rangesCount, const int32_t* baseVertices = nullptr) const override {}
+
+      uint64_t GetUploadedBytes() const
+      {
+         uint64_t bytes = 0;
+
+         for (auto& vbo : VBOs)
+            bytes += vbo->Storage.UploadedBytes;
+
+         for (auto& ibo : IBOs)
+            bytes += ibo->Storage.UploadedBytes;
+
+         return bytes;
+      }
+   };
+
+   //Quad of 2 triangles
+   assets::TrigVertices MakeQuad(const float z)
+   {
+      assets::TrigVertices quad;
+      quad.Positions = { { 0.0f, 0.0f, z }, { 1.0f, 0.0f, z }, { 1.0f, 1.0f, z }, { 0.0f, 1.0f, z } };
+      quad.Normals.assign(4, mm::vec3(0.0f, 0.0f, 1.0f));
+      quad.UVs = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+      quad.Tangents.assign(4, mm::vec3(1.0f, 0.0f, 0.0f));
+      quad.Indices = { 0, 1, 2, 0, 2, 3 };
+
+      return quad;
+   }
+
+   uint64_t GetFloatBytes(const assets::TrigVertices& level)
+   {
+      return level.Positions.size() * (sizeof(mm::vec3) * 3 + sizeof(mm::vec2)) + level.Indices.size() * sizeof(uint32_t);
+   }
+
+   MeshResidencyParams SmallParams()
+   {
+      MeshResidencyParams params;
+      params.DynamicVertices = 16;
+      params.DynamicIndices = 32;
+      params.ResidentVertices = 64;
+      params.ResidentIndices = 128;
+
+      return params;
+   }
+}
+
+TEST(MeshResidency, UploadsOnce)
+{
+   MockGraphicsDevice gd;
+   MeshResidency residency(gd, SmallParams());
+
+   ASSERT_EQ(gd.GetUploadedBytes(), 0);
+
+   assets::TrigVertices mesh = MakeQuad(0.0f);
+   mesh.Lods.push_back(std::make_shared<assets::TrigVertices>(MakeQuad(1.0f)));
+   mesh.Lods[0]->Indices = { 0, 1, 2 };
+
+   const ResidencyHandle first = residency.Upload(MakeQuad(2.0f));
+   const ResidencyHandle second = residency.Upload(mesh);
+
+   ASSERT_NE(first, InvalidResidency);
+   ASSERT_NE(second, InvalidResidency);
+
+   const uint64_t uploaded = GetFloatBytes(MakeQuad(2.0f)) + GetFloatBytes(mesh) + GetFloatBytes(*mesh.Lods[0]);
+   EXPECT_EQ(gd.GetUploadedBytes(), uploaded);
+   EXPECT_EQ(residency.GetStats().ResidentBytes, uploaded);
+
+   //Ranges follow the dynamic part and each other
+   const GeometryRange level0 = residency.GetLevel(second, 0);
+   const GeometryRange level1 = residency.GetLevel(second, 1);
+
+   EXPECT_EQ(residency.GetLevel(first, 0).FirstVertex, 16);
+   EXPECT_EQ(level0.FirstVertex, 20);
+   EXPECT_EQ(level0.FirstIndex, 38);
+   EXPECT_EQ(level1.FirstVertex, 24);
+   EXPECT_EQ(level1.IndicesCount, 3);
+
+   //Indices stay relative to the level, the FirstVertex is their base vertex
+   const uint32_t* indices = reinterpret_cast<const uint32_t*>(gd.IBOs[0]->Storage.Bytes.data());
+   EXPECT_EQ(indices[level0.FirstIndex + 2], 2);
+   EXPECT_EQ(indices[level1.FirstIndex + 1], 1);
+
+   const mm::vec3* positions = reinterpret_cast<const mm::vec3*>(gd.VBOs[0]->Storage.Bytes.data());
+   EXPECT_EQ(positions[level1.FirstVertex].z, 1.0f);
+
+   //Draws of the resident meshes only read the ranges, so the frames don't upload anything
+   for (int frame = 0; frame < 10; ++frame)
+   {
+      residency.GetLevel(first, 0);
+      residency.GetLevel(second, frame % 2);
+   }
+
+   EXPECT_EQ(gd.GetUploadedBytes(), uploaded);
+}
+
+TEST(MeshResidency, FallsBackToDynamic)
+{
+   MockGraphicsDevice gd;
+   MeshResidency residency(gd, SmallParams());
+
+   //Packed mesh doesn't match the float layout
+   assets::TrigVertices packed = MakeQuad(0.0f);
+   packed.PackedVertices.resize(4);
+   EXPECT_EQ(residency.Upload(packed), InvalidResidency);
+
+   //Doesn't fit into the rest of the resident part
+   assets::TrigVertices big = MakeQuad(0.0f);
+   big.Positions.resize(65);
+   EXPECT_EQ(residency.Upload(big), InvalidResidency);
+
+   EXPECT_EQ(gd.GetUploadedBytes(), 0);
+
+   //Dynamic draws upload every time
+   const assets::TrigVertices quad = MakeQuad(0.0f);
+
+   GeometryRange range;
+   ASSERT_TRUE(residency.UploadDynamic(quad, quad.Indices.size(), range));
+   ASSERT_TRUE(residency.UploadDynamic(quad, 3, range));
+
+   EXPECT_EQ(range.FirstVertex, 0);
+   EXPECT_EQ(range.IndicesCount, 3);
+   EXPECT_EQ(gd.GetUploadedBytes(), GetFloatBytes(quad) * 2 - 3 * sizeof(uint32_t));
+   EXPECT_EQ(residency.GetStats().DynamicBytes, gd.GetUploadedBytes());
+
+   EXPECT_FALSE(residency.UploadDynamic(big, 0, range));
+}
+
+TEST(MeshResidency, ReleasesAndDefragments)
+{
+   MockGraphicsDevice gd;
+   MeshResidency residency(gd, SmallParams());
+
+   const ResidencyHandle first = residency.Upload(MakeQuad(0.0f));
+   const ResidencyHandle second = residency.Upload(MakeQuad(1.0f));
+   const ResidencyHandle third = residency.Upload(MakeQuad(2.0f));
+
+   residency.Release(first);
+
+   EXPECT_EQ(residency.GetStats().MeshesCount, 2);
+   EXPECT_EQ(residency.GetVertexHeapStats().Ranges.FreeBlocksCount, 2);
+
+   const uint64_t uploaded = gd.GetUploadedBytes();
+
+   EXPECT_EQ(residency.Defragment(1), 2);
+   EXPECT_EQ(residency.Defragment(4), 2);
+   EXPECT_EQ(residency.Defragment(4), 0);
+
+   EXPECT_EQ(residency.GetVertexHeapStats().Ranges.FreeBlocksCount, 1);
+   EXPECT_EQ(residency.GetIndexHeapStats().Ranges.FreeBlocksCount, 1);
+
+   //Moved ranges follow the dynamic part again and keep their data, the copies aren't uploads
+   const GeometryRange moved = residency.GetLevel(second, 0);
+   const GeometryRange last = residency.GetLevel(third, 0);
+
+   EXPECT_EQ(moved.FirstVertex, 16);
+   EXPECT_EQ(moved.FirstIndex, 32);
+   EXPECT_EQ(last.FirstVertex, 20);
+   EXPECT_EQ(last.FirstIndex, 38);
+
+   const mm::vec3* positions = reinterpret_cast<const mm::vec3*>(gd.VBOs[0]->Storage.Bytes.data());
+   const mm::vec2* uvs = reinterpret_cast<const mm::vec2*>(gd.VBOs[2]->Storage.Bytes.data());
+   const uint32_t* indices = reinterpret_cast<const uint32_t*>(gd.IBOs[0]->Storage.Bytes.data());
+
+   EXPECT_EQ(positions[moved.FirstVertex + 3].z, 1.0f);
+   EXPECT_EQ(positions[last.FirstVertex].z, 2.0f);
+   EXPECT_EQ(uvs[last.FirstVertex + 2].y, 1.0f);
+   EXPECT_EQ(indices[last.FirstIndex + 5], 3);
+
+   EXPECT_EQ(gd.GetUploadedBytes(), uploaded);
+
+   //Handle of the released mesh is reused
+   EXPECT_EQ(residency.Upload(MakeQuad(3.0f)), first);
+   EXPECT_EQ(residency.GetLevel(first, 0).FirstVertex, 24);
+}
@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "asset-manager/cook/meshlets.h"
+#include "graphics/culling.h"
+
+#include "test-fixtures.h"
+
+using namespace assets::cook;
+using namespace fixtures;
+
+namespace
+{
+   size_t CullGrid(const std::vector<Meshlet>& meshlets, const mm::vec3& cameraPosition, const mm::mat4& transform)
+   {
+      const graphics::Frustum frustum = graphics::ExtractFrustum(ViewCamera(cameraPosition));
+
+      graphics::MeshletCullParams params;
+      params.ViewFrustum = &frustum;
+      params.CameraPosition = cameraPosition;
+      params.Transform = &transform;
+
+      std::vector<graphics::DrawRange> ranges;
+      const size_t visibleCount = graphics::CullMeshlets(meshlets, params, ranges);
+
+      size_t rangesCount = 0;
+      for (auto& range : ranges)
+         rangesCount += range.IndicesCount;
+
+      EXPECT_EQ(rangesCount, visibleCount);
+
+      return visibleCount;
+   }
+}
+
+TEST(Meshlets, RespectLimitsAndCoverMesh)
+{
+   const IndexedMesh grid = Grid(48);
+
+   std::vector<Meshlet> meshlets;
+   std::vector<uint32_t> triangles;
+   BuildMeshlets(grid.Positions.data(), grid.Positions.size(), grid.Indices, meshlets, triangles);
+
+   //Every triangle is in the single meshlet
+   std::vector<uint32_t> sorted = triangles;
+   std::sort(sorted.begin(), sorted.end());
+
+   std::vector<uint32_t> expected(grid.Indices.size() / 3);
+   std::iota(expected.begin(), expected.end(), 0);
+
+   EXPECT_EQ(sorted, expected);
+
+   uint32_t nextIndex = 0;
+
+   for (auto& meshlet : meshlets)
+   {
+      EXPECT_EQ(meshlet.FirstIndex, nextIndex);
+      EXPECT_LE(meshlet.IndicesCount, MaxMeshletTriangles * 3);
+
+      nextIndex += meshlet.IndicesCount;
+
+      std::vector<uint32_t> vertices;
+
+      for (uint32_t i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndicesCount; ++i)
+      {
+         const uint32_t vertex = grid.Indices[triangles[i / 3] * 3 + i % 3];
+         vertices.push_back(vertex);
+
+         EXPECT_LE(mm::length(grid.Positions[vertex] - meshlet.Center), meshlet.Radius + 0.0001f);
+      }
+
+      std::sort(vertices.begin(), vertices.end());
+      EXPECT_LE(std::unique(vertices.begin(), vertices.end()) - vertices.begin(), MaxMeshletVertices);
+
+      //Flat grid has the single normal
+      EXPECT_NEAR(meshlet.ConeAxis.y, 1.0f, 0.0001f);
+      EXPECT_NEAR(meshlet.ConeCos, 1.0f, 0.0001f);
+   }
+
+   EXPECT_EQ(nextIndex, grid.Indices.size());
+
+   //Connected grid fills the meshlets well
+   const size_t minMeshlets = (grid.Indices.size() / 3 + MaxMeshletTriangles - 1) / MaxMeshletTriangles;
+   printf("%zu meshlets, at least %zu are needed\n", meshlets.size(), minMeshlets);
+   EXPECT_LT(meshlets.size(), minMeshlets * 2);
+}
+
+TEST(Meshlets, CulledByFrustumAndCone)
+{
+   const IndexedMesh grid = Grid(32);
+
+   std::vector<Meshlet> meshlets;
+   std::vector<uint32_t> triangles;
+   BuildMeshlets(grid.Positions.data(), grid.Positions.size(), grid.Indices, meshlets, triangles);
+
+   const size_t allCount = grid.Indices.size();
+
+   //Grid is below the camera and in front of it, from (-16, -5, 10) to (16, -5, 42)
+   const mm::mat4 translate = mm::translate(mm::mat4(), mm::vec3(-16.0f, -5.0f, 10.0f));
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f), translate), allCount);
+
+   //Same grid from below faces away, the camera is far enough below for the bounding spheres
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f, -30.0f, -40.0f), translate), 0);
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f, 20.0f, -40.0f), translate), allCount);
+
+   //Camera moved to the right sees only the part of the grid
+   const size_t partCount = CullGrid(meshlets, mm::vec3(30.0f, 0.0f, 0.0f), translate);
+   EXPECT_GT(partCount, 0);
+   EXPECT_LT(partCount, allCount);
+
+   //Behind the camera
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f, 0.0f, 100.0f), translate), 0);
+}
+
+TEST(Meshlets, CulledByDrawTransform)
+{
+   const IndexedMesh grid = Grid(32);
+
+   std::vector<Meshlet> meshlets;
+   std::vector<uint32_t> triangles;
+   BuildMeshlets(grid.Positions.data(), grid.Positions.size(), grid.Indices, meshlets, triangles);
+
+   const size_t allCount = grid.Indices.size();
+
+   //Grid turned around the Z axis faces down, it is above the camera from (-16, 5, 10) to (16, 5, 42)
+   mm::mat4 rotation;
+   rotation.Data[0] = -1.0f;
+   rotation.Data[5] = -1.0f;
+
+   const mm::mat4 turned = mm::translate(mm::mat4(), mm::vec3(16.0f, 5.0f, 10.0f)) * rotation;
+
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f), turned), allCount);
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f, 30.0f, -40.0f), turned), 0);
+
+   //Mirrored grid isn't culled by the cones, so it is kept from below
+   const mm::mat4 mirrored = mm::scale(mm::translate(mm::mat4(), mm::vec3(16.0f, -5.0f, 10.0f)), mm::vec3(-1.0f, 1.0f, 1.0f));
+
+   EXPECT_EQ(CullGrid(meshlets, mm::vec3(0.0f, -30.0f, -40.0f), mirrored), allCount);
+}
+
+TEST(Meshlets, ConeKeepsEdgeOnMeshlets)
+{
+   //Camera in the plane of the triangles sees their edges, the sphere around them must keep them
+   EXPECT_FALSE(graphics::IsConeBackfacing(mm::vec3(0.0f), 1.0f, mm::vec3(0.0f, 1.0f, 0.0f), 1.0f, 0.0f, mm::vec3(10.0f, 0.0f, 0.0f)));
+   EXPECT_TRUE(graphics::IsConeBackfacing(mm::vec3(0.0f), 1.0f, mm::vec3(0.0f, 1.0f, 0.0f), 1.0f, 0.0f, mm::vec3(0.0f, -10.0f, 0.0f)));
+
+   //Wide cone isn't culled from the slanted view that the narrow one is
+   const mm::vec3 slanted(5.0f, -10.0f, 0.0f);
+   EXPECT_TRUE(graphics::IsConeBackfacing(mm::vec3(0.0f), 1.0f, mm::vec3(0.0f, 1.0f, 0.0f), 0.98f, sqrtf(1.0f - 0.98f * 0.98f), slanted));
+   EXPECT_FALSE(graphics::IsConeBackfacing(mm::vec3(0.0f), 1.0f, mm::vec3(0.0f, 1.0f, 0.0f), 0.5f, sqrtf(0.75f), slanted));
+}
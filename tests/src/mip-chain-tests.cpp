@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "asset-manager/cook/mip-chain.h"
+
+using namespace assets;
+using namespace assets::cook;
+
+namespace
+{
+   std::vector<uint8_t> BuildLevel(const std::vector<uint8_t>& pixels, const int32_t width, const int32_t height, const int32_t channels,
+                                   const MipFilter filter, const size_t level)
+   {
+      PixelBuffer chain;
+      std::vector<MipLevel> mips;
+
+      EXPECT_TRUE(BuildMipChain(pixels.data(), width, height, channels, filter, chain, mips));
+      EXPECT_EQ(mips.size(), GetMipsCount(width, height));
+
+      const MipLevel& mip = mips[level];
+      return std::vector<uint8_t>(chain.get() + mip.Offset, chain.get() + mip.Offset + mip.Size);
+   }
+}
+
+TEST(MipChain, OddSizesKeepEdges)
+{
+   //Only the last column is lit, the even filter would drop it from the 2x1 level
+   std::vector<uint8_t> pixels(5 * 3, 0);
+   for (size_t y = 0; y < 3; ++y)
+      pixels[y * 5 + 4] = 255;
+
+   const std::vector<uint8_t> level1 = BuildLevel(pixels, 5, 3, 1, MipFilter::Linear, 1);
+   ASSERT_EQ(level1.size(), 2);
+
+   //Second texel covers the 2/5 of the column 4
+   EXPECT_EQ(level1[0], 0);
+   EXPECT_EQ(level1[1], 102);
+
+   //Whole image averages to the 1/5 of the column
+   EXPECT_EQ(BuildLevel(pixels, 5, 3, 1, MipFilter::Linear, 2)[0], 51);
+
+   //Weights of every texel sum to 1, so the flat image stays flat at every level
+   const std::vector<uint8_t> flat(7 * 5 * 4, 200);
+
+   for (size_t level = 1; level < GetMipsCount(7, 5); ++level)
+   {
+      for (uint8_t value : BuildLevel(flat, 7, 5, 4, MipFilter::Srgb, level))
+         EXPECT_NEAR(value, 200, 1);
+   }
+}
+
+TEST(MipChain, SrgbAveragedInLinearSpace)
+{
+   //Black and white, alpha is 0 and 255
+   const std::vector<uint8_t> pixels = { 0, 0, 0, 0, 255, 255, 255, 255 };
+
+   const std::vector<uint8_t> srgb = BuildLevel(pixels, 2, 1, 4, MipFilter::Srgb, 1);
+
+   //Linear 0.5 is 188 in sRGB, the alpha is averaged as is
+   EXPECT_NEAR(srgb[0], 188, 1);
+   EXPECT_NEAR(srgb[2], 188, 1);
+   EXPECT_NEAR(srgb[3], 128, 1);
+
+   EXPECT_NEAR(BuildLevel(pixels, 2, 1, 4, MipFilter::Linear, 1)[0], 128, 1);
+}
+
+TEST(MipChain, NormalsRenormalized)
+{
+   //+X and +Z normals, their average is shorter than 1 before the renormalization
+   const std::vector<uint8_t> pixels = { 255, 128, 128, 128, 128, 255 };
+
+   const std::vector<uint8_t> normal = BuildLevel(pixels, 2, 1, 3, MipFilter::Normal, 1);
+
+   const float x = normal[0] / 255.0f * 2.0f - 1.0f;
+   const float y = normal[1] / 255.0f * 2.0f - 1.0f;
+   const float z = normal[2] / 255.0f * 2.0f - 1.0f;
+
+   EXPECT_NEAR(sqrtf(x * x + y * y + z * z), 1.0f, 0.02f);
+   EXPECT_NEAR(x, z, 0.01f);
+   EXPECT_NEAR(y, 0.0f, 0.01f);
+}
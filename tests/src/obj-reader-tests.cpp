@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "asset-manager/obj/obj-reader.h"
+
+using namespace assets::obj;
+
+namespace
+{
+   //Grid of size x size quads with the shared UV and normal, every inner vertex is used by 6 corners
+   std::string GridObj(const uint32_t size)
+   {
+      std::string text = "# grid\nvt 0.5 0.5\nvn 0 1 0\n";
+
+      for (uint32_t z = 0; z <= size; ++z)
+      {
+         for (uint32_t x = 0; x <= size; ++x)
+            text += "v " + std::to_string(x) + " 0 " + std::to_string(z) + "\n";
+      }
+
+      for (uint32_t z = 0; z < size; ++z)
+      {
+         for (uint32_t x = 0; x < size; ++x)
+         {
+            const uint32_t i = z * (size + 1) + x + 1;
+            const std::string a = std::to_string(i) + "/1/1 ";
+            const std::string b = std::to_string(i + 1) + "/1/1 ";
+            const std::string c = std::to_string(i + size + 1) + "/1/1 ";
+            const std::string d = std::to_string(i + size + 2) + "/1/1 ";
+
+            text += "f " + a + c + b + "\r\nf " + b + c + d + "\r\n";
+         }
+      }
+
+      return text;
+   }
+
+   bool ReadInWindows(const std::string& text, const size_t windowSize, ObjMesh& res, const size_t memoryLimit = 0)
+   {
+      ObjReader reader(memoryLimit);
+
+      for (size_t i = 0; i < text.size(); i += windowSize)
+      {
+         if (!reader.Feed(text.data() + i, std::min(windowSize, text.size() - i)))
+            return false;
+      }
+
+      return reader.Finish(res);
+   }
+}
+
+TEST(ObjReader, WindowsGiveSameMesh)
+{
+   const uint32_t size = 8;
+   const std::string text = GridObj(size);
+
+   ObjMesh whole;
+   ASSERT_TRUE(ReadInWindows(text, text.size(), whole));
+
+   //Corners are welded while they are read, the vertices are in the order of the first use
+   EXPECT_EQ(whole.Positions.size(), (size + 1) * (size + 1));
+   EXPECT_EQ(whole.Indices.size(), size * size * 6);
+   EXPECT_EQ(whole.Indices[4], 1);
+   EXPECT_EQ(whole.Positions[1].z, 1.0f);
+   EXPECT_EQ(whole.Normals[0].y, 1.0f);
+   EXPECT_EQ(whole.UVs[0].x, 0.5f);
+
+   //Windows cut the lines and the numbers anywhere, even between \r and \n
+   for (size_t windowSize : { 1, 2, 3, 7, 64, 1000 })
+   {
+      ObjMesh mesh;
+      ASSERT_TRUE(ReadInWindows(text, windowSize, mesh)) << windowSize;
+
+      EXPECT_EQ(mesh.Indices, whole.Indices) << windowSize;
+      ASSERT_EQ(mesh.Positions.size(), whole.Positions.size()) << windowSize;
+
+      for (size_t i = 0; i < mesh.Positions.size(); ++i)
+         EXPECT_EQ(mesh.Positions[i].x, whole.Positions[i].x);
+   }
+
+   //Last line doesn't need the line break
+   ObjMesh triangle;
+   ASSERT_TRUE(ReadInWindows("v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\nf 1/1/1 2/1/1 3/1/1", 5, triangle));
+   EXPECT_EQ(triangle.Indices, (std::vector<uint32_t>{ 0, 1, 2 }));
+}
+
+TEST(ObjReader, KeepsMemoryLimit)
+{
+   const std::string text = GridObj(64);
+
+   ObjReader unlimited;
+   ASSERT_TRUE(unlimited.Feed(text.data(), text.size()));
+
+   ObjMesh mesh;
+   ASSERT_TRUE(unlimited.Finish(mesh));
+
+   const size_t peakBytes = unlimited.GetPeakBytes();
+
+   //Final buffers are the part of the peak, the source attributes and the growth of the vectors are the rest
+   const size_t meshBytes = mesh.Positions.size() * (sizeof(mm::vec3) * 2 + sizeof(mm::vec2)) + mesh.Indices.size() * sizeof(uint32_t);
+   EXPECT_GE(peakBytes, meshBytes);
+   EXPECT_LT(peakBytes, meshBytes * 3);
+
+   //Growth near the limit is cut to fit, so the limit is never crossed
+   ObjMesh limitedMesh;
+   ASSERT_TRUE(ReadInWindows(text, 4096, limitedMesh, peakBytes));
+   EXPECT_EQ(limitedMesh.Indices, mesh.Indices);
+
+   ObjReader limited(peakBytes);
+   limited.Feed(text.data(), text.size());
+   EXPECT_LE(limited.GetPeakBytes(), peakBytes);
+
+   ObjMesh failed;
+   EXPECT_FALSE(ReadInWindows(text, 4096, failed, meshBytes));
+}
+
+TEST(ObjReader, LongLineKeepsMemoryLimit)
+{
+   //Comment without the line break spans all the windows, so it is carried between them
+   const std::string text = "v 0 0 0\n#" + std::string(64 * 1024, 'x');
+
+   ObjMesh mesh;
+   EXPECT_TRUE(ReadInWindows(text, 1024, mesh, 256 * 1024));
+
+   ObjReader reader(16 * 1024);
+   bool isFed = true;
+
+   for (size_t i = 0; i < text.size() && isFed; i += 1024)
+      isFed = reader.Feed(text.data() + i, std::min<size_t>(1024, text.size() - i));
+
+   EXPECT_FALSE(isFed);
+   EXPECT_NE(reader.GetError(), nullptr);
+   EXPECT_LE(reader.GetPeakBytes(), 16 * 1024);
+}
+
+TEST(ObjReader, RejectsInvalidFaces)
+{
+   ObjMesh mesh;
+
+   EXPECT_FALSE(ReadInWindows("v 0 0 0\nvt 0 0\nvn 0 0 1\nf 1/1/1 2/1/1 1/1/1\n", 4, mesh));
+   EXPECT_FALSE(ReadInWindows("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", 4, mesh));
+   EXPECT_FALSE(ReadInWindows("v 0 x 0\n", 4, mesh));
+
+   ObjReader reader;
+   EXPECT_FALSE(reader.Feed("vn 0 0\n", 7));
+   EXPECT_NE(reader.GetError(), nullptr);
+
+   //Reader ignores the input after the error
+   EXPECT_FALSE(reader.Feed("v 0 0 0\n", 8));
+   EXPECT_FALSE(reader.Finish(mesh));
+}
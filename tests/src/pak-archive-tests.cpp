@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "asset-manager/pak/pak-writer.h"
+#include "asset-manager/pak/pak-archive.h"
+
+using namespace assets;
+
+namespace
+{
+   std::vector<uint8_t> MakeEntry(const size_t size, const uint8_t seed)
+   {
+      std::vector<uint8_t> data(size);
+      for (size_t i = 0; i < size; ++i)
+         data[i] = static_cast<uint8_t>(i % 13 + seed);
+
+      return data;
+   }
+
+   bool ReadEntry(const pak::Archive& archive, const uint64_t pathHash, std::vector<uint8_t>& result)
+   {
+      const pak::TocEntry* entry = archive.Find(pathHash);
+      if (!entry)
+         return false;
+
+      RawData data;
+      if (!archive.Read(*entry, data))
+         return false;
+
+      result.assign(data.Data, data.Data + data.Size);
+      return true;
+   }
+
+   //Changes the Size of the first entry in the table of contents of the written archive
+   void CorruptSize(const std::string& path, const uint64_t size)
+   {
+      FILE* file = fopen(path.c_str(), "r+b");
+      ASSERT_TRUE(file);
+
+      pak::Header header;
+      ASSERT_EQ(fread(&header, sizeof(header), 1, file), 1);
+
+      pak::TocEntry entry;
+      ASSERT_EQ(fseek(file, static_cast<long>(header.TocOffset), SEEK_SET), 0);
+      ASSERT_EQ(fread(&entry, sizeof(entry), 1, file), 1);
+
+      entry.Size = size;
+
+      ASSERT_EQ(fseek(file, static_cast<long>(header.TocOffset), SEEK_SET), 0);
+      ASSERT_EQ(fwrite(&entry, sizeof(entry), 1, file), 1);
+
+      fclose(file);
+   }
+}
+
+TEST(PakArchive, ReadsStoredAndCompressedEntries)
+{
+   const std::string path = "pak-archive-test.pak";
+
+   const std::vector<uint8_t> compressible = MakeEntry(4096, 1);
+   const std::vector<uint8_t> small = MakeEntry(3, 2);
+
+   pak::Writer writer;
+   ASSERT_TRUE(writer.Open(path));
+   ASSERT_TRUE(writer.AddEntry(20, compressible.data(), compressible.size(), true));
+   ASSERT_TRUE(writer.AddEntry(10, small.data(), small.size(), true, pak::EF_COOKED));
+   ASSERT_TRUE(writer.Finish());
+
+   {
+      pak::Archive archive;
+      ASSERT_TRUE(archive.Mount(path));
+
+      //Too small entry gains nothing from the compression, so it is stored
+      ASSERT_TRUE(archive.Find(20));
+      ASSERT_TRUE(archive.Find(10));
+      EXPECT_TRUE(archive.Find(20)->Flags & pak::EF_COMPRESSED);
+      EXPECT_EQ(archive.Find(10)->Flags, pak::EF_COOKED);
+      EXPECT_FALSE(archive.Find(15));
+
+      std::vector<uint8_t> data;
+      ASSERT_TRUE(ReadEntry(archive, 20, data));
+      EXPECT_EQ(data, compressible);
+
+      ASSERT_TRUE(ReadEntry(archive, 10, data));
+      EXPECT_EQ(data, small);
+   }
+
+   remove(path.c_str());
+}
+
+TEST(PakArchive, RejectsDuplicatePaths)
+{
+   const std::string path = "pak-archive-test.pak";
+
+   const std::vector<uint8_t> data = MakeEntry(100, 1);
+
+   pak::Writer writer;
+   ASSERT_TRUE(writer.Open(path));
+   ASSERT_TRUE(writer.AddEntry(1, data.data(), data.size(), false));
+
+   //Same hash is refused whatever the data is, the first entry stays
+   EXPECT_FALSE(writer.AddEntry(1, data.data(), data.size(), false));
+   EXPECT_FALSE(writer.AddEntry(1, data.data(), 10, true));
+
+   ASSERT_TRUE(writer.AddEntry(2, data.data(), 10, false));
+   ASSERT_TRUE(writer.Finish());
+
+   ASSERT_EQ(writer.GetToc().size(), 2);
+   EXPECT_EQ(writer.GetToc()[0].Size, data.size());
+
+   remove(path.c_str());
+}
+
+TEST(PakArchive, RejectsMismatchedStoredSize)
+{
+   const std::string path = "pak-archive-test.pak";
+
+   const std::vector<uint8_t> data = MakeEntry(100, 1);
+
+   pak::Writer writer;
+   ASSERT_TRUE(writer.Open(path));
+   ASSERT_TRUE(writer.AddEntry(1, data.data(), data.size(), false));
+   ASSERT_TRUE(writer.Finish());
+
+   //Bigger size of the stored entry would expose the table of contents after it
+   CorruptSize(path, data.size() + 64);
+
+   {
+      pak::Archive archive;
+      ASSERT_TRUE(archive.Mount(path));
+
+      std::vector<uint8_t> result;
+      EXPECT_FALSE(ReadEntry(archive, 1, result));
+   }
+
+   CorruptSize(path, data.size() - 1);
+
+   {
+      pak::Archive archive;
+      ASSERT_TRUE(archive.Mount(path));
+
+      std::vector<uint8_t> result;
+      EXPECT_FALSE(ReadEntry(archive, 1, result));
+   }
+
+   remove(path.c_str());
+}
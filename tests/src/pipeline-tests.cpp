@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "jobs/pipeline.h"
+
+using namespace core;
+
+namespace
+{
+   struct TestItem
+   {
+      uint32_t Value;
+      uint32_t Stages;
+   };
+
+   //Odd items fail in the second stage
+   bool CountingStage(uintptr_t item, uintptr_t args)
+   {
+      TestItem* test = reinterpret_cast<TestItem*>(item);
+
+      return ++test->Stages == 1 || test->Value % 2 == 0;
+   }
+}
+
+TEST(Pipeline, KeepsStageLimits)
+{
+   std::vector<TestItem> items(32);
+
+   std::vector<uint32_t> uploaded;
+
+   const StageFunc upload = [](uintptr_t item, uintptr_t args)
+   {
+      reinterpret_cast<std::vector<uint32_t>*>(args)->push_back(reinterpret_cast<TestItem*>(item)->Value);
+      return true;
+   };
+
+   Pipeline pipeline({ { CountingStage, 0, 2 },
+                       { CountingStage, 0, 3 },
+                       { upload, reinterpret_cast<uintptr_t>(&uploaded), 1, true } }, 4);
+
+   for (uint32_t i = 0; i < items.size(); ++i)
+   {
+      items[i] = { i, 0 };
+      pipeline.Add(reinterpret_cast<uintptr_t>(&items[i]));
+   }
+
+   pipeline.Drain();
+
+   EXPECT_TRUE(pipeline.IsDone());
+
+   //Every item has passed both stages, the failed ones don't reach the upload
+   for (auto& item : items)
+      EXPECT_EQ(item.Stages, 2);
+
+   EXPECT_EQ(uploaded.size(), items.size() / 2);
+
+   for (uint32_t value : uploaded)
+      EXPECT_EQ(value % 2, 0);
+
+   EXPECT_EQ(pipeline.GetStats(1).Failed, items.size() / 2);
+   EXPECT_EQ(pipeline.GetStats(2).Processed, items.size() / 2);
+
+   //Stage limits and the queue bound hold
+   EXPECT_LE(pipeline.GetStats(0).MaxRunning, 2);
+   EXPECT_LE(pipeline.GetStats(1).MaxRunning, 3);
+   EXPECT_LE(pipeline.GetStats(1).MaxQueued, 4);
+   EXPECT_LE(pipeline.GetStats(2).MaxQueued, 4);
+   EXPECT_EQ(pipeline.GetStats(2).MaxRunning, 1);
+}
+
+TEST(Pipeline, SlowStageHoldsBackEarlierOnes)
+{
+   std::vector<TestItem> items(8);
+
+   //Nothing takes the items from the last queue until the pump runs the main thread stage
+   const StageFunc upload = [](uintptr_t item, uintptr_t args) { return true; };
+
+   Pipeline pipeline({ { CountingStage, 0, 4 },
+                       { upload, 0, 1, true } }, 3);
+
+   for (uint32_t i = 0; i < items.size(); ++i)
+   {
+      items[i] = { i, 0 };
+      pipeline.Add(reinterpret_cast<uintptr_t>(&items[i]));
+   }
+
+   //Queue of 3 lets only 3 of the 4 slots start
+   pipeline.Pump();
+
+   EXPECT_EQ(pipeline.GetStats(0).MaxRunning, 3);
+
+   pipeline.Drain();
+
+   EXPECT_LE(pipeline.GetStats(1).MaxQueued, 3);
+   EXPECT_EQ(pipeline.GetStats(1).Processed, items.size());
+}
+
+TEST(Pipeline, AsyncStageCompletesLater)
+{
+   struct AsyncState
+   {
+      Pipeline* Owner = nullptr;
+      std::vector<uintptr_t> Started;
+      size_t Flushes = 0;
+   };
+
+   std::vector<TestItem> items(6);
+   AsyncState state;
+
+   //Items are completed by the test after the pump, odd ones fail to start
+   const StageFunc start = [](uintptr_t item, uintptr_t args)
+   {
+      if (reinterpret_cast<TestItem*>(item)->Value % 2)
+         return false;
+
+      reinterpret_cast<AsyncState*>(args)->Started.push_back(item);
+      return true;
+   };
+
+   const StageFlushFunc flush = [](uintptr_t args) { ++reinterpret_cast<AsyncState*>(args)->Flushes; };
+
+   Pipeline pipeline({ { start, reinterpret_cast<uintptr_t>(&state), 2, false, true, flush },
+                       { CountingStage, 0, 1, true } }, 4);
+
+   state.Owner = &pipeline;
+
+   for (uint32_t i = 0; i < items.size(); ++i)
+   {
+      items[i] = { i, 0 };
+      pipeline.Add(reinterpret_cast<uintptr_t>(&items[i]));
+   }
+
+   while (!pipeline.IsDone())
+   {
+      pipeline.Pump();
+
+      for (uintptr_t item : state.Started)
+         state.Owner->Complete(0, item, true);
+
+      state.Started.clear();
+   }
+
+   EXPECT_LE(pipeline.GetStats(0).MaxRunning, 2);
+   EXPECT_EQ(pipeline.GetStats(0).Failed, items.size() / 2);
+   EXPECT_EQ(pipeline.GetStats(1).Processed, items.size() / 2);
+   EXPECT_GT(state.Flushes, 0);
+}
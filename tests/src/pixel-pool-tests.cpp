@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "asset-manager/pixel-pool.h"
+
+using namespace assets;
+
+//Stats are global, so only their changes by the test are checked
+TEST(PixelPool, ReusesReleasedBuffers)
+{
+   PixelPool::Trim();
+
+   const PixelPoolStats start = PixelPool::GetStats();
+   EXPECT_EQ(start.CachedBytes, 0);
+
+   //10000 bytes are in the 16K class
+   void* first = PixelPool::Allocate(10'000);
+   ASSERT_NE(first, nullptr);
+
+   PixelPoolStats stats = PixelPool::GetStats();
+   EXPECT_EQ(stats.Misses, start.Misses + 1);
+   EXPECT_EQ(stats.LiveBytes, start.LiveBytes + 16 * 1024);
+   EXPECT_GE(stats.PeakLiveBytes, stats.LiveBytes);
+
+   PixelPool::Free(first);
+
+   stats = PixelPool::GetStats();
+   EXPECT_EQ(stats.LiveBytes, start.LiveBytes);
+   EXPECT_EQ(stats.CachedBytes, 16 * 1024);
+
+   //Another size of the same class gets the cached buffer
+   void* second = PixelPool::Allocate(9'000);
+   EXPECT_EQ(second, first);
+
+   stats = PixelPool::GetStats();
+   EXPECT_EQ(stats.Hits, start.Hits + 1);
+   EXPECT_EQ(stats.CachedBytes, 0);
+
+   //Growth inside of the class keeps the buffer
+   EXPECT_EQ(PixelPool::Reallocate(second, 16 * 1024), second);
+
+   PixelPool::Free(second);
+
+   //Small allocations aren't pooled
+   void* small = PixelPool::Allocate(100);
+   ASSERT_NE(small, nullptr);
+   PixelPool::Free(small);
+
+   stats = PixelPool::GetStats();
+   EXPECT_EQ(stats.Hits + stats.Misses, start.Hits + start.Misses + 2);
+}
+
+TEST(PixelPool, KeepsCacheInBudget)
+{
+   PixelPool::Trim();
+
+   void* buffers[4];
+   for (auto& buffer : buffers)
+      buffer = PixelPool::Allocate(64 * 1024);
+
+   PixelPool::SetCacheBudget(128 * 1024);
+
+   for (auto& buffer : buffers)
+      PixelPool::Free(buffer);
+
+   //Buffers above the budget go back to the system
+   EXPECT_EQ(PixelPool::GetStats().CachedBytes, 128 * 1024);
+
+   PixelPool::SetCacheBudget(64 * 1024);
+   EXPECT_EQ(PixelPool::GetStats().CachedBytes, 64 * 1024);
+
+   PixelPool::SetCacheBudget(PixelPool::DefaultCacheBudget);
+   PixelPool::Trim();
+   EXPECT_EQ(PixelPool::GetStats().CachedBytes, 0);
+}
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "graphics/render-sort.h"
+
+using namespace graphics;
+
+namespace
+{
+   //Keys like the ones of the scene: few layers and materials, the depth of every draw is different
+   std::vector<SortItem> MakeItems(const size_t count)
+   {
+      std::mt19937 random(7);
+
+      std::vector<SortItem> items(count);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         RenderKeyParams params;
+         params.Layer = random() % 8 ? Layer::Normal : Layer::Debug;
+         params.IsTranslucent = random() % 10 == 0;
+         params.MaterialId = random() % 300;
+         params.ViewDepth = static_cast<float>(random() % 100'000) / 100.0f;
+         params.FarDepth = 1000.0f;
+
+         items[i] = { BuildRenderKey(params).KeyId, static_cast<uint32_t>(i) };
+      }
+
+      return items;
+   }
+
+   void ExpectSorted(const std::vector<SortItem>& items, std::vector<SortItem> expected)
+   {
+      std::stable_sort(expected.begin(), expected.end(),
+                       [](auto& left, auto& right)
+                       {
+                          return left.Key < right.Key;
+                       });
+
+      ASSERT_EQ(items.size(), expected.size());
+
+      for (size_t i = 0; i < items.size(); ++i)
+      {
+         ASSERT_EQ(items[i].Key, expected[i].Key);
+         ASSERT_EQ(items[i].Index, expected[i].Index);
+      }
+   }
+}
+
+TEST(RenderSort, KeyOrder)
+{
+   RenderKeyParams near;
+   near.ViewDepth = 1.0f;
+   near.FarDepth = 100.0f;
+
+   RenderKeyParams far = near;
+   far.ViewDepth = 50.0f;
+
+   //Opaque go from the front, translucent from the back
+   EXPECT_LT(BuildRenderKey(near).KeyId, BuildRenderKey(far).KeyId);
+
+   near.IsTranslucent = far.IsTranslucent = true;
+   EXPECT_GT(BuildRenderKey(near).KeyId, BuildRenderKey(far).KeyId);
+
+   //Opaque are before the translucent and grouped by the material before the depth
+   RenderKeyParams opaque;
+   opaque.MaterialId = 3;
+   opaque.ViewDepth = 99.0f;
+   opaque.FarDepth = 100.0f;
+
+   RenderKeyParams otherMaterial = opaque;
+   otherMaterial.MaterialId = 4;
+   otherMaterial.ViewDepth = 0.0f;
+
+   EXPECT_LT(BuildRenderKey(opaque).KeyId, BuildRenderKey(otherMaterial).KeyId);
+   EXPECT_LT(BuildRenderKey(otherMaterial).KeyId, BuildRenderKey(far).KeyId);
+
+   //Layer is above everything, the depth beyond the far is clamped
+   RenderKeyParams debug;
+   debug.Layer = Layer::Debug;
+
+   RenderKeyParams beyond = opaque;
+   beyond.ViewDepth = 1e6f;
+
+   EXPECT_LT(BuildRenderKey(far).KeyId, BuildRenderKey(debug).KeyId);
+   EXPECT_EQ(BuildRenderKey(beyond).Depth, (1u << RenderKeyDepthBits) - 1);
+
+   //Views replace only the depth of the key
+   EXPECT_EQ(QuantizeRenderDepth(far.ViewDepth, far.FarDepth, true), BuildRenderKey(far).Depth);
+   EXPECT_EQ(QuantizeRenderDepth(-5.0f, 100.0f, false), 0);
+}
+
+TEST(RenderSort, SortsStable)
+{
+   RenderSorter sorter;
+
+   for (size_t count : { 0, 1, 2, 1000 })
+   {
+      std::vector<SortItem> items = MakeItems(count);
+      const std::vector<SortItem> source = items;
+
+      sorter.Sort(items);
+      ExpectSorted(items, source);
+   }
+
+   //Equal keys keep the order of the queue
+   std::vector<SortItem> items = { { 5, 0 }, { 1, 1 }, { 5, 2 }, { 1, 3 }, { 5, 4 } };
+   sorter.Sort(items);
+
+   const uint32_t expected[] = { 1, 3, 0, 2, 4 };
+
+   for (size_t i = 0; i < items.size(); ++i)
+      EXPECT_EQ(items[i].Index, expected[i]);
+}
+
+TEST(RenderSort, ParallelMatchesSerial)
+{
+   RenderSorter sorter;
+
+   std::vector<SortItem> items = MakeItems(100'000);
+   const std::vector<SortItem> source = items;
+
+   sorter.Sort(items, true);
+   ExpectSorted(items, source);
+
+   //Scratch is reused by the next sort
+   items = source;
+   sorter.Sort(items, true);
+   ExpectSorted(items, source);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "math/math.h"
+#include "graphics/camera/camera.h"
+
+//Meshes and cameras that several test files build their cases on
+namespace fixtures
+{
+   struct IndexedMesh
+   {
+      std::vector<mm::vec3> Positions;
+      std::vector<uint32_t> Indices;
+   };
+
+   //Indices of the size x size quads, the vertices are the (size + 1) x (size + 1) grid
+   inline std::vector<uint32_t> GridIndices(const uint32_t size)
+   {
+      std::vector<uint32_t> indices;
+
+      for (uint32_t z = 0; z < size; ++z)
+      {
+         for (uint32_t x = 0; x < size; ++x)
+         {
+            const uint32_t i = z * (size + 1) + x;
+            indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+         }
+      }
+
+      return indices;
+   }
+
+   //Square of the size x size quads in the XZ plane facing up
+   inline IndexedMesh Grid(const uint32_t size)
+   {
+      IndexedMesh mesh;
+
+      for (uint32_t z = 0; z <= size; ++z)
+      {
+         for (uint32_t x = 0; x <= size; ++x)
+            mesh.Positions.emplace_back(static_cast<float>(x), 0.0f, static_cast<float>(z));
+      }
+
+      mesh.Indices = GridIndices(size);
+
+      return mesh;
+   }
+
+   //Camera at the position looks along +Z, as the engine projection does, its field of view is 90 degrees
+   inline graphics::Camera ViewCamera(const mm::vec3& position)
+   {
+      graphics::Camera camera;
+      camera.Position = position;
+      camera.ForwardAxis = mm::vec3(0.0f, 0.0f, 1.0f);
+      camera.RightAxis = mm::vec3(1.0f, 0.0f, 0.0f);
+      camera.UpAxis = mm::vec3(0.0f, 1.0f, 0.0f);
+      camera.Fov = 3.14159265f / 2.0f;
+      camera.Aspect = 1.0f;
+      camera.Perspective = true;
+
+      return camera;
+   }
+}
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include <iostream>
+#include <cstring>
 
 #include "math/math.h"
 
@@ -38,8 +39,14 @@ TEST(VectorMath, Functions)
    EXPECT_EQ(mm::length(v3), 3.0f);
 }
 
+//Cook worker of the CookWorker tests is this executable
+int RunTestCookWorker();
+
 int main(int argc, char* argv[])
 {
+   if (argc > 1 && !strcmp(argv[1], "--cook-worker"))
+      return RunTestCookWorker();
+
    ::testing::InitGoogleTest(&argc, argv);
 
    RUN_ALL_TESTS();
@@ -0,0 +1,288 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "graphics/streaming/mip-selection.h"
+#include "asset-manager/cook/mip-chain.h"
+#include "graphics/streaming/texture-streamer.h"
+#include "test-fixtures.h"
+
+using namespace graphics;
+using namespace graphics::streaming;
+
+namespace
+{
+   MipSelectionParams Params(const float radius, const float distance)
+   {
+      MipSelectionParams params;
+      params.BoundingRadius = radius;
+      params.Distance = distance;
+      params.Fov = 3.14159265f / 2.0f; //tan(fov / 2) = 1, so the projected size is radius / distance * height
+      params.ViewportHeight = 1024.0f;
+
+      return params;
+   }
+
+   ResidencyRequest Request(const uint16_t levelsCount, const uint16_t wantedLevel, const float priority)
+   {
+      ResidencyRequest request = {};
+      request.LevelsCount = levelsCount;
+      request.WantedLevel = wantedLevel;
+      request.Priority = priority;
+
+      //Square RGBA8 texture
+      for (uint16_t i = 0; i < levelsCount; ++i)
+      {
+         const uint64_t size = 1ull << (levelsCount - 1 - i);
+         request.LevelSizes[i] = size * size * 4;
+      }
+
+      return request;
+   }
+
+   //Storage is only counted, the levels written into it have to be inside it
+   class MockTexture2D : public Texture2D
+   {
+   public:
+      uint16_t SizeX = 0;
+      uint16_t SizeY = 0;
+      uint16_t LevelsCount = 0;
+
+      void InitData(const uint16_t sizeX, const uint16_t sizeY, const InternalFormat internalFormat, const Format format,
+                    const Type type, const TextureParams& params, const uint16_t levelsCount = 1) override
+      {
+         SizeX = sizeX;
+         SizeY = sizeY;
+         LevelsCount = levelsCount;
+      }
+
+      void UpdateData(const size_t sizeX, const size_t sizeY, const void* data, const uint16_t level = 0) override
+      {
+         ASSERT_LT(level, LevelsCount);
+         EXPECT_EQ(sizeX, std::max(1, SizeX >> level));
+         EXPECT_EQ(sizeY, std::max(1, SizeY >> level));
+      }
+
+      void UpdateCompressedData(const size_t sizeX, const size_t sizeY, const void* data, const size_t dataSize,
+                                const uint16_t level = 0) override {}
+
+      void Reallocate(const uint16_t sizeX, const uint16_t sizeY, const uint16_t levelsCount, const int32_t levelShift) override
+      {
+         InitData(sizeX, sizeY, InternalFormat::RGBA8, Format::RGBA, Type::Ubyte, {}, levelsCount);
+      }
+
+      void SetBorderColor(const mm::vec4& color) const override {}
+
+      uint16_t GetSizeX() const override { return SizeX; }
+      uint16_t GetSizeY() const override { return SizeY; }
+      uint16_t GetLevelsCount() const override { return LevelsCount; }
+
+      //RGBA8 levels of the storage
+      uint64_t GetAllocatedBytes() const
+      {
+         uint64_t bytes = 0;
+         for (uint16_t i = 0; i < LevelsCount; ++i)
+            bytes += static_cast<uint64_t>(std::max(1, SizeX >> i)) * std::max(1, SizeY >> i) * 4;
+
+         return bytes;
+      }
+   };
+
+   //Only the textures are created, the streamer doesn't draw
+   class MockGraphicsDevice : public GraphicsDevice
+   {
+   public:
+      std::vector<std::shared_ptr<MockTexture2D>> Textures;
+
+      std::shared_ptr<Canvas> CreateCanvas(const uint16_t sizeX, const uint16_t sizeY, const std::string_view& title) override { return nullptr; }
+      std::shared_ptr<ShaderProgram> CreateShaderProgram() override { return nullptr; }
+      std::shared_ptr<ComputeShader> CreateComputeShader() override { return nullptr; }
+
+      std::shared_ptr<Texture2D> CreateTexture2D() override
+      {
+         return Textures.emplace_back(std::make_shared<MockTexture2D>());
+      }
+
+      std::shared_ptr<Cubemap> CreateCubemap() override { return nullptr; }
+      std::shared_ptr<VertexBuffer> CreateVBO() override { return nullptr; }
+      std::shared_ptr<IndexBuffer> CreateIBO() override { return nullptr; }
+      std::shared_ptr<UniformBuffer> CreateUBO() override { return nullptr; }
+      std::shared_ptr<ShaderBuffer> CreateSBO() override { return nullptr; }
+      std::shared_ptr<Framebuffer> CreateFBO() override { return nullptr; }
+
+      std::string GetDeviceInfo() const override { return "mock"; }
+      void EnableFeature(const Feature feature) const override {}
+      void DisableFeature(const Feature feature) const override {}
+      void Clear() override {}
+      void SetViewport(const mm::ivec2& origin, const mm::ivec2& size) const override {}
+      void SetClearColor(const mm::vec4& color) const override {}
+      void SetBlendSettings(const BlendFunc func, const BlendValue src, const BlendValue dst) const override {}
+      void SetCullingFace(const Face face) const override {}
+      void DrawTriangles(const std::shared_ptr<ShaderProgram>& program, const size_t verticesCount, const size_t firstVertex = 0) const override {}
+      void DrawIndexedTriangles(const std::shared_ptr<ShaderProgram>& program, const void* const* indexOffsets, const int32_t* indicesCounts,
+                                const size_t rangesCount, const int32_t* baseVertices = nullptr) const override {}
+   };
+
+   class StreamedMaterial : public BaseMaterial
+   {
+   public:
+      Texture2D* Texture = nullptr;
+
+      void CollectTextures(std::vector<Texture2D*>& textures) const override
+      {
+         textures.push_back(Texture);
+      }
+   };
+
+   constexpr int32_t StreamedSize = 256;
+
+   //Levels of the RGBA8 256 x 256 image, the args count the loads
+   assets::PixelsData LoadLevels(const std::string_view& filepath, const size_t firstLevel, const size_t levelsCount, uintptr_t args)
+   {
+      ++*reinterpret_cast<size_t*>(args);
+
+      const size_t chainCount = assets::cook::GetMipsCount(StreamedSize, StreamedSize);
+
+      assets::PixelsData image;
+      image.Width = StreamedSize;
+      image.Height = StreamedSize;
+      image.Channels = 4;
+      image.FirstLevel = static_cast<int32_t>(std::min(firstLevel, chainCount - 1));
+
+      uint64_t offset = 0;
+      for (size_t i = image.FirstLevel; i < chainCount && i - image.FirstLevel < levelsCount; ++i)
+      {
+         const int32_t size = std::max(1, StreamedSize >> i);
+
+         image.Mips.push_back({ size, size, offset, static_cast<uint64_t>(size) * size * 4 });
+         offset += image.Mips.back().Size;
+      }
+
+      image.Pixels.reset(static_cast<uint8_t*>(assets::PixelPool::Allocate(offset)));
+      image.IsValid = true;
+
+      return image;
+   }
+}
+
+TEST(MipSelection, FollowsScreenSize)
+{
+   //Bounds cover the whole 1024 pixels viewport, so the 1024 texture is needed in full
+   EXPECT_EQ(SelectMipLevel(1024, 1024, Params(1.0f, 1.0f + 1e-3f)), 0);
+
+   //Every doubling of the distance halves the projected size
+   EXPECT_EQ(SelectMipLevel(1024, 1024, Params(1.0f, 2.0f)), 1);
+   EXPECT_EQ(SelectMipLevel(1024, 1024, Params(1.0f, 4.0f)), 2);
+   EXPECT_EQ(SelectMipLevel(1024, 1024, Params(1.0f, 64.0f)), 6);
+
+   //Clamped to the last level
+   EXPECT_EQ(SelectMipLevel(1024, 1024, Params(1.0f, 1e6f)), 10);
+
+   //Non square textures are selected by the bigger side
+   EXPECT_EQ(SelectMipLevel(1024, 256, Params(1.0f, 4.0f)), 2);
+}
+
+TEST(MipSelection, CameraInsideBounds)
+{
+   EXPECT_EQ(SelectMipLevel(4096, 4096, Params(10.0f, 5.0f)), 0);
+   EXPECT_FLOAT_EQ(GetProjectedSize(Params(10.0f, 5.0f)), 1024.0f);
+}
+
+TEST(MipSelection, Bias)
+{
+   MipSelectionParams params = Params(1.0f, 2.0f);
+   params.Bias = 1.0f;
+
+   EXPECT_EQ(SelectMipLevel(1024, 1024, params), 2);
+}
+
+TEST(ResidencyBudget, FitsWithoutDrops)
+{
+   std::vector<ResidencyRequest> requests = { Request(11, 0, 100.0f), Request(11, 3, 10.0f) };
+
+   const uint64_t wanted = GetResidentSize(requests[0], 0) + GetResidentSize(requests[1], 3);
+
+   EXPECT_EQ(FitResidencyBudget(requests, wanted), wanted);
+   EXPECT_EQ(requests[0].ResidentLevel, 0);
+   EXPECT_EQ(requests[1].ResidentLevel, 3);
+}
+
+TEST(ResidencyBudget, DropsLeastImportantFirst)
+{
+   std::vector<ResidencyRequest> requests = { Request(11, 0, 1000.0f), Request(11, 0, 10.0f) };
+
+   //Room for one full chain and the second one without the level 0
+   const uint64_t budget = GetResidentSize(requests[0], 0) + GetResidentSize(requests[1], 1);
+
+   EXPECT_LE(FitResidencyBudget(requests, budget), budget);
+   EXPECT_EQ(requests[0].ResidentLevel, 0);
+   EXPECT_EQ(requests[1].ResidentLevel, 1);
+}
+
+TEST(ResidencyBudget, DegradesEvenly)
+{
+   //Equal textures lose the levels in turns
+   std::vector<ResidencyRequest> requests = { Request(11, 0, 100.0f), Request(11, 0, 100.0f) };
+
+   const uint64_t budget = GetResidentSize(requests[0], 2) * 2;
+
+   EXPECT_LE(FitResidencyBudget(requests, budget), budget);
+   EXPECT_EQ(requests[0].ResidentLevel, 2);
+   EXPECT_EQ(requests[1].ResidentLevel, 2);
+}
+
+TEST(ResidencyBudget, KeepsLastLevel)
+{
+   std::vector<ResidencyRequest> requests = { Request(11, 0, 100.0f), Request(5, 0, 1.0f) };
+
+   EXPECT_EQ(FitResidencyBudget(requests, 0), requests[0].LevelSizes[10] + requests[1].LevelSizes[4]);
+   EXPECT_EQ(requests[0].ResidentLevel, 10);
+   EXPECT_EQ(requests[1].ResidentLevel, 4);
+}
+
+TEST(TextureStreamer, AllocatesResidentLevels)
+{
+   MockGraphicsDevice device;
+   size_t loadsCount = 0;
+
+   TextureStreamer streamer(device, LoadLevels, reinterpret_cast<uintptr_t>(&loadsCount), {}, 1024 * 1024);
+
+   auto texture = streamer.Register("texture.png");
+   MockTexture2D& storage = *device.Textures[0];
+
+   //Only the 1x1 level is read and allocated
+   EXPECT_EQ(storage.GetAllocatedBytes(), 4u);
+
+   auto material = std::make_shared<StreamedMaterial>();
+   material->Texture = texture.get();
+
+   auto mesh = std::make_shared<Mesh>();
+   mesh->Vertices.Positions = { mm::vec3(-1.0f), mm::vec3(1.0f) };
+   mesh->Material = material;
+   mesh->Scale = mm::vec3(1.0f);
+   mesh->Translate = mm::vec3(0.0f, 0.0f, 2.0f);
+
+   const Camera camera = fixtures::ViewCamera(mm::vec3(0.0f));
+   const std::vector<std::shared_ptr<Mesh>> meshes = { mesh };
+
+   //Mesh covers the viewport, the next update uploads the read levels
+   streamer.Update(camera, meshes, 1024.0f);
+   while (core::JobSystem::RunNext());
+   streamer.Update(camera, meshes, 1024.0f);
+
+   const uint64_t fullBytes = storage.GetAllocatedBytes();
+
+   EXPECT_EQ(storage.GetSizeX(), StreamedSize);
+   EXPECT_EQ(streamer.GetStats().ResidentBytes, fullBytes);
+
+   //Dropped levels are freed without any load
+   streamer.SetBudget(64 * 1024);
+   streamer.Update(camera, meshes, 1024.0f);
+
+   EXPECT_LT(storage.GetAllocatedBytes(), fullBytes);
+   EXPECT_LE(storage.GetAllocatedBytes(), 64u * 1024);
+   EXPECT_EQ(streamer.GetStats().ResidentBytes, storage.GetAllocatedBytes());
+   EXPECT_EQ(streamer.GetStats().LoadsInFlight, 0u);
+   EXPECT_EQ(loadsCount, 2u);
+}
@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "asset-manager/cook/vertex-quantize.h"
+
+using namespace assets::cook;
+
+namespace
+{
+   struct FloatVertices
+   {
+      std::vector<mm::vec3> Positions;
+      std::vector<mm::vec3> Normals;
+      std::vector<mm::vec2> UVs;
+      std::vector<mm::vec3> Tangents;
+      std::vector<mm::vec3> Bitangents;
+
+      inline void Resize(const size_t count)
+      {
+         Positions.resize(count);
+         Normals.resize(count);
+         UVs.resize(count);
+         Tangents.resize(count);
+         Bitangents.resize(count);
+      }
+   };
+
+   mm::vec3 RandomDirection(std::mt19937& random)
+   {
+      std::normal_distribution<float> normal;
+      return mm::normalize(mm::vec3(normal(random), normal(random), normal(random)));
+   }
+
+   //Tangent frames of both handedness, the count isn't a multiple of 4 so the scalar tail is used too
+   FloatVertices RandomVertices(const size_t count)
+   {
+      std::mt19937 random(7);
+      std::uniform_real_distribution<float> position(-3.0f, 5.0f);
+      std::uniform_real_distribution<float> uv(-1.0f, 2.0f);
+
+      FloatVertices vertices;
+      vertices.Resize(count);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         vertices.Positions[i] = mm::vec3(position(random), position(random) * 0.1f, position(random));
+         vertices.Normals[i] = RandomDirection(random);
+
+         const mm::vec3 tangent = mm::cross(vertices.Normals[i], RandomDirection(random));
+         vertices.Tangents[i] = mm::normalize(tangent);
+
+         const float handedness = i % 3 == 0 ? -1.0f : 1.0f;
+         vertices.Bitangents[i] = mm::cross(vertices.Normals[i], vertices.Tangents[i]) * handedness;
+
+         vertices.UVs[i] = mm::vec2(uv(random), uv(random));
+      }
+
+      return vertices;
+   }
+}
+
+TEST(VertexQuantize, HalfFloats)
+{
+   EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+   EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+   EXPECT_EQ(FloatToHalf(0.5f), 0x3800);
+   EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+   EXPECT_EQ(FloatToHalf(65520.0f), 0x7c00);
+   EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+
+   //Tie between 1 and the next half rounds to the even mantissa
+   EXPECT_EQ(FloatToHalf(1.0f + 1.0f / 2048.0f), 0x3c00);
+   EXPECT_EQ(FloatToHalf(1.0f + 3.0f / 2048.0f), 0x3c02);
+
+   //Every finite half survives the round trip, subnormals too
+   for (uint32_t half = 0; half < 0x10000; ++half)
+   {
+      if ((half & 0x7c00) == 0x7c00)
+         continue;
+
+      ASSERT_EQ(FloatToHalf(HalfToFloat(static_cast<uint16_t>(half))), half) << half;
+   }
+
+   EXPECT_TRUE(std::isinf(HalfToFloat(0x7c00)));
+   EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(NAN))));
+}
+
+TEST(VertexQuantize, PackedVerticesRoundTrip)
+{
+   const size_t count = 1003;
+   const FloatVertices source = RandomVertices(count);
+
+   const VertexBounds bounds = ComputeVertexBounds(source.Positions.data(), count);
+
+   std::vector<PackedVertex> packed(count);
+   PackVertices(source.Positions.data(), source.Normals.data(), source.UVs.data(), source.Tangents.data(), source.Bitangents.data(),
+                count, bounds, packed.data());
+
+   FloatVertices res;
+   res.Resize(count);
+
+   UnpackVertices(packed.data(), count, bounds, res.Positions.data(), res.Normals.data(), res.UVs.data(), res.Tangents.data(), res.Bitangents.data());
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      //Half of the unorm step along every axis
+      EXPECT_NEAR(res.Positions[i].x, source.Positions[i].x, bounds.Scale.x / 65535.0f);
+      EXPECT_NEAR(res.Positions[i].y, source.Positions[i].y, bounds.Scale.y / 65535.0f);
+      EXPECT_NEAR(res.Positions[i].z, source.Positions[i].z, bounds.Scale.z / 65535.0f);
+
+      //Octahedral snorm16 is within ~0.01 degree
+      EXPECT_GT(mm::dot(res.Normals[i], source.Normals[i]), 0.99999f) << i;
+      EXPECT_GT(mm::dot(res.Tangents[i], source.Tangents[i]), 0.99999f) << i;
+      EXPECT_GT(mm::dot(res.Bitangents[i], source.Bitangents[i]), 0.9999f) << i;
+
+      EXPECT_NEAR(res.UVs[i].x, source.UVs[i].x, 1.0f / 1024.0f);
+      EXPECT_NEAR(res.UVs[i].y, source.UVs[i].y, 1.0f / 1024.0f);
+   }
+
+   //SSE kernels and the scalar tail give the same bits, the shifted range puts the vertices into the other one
+   std::vector<PackedVertex> shifted(count - 1);
+   PackVertices(source.Positions.data() + 1, source.Normals.data() + 1, source.UVs.data() + 1, source.Tangents.data() + 1,
+                source.Bitangents.data() + 1, count - 1, bounds, shifted.data());
+
+   EXPECT_EQ(memcmp(shifted.data(), packed.data() + 1, shifted.size() * sizeof(PackedVertex)), 0);
+}
+
+TEST(VertexQuantize, AxisAlignedFrames)
+{
+   //Poles and the folded corners of the octahedron are exact
+   const std::vector<mm::vec3> directions = { { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+                                              { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } };
+
+   const size_t count = directions.size();
+
+   FloatVertices source;
+   source.Resize(count);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      source.Positions[i] = mm::vec3(1.0f, 2.0f, 3.0f);
+      source.Normals[i] = directions[i];
+      source.Tangents[i] = directions[(i + 2) % count];
+      source.Bitangents[i] = mm::cross(source.Normals[i], source.Tangents[i]);
+      source.UVs[i] = mm::vec2(0.25f, 0.75f);
+   }
+
+   const VertexBounds bounds = ComputeVertexBounds(source.Positions.data(), count);
+
+   std::vector<PackedVertex> packed(count);
+   PackVertices(source.Positions.data(), source.Normals.data(), source.UVs.data(), source.Tangents.data(), source.Bitangents.data(),
+                count, bounds, packed.data());
+
+   FloatVertices res;
+   res.Resize(count);
+
+   UnpackVertices(packed.data(), count, bounds, res.Positions.data(), res.Normals.data(), res.UVs.data(), res.Tangents.data(), res.Bitangents.data());
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      //Single point has the zero bounds, every vertex is at the offset
+      EXPECT_EQ(res.Positions[i].x, 1.0f);
+      EXPECT_EQ(res.Positions[i].z, 3.0f);
+
+      EXPECT_NEAR(mm::dot(res.Normals[i], source.Normals[i]), 1.0f, 1e-6f) << i;
+      EXPECT_NEAR(mm::dot(res.Tangents[i], source.Tangents[i]), 1.0f, 1e-6f) << i;
+      EXPECT_EQ(res.UVs[i].x, 0.25f);
+      EXPECT_EQ(res.UVs[i].y, 0.75f);
+   }
+
+   //Vertex layout is more than twice smaller than the float one
+   EXPECT_LT(sizeof(PackedVertex) * 2, sizeof(mm::vec3) * 4 + sizeof(mm::vec2));
+}
@@ -0,0 +1,12 @@
+#include "asset-manager/asset-manager.h"
+#include "asset-manager/cook/cook-worker.h"
+
+//Cooks the loose assets for the AssetManager, it is started by the CookWorkerPool and talks to it over its stdin and stdout
+//Crash of the cook takes down only this process, the engine restarts it
+//
+//Usage: cook-worker
+
+int main(int argc, char* argv[])
+{
+   return assets::cook::RunCookWorker(assets::loaders::CookSourceFile);
+}
@@ -0,0 +1,188 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "asset-manager/pak/pak-writer.h"
+#include "asset-manager/cook/mip-chain.h"
+#include "asset-manager/cook/block-compression.h"
+#include "utils/hashed-string.h"
+
+#include "stb/stb_image.h"
+
+//Packs all files of the given directories into the single archive
+//Entries are keyed by the same path hash as the AssetManager uses, so paths must be relative to the engine working directory
+//
+//Usage: pak-packer [-c] [-t] [-q fast|normal|high] <output.pak> <directory>...
+//   -c   compress entries, when the compression doesn't give enough gain entry is stored as is
+//   -t   cook images, they are stored block compressed with the full mip chain instead of the source files
+//   -q   block compression quality of the cooked images, normal by default, high uses BC7 for the color images
+
+namespace
+{
+   bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& buffer)
+   {
+      FILE* file = fopen(path.string().c_str(), "rb");
+      if (!file)
+         return false;
+
+      fseek(file, 0, SEEK_END);
+      const long size = ftell(file);
+      rewind(file);
+
+      if (size < 0)
+      {
+         fclose(file);
+         return false;
+      }
+
+      buffer.resize(static_cast<size_t>(size));
+      const bool res = fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+      fclose(file);
+
+      return res;
+   }
+
+   bool IsImage(const std::filesystem::path& path)
+   {
+      const auto extension = path.extension();
+      return extension == ".png" || extension == ".jpg";
+   }
+
+   //Same result as the AssetManager gives for the loose image, so the cooked and loose assets are interchangeable
+   bool CookImage(const std::string& path, const assets::cook::CompressionQuality quality, std::vector<uint8_t>& buffer)
+   {
+      int32_t width, height, channels;
+      assets::PixelBuffer pixels(stbi_load_from_memory(buffer.data(), static_cast<int>(buffer.size()), &width, &height, &channels, 0));
+      if (!pixels)
+         return false;
+
+      assets::cook::FlipRows(pixels.get(), static_cast<size_t>(width) * channels, height);
+
+      assets::PixelBuffer chain;
+      std::vector<assets::MipLevel> mips;
+
+      const assets::cook::MipFilter filter = assets::cook::GetMipFilter(path);
+
+      if (!assets::cook::BuildMipChain(pixels.get(), width, height, channels, filter, chain, mips))
+         return false;
+
+      const assets::cook::BlockFormat format = assets::cook::SelectBlockFormat(filter, channels, quality);
+
+      assets::PixelBuffer blocks;
+      std::vector<assets::MipLevel> blockMips;
+
+      if (!assets::cook::CompressMipChain(chain.get(), mips, channels, format, quality, blocks, blockMips))
+         return false;
+
+      buffer = assets::cook::WriteTexture(width, height, channels, format, blocks.get(), blockMips);
+
+      return true;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   bool compress = false;
+   bool cookImages = false;
+   assets::cook::CompressionQuality quality = assets::cook::CompressionQuality::Normal;
+
+   int argIndex = 1;
+   for (; argIndex < argc && argv[argIndex][0] == '-'; ++argIndex)
+   {
+      if (!strcmp(argv[argIndex], "-c"))
+         compress = true;
+      else if (!strcmp(argv[argIndex], "-t"))
+         cookImages = true;
+      else if (!strcmp(argv[argIndex], "-q") && argIndex + 1 < argc)
+      {
+         const char* value = argv[++argIndex];
+
+         if (!strcmp(value, "fast"))
+            quality = assets::cook::CompressionQuality::Fast;
+         else if (!strcmp(value, "normal"))
+            quality = assets::cook::CompressionQuality::Normal;
+         else if (!strcmp(value, "high"))
+            quality = assets::cook::CompressionQuality::High;
+         else
+         {
+            printf("Unknown quality: %s\n", value);
+            return -1;
+         }
+      }
+      else
+         break;
+   }
+
+   if (argc - argIndex < 2)
+   {
+      printf("Usage: pak-packer [-c] [-t] [-q fast|normal|high] <output.pak> <directory>...\n");
+      return -1;
+   }
+
+   const char* outputPath = argv[argIndex++];
+
+   assets::pak::Writer writer;
+   if (!writer.Open(outputPath))
+   {
+      printf("Couldn't create archive: %s\n", outputPath);
+      return -1;
+   }
+
+   size_t totalSize = 0;
+   std::vector<uint8_t> buffer;
+
+   for (; argIndex < argc; ++argIndex)
+   {
+      for (auto& entry : std::filesystem::recursive_directory_iterator(argv[argIndex]))
+      {
+         if (!entry.is_regular_file())
+            continue;
+
+         //Generic path uses '/' separator on every platform, the same as paths in the engine code
+         const std::string path = entry.path().lexically_normal().generic_string();
+
+         if (!ReadFile(entry.path(), buffer))
+         {
+            printf("Couldn't read file: %s\n", path.c_str());
+            return -1;
+         }
+
+         uint32_t flags = assets::pak::EF_NONE;
+
+         if (cookImages && IsImage(entry.path()))
+         {
+            if (!CookImage(path, quality, buffer))
+            {
+               printf("Couldn't cook image: %s\n", path.c_str());
+               return -1;
+            }
+
+            flags |= assets::pak::EF_COOKED;
+         }
+
+         if (!writer.AddEntry(utils::HashFnv1a(path), buffer.data(), buffer.size(), compress, flags))
+         {
+            printf("Couldn't add file, it is duplicated or write failed: %s\n", path.c_str());
+            return -1;
+         }
+
+         const auto& toc = writer.GetToc();
+         printf("%s %zu -> %llu\n", path.c_str(), buffer.size(), static_cast<unsigned long long>(toc.back().StoredSize));
+
+         totalSize += buffer.size();
+      }
+   }
+
+   if (!writer.Finish())
+   {
+      printf("Couldn't finish archive: %s\n", outputPath);
+      return -1;
+   }
+
+   printf("Packed %zu files, %zu bytes into %s\n", writer.GetToc().size(), totalSize, outputPath);
+
+   return 0;
+}